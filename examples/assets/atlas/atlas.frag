@@ -0,0 +1,11 @@
+#version 460 core
+
+uniform sampler2DArray u_atlas_sampler;
+
+in vec2 m_uv;
+flat in float m_layer;
+out vec4 o_color;
+
+void main() {
+    o_color = texture(u_atlas_sampler, vec3(m_uv, m_layer));
+}
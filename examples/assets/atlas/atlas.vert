@@ -0,0 +1,15 @@
+#version 460 core
+
+layout(location = 0) in vec2 i_corner;  // per vertex, in [0, 1]^2
+layout(location = 1) in vec4 i_rect;    // per instance, x0 y0 x1 y1 in NDC
+layout(location = 2) in vec4 i_uv_rect; // per instance, u0 v0 u1 v1
+layout(location = 3) in float i_layer;  // per instance
+
+out vec2 m_uv;
+flat out float m_layer;
+
+void main() {
+    m_uv = mix(i_uv_rect.xy, i_uv_rect.zw, i_corner);
+    m_layer = i_layer;
+    gl_Position = vec4(mix(i_rect.xy, i_rect.zw, i_corner), 0.0, 1.0);
+}
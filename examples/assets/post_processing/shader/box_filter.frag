@@ -2,10 +2,16 @@
 
 uniform sampler2D u_input_texture_sampler;
 uniform vec2 u_window_size;
+uniform vec2 u_input_uv_scale;  // the part of the input holding the image, < 1 with dynamic resolution
 
 in vec2 m_uv;
 out vec4 o_color;
 
+vec2 input_uv(vec2 uv) {
+    vec2 half_texel = 0.5 / u_window_size;
+    return clamp(uv, half_texel, 1.0 - half_texel) * u_input_uv_scale;
+}
+
 void main() {
     vec2 texel_size = 1.0 / u_window_size;
 
@@ -13,7 +19,7 @@ void main() {
     for(int x = -1; x <= 1; x++) {
         for(int y = -1; y <= 1; y++) {
             vec2 sample_uv = m_uv + texel_size * vec2(float(x), float(y));
-            res += texture(u_input_texture_sampler, sample_uv).xyz;
+            res += texture(u_input_texture_sampler, input_uv(sample_uv)).xyz;
         }
     }
     res /= 9.0;
@@ -0,0 +1,14 @@
+// pointwise pass, see gfx-utils-core/pointwise_fusion.h
+
+uniform float u_saturation = 1.0;
+uniform float u_contrast = 1.0;  // around middle gray
+uniform vec3 u_tint = vec3(1.0);
+
+vec3 pointwise(vec3 color) {
+    const vec3 luma_weights = vec3(0.2126, 0.7152, 0.0722);
+    const float middle_gray = 0.18;
+
+    vec3 res = mix(vec3(dot(color, luma_weights)), color, u_saturation);
+    res = max(middle_gray * pow(max(res, 0.0) / middle_gray, vec3(u_contrast)), 0.0);
+    return res * u_tint;
+}
@@ -1,11 +1,24 @@
 #version 460 core
 
 uniform sampler2D u_input_texture_sampler;
-uniform vec2 u_window_size;
+uniform vec2 u_input_uv_scale;  // the part of the input holding the image, < 1 with dynamic resolution
 
 in vec2 m_uv;
 out vec4 o_color;
 
+// upscales (or just copies) the part of the input holding the image to the window, bilinear by hand
+// since the render targets are GL_NEAREST; texels outside that part are never fetched
 void main() {
-    o_color = texture(u_input_texture_sampler, m_uv);
+    vec2 image_size = u_input_uv_scale * vec2(textureSize(u_input_texture_sampler, 0));
+    ivec2 max_texel = max(ivec2(ceil(image_size)) - 1, ivec2(0));
+
+    vec2 texel_pos = m_uv * image_size - 0.5;
+    ivec2 texel = ivec2(floor(texel_pos));
+    vec2 weight = texel_pos - vec2(texel);
+
+    vec4 c00 = texelFetch(u_input_texture_sampler, clamp(texel, ivec2(0), max_texel), 0);
+    vec4 c10 = texelFetch(u_input_texture_sampler, clamp(texel + ivec2(1, 0), ivec2(0), max_texel), 0);
+    vec4 c01 = texelFetch(u_input_texture_sampler, clamp(texel + ivec2(0, 1), ivec2(0), max_texel), 0);
+    vec4 c11 = texelFetch(u_input_texture_sampler, clamp(texel + ivec2(1, 1), ivec2(0), max_texel), 0);
+    o_color = mix(mix(c00, c10, weight.x), mix(c01, c11, weight.x), weight.y);
 }
@@ -0,0 +1,7 @@
+// pointwise pass, see gfx-utils-core/pointwise_fusion.h
+
+uniform float u_exposure = 0.0;  // in stops
+
+vec3 pointwise(vec3 color) {
+    return color * exp2(u_exposure);
+}
@@ -0,0 +1,8 @@
+// pointwise pass, see gfx-utils-core/pointwise_fusion.h
+// on top of the sRGB encoding of the final pass
+
+uniform float u_gamma = 1.0;
+
+vec3 pointwise(vec3 color) {
+    return pow(max(color, 0.0), vec3(1.0 / u_gamma));
+}
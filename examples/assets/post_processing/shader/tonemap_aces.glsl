@@ -0,0 +1,11 @@
+// pointwise pass, see gfx-utils-core/pointwise_fusion.h
+// Narkowicz's fit of the ACES filmic curve, maps [0, inf) to [0, 1)
+
+vec3 pointwise(vec3 color) {
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    return clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+}
@@ -2,10 +2,16 @@
 
 uniform sampler2D u_input_texture_sampler;
 uniform vec2 u_window_size;
+uniform vec2 u_input_uv_scale;  // the part of the input holding the image, < 1 with dynamic resolution
 
 in vec2 m_uv;
 out vec4 o_color;
 
+vec2 input_uv(vec2 uv) {
+    vec2 half_texel = 0.5 / u_window_size;
+    return clamp(uv, half_texel, 1.0 - half_texel) * u_input_uv_scale;
+}
+
 uniform float strength;
 
 const vec3 gray_weights = vec3(0.299, 0.587, 0.114);
@@ -21,9 +27,9 @@ void main() {
     for(int x = -1; x <= 1; x++) {
         for(int y = -1; y <= 1; y++) {
             vec2 uv = m_uv + vec2(x, y) * texel_size;
-            edge += kernel[(1 - y) * 3 + (x + 1)] * dot(texture(u_input_texture_sampler, uv).xyz, gray_weights);
+            edge += kernel[(1 - y) * 3 + (x + 1)] * dot(texture(u_input_texture_sampler, input_uv(uv)).xyz, gray_weights);
         }
     }
 
-    o_color = vec4(clamp(strength * edge + texture(u_input_texture_sampler, m_uv).xyz, 0.0, 1.0), 1.0);
+    o_color = vec4(clamp(strength * edge + texture(u_input_texture_sampler, input_uv(m_uv)).xyz, 0.0, 1.0), 1.0);
 }
@@ -0,0 +1,170 @@
+#include <gfx-utils-core/app.h>
+#include <gfx-utils-core/debug_draw.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/render_pass.h>
+#include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/texture_atlas.h>
+#include <gfx-utils-core/vertex_buffer.h>
+
+#include <glad/glad.h>
+#include <imgui.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+
+constexpr int WINDOW_WIDTH = 1280;
+constexpr int WINDOW_HEIGHT = 960;
+constexpr const char *WINDOW_TITLE = "Example: atlas";
+constexpr const char *INPUT_TEXTURE_FOLDER = "assets/post_processing/input_image";
+constexpr int N_GENERATED_SPRITES = 96;
+constexpr int N_COLUMNS = 12;
+
+int main() {
+	using namespace gfxutils;
+
+	auto &app = App::instance();
+	app.init(WINDOW_TITLE, WINDOW_WIDTH, WINDOW_HEIGHT);
+	app.set_flag_vsync(true);
+	app.set_clear_color({ 0.341f, 0.808f, 0.980f });
+
+	ShaderProgram::ShaderProgramBuilder atlas_pass_shader_program_builder("atlas_pass_shader_program");
+	{
+		Shader::ShaderBuilder vs_builder("atlas_pass_vs");
+		auto vertex_shader = vs_builder
+		                         .set_type(ShaderType::VERTEX_SHADER)
+		                         .set_source_from_file("assets/atlas/atlas.vert")
+		                         .build();
+
+		Shader::ShaderBuilder fs_builder("atlas_pass_fs");
+		auto fragment_shader = fs_builder
+		                           .set_type(ShaderType::FRAGMENT_SHADER)
+		                           .set_source_from_file("assets/atlas/atlas.frag")
+		                           .build();
+
+		atlas_pass_shader_program_builder.add_shader(vertex_shader).add_shader(fragment_shader);
+	}
+	auto atlas_pass_shader_program = atlas_pass_shader_program_builder.build();
+
+	// pack every image of the post_processing example, plus a bunch of generated sprites of different sizes
+	TextureAtlas::TextureAtlasBuilder atlas_builder("sprite_atlas");
+	atlas_builder.set_page_size(1024, 1024).set_filter(GL_LINEAR);
+
+	namespace fs = std::filesystem;
+	if (fs::exists(INPUT_TEXTURE_FOLDER) && fs::is_directory(INPUT_TEXTURE_FOLDER)) {
+		for (const auto &entry : fs::directory_iterator(INPUT_TEXTURE_FOLDER)) {
+			if (entry.is_regular_file()) {
+				atlas_builder.add_image_from_file(entry.path().filename().string(), entry.path().string());
+			}
+		}
+	}
+
+	for (int i = 0; i < N_GENERATED_SPRITES; i++) {
+		size_t width = 32 + ((i * 37) % 96);
+		size_t height = 32 + ((i * 53) % 96);
+		Image sprite(width, height, 4, ImageElementType::U8);
+		for (size_t y = 0; y < height; y++) {
+			uint8_t *row = sprite.row(y);
+			for (size_t x = 0; x < width; x++) {
+				bool checker = ((x / 8) + (y / 8)) % 2 == 0;
+				row[(x * 4) + 0] = static_cast<uint8_t>(checker ? (i * 41) % 256 : 255);
+				row[(x * 4) + 1] = static_cast<uint8_t>(checker ? (i * 89) % 256 : 255);
+				row[(x * 4) + 2] = static_cast<uint8_t>(checker ? (i * 151) % 256 : 255);
+				row[(x * 4) + 3] = 255;
+			}
+		}
+		atlas_builder.add_image(std::format("sprite_{}", i), std::move(sprite));
+	}
+
+	auto atlas = std::move(atlas_builder).build();
+
+	// a unit quad instanced once per image, all of them drawn with a single draw call
+	std::vector<float> instances;
+	std::vector<glm::vec4> sprite_rects;  // x0 y0 x1 y1 in NDC, for the bounds overlay
+	const auto &entries = atlas.get_entries();
+	int n_rows = (static_cast<int>(entries.size()) + N_COLUMNS - 1) / N_COLUMNS;
+	float cell_width = 2.0f / N_COLUMNS;
+	float cell_height = 2.0f / static_cast<float>(std::max(n_rows, 1));
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		const auto &region = entries[i]._Region;
+		auto column = static_cast<float>(i % N_COLUMNS);
+		auto row = static_cast<float>(i / N_COLUMNS);
+
+		// keep the aspect ratio inside the cell
+		float scale = std::min(cell_width * WINDOW_WIDTH / static_cast<float>(region._Width),
+		                       cell_height * WINDOW_HEIGHT / static_cast<float>(region._Height)) *
+		              0.9f;
+		float half_width = static_cast<float>(region._Width) * scale / WINDOW_WIDTH * 0.5f;
+		float half_height = static_cast<float>(region._Height) * scale / WINDOW_HEIGHT * 0.5f;
+		float center_x = -1.0f + (column + 0.5f) * cell_width;
+		float center_y = 1.0f - (row + 0.5f) * cell_height;
+
+		const auto &uv = region._UVRect;
+		float instance[] = {
+			center_x - half_width, center_y - half_height, center_x + half_width, center_y + half_height,
+			uv.x, uv.y, uv.z, uv.w,
+			static_cast<float>(region._Page)
+		};
+		instances.insert(instances.end(), std::begin(instance), std::end(instance));
+		sprite_rects.emplace_back(instance[0], instance[1], instance[2], instance[3]);
+	}
+
+	std::vector<float> quad_corners = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+	auto sprite_vertex_buffer = VertexBuffer::VertexBufferBuilder("sprite_quads", std::move(quad_corners))
+	                                .add_attribute(2)  // corner (vec2)
+	                                .set_indices(std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 })
+	                                .add_instance_attribute(4)  // rectangle (vec4, x0 y0 x1 y1)
+	                                .add_instance_attribute(4)  // texture coordinates (vec4, u0 v0 u1 v1)
+	                                .add_instance_attribute(1)  // atlas layer (float)
+	                                .set_instance_data(std::move(instances))
+	                                .build();
+
+	auto debug_draw = DebugDraw::DebugDrawBuilder("debug_draw").build();
+
+	auto default_pass = RenderPass::RenderPassBuilder("default_pass").build();
+
+	RenderPassConfig render_pass_config;
+	render_pass_config._EnableDepthTest = false;
+	render_pass_config._EnableSRGB = false;
+
+	bool show_bounds = false;
+	app.run([&](float dt [[maybe_unused]]) {
+		ImGui::Begin("Control", nullptr, ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize);
+		{
+			ImGui::Text("%d image(s) in %d page(s), 1 instanced draw call", static_cast<int>(entries.size()), static_cast<int>(atlas.get_texture().get_info()._Layers));
+			ImGui::Checkbox("Show bounds", &show_bounds);
+			if (show_bounds) {
+				const auto &stats = debug_draw.get_stats();
+				ImGui::Text("Debug draw: %d vertices, %d draw call(s)", static_cast<int>(stats._NumVertices), static_cast<int>(stats._NumDrawCalls));
+			}
+		}
+		ImGui::End();
+
+		default_pass.use(render_pass_config, [&]() {
+			atlas_pass_shader_program.use();
+
+			atlas.use(0);
+			atlas_pass_shader_program.set_uniform("u_atlas_sampler", 0);
+
+			sprite_vertex_buffer.draw_instanced(sprite_vertex_buffer.get_instance_count());
+
+			// every outline goes into the same overlay batch, i.e. one upload and one draw call
+			auto [window_width, window_height] = app.get_window_size();
+			glm::vec2 screen_size(static_cast<float>(window_width), static_cast<float>(window_height));
+			if (show_bounds) {
+				for (const auto &rect : sprite_rects) {
+					glm::vec2 min((rect.x + 1.0f) * 0.5f * screen_size.x, (1.0f - rect.w) * 0.5f * screen_size.y);
+					glm::vec2 max((rect.z + 1.0f) * 0.5f * screen_size.x, (1.0f - rect.y) * 0.5f * screen_size.y);
+					debug_draw.overlay_rect(min, max, { 1.0f, 0.2f, 0.2f, 1.0f });
+				}
+			}
+			debug_draw.flush(glm::mat4(1.0f), screen_size);
+		});
+	});
+
+	app.shutdown();
+
+	return 0;
+}
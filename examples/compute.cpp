@@ -1,10 +1,18 @@
 #include <gfx-utils-core/app.h>
+#include <gfx-utils-core/render_graph.h>
 #include <gfx-utils-core/render_pass.h>
 #include <gfx-utils-core/shader_program.h>
-#include <gfx-utils-core/storage_buffer.h>
+#include <gfx-utils-core/typed_storage_buffer.h>
 #include <gfx-utils-core/vertex_buffer.h>
 #include <gfx-utils-core/vertices.h>
 
+#include <glm/glm.hpp>
+#include <imgui.h>
+
+#include <chrono>
+#include <future>
+#include <span>
+
 constexpr int WINDOW_WIDTH = 960;
 constexpr int WINDOW_HEIGHT = 960;
 constexpr const char *WINDOW_TITLE = "Example: Compute";
@@ -52,36 +60,78 @@ int main() {
 	default_pass_shader_program.use();
 	default_pass_shader_program.set_uniform("window_width", WINDOW_WIDTH);
 
-	auto default_pass = RenderPass::RenderPassBuilder("default_pass").build();
-
 	auto quad_vertex_buffer = VertexBuffer::VertexBufferBuilder("fullscreen_quad", g_screen_quad_vertices)
 	                              .add_attribute(2)  // position (vec2)
 	                              .add_attribute(2)  // texture coordinates (vec2)
 	                              .build();
-	auto storage_buffer = StorageBuffer::StorageBufferBuilder("compute_input_buffer")
-	                          .set_size(WINDOW_WIDTH * WINDOW_HEIGHT * 16)
+	auto storage_buffer = TypedStorageBuffer<glm::vec4>::TypedStorageBufferBuilder("compute_input_buffer")
+	                          .set_capacity(WINDOW_WIDTH * WINDOW_HEIGHT)
 	                          .build();
 
 	RenderPassConfig render_pass_config;
 	render_pass_config._EnableDepthTest = false;
 	render_pass_config._EnableSRGB = false;
 
+	// the average brightness of the fractal comes from an asynchronous readback, which lags a few frames behind but never stalls the GPU
+	std::future<StorageBufferReadback> brightness_read;
+	float average_brightness = 0.0f;
+
 	float time = 0.0f;
-	app.run([&](float dt [[maybe_unused]]) {
-		default_pass.use(render_pass_config, [&]() {
-			compute_shader_program.use();
-			compute_shader_program.set_uniform("time", time * 0.5f);
-			storage_buffer.bind(0);
-			glDispatchCompute(static_cast<GLuint>(WINDOW_WIDTH >> 4), static_cast<GLuint>(WINDOW_HEIGHT >> 4), 1);
-			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-			default_pass_shader_program.use();
-			storage_buffer.bind(0);
-			quad_vertex_buffer.use();
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			time += dt;
-		});
+	float frame_dt = 0.0f;
+
+	// the graph places the barriers: shader storage between the dispatch and the draw, buffer update before the readback
+	auto render_graph = RenderGraph::RenderGraphBuilder("compute_graph").build();
+	auto fractal_buffer = render_graph.import_buffer("fractal", storage_buffer.get_buffer());
+
+	render_graph.add_pass("fractal", RenderGraphPassType::COMPUTE)
+	    .write(fractal_buffer, RenderGraphUsage::STORAGE_WRITE)
+	    .set_execute([&](const RenderGraph::Context &) {
+		    compute_shader_program.use();
+		    compute_shader_program.set_uniform("time", time * 0.5f);
+		    storage_buffer.bind(compute_shader_program, "InputBuffer");
+		    glDispatchCompute(static_cast<GLuint>(WINDOW_WIDTH >> 4), static_cast<GLuint>(WINDOW_HEIGHT >> 4), 1);
+
+		    time += frame_dt;
+	    });
+
+	render_graph.add_pass("present", RenderGraphPassType::RASTER)
+	    .read(fractal_buffer, RenderGraphUsage::STORAGE_READ)
+	    .set_side_effect()
+	    .set_config(render_pass_config)
+	    .set_execute([&](const RenderGraph::Context &) {
+		    default_pass_shader_program.use();
+		    storage_buffer.bind(default_pass_shader_program, "InputBuffer");
+		    quad_vertex_buffer.use();
+		    glDrawArrays(GL_TRIANGLES, 0, 6);
+	    });
+
+	render_graph.add_pass("brightness_readback", RenderGraphPassType::TRANSFER)
+	    .read(fractal_buffer, RenderGraphUsage::COPY_SRC)
+	    .set_side_effect()
+	    .set_execute([&](const RenderGraph::Context &) {
+		    if (!brightness_read.valid()) {
+			    brightness_read = storage_buffer.get_buffer().read_async(0, storage_buffer.capacity() * sizeof(glm::vec4));
+		    }
+	    });
+
+	app.run([&](float dt) {
+		frame_dt = dt;
+		render_graph.execute();
+
+		storage_buffer.get_buffer().poll_async_reads();
+		if (brightness_read.valid() && brightness_read.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			auto readback = brightness_read.get();
+			auto pixels = std::span(reinterpret_cast<const glm::vec4 *>(readback._Data.data()), readback._Data.size() / sizeof(glm::vec4));
+			double sum = 0.0;
+			for (const auto &pixel : pixels) {
+				sum += (pixel.r + pixel.g + pixel.b) / 3.0f;
+			}
+			average_brightness = pixels.empty() ? 0.0f : static_cast<float>(sum / static_cast<double>(pixels.size()));
+		}
+
+		ImGui::Begin("Compute");
+		ImGui::Text("average brightness: %.3f", average_brightness);
+		ImGui::End();
 	});
 
 	app.shutdown();
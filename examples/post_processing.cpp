@@ -1,7 +1,14 @@
 #include <gfx-utils-core/app.h>
+#include <gfx-utils-core/dynamic_resolution.h>
+#include <gfx-utils-core/effect_chain.h>
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/gpu_timer.h>
+#include <gfx-utils-core/image_codec_registry.h>
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/render_pass.h>
+#include <gfx-utils-core/render_target_pool.h>
 #include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/tiled_image_processor.h>
 #include <gfx-utils-core/vertex_buffer.h>
 #include <gfx-utils-core/vertices.h>
 
@@ -9,10 +16,10 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui.h>
 
-#include <json/json.h>
+#include <algorithm>
 #include <filesystem>
 #include <format>
-#include <fstream>
+#include <optional>
 #include <unordered_set>
 
 constexpr int WINDOW_WIDTH = 1920;
@@ -21,141 +28,55 @@ constexpr const char *WINDOW_TITLE = "Example: post_processing";
 constexpr const char *CONFIG_FILE_PATH = "assets/post_processing/config.json";
 constexpr const char *SHADER_ROOT_PATH = "assets/post_processing/shader";
 constexpr const char *INPUT_TEXTURE_FOLDER = "assets/post_processing/input_image";
+constexpr const char *TILED_OUTPUT_FILE_PATH = "output_tiled.png";
+constexpr size_t TILE_SIZE = 1024;
+constexpr size_t TILE_APRON = 8;  // wider than the kernels under assets/post_processing/shader
+constexpr float MIN_RESOLUTION_SCALE = 0.5f;
 
 using namespace gfxutils;
 
 VertexBuffer g_quad_vertex_buffer;
 
-struct PostProcessingStage {
-	std::string _EffectName;
-	std::vector<ShaderProgram> _ShaderProgramVec;
-	std::vector<RenderPass> _RenderPassVec;
-	std::vector<Texture> _RenderTargetVec;
-
-	const Texture &execute(const Texture &input) {
-		RenderPassConfig render_pass_config;
-		render_pass_config._EnableDepthTest = false;
-		render_pass_config._EnableSRGB = false;
-
-		for (size_t i = 0; const auto &render_pass : _RenderPassVec) {
-			auto &shader_program = _ShaderProgramVec[i];
-			render_pass.use(render_pass_config, [&]() {
-				g_quad_vertex_buffer.use();
-				shader_program.use();
-				shader_program.set_uniform("u_input_texture_sampler", 0);
-				input.use(0);
-
-				glDrawArrays(GL_TRIANGLES, 0, 6);
-			});
-
-			++i;
-		}
-
-		return _RenderTargetVec.back();
-	}
-};
-
 int main() {
 	auto &app = App::instance();
 	app.init(WINDOW_TITLE, WINDOW_WIDTH, WINDOW_HEIGHT);
 	app.set_flag_vsync(false);
 	app.set_clear_color({ 0.341f, 0.808f, 0.980f });
 
-	auto load_shader = [](const std::string &pass_name, const std::string &vs_path, const std::string &fs_path) {
-		ShaderProgram::ShaderProgramBuilder shader_program_builder(std::format("{}_shader_program", pass_name));
-		Shader::ShaderBuilder vs_builder(std::format("{}_vs", pass_name));
-		auto vertex_shader = vs_builder
-		                         .set_type(ShaderType::VERTEX_SHADER)
-		                         .set_source_from_file(std::format("{}/{}", SHADER_ROOT_PATH, vs_path))
-		                         .build();
-
-		Shader::ShaderBuilder fs_builder(std::format("{}_fs", pass_name));
-		auto fragment_shader = fs_builder
-		                           .set_type(ShaderType::FRAGMENT_SHADER)
-		                           .set_source_from_file(std::format("{}/{}", SHADER_ROOT_PATH, fs_path))
-		                           .build();
-
-		shader_program_builder.add_shader(vertex_shader).add_shader(fragment_shader);
-
-		auto shader_program = shader_program_builder.build();
-		shader_program.use();
-		shader_program.set_uniform("u_window_size",
-		                           glm::vec2(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)));
-
-		return shader_program;
-	};
-
-	// load config file
-	std::ifstream config_file_in(CONFIG_FILE_PATH);
-	if (!config_file_in) {
-		g_logger->error("config file does not exist");
-		return -1;
-	}
-	Json::Value config_root;
-	config_file_in >> config_root;
-	config_file_in.close();
-
-	auto load_effects = [&](std::vector<PostProcessingStage> &effect_vec, const std::string &type) -> bool {
-		auto &root_node = config_root[type];
-		for (auto &effect_node : root_node) {
-			PostProcessingStage fx;
-
-			std::string fx_name = effect_node["fx_name"].asString();
-			auto &render_passes_node = effect_node["render_passes"];
-
-			g_logger->info("loading {} effect '{}' with {} render pass(s)", type, fx_name, render_passes_node.size());
-
-			if (render_passes_node.empty()) {
-				g_logger->error("effect must contain at least 1 render pass!");
-				return false;
-			}
-
-			fx._EffectName = fx_name;
-
-			for (auto &render_pass_node : render_passes_node) {
-				std::string pass_name = render_pass_node["pass_name"].asString();
-				g_logger->info("loading render pass '{}'", pass_name);
-
-				// prepare shaders
-				std::string vs_path = render_pass_node["vs_path"].asString();
-				std::string fs_path = render_pass_node["fs_path"].asString();
-				auto shader_program = load_shader(pass_name, vs_path, fs_path);
-
-				fx._ShaderProgramVec.push_back(shader_program);
-
-				// prepare render passes
-				auto render_target = Texture::TextureBuilder(std::format("{}/color", pass_name))
-				                         .set_size(WINDOW_WIDTH, WINDOW_HEIGHT)
-				                         .set_format(GL_RGBA32F)
-				                         .set_filter(GL_NEAREST)
-				                         .build();
-				auto render_pass = RenderPass::RenderPassBuilder(pass_name)
-				                       .add_color_attachment(render_target, false)
-				                       .build();
-
-				fx._RenderTargetVec.push_back(render_target);
-				fx._RenderPassVec.push_back(render_pass);
-			}
-
-			effect_vec.push_back(fx);
-		}
-		return true;
-	};
-
-	// load AA effects
-	std::vector<PostProcessingStage> effect_aa_vec;
-	if (!load_effects(effect_aa_vec, "aa")) {
-		return -1;
-	}
-
-	// load sharpening effects
-	std::vector<PostProcessingStage> effect_sharpening_vec;
-	if (!load_effects(effect_sharpening_vec, "sharpening")) {
+	// the effects of the config; AA, then sharpening, then the color effects in the config order
+	auto effect_chain = EffectChain::EffectChainBuilder("effect_chain")
+	                        .set_config_file(CONFIG_FILE_PATH)
+	                        .build();
+	if (!effect_chain.is_complete()) {
 		return -1;
 	}
+	auto effect_aa_names = effect_chain.get_effect_names("aa");
+	auto effect_sharpening_names = effect_chain.get_effect_names("sharpening");
+	auto effect_color_names = effect_chain.get_effect_names("color");
+
+	// render targets of the effects, window-sized ones follow the window when it's resized
+	auto render_target_pool = RenderTargetPool::RenderTargetPoolBuilder("render_target_pool").build();
+	RenderTargetDesc window_target_desc{ ._InternalFormat = GL_RGBA32F, ._WindowScale = 1.0f };
+
+	// tiled mode: the same effects with tile-sized render targets, for input files of any size
+	auto tiled_processor = TiledImageProcessor::TiledImageProcessorBuilder("tiled_processor")
+	                           .set_tile_size(TILE_SIZE)
+	                           .set_apron(TILE_APRON)
+	                           .build();
+	size_t tile_texture_size = tiled_processor.get_tile_texture_size();
+	RenderTargetDesc tile_target_desc{ ._Width = tile_texture_size, ._Height = tile_texture_size, ._InternalFormat = GL_RGBA32F };
 
 	// prepare default resources (final pass)
-	auto default_pass_shader_program = load_shader("default_pass", "default.vert", "default.frag");
+	auto default_pass_shader_program = ShaderProgram::ShaderProgramBuilder("default_pass_shader_program")
+	                                       .add_shader(Shader::ShaderBuilder("default_pass_vs")
+	                                                       .set_type(ShaderType::VERTEX_SHADER)
+	                                                       .set_source_from_file(std::format("{}/default.vert", SHADER_ROOT_PATH))
+	                                                       .build())
+	                                       .add_shader(Shader::ShaderBuilder("default_pass_fs")
+	                                                       .set_type(ShaderType::FRAGMENT_SHADER)
+	                                                       .set_source_from_file(std::format("{}/default.frag", SHADER_ROOT_PATH))
+	                                                       .build())
+	                                       .build();
 	auto default_pass = RenderPass::RenderPassBuilder("default_pass").build();
 
 	// prepare vertices
@@ -164,15 +85,17 @@ int main() {
 	                           .add_attribute(2)  // texture coordinates (vec2)
 	                           .build();
 
+	// the effects work on linear colors, the final pass encodes them back to sRGB
 	RenderPassConfig render_pass_config;
 	render_pass_config._EnableDepthTest = false;
-	render_pass_config._EnableSRGB = false;
+	render_pass_config._EnableSRGB = true;
 
 	// detect images under assets/post_processing/input_image folder
 	// here we guarantee at least one image is available, or the program aborts
 	int curr_selected_texture = 0;
 	std::vector<Texture> input_texture_vec;
 	std::vector<std::string> input_texture_names;
+	std::vector<std::string> input_texture_paths;
 
 	namespace fs = std::filesystem;
 	if (!fs::exists(INPUT_TEXTURE_FOLDER) || !fs::is_directory(INPUT_TEXTURE_FOLDER) || fs::is_empty(INPUT_TEXTURE_FOLDER)) {
@@ -192,104 +115,184 @@ int main() {
 			    ext == ".bmp" || ext == ".tga") {
 				auto image_path = entry.path();
 				auto texture = Texture::TextureBuilder(image_path.stem().string())
-				                   .set_data_from_file(image_path.string())
-				                   .set_format(GL_RGBA32F)  // here we assume the input image is all in linear color space (for now)
+				                   .set_data_from_file(image_path.string(), "", ColorConversion::SRGB_TO_LINEAR)
+				                   .set_format(GL_RGBA32F)
 				                   .set_filter(GL_NEAREST)
 				                   .build();
 				input_texture_vec.push_back(texture);
 				input_texture_names.push_back(image_path.filename().string());
+				input_texture_paths.push_back(image_path.string());
 			}
 		}
 	}
 
-	// shader reflector utility function
-	auto reflect_shader = [](std::vector<ShaderProgram> &shader_program_vec) {
-		static std::unordered_set<std::string> uniform_name_exclude_set{ "u_input_texture_sampler", "u_window_size" };
-		for (auto &shader_program : shader_program_vec) {
-			if (ImGui::CollapsingHeader(shader_program.get_name().c_str())) {
-				shader_program.use();
-
-				bool has_uniform = false;
-				auto uniform_info_vec = shader_program.get_all_uniform_info();
-				for (auto &uniform_info : uniform_info_vec) {
-					if (!uniform_name_exclude_set.contains(uniform_info._Name)) {
-						has_uniform = true;
-
-						const char *label = uniform_info._Name.c_str();
-
-						switch (uniform_info._Type) {
-						case ShaderDataType::INT:
-							{
-								static int value = 0;
-								if (ImGui::InputInt(label, &value)) {
-									shader_program.set_uniform(uniform_info._Name, value);
-								}
-								break;
-							}
-						case ShaderDataType::FLOAT:
-							{
-								static float value = 0.0f;
-								if (ImGui::InputFloat(label, &value)) {
-									shader_program.set_uniform(uniform_info._Name, value);
-								}
-								break;
-							}
-						case ShaderDataType::VEC2:
-							{
-								static glm::vec2 value(0.0f);
-								if (ImGui::InputFloat2(label, glm::value_ptr(value))) {
-									shader_program.set_uniform(uniform_info._Name, value);
-								}
-								break;
-							}
-						case ShaderDataType::VEC3:
-							{
-								static glm::vec3 value(0.0f);
-								if (ImGui::InputFloat3(label, glm::value_ptr(value))) {
-									shader_program.set_uniform(uniform_info._Name, value);
-								}
-								break;
-							}
-						default:
-							break;
-						}
+	// the parameters of the selected effects, kept by the chain across frames and selections
+	auto edit_parameters = [&](const std::vector<std::string> &effect_names) {
+		for (const auto &effect_name : effect_names) {
+			if (!ImGui::CollapsingHeader(effect_name.c_str())) {
+				continue;
+			}
+
+			auto parameters = effect_chain.get_parameters(effect_name);
+			if (parameters.empty()) {
+				ImGui::Text("(no uniforms)");
+			}
+			for (auto &parameter : parameters) {
+				auto label = std::format("{}##{}", parameter._Name, effect_name);
+				bool is_changed = false;
+				switch (parameter._Type) {
+				case ShaderDataType::INT:
+					{
+						int value = static_cast<int>(parameter._Value.x);
+						is_changed = ImGui::InputInt(label.c_str(), &value);
+						parameter._Value.x = static_cast<float>(value);
+						break;
 					}
+				case ShaderDataType::FLOAT:
+					is_changed = ImGui::InputFloat(label.c_str(), &parameter._Value.x);
+					break;
+				case ShaderDataType::VEC2:
+					is_changed = ImGui::InputFloat2(label.c_str(), glm::value_ptr(parameter._Value));
+					break;
+				case ShaderDataType::VEC3:
+					is_changed = ImGui::InputFloat3(label.c_str(), glm::value_ptr(parameter._Value));
+					break;
+				default:
+					break;
 				}
-
-				if (!has_uniform) {
-					ImGui::Text("(no uniforms)");
+				if (is_changed) {
+					effect_chain.set_parameter(effect_name, parameter._Name, parameter._Value);
 				}
 			}
 		}
 	};
 
-	// AA
-	int curr_selected_aa = 0;
+	// the selection by name, so it outlives reloads of the config
+	// AA, empty for none
+	std::string selected_aa;
+
+	// sharpening, empty for none
+	std::string selected_sharpening;
 
-	// sharpening
-	int curr_selected_sharpening = 0;
+	// color, any number of them
+	std::unordered_set<std::string> enabled_color_effects;
 
 	// perf
-	constexpr int QUERY_FREQ = 10;
-	int frame_cnt = 0;  // read gpu query every `QUERY_FREQ` frames
 	float frame_time_average = 0.0f;
 	float gpu_time_average = 0.0f;
-	GLuint gpu_time_query;
+	auto gpu_timer = GPUTimer::GPUTimerBuilder("effects_timer").build();  // the effects and the default pass, ImGui excluded
+	GLStateCacheStats gl_state_stats;                                       // same
+
+	bool prefer_compute = true;  // the compute implementation of the effects that have one
+	bool is_pointwise_fusion_enabled = true;
+	bool is_auto_precision_enabled = true;  // the target formats declared by the passes rather than GL_RGBA32F everywhere
+	std::optional<float> precision_error;   // of the latest validation
+
+	// dynamic resolution: the effects render into a scaled viewport of their targets, the default pass upscales
+	bool is_dynamic_resolution_enabled = false;
+	float target_gpu_ms = 4.0f;
+	DynamicResolutionController resolution_controller(target_gpu_ms, MIN_RESOLUTION_SCALE);
+
+	// the selected effects, in order
+	auto get_selected_effects = [&]() {
+		std::vector<std::string> res;
+		if (std::ranges::find(effect_aa_names, selected_aa) != effect_aa_names.end()) {
+			res.push_back(selected_aa);
+		}
+		if (std::ranges::find(effect_sharpening_names, selected_sharpening) != effect_sharpening_names.end()) {
+			res.push_back(selected_sharpening);
+		}
+		for (const auto &effect_color_name : effect_color_names) {
+			if (enabled_color_effects.contains(effect_color_name)) {
+				res.push_back(effect_color_name);
+			}
+		}
+		return res;
+	};
+
+	// the selected effects, chained; their targets go back to the pool at the end of the frame
+	auto run_effects = [&](const Texture &input, float resolution_scale, glm::vec2 &uv_scale) {
+		auto output = effect_chain.execute(input, uv_scale, render_target_pool, window_target_desc, resolution_scale);
+		return output.has_value() ? output->_Texture : input;
+	};
 
+	auto &gl_state_cache = GLStateCache::instance();
 	app.run([&](float dt) {
+		gl_state_cache.reset_stats();
+
+		if (effect_chain.poll_changes()) {
+			effect_aa_names = effect_chain.get_effect_names("aa");
+			effect_sharpening_names = effect_chain.get_effect_names("sharpening");
+			effect_color_names = effect_chain.get_effect_names("color");
+		}
+
+		auto selected_effects = get_selected_effects();
+		effect_chain.set_effects(selected_effects);
+		effect_chain.set_prefer_compute(prefer_compute);
+		effect_chain.set_fusion_enabled(is_pointwise_fusion_enabled);
+		effect_chain.set_auto_precision_enabled(is_auto_precision_enabled);
+
+		gpu_timer.begin();
+
+		const auto &input = input_texture_vec[curr_selected_texture];
+		float resolution_scale = is_dynamic_resolution_enabled ? resolution_controller.get_scale() : 1.0f;
+		glm::vec2 uv_scale(1.0f);
+		auto output = run_effects(input, resolution_scale, uv_scale);
+
+		// also the upscale pass, it filters the part of the output holding the image up to the window size
+		default_pass.use(render_pass_config, [&]() {
+			g_quad_vertex_buffer.use();
+			default_pass_shader_program.use();
+
+			output.use(0);
+			default_pass_shader_program.set_uniform("u_input_texture_sampler", 0);
+			default_pass_shader_program.set_uniform("u_input_uv_scale", uv_scale);
+
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		});
+		gl_state_cache.set_capability(GL_FRAMEBUFFER_SRGB, false);  // ImGui colors are sRGB already
+		gl_state_stats = gl_state_cache.get_stats();
+
+		gpu_timer.end();
+
 		ImGui::Begin("Control");
 		{
 			ImGui::SeparatorText("Profiling");
 
 			// export buttons
-			if (curr_selected_sharpening != 0 || curr_selected_aa != 0) {
+			if (!selected_effects.empty()) {
+				// the output on screen may be rendered at a lower resolution, exports run the effects again at full resolution
+				auto get_full_resolution_output = [&]() {
+					glm::vec2 full_uv_scale(1.0f);
+					return resolution_scale < 1.0f ? run_effects(input, 1.0f, full_uv_scale) : output;
+				};
 				if (ImGui::Button("export framebuffer")) {
-					if (curr_selected_sharpening != 0) {
-						size_t sharpening_id = curr_selected_sharpening - 1;
-						effect_sharpening_vec[sharpening_id]._RenderTargetVec.back().export_to_file("output.png");
-					} else if (curr_selected_aa != 0) {
-						size_t aa_id = curr_selected_aa - 1;
-						effect_aa_vec[aa_id]._RenderTargetVec.back().export_to_file("output.png");
+					ImageCodecRegistry::instance().encode("output.png",
+					                                      get_full_resolution_output().read_to_image(ImageElementType::F32).convert(ImageElementType::U8, ColorConversion::LINEAR_TO_SRGB));
+				}
+				if (ImGui::Button("export framebuffer (float)")) {
+					get_full_resolution_output().export_to_file("output.pfm");  // keeps the full GL_RGBA32F precision, in linear color space
+				}
+
+				// runs the selected effects on the input file itself rather than the window-sized texture,
+				// so the output keeps the resolution of the input however large it is
+				if (ImGui::Button("process input file (tiled)")) {
+					// the processor reads the output tile back before the next one is rendered, so it can be recycled then
+					std::optional<PooledRenderTarget> output_tile;
+					tiled_processor.process(input_texture_paths[curr_selected_texture],
+					                        TILED_OUTPUT_FILE_PATH,
+					                        [&](const Texture &input_tile) -> const Texture & {
+						                        if (output_tile.has_value()) {
+							                        render_target_pool.release(*output_tile);
+							                        output_tile.reset();
+						                        }
+
+						                        glm::vec2 tile_uv_scale(1.0f);
+						                        output_tile = effect_chain.execute(input_tile, tile_uv_scale, render_target_pool, tile_target_desc);
+						                        return output_tile.has_value() ? output_tile->_Texture : input_tile;
+					                        });
+					if (output_tile.has_value()) {
+						render_target_pool.release(*output_tile);
 					}
 				}
 			}
@@ -297,6 +300,55 @@ int main() {
 			ImGui::Text("Frame time (avg): %fs", frame_time_average);
 			ImGui::Text("GPU time (avg): %fms", gpu_time_average);
 
+			ImGui::Checkbox("Compute shaders (where available)", &prefer_compute);
+			ImGui::Checkbox("Fuse pointwise passes", &is_pointwise_fusion_enabled);
+			ImGui::Checkbox("Declared target precision", &is_auto_precision_enabled);
+			if (is_auto_precision_enabled) {
+				ImGui::SameLine();
+				if (ImGui::Button("validate")) {
+					precision_error = effect_chain.validate_precision(input, render_target_pool, window_target_desc);
+				}
+				if (precision_error.has_value()) {
+					ImGui::SameLine();
+					ImGui::Text("max error vs RGBA32F: %g", *precision_error);
+				}
+			}
+			// the GPU time of each pass, a few frames late like the total
+			auto get_format_name = [](GLenum format) {
+				switch (format) {
+				case GL_RGBA8:
+					return "RGBA8";
+				case GL_R11F_G11F_B10F:
+					return "R11F_G11F_B10F";
+				case GL_RGBA16F:
+					return "RGBA16F";
+				default:
+					return "RGBA32F";
+				}
+			};
+			for (const auto &pass_stats : effect_chain.get_pass_stats()) {
+				auto text = std::format("  {} ({}, {}): {:.3f}ms", pass_stats._Name, pass_stats._IsCompute ? "cs" : "fs", get_format_name(pass_stats._Format), pass_stats._GPUMs.value_or(0.0f));
+				if (pass_stats._NumConfigPasses > 1) {
+					text += std::format(" ({} passes fused)", pass_stats._NumConfigPasses);
+				}
+				ImGui::TextUnformatted(text.c_str());
+			}
+			ImGui::Checkbox("Dynamic resolution", &is_dynamic_resolution_enabled);
+			if (is_dynamic_resolution_enabled) {
+				if (ImGui::SliderFloat("Target GPU time (ms)", &target_gpu_ms, 0.5f, 33.0f)) {
+					resolution_controller.set_target_ms(target_gpu_ms);
+				}
+				auto effects_resolution = default_pass.get_viewport_size(resolution_scale);
+				ImGui::Text("Resolution scale: %.3f (%dx%d)", resolution_scale, effects_resolution.x, effects_resolution.y);
+			}
+
+			auto pool_stats = render_target_pool.get_stats();
+			ImGui::Text("Render targets: %zu (%.1fMB, peak %.1fMB)",
+			            pool_stats._NumSlots,
+			            static_cast<double>(pool_stats._AllocatedBytes) / (1 << 20),
+			            static_cast<double>(pool_stats._PeakBytes) / (1 << 20));
+			ImGui::Text("GL state calls: %zu (%zu redundant skipped)", gl_state_stats._NumCalls, gl_state_stats._NumSkipped);
+
 			ImGui::SeparatorText("Basics");
 
 			// input image selection
@@ -309,90 +361,55 @@ int main() {
 			}
 
 			// aa & sharpening selection
-			{
-				std::vector<const char *> aa_options;
-				aa_options.push_back("(none)");
-				for (const auto &effect_aa : effect_aa_vec) {
-					aa_options.push_back(effect_aa._EffectName.c_str());
+			auto effect_combo = [](const char *label, const std::vector<std::string> &effect_names, std::string &selected_effect) {
+				std::vector<const char *> options;
+				options.push_back("(none)");
+				int curr_selected = 0;
+				for (const auto &effect_name : effect_names) {
+					if (effect_name == selected_effect) {
+						curr_selected = static_cast<int>(options.size());
+					}
+					options.push_back(effect_name.c_str());
 				}
-				ImGui::Combo("AA", &curr_selected_aa, aa_options.data(), static_cast<int>(aa_options.size()));
-
-				std::vector<const char *> sharpening_options;
-				sharpening_options.push_back("(none)");
-				for (const auto &effect_sharpening : effect_sharpening_vec) {
-					sharpening_options.push_back(effect_sharpening._EffectName.c_str());
+				if (ImGui::Combo(label, &curr_selected, options.data(), static_cast<int>(options.size()))) {
+					selected_effect = curr_selected == 0 ? "" : effect_names[curr_selected - 1];
+				}
+			};
+			effect_combo("AA", effect_aa_names, selected_aa);
+			effect_combo("Sharpening", effect_sharpening_names, selected_sharpening);
+
+			// color effects, applied in this order
+			for (const auto &effect_color_name : effect_color_names) {
+				bool is_enabled = enabled_color_effects.contains(effect_color_name);
+				if (ImGui::Checkbox(effect_color_name.c_str(), &is_enabled)) {
+					if (is_enabled) {
+						enabled_color_effects.insert(effect_color_name);
+					} else {
+						enabled_color_effects.erase(effect_color_name);
+					}
 				}
-				ImGui::Combo("Sharpening", &curr_selected_sharpening, sharpening_options.data(), static_cast<int>(sharpening_options.size()));
 			}
 		}
 
 		ImGui::SeparatorText("Shader Configs");
 
-		// gpu time measurement start
-		if (frame_cnt == 0) {
-			glGenQueries(1, &gpu_time_query);
-			glBeginQuery(GL_TIME_ELAPSED, gpu_time_query);
-		}
-
-		if (curr_selected_aa != 0) {
-			size_t aa_id = curr_selected_aa - 1;
-			effect_aa_vec[aa_id].execute(input_texture_vec[curr_selected_texture]);
-
-			reflect_shader(effect_aa_vec[aa_id]._ShaderProgramVec);
-		}
-
-		if (curr_selected_sharpening != 0) {
-			size_t sharpening_id = curr_selected_sharpening - 1;
-			if (curr_selected_aa == 0) {
-				effect_sharpening_vec[sharpening_id].execute(input_texture_vec[curr_selected_texture]);
-			} else {
-				size_t aa_id = curr_selected_aa - 1;
-				effect_sharpening_vec[sharpening_id].execute(effect_aa_vec[aa_id]._RenderTargetVec.back());
-			}
-
-			reflect_shader(effect_sharpening_vec[sharpening_id]._ShaderProgramVec);
-		}
+		edit_parameters(selected_effects);
 
 		ImGui::End();
 
-		default_pass.use(render_pass_config, [&]() {
-			g_quad_vertex_buffer.use();
-			default_pass_shader_program.use();
+		render_target_pool.end_frame();
 
-			if (curr_selected_sharpening != 0) {
-				size_t sharpening_id = curr_selected_sharpening - 1;
-				effect_sharpening_vec[sharpening_id]._RenderTargetVec.back().use(0);
-			} else if (curr_selected_aa != 0) {
-				size_t aa_id = curr_selected_aa - 1;
-				effect_aa_vec[aa_id]._RenderTargetVec.back().use(0);
-			} else {
-				input_texture_vec[curr_selected_texture].use(0);
+		// results come back a few frames late, the timer never waits for them
+		if (auto gpu_ms = gpu_timer.take_ms(); gpu_ms.has_value()) {
+			gpu_time_average = (gpu_time_average + *gpu_ms) * 0.5f;
+			if (is_dynamic_resolution_enabled) {
+				resolution_controller.update(gpu_ms);
 			}
-			default_pass_shader_program.set_uniform("u_input_texture_sampler", 0);
-
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-		});
-
-		if (frame_cnt == 0) {
-			glEndQuery(GL_TIME_ELAPSED);
-		}
-
-		// gpu time measurement end
-		if (frame_cnt == QUERY_FREQ) {
-			GLuint64 result = 0;
-			glGetQueryObjectui64v(gpu_time_query, GL_QUERY_RESULT, &result);
-			gpu_time_average = (gpu_time_average + static_cast<float>(result) / 1e6f) * 0.5f;
-
-			frame_cnt = 0;
-		} else {
-			++frame_cnt;
 		}
 
 		frame_time_average = (frame_time_average + dt) * 0.5f;
 	});
 
-	glDeleteQueries(1, &gpu_time_query);
-
 	app.shutdown();
 
 	return 0;
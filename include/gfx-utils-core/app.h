@@ -22,6 +22,7 @@ using OnWindowSizeFunc = std::function<void(int width, int height)>;
 class App : public Singleton<App> {
 private:
 	GLFWwindow *_Window;
+	bool _IsHeadless = false;
 
 	std::string _WindowTitle;
 	int _WindowWidth;
@@ -39,6 +40,9 @@ private:
 
 public:
 	void init(const std::string &title, int width, int height);
+	// GL context on an invisible window, without ImGui or input callbacks, for offline processing (`run()` is not available)
+	// returns false if no context could be created
+	bool init_headless();
 	void run(const std::function<void(float delta_time)> &callback);
 	void shutdown();
 
@@ -62,8 +66,8 @@ public:
 	void on_window_size(int width, int height);
 
 private:
-	void _init_window(const std::string &title, int width, int height);
-	void _init_opengl() const;
+	bool _init_window(const std::string &title, int width, int height, bool visible);
+	bool _init_opengl() const;
 	void _init_IMGUI();
 	void _init_IMGUI_styles();
 	void _init_callbacks();
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gfxutils {
+
+struct AtlasRegion {
+	size_t _Page;
+	size_t _X;  // texels, origin at the bottom-left as in GL
+	size_t _Y;
+	size_t _Width;
+	size_t _Height;
+	// (u0, v0, u1, v1) on the outer edges of the rectangle, a GL_LINEAR lookup there reaches half a texel into the
+	// padding: without padding, inset the rect by half a texel (0.5 / page size) on each side to avoid bleeding
+	glm::vec4 _UVRect;
+};
+
+// skyline bottom-left rectangle packer, opens a new page whenever a rectangle does not fit into the existing ones
+class AtlasPacker {
+private:
+	struct SkylineNode {
+		size_t _X;
+		size_t _Y;
+		size_t _Width;
+	};
+
+	size_t _PageWidth;
+	size_t _PageHeight;
+	size_t _Padding;
+	std::vector<std::vector<SkylineNode>> _Pages;
+
+public:
+	// `padding` texels are kept free on every side of each rectangle to avoid filtering bleed, the region is the inner rectangle
+	AtlasPacker(size_t page_width, size_t page_height, size_t padding = 1);
+
+	// returns std::nullopt if the rectangle is larger than a page
+	[[nodiscard]] std::optional<AtlasRegion> pack(size_t width, size_t height);
+	// packs in descending height order for tighter pages, results are in input order
+	[[nodiscard]] std::vector<std::optional<AtlasRegion>> pack_all(const std::vector<std::pair<size_t, size_t>> &sizes);
+
+	[[nodiscard]] size_t get_page_count() const;
+	[[nodiscard]] size_t get_page_width() const;
+	[[nodiscard]] size_t get_page_height() const;
+
+private:
+	[[nodiscard]] std::optional<AtlasRegion> _pack_into_page(size_t page, size_t width, size_t height);
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/texture.h>
+#include <gfx-utils-core/tiled_image_processor.h>
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+struct BatchJob {
+	std::string _InputPath;
+	std::string _OutputPath;
+};
+
+struct BatchProcessingStats {
+	size_t _NumImages = 0;  // processed successfully
+	size_t _NumFailed = 0;
+	size_t _NumPixels = 0;  // of the processed images
+	size_t _NumTiles = 0;
+	double _Seconds = 0.0;
+
+	[[nodiscard]] double get_images_per_second() const { return (_Seconds > 0.0 ? static_cast<double>(_NumImages) / _Seconds : 0.0); }
+	[[nodiscard]] double get_megapixels_per_second() const { return (_Seconds > 0.0 ? static_cast<double>(_NumPixels) / 1e6 / _Seconds : 0.0); }
+};
+
+// runs a GPU processing step over many image files with the stages of consecutive images overlapped:
+//   decode (worker threads) -> upload (PBO) -> process -> readback (PBO + fence) -> encode (worker threads)
+// the stages are connected by bounded queues, so memory holds at most a few images per stage whatever the number of files
+// images are processed in fixed-size tiles like TiledImageProcessor, so one set of render targets serves every image size
+class BatchImageProcessor : public IBuildTarget<BatchImageProcessor> {
+public:
+	using TileFunc = TiledImageProcessor::TileFunc;
+
+private:
+	size_t _TileSize;
+	size_t _Apron;
+	size_t _NumDecodeThreads;
+	size_t _NumEncodeThreads;
+	size_t _QueueCapacity;
+	Texture _InputTile;
+	std::vector<GLuint> _UploadPBOs;    // ring, one slot per tile in flight
+	std::vector<GLuint> _ReadbackPBOs;  // ring, one slot per tile in flight
+
+public:
+	class BatchImageProcessorBuilder : public IBuilder<BatchImageProcessorBuilder, BatchImageProcessor> {
+	private:
+		size_t _TileSize = 1024;
+		size_t _Apron = 16;
+		GLenum _InternalFormat = GL_RGBA32F;
+		size_t _NumDecodeThreads = 0;
+		size_t _NumEncodeThreads = 0;
+		size_t _QueueCapacity = 4;
+		size_t _NumTilesInFlight = 3;
+
+	public:
+		BatchImageProcessorBuilder(const std::string &name);
+
+		// see TiledImageProcessor::TiledImageProcessorBuilder
+		BatchImageProcessorBuilder &set_tile_size(size_t tile_size);
+		BatchImageProcessorBuilder &set_apron(size_t apron);
+		BatchImageProcessorBuilder &set_format(GLenum internal_format);
+		// 0: half of the hardware threads each
+		BatchImageProcessorBuilder &set_thread_count(size_t n_decode_threads, size_t n_encode_threads);
+		// the number of decoded images waiting for the GPU, and of processed images waiting for an encoder
+		BatchImageProcessorBuilder &set_queue_capacity(size_t capacity);
+		// the number of tiles whose readback is pending before the oldest one is waited for
+		BatchImageProcessorBuilder &set_tiles_in_flight(size_t n_tiles);
+
+		[[nodiscard]] BatchImageProcessor _build() const;
+	};
+
+	[[nodiscard]] size_t get_tile_size() const;
+	[[nodiscard]] size_t get_apron() const;
+	// the size of the textures passed to and returned from the TileFunc
+	[[nodiscard]] size_t get_tile_texture_size() const;
+
+	// outputs are RGBA, encoded by the codec matching the output extension; the images finish in no particular order
+	// returns false if any job failed, the others are still processed
+	bool process(const std::vector<BatchJob> &jobs, const TileFunc &tile_func, BatchProcessingStats *stats = nullptr) const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace gfxutils {
+
+// multi-producer multi-consumer FIFO with a fixed capacity, producers block while it is full,
+// so a slow stage of a pipeline holds back the faster ones instead of piling up their output
+template<typename T>
+class BoundedQueue {
+private:
+	std::deque<T> _Items;
+	size_t _Capacity;
+	bool _IsClosed = false;
+	mutable std::mutex _Mutex;
+	std::condition_variable _NotFull;
+	std::condition_variable _NotEmpty;
+
+public:
+	explicit BoundedQueue(size_t capacity)
+	    : _Capacity(capacity == 0 ? 1 : capacity) {
+	}
+
+	BoundedQueue(const BoundedQueue &) = delete;
+	BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+	// blocks while the queue is full, returns false (and drops `item`) if the queue is closed
+	bool push(T item) {
+		std::unique_lock lock(_Mutex);
+		_NotFull.wait(lock, [&]() { return _Items.size() < _Capacity || _IsClosed; });
+		if (_IsClosed) {
+			return false;
+		}
+
+		_Items.push_back(std::move(item));
+		lock.unlock();
+		_NotEmpty.notify_one();
+		return true;
+	}
+
+	// blocks until an item is available, returns std::nullopt once the queue is closed and drained
+	[[nodiscard]] std::optional<T> pop() {
+		std::unique_lock lock(_Mutex);
+		_NotEmpty.wait(lock, [&]() { return !_Items.empty() || _IsClosed; });
+		if (_Items.empty()) {
+			return std::nullopt;
+		}
+
+		T item = std::move(_Items.front());
+		_Items.pop_front();
+		lock.unlock();
+		_NotFull.notify_one();
+		return item;
+	}
+
+	// wakes every blocked producer and consumer, items already queued can still be popped
+	void close() {
+		{
+			std::lock_guard lock(_Mutex);
+			_IsClosed = true;
+		}
+		_NotFull.notify_all();
+		_NotEmpty.notify_all();
+	}
+
+	[[nodiscard]] size_t size() const {
+		std::lock_guard lock(_Mutex);
+		return _Items.size();
+	}
+
+	[[nodiscard]] size_t get_capacity() const {
+		return _Capacity;
+	}
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/texture.h>
+#include <gfx-utils-core/vertex_buffer.h>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfxutils {
+
+struct CommandBufferStats {
+	size_t _NumCommands = 0;
+	// state changes between consecutive commands of the last submit
+	size_t _NumProgramChanges = 0;
+	size_t _NumTextureChanges = 0;
+	size_t _NumVertexArrayChanges = 0;
+};
+
+// records draws and dispatches as plain structs with the state they need (program, textures, vertex array, uniforms),
+// then sorts them by a 64-bit key (pass, program, textures, vertex array) and replays them through the GLStateCache
+// recording makes no GL calls, so buffers can be filled on worker threads and merged with append() on the GL thread
+// passes keep their order, commands within a pass are reordered: put commands that depend on each other in different passes
+// NOTE: the recorded objects must stay alive until the buffer is submitted
+class CommandBuffer {
+public:
+	static constexpr size_t MAX_TEXTURE_UNITS = 8;
+	static constexpr size_t MAX_PASSES = 256;
+
+private:
+	enum class CommandType : uint8_t {
+		DRAW,
+		DISPATCH
+	};
+
+	enum class UniformType : uint8_t {
+		INT,
+		FLOAT,
+		VEC2,
+		VEC3,
+		VEC4,
+		MAT4
+	};
+
+	struct TextureBinding {
+		GLuint _Texture;
+		GLenum _Target;
+		uint8_t _Unit;
+	};
+
+	struct Uniform {
+		GLint _Location;
+		UniformType _Type;
+		std::array<float, 16> _Data;  // ints are stored bitwise
+	};
+
+	struct Command {
+		uint64_t _SortKey;
+		CommandType _Type;
+		uint8_t _Pass;
+		uint8_t _NumTextures;
+		uint8_t _NumUniforms;
+		uint32_t _FirstTexture;  // into _Textures
+		uint32_t _FirstUniform;  // into _Uniforms
+		GLuint _Program;
+		// draws
+		GLuint _VertexArray;
+		GLenum _Mode;
+		GLenum _IndexType;       // 0: not indexed
+		uint32_t _Count;         // vertices or indices
+		uint32_t _NumInstances;  // 0: not instanced
+		uint32_t _FirstInstance;
+		// dispatches
+		std::array<uint32_t, 3> _NumGroups;
+	};
+
+	std::vector<Command> _Commands;
+	std::vector<TextureBinding> _Textures;
+	std::vector<Uniform> _Uniforms;
+	std::array<GLbitfield, MAX_PASSES> _PassBarriers{};
+	bool _IsSorted = true;
+
+	// recording state
+	uint8_t _Pass = 0;
+	const ShaderProgram *_Program = nullptr;
+	std::array<TextureBinding, MAX_TEXTURE_UNITS> _BoundTextures{};
+	std::vector<Uniform> _BoundUniforms;
+	const VertexBuffer *_VertexBuffer = nullptr;
+
+	CommandBufferStats _Stats;
+
+public:
+	// commands recorded from now on belong to `pass`, passes are submitted in ascending order
+	// `barriers` are issued once before the first command of the pass, e.g. after the dispatches of an earlier pass
+	// (a pass without commands still issues them, before the next pass or at the end of submit())
+	void set_pass(uint8_t pass, GLbitfield barriers = 0);
+	// also drops the uniforms set so far, they belong to the previous program
+	void set_program(const ShaderProgram &program);
+	void set_texture(size_t texture_unit, const Texture &texture);
+	void set_vertex_buffer(const VertexBuffer &vertex_buffer);
+
+	// applies to the commands recorded after it, until set again or the program changes
+	// unknown names are ignored, like the uniforms the compiler optimized out
+	void set_uniform(const std::string &name, int scalar);
+	void set_uniform(const std::string &name, float scalar);
+	void set_uniform(const std::string &name, const glm::vec2 &vector);
+	void set_uniform(const std::string &name, const glm::vec3 &vector);
+	void set_uniform(const std::string &name, const glm::vec4 &vector);
+	void set_uniform(const std::string &name, const glm::mat4 &matrix);
+
+	// every vertex of the vertex buffer, through its index buffer if it has one (see VertexBuffer::draw)
+	void draw(GLenum mode = GL_TRIANGLES);
+	void draw_instanced(size_t n_instances, GLenum mode = GL_TRIANGLES, size_t first_instance = 0);
+	void dispatch(size_t n_groups_x, size_t n_groups_y = 1, size_t n_groups_z = 1);
+
+	// moves the commands of `other` (e.g. recorded on another thread) to the end of this buffer
+	void append(CommandBuffer &&other);
+	// orders the commands by their keys, submit() sorts if needed
+	void sort();
+	// issues the commands, the buffer keeps them, e.g. to submit them again next frame
+	void submit();
+	// drops the commands and the recording state
+	void clear();
+
+	[[nodiscard]] size_t get_command_count() const;
+	[[nodiscard]] CommandBufferStats get_stats() const;
+
+private:
+	void _set_uniform(const std::string &name, UniformType type, const float *data, size_t n_floats);
+	[[nodiscard]] Command &_record(CommandType type, GLuint vertex_array);
+};
+
+}  // namespace gfxutils
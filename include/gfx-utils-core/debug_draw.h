@@ -0,0 +1,129 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/linear_arena.h>
+#include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/streaming_buffer.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace gfxutils {
+
+struct DebugDrawStats {
+	size_t _NumVertices = 0;     // submitted in the last flush
+	size_t _NumDrawCalls = 0;    // issued in the last flush
+	size_t _NumDropped = 0;      // primitives dropped in the last flush because the arena or the streaming buffer was full
+	size_t _PeakArenaBytes = 0;  // since construction
+};
+
+// immediate-mode lines, points, triangles and screen-space overlays for visualization and debugging
+// primitives are accumulated into a per-frame CPU arena, grouped by primitive type and state, and flush() uploads all of
+// them into a streaming buffer at once, then issues one draw per non-empty group (at most 9 per frame)
+// world-space primitives use the view-projection matrix given to flush(), overlays are in pixels from the top-left corner
+// NOTE: call flush() once per frame (it ends the frame of the streaming buffer), inside the render pass drawing the scene
+class DebugDraw : public IBuildTarget<DebugDraw> {
+private:
+	struct Vertex {
+		glm::vec3 _Pos;
+		uint32_t _Color;  // RGBA8
+	};
+
+	// vertices of a batch are chained chunks in the arena, so batches can grow in any order without copies
+	struct Chunk {
+		static constexpr size_t CAPACITY = 256;
+
+		Vertex _Vertices[CAPACITY];
+		size_t _Size;
+		Chunk *_Next;
+	};
+
+	struct Batch {
+		Chunk *_Head = nullptr;
+		Chunk *_Tail = nullptr;
+		size_t _NumVertices = 0;
+	};
+
+	enum BatchSpace : size_t { WORLD_DEPTH_TESTED, WORLD, SCREEN };  // also the draw order
+	enum BatchPrimitive : size_t { POINTS, LINES, TRIANGLES };
+
+	static constexpr size_t N_BATCH_SPACES = 3;
+	static constexpr size_t N_BATCH_PRIMITIVES = 3;
+
+	struct State {
+		LinearArena _Arena;
+		StreamingBuffer _StreamingBuffer;
+		ShaderProgram _ShaderProgram;
+		GLuint _VAO = 0;
+		std::array<Batch, N_BATCH_SPACES * N_BATCH_PRIMITIVES> _Batches;
+		bool _DepthTest = true;
+		float _PointSize = 1.0f;
+		DebugDrawStats _Stats;
+		size_t _NumDropped = 0;  // since the last flush
+
+		explicit State(size_t arena_size_bytes)
+		    : _Arena(arena_size_bytes) {
+		}
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the batcher
+
+public:
+	class DebugDrawBuilder : public IBuilder<DebugDrawBuilder, DebugDraw> {
+	private:
+		size_t _ArenaSizeBytes = 1 << 20;
+		float _PointSize = 4.0f;
+
+	public:
+		DebugDrawBuilder(const std::string &name);
+
+		// CPU memory for one frame of primitives, the streaming buffer gets the same budget per frame, default: 1 MiB
+		DebugDrawBuilder &set_arena_size(size_t arena_size_bytes);
+		// in pixels, default: 4
+		DebugDrawBuilder &set_point_size(float point_size);
+
+		[[nodiscard]] DebugDraw _build() const;
+	};
+
+	// whether the following world-space primitives are hidden behind the scene, default: true
+	// NOTE: debug primitives never write depth
+	void set_depth_test(bool enable) const;
+
+	void point(const glm::vec3 &pos, const glm::vec4 &color) const;
+	void line(const glm::vec3 &from, const glm::vec3 &to, const glm::vec4 &color) const;
+	void triangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, const glm::vec4 &color) const;
+	// wireframe axis-aligned box
+	void box(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &color) const;
+	// wireframe box, i.e. the [-1, 1]^3 cube transformed by `transform` (e.g. a light's view-projection inverse for its frustum)
+	void box(const glm::mat4 &transform, const glm::vec4 &color) const;
+	void circle(const glm::vec3 &center, const glm::vec3 &normal, float radius, const glm::vec4 &color, size_t n_segments = 32) const;
+	// three great circles
+	void sphere(const glm::vec3 &center, float radius, const glm::vec4 &color, size_t n_segments = 32) const;
+	// x, y and z axes of `transform` in red, green and blue
+	void axes(const glm::mat4 &transform, float size = 1.0f) const;
+
+	// screen-space overlays, in pixels from the top-left corner, drawn last and without depth test
+	void overlay_line(const glm::vec2 &from, const glm::vec2 &to, const glm::vec4 &color) const;
+	void overlay_rect(const glm::vec2 &min, const glm::vec2 &max, const glm::vec4 &color, bool filled = false) const;
+
+	// uploads and draws everything submitted since the last flush, then starts a new frame
+	// screen_size: in pixels, for the overlays
+	void flush(const glm::mat4 &view_projection, const glm::vec2 &screen_size) const;
+	// drops everything submitted since the last flush
+	void clear() const;
+
+	[[nodiscard]] const DebugDrawStats &get_stats() const;
+
+private:
+	// reserves n_vertices contiguous vertices of a batch, nullptr if the arena is full
+	[[nodiscard]] Vertex *_push(BatchSpace space, BatchPrimitive primitive, size_t n_vertices) const;
+	[[nodiscard]] BatchSpace _get_world_space() const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace gfxutils {
+
+struct DirtyRect {
+	size_t _X;
+	size_t _Y;
+	size_t _Width;
+	size_t _Height;
+
+	[[nodiscard]] size_t get_area() const { return _Width * _Height; }
+};
+
+// accumulates the regions of an image changed during a frame (e.g. brush strokes) and merges them into a few
+// rectangles, which are then uploaded with Texture::update_region() instead of the whole image
+// two rectangles are merged when their bounding box costs no more texels than both of them, and the ones left
+// are merged by least wasted area down to `max_rects`, since every upload has a fixed cost on top of its size
+class DirtyRectTracker {
+private:
+	size_t _Width;
+	size_t _Height;
+	size_t _MaxRects;
+	std::vector<DirtyRect> _Rects;
+
+public:
+	DirtyRectTracker(size_t width, size_t height, size_t max_rects = 8);
+
+	// clipped to the tracked area, empty rectangles are ignored
+	void add(size_t x, size_t y, size_t width, size_t height);
+	void add_all();
+
+	// returns the merged rectangles and resets the tracker, call once per frame
+	[[nodiscard]] std::vector<DirtyRect> take();
+	void clear();
+
+	[[nodiscard]] bool empty() const;
+	[[nodiscard]] const std::vector<DirtyRect> &get_rects() const;
+	// texels covered by the rectangles, i.e. what take() would have uploaded
+	[[nodiscard]] size_t get_dirty_area() const;
+
+private:
+	void _merge_overlapping(size_t index);
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/storage_buffer.h>
+#include <gfx-utils-core/vertex_buffer.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+// the layouts glMultiDrawArraysIndirect() and glMultiDrawElementsIndirect() read, see the GL spec
+struct DrawArraysIndirectCommand {
+	uint32_t _Count;
+	uint32_t _InstanceCount;
+	uint32_t _First;
+	uint32_t _BaseInstance;
+};
+
+struct DrawElementsIndirectCommand {
+	uint32_t _Count;
+	uint32_t _InstanceCount;
+	uint32_t _FirstIndex;
+	int32_t _BaseVertex;
+	uint32_t _BaseInstance;
+};
+
+static_assert(sizeof(DrawArraysIndirectCommand) == 16 && sizeof(DrawElementsIndirectCommand) == 20);
+
+// a list of draw commands submitted with a single multi-draw call, e.g. many meshes packed into one vertex buffer
+// or the instances of several objects in one instance stream (see `_BaseInstance`)
+// the commands can also be written on the GPU, e.g. by a culling compute shader (see bind() and set_command_count()),
+// which can also write how many of them to draw (see draw_indirect_count())
+class DrawIndirectBuffer : public IBuildTarget<DrawIndirectBuffer> {
+private:
+	struct State {
+		GLuint _BufferHandle;
+		size_t _CapacityBytes;
+		size_t _NumCommands;
+		bool _IsIndexed;  // which command type the buffer holds
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the buffer
+
+public:
+	class DrawIndirectBufferBuilder : public IBuilder<DrawIndirectBufferBuilder, DrawIndirectBuffer> {
+	private:
+		size_t _Capacity = 16;
+
+	public:
+		DrawIndirectBufferBuilder(const std::string &name);
+
+		// in commands, the buffer grows when more are set, default: 16
+		DrawIndirectBufferBuilder &set_capacity(size_t n_commands);
+
+		[[nodiscard]] DrawIndirectBuffer _build() const;
+	};
+
+	// replaces the commands, for draw() without/with an index buffer
+	void set_commands(std::span<const DrawArraysIndirectCommand> commands) const;
+	void set_commands(std::span<const DrawElementsIndirectCommand> commands) const;
+	// for commands written on the GPU: makes room for n_commands of the given type without uploading any, call it
+	// before they are written (growing drops the contents)
+	void set_command_count(size_t n_commands, bool is_indexed) const;
+
+	// binds the commands as a storage buffer, e.g. for a compute shader writing them
+	void bind(size_t binding_point) const;
+
+	// issues every command at once, from the vertex (and index) buffer of `vertex_buffer`
+	// NOTE: the command type must match whether `vertex_buffer` is indexed
+	void draw(const VertexBuffer &vertex_buffer, GLenum mode = GL_TRIANGLES) const;
+	// issues the first N commands, N read on the GPU from the uint at `count_offset` bytes in `count_buffer` (e.g. an
+	// atomic counter of a culling shader) and clamped to get_command_count(); needs a memory barrier with
+	// GL_COMMAND_BARRIER_BIT after the commands and the count were written
+	void draw_indirect_count(const VertexBuffer &vertex_buffer, const StorageBuffer &count_buffer, size_t count_offset = 0, GLenum mode = GL_TRIANGLES) const;
+
+	[[nodiscard]] size_t get_command_count() const;
+
+	[[nodiscard]] GLuint _get_handle() const;
+
+private:
+	void _set_commands(const void *data, size_t n_commands, size_t command_size, bool is_indexed) const;
+	// false (and logs why) if the command type doesn't match `vertex_buffer`
+	[[nodiscard]] bool _check_vertex_buffer(const VertexBuffer &vertex_buffer) const;
+};
+
+}  // namespace gfxutils
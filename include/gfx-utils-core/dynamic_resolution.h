@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+
+namespace gfxutils {
+
+// picks the resolution scale (of each axis, see RenderPassConfig::_ResolutionScale) that keeps the measured GPU time
+// of the scaled work near a target, e.g. fed with GPUTimer::take_ms() once per frame
+// the cost is taken as proportional to the pixel count, i.e. to the square of the scale; the timings lag a few frames
+// behind the scale they were measured at, so the controller only moves part of the way and ignores small errors
+class DynamicResolutionController {
+private:
+	float _TargetMs;
+	float _MinScale;
+	float _MaxScale;
+	float _Scale;
+	std::optional<float> _SmoothedMs;
+
+public:
+	DynamicResolutionController(float target_ms, float min_scale = 0.5f, float max_scale = 1.0f);
+
+	void set_target_ms(float target_ms);
+	void set_scale_range(float min_scale, float max_scale);
+
+	// feeds a new GPU time, std::nullopt (no new result) keeps the scale; returns the scale to render at
+	float update(std::optional<float> gpu_ms);
+	// back to the maximum scale, e.g. after the scaled work changed
+	void reset();
+
+	[[nodiscard]] float get_scale() const;
+	[[nodiscard]] float get_target_ms() const;
+	// the smoothed GPU time the scale is based on
+	[[nodiscard]] std::optional<float> get_smoothed_ms() const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <gfx-utils-core/gpu_timer.h>
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/pointwise_fusion.h>
+#include <gfx-utils-core/render_target_pool.h>
+#include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/shader_types.h>
+#include <gfx-utils-core/texture.h>
+#include <gfx-utils-core/vertex_buffer.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace gfxutils {
+
+// a uniform of an effect the user can tune, i.e. one the chain doesn't set itself
+struct EffectParameter {
+	std::string _Name;
+	ShaderDataType _Type;      // INT, FLOAT, VEC2 or VEC3
+	glm::vec4 _Value{ 0.0f };  // the components the type uses, the initializer in the shader until it's set
+};
+
+// a pass of the chain as it runs, after fusion
+struct EffectPassStats {
+	std::string _Name;            // "a+b" for pointwise passes fused into one
+	bool _IsCompute = false;
+	size_t _NumConfigPasses = 1;  // passes of the config it runs
+	GLenum _Format = GL_NONE;     // of its target, GL_NONE for the format of the chain's target description
+	std::optional<float> _GPUMs;  // the latest result of its timer
+};
+
+// post processing effects described by a config file:
+//     { "<category>": [ { "fx_name": "...",
+//                         "render_passes": [ { "pass_name": "...", "vs_path": "...", "fs_path": "...", "pointwise": false } ],
+//                         "compute_passes": [ { "pass_name": "...", "cs_path": "..." } ] } ] }
+// "pointwise" and "compute_passes" are optional: pointwise passes are GLSL snippets (see pointwise_fusion.h), compute passes
+// replace the render passes of their effect when compute is preferred
+// passes may also declare what their output needs, so the chain renders it into the smallest format that holds it:
+//     "precision": "low" (8 bits in [0, 1], ~6 mantissa bits above), "medium" (half float) or "high" (float)
+//     "range": "ldr" ([0, 1]), "hdr" (>= 0, the default) or "signed"
+//     "alpha": true if the next passes read the alpha channel, default: false
+// i.e. RGBA8, R11F_G11F_B10F, RGBA16F or RGBA32F; passes without "precision" use the format of the target description
+// the selected effects run back to back, each pass reading the output of the previous one: the chain ping-pongs between
+// two targets however many passes it has, and runs consecutive pointwise passes as one generated pass
+// the shaders get their input as u_input_texture_sampler (unit 0), their resolution as u_window_size and the part of the
+// input holding the image as u_input_uv_scale; compute shaders write the image bound to unit 0
+// the config can be edited while the chain runs, see poll_changes(): only the passes that changed are rebuilt
+class EffectChain : public IBuildTarget<EffectChain> {
+private:
+	struct Pass {
+		std::string _Name;
+		ShaderProgram _ShaderProgram;  // unset for pointwise passes, whose programs are generated per run
+		bool _IsCompute = false;
+		std::optional<PointwisePass> _Pointwise;
+		std::string _VsPath;
+		GLenum _Format = GL_NONE;  // the one its declared precision needs, if any
+		// its config entry and the write times of its sources, a pass with the same one is reused on reload
+		std::string _Signature;
+	};
+
+	struct Effect {
+		std::string _Name;
+		std::string _Category;
+		std::vector<Pass> _RenderPasses;
+		std::vector<Pass> _ComputePasses;
+		std::vector<EffectParameter> _Parameters;  // the uniforms of all its passes, by name
+	};
+
+	// a pass of the compiled chain
+	struct Step {
+		std::string _Name;
+		ShaderProgram _ShaderProgram;
+		bool _IsCompute = false;
+		std::vector<size_t> _EffectIndices;  // whose parameters it takes
+		size_t _NumConfigPasses = 1;
+		GLenum _Format = GL_NONE;  // of its last pass, the others keep their outputs in registers
+	};
+
+	struct State {
+		std::string _ConfigPath;
+		std::string _ShaderRoot;
+		std::vector<std::pair<std::string, int64_t>> _WatchedFiles;  // the config and the shaders it uses, with their write times
+
+		std::vector<std::string> _Categories;
+		std::vector<Effect> _Effects;
+		std::vector<size_t> _Selection;
+		bool _PreferCompute = true;
+		bool _IsFusionEnabled = true;
+		bool _IsAutoPrecisionEnabled = true;
+
+		std::vector<Step> _Steps;  // compiled from the selection when it changes
+		bool _IsDirty = true;
+		// the programs of pointwise runs, by variant and pass signatures, failed builds included so they are reported once
+		std::unordered_map<std::string, ShaderProgram> _GeneratedPrograms;
+		std::unordered_map<std::string, GPUTimer> _Timers;  // by step name and variant, kept across recompilations
+
+		VertexBuffer _QuadVertexBuffer;
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the chain
+
+public:
+	class EffectChainBuilder : public IBuilder<EffectChainBuilder, EffectChain> {
+	private:
+		std::string _ConfigPath;
+		std::string _ShaderRoot;
+
+	public:
+		EffectChainBuilder(const std::string &name);
+
+		EffectChainBuilder &set_config_file(const std::string &config_path);
+		// where the shader paths of the config are resolved, default: the folder of the config + /shader
+		EffectChainBuilder &set_shader_root(const std::string &shader_root);
+
+		// effects whose shaders fail to build are left out with a warning
+		[[nodiscard]] EffectChain _build() const;
+	};
+
+	// the top-level keys of the config, sorted
+	[[nodiscard]] std::vector<std::string> get_categories() const;
+	// in the order of the config
+	[[nodiscard]] std::vector<std::string> get_effect_names(const std::string &category) const;
+
+	// the effects to run, in order; returns false and keeps the selection if one of them doesn't exist
+	bool set_effects(const std::vector<std::string> &effect_names) const;
+	[[nodiscard]] std::vector<std::string> get_effects() const;
+	// the compute implementation of the effects that have one, and compute shaders for the pointwise passes
+	void set_prefer_compute(bool prefer_compute) const;
+	void set_fusion_enabled(bool is_fusion_enabled) const;
+	// the formats declared by the passes rather than the one of the target description, on by default
+	void set_auto_precision_enabled(bool is_auto_precision_enabled) const;
+
+	[[nodiscard]] std::vector<EffectParameter> get_parameters(const std::string &effect_name) const;
+	// only the components of its type are used; returns false if the effect has no such parameter
+	bool set_parameter(const std::string &effect_name, const std::string &parameter_name, const glm::vec4 &value) const;
+
+	// runs the selected effects on `input`, std::nullopt if none is selected; the returned target comes from `pool`, in the
+	// format of the last pass, and is released by the caller (or at frame end), the other ones are released before returning
+	// `uv_scale`: the part of `input` holding the image on entry, the part of the returned target on return
+	// with a resolution scale below 1 the passes render the lower left part of their targets, see RenderPassConfig
+	[[nodiscard]] std::optional<PooledRenderTarget> execute(const Texture &input,
+	                                                        glm::vec2 &uv_scale,
+	                                                        const RenderTargetPool &pool,
+	                                                        const RenderTargetDesc &target_desc,
+	                                                        float resolution_scale = 1.0f) const;
+
+	// validation of the declared precisions: runs the selected effects on `input` with the declared formats and with the one
+	// of `target_desc` for every pass, and returns the largest difference of the color channels, std::nullopt if none is
+	// selected; reads both outputs back, so it stalls
+	[[nodiscard]] std::optional<float> validate_precision(const Texture &input, const RenderTargetPool &pool, const RenderTargetDesc &target_desc) const;
+
+	// the passes of the selection as they run, with their GPU times
+	[[nodiscard]] std::vector<EffectPassStats> get_pass_stats() const;
+
+	// reloads the config, diffed against the live effects: passes whose config entry and sources didn't change keep their
+	// programs, the effects keep the values of the parameters they still declare and stay selected unless removed
+	// an effect that fails to build keeps its previous version; returns false and keeps everything if the config can't be read
+	bool reload() const;
+	// reloads the config if it or a shader it uses was written since the last load, call once per frame
+	// returns true if it reloaded (see reload()), the effect names may have changed then
+	bool poll_changes() const;
+
+private:
+	[[nodiscard]] std::optional<PooledRenderTarget> _execute(const Texture &input,
+	                                                         glm::vec2 &uv_scale,
+	                                                         const RenderTargetPool &pool,
+	                                                         const RenderTargetDesc &target_desc,
+	                                                         float resolution_scale,
+	                                                         bool is_auto_precision_enabled) const;
+	bool _load_config() const;
+	void _compile() const;
+	// the generated program of a run of pointwise passes, cached
+	[[nodiscard]] ShaderProgram _get_pointwise_program(const std::vector<const Pass *> &run, bool is_compute) const;
+	[[nodiscard]] const std::vector<Pass> &_get_passes(const Effect &effect) const;
+	void _apply_parameters(Step &step) const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/singleton.h>
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+
+namespace gfxutils {
+
+struct GLStateCacheStats {
+	size_t _NumCalls = 0;    // state changes sent to GL
+	size_t _NumSkipped = 0;  // calls that matched the cached state
+};
+
+// tracks the program, vertex array, framebuffer and texture bindings, the viewport and the capabilities set through it,
+// and skips the GL calls that wouldn't change anything
+// the library binds and toggles these only through here
+// NOTE: code changing the same state behind its back (e.g. ImGui's renderer, raw GL calls) must invalidate() the cache
+// afterwards, the next call of each kind then goes to GL unconditionally
+class GLStateCache : public Singleton<GLStateCache> {
+private:
+	static constexpr GLuint UNKNOWN = std::numeric_limits<GLuint>::max();
+	static constexpr size_t MAX_TEXTURE_UNITS = 32;  // units past it are bound without caching
+	static constexpr size_t N_TEXTURE_TARGETS = 3;   // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_2D_MULTISAMPLE
+
+	GLuint _Program = UNKNOWN;
+	GLuint _VertexArray = UNKNOWN;
+	GLuint _DrawFramebuffer = UNKNOWN;
+	GLuint _ReadFramebuffer = UNKNOWN;
+	size_t _ActiveTextureUnit = UNKNOWN;
+	std::array<std::array<GLuint, N_TEXTURE_TARGETS>, MAX_TEXTURE_UNITS> _Textures;
+	std::array<GLint, 4> _Viewport;  // x, y, width, height, a negative width: unknown
+	std::unordered_map<GLenum, bool> _Capabilities;  // missing: unknown
+	GLStateCacheStats _Stats;
+
+public:
+	GLStateCache();
+
+	void use_program(GLuint program);
+	void bind_vertex_array(GLuint vertex_array);
+	// GL_FRAMEBUFFER binds both the draw and the read framebuffer
+	void bind_framebuffer(GLenum target, GLuint framebuffer);
+	void bind_texture(size_t texture_unit, GLenum target, GLuint texture);
+	// binds to the active unit, e.g. to upload
+	void bind_texture(GLenum target, GLuint texture);
+	void set_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	// glEnable / glDisable
+	void set_capability(GLenum capability, bool enabled);
+	// the cached value, queried from GL once if unknown
+	[[nodiscard]] bool is_enabled(GLenum capability);
+
+	// deleting an object unbinds it, the cache follows so a new object reusing the name isn't taken as bound
+	void forget_program(GLuint program);
+	void forget_vertex_array(GLuint vertex_array);
+	void forget_framebuffer(GLuint framebuffer);
+	void forget_texture(GLuint texture);
+
+	// marks everything as unknown
+	void invalidate();
+
+	[[nodiscard]] GLStateCacheStats get_stats() const;
+	void reset_stats();
+
+private:
+	// index into a unit's bindings, N_TEXTURE_TARGETS for targets that aren't cached
+	[[nodiscard]] static size_t _get_target_index(GLenum target);
+	void _set_active_texture_unit(size_t texture_unit);
+};
+
+}  // namespace gfxutils
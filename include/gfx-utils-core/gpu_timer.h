@@ -0,0 +1,65 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+struct GPUTimerStats {
+	size_t _NumResults = 0;
+	size_t _NumSkipped = 0;  // begin() calls dropped because every measurement was still in flight
+};
+
+// GPU time of the commands between begin() and end(), through pairs of GL_TIMESTAMP queries read without stalling:
+// the pairs are used round-robin and a result is only read once GL reports it available, a few frames later
+// timestamps rather than GL_TIME_ELAPSED queries, so timers can be nested, e.g. per pass inside a frame timer
+class GPUTimer : public IBuildTarget<GPUTimer> {
+private:
+	struct State {
+		std::vector<GLuint> _Queries;  // the begin and end timestamps of each measurement, interleaved
+		size_t _OldestPending = 0;     // ring of the measurements in flight, from the oldest one
+		size_t _NumPending = 0;
+		bool _IsRunning = false;    // between a begin() that got a query and its end()
+		std::optional<float> _LastMs;
+		bool _HasNewResult = false;  // since the last take_ms()
+		GPUTimerStats _Stats;
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the timer
+
+public:
+	class GPUTimerBuilder : public IBuilder<GPUTimerBuilder, GPUTimer> {
+	private:
+		size_t _NumQueries = 4;
+
+	public:
+		GPUTimerBuilder(const std::string &name);
+
+		// measurements in flight (two queries each), more than the frames the driver queues
+		GPUTimerBuilder &set_query_count(size_t n_queries);
+
+		[[nodiscard]] GPUTimer _build() const;
+	};
+
+	void begin() const;
+	void end() const;
+
+	// the latest available result in milliseconds, std::nullopt before the first one
+	[[nodiscard]] std::optional<float> get_ms() const;
+	// like get_ms(), but only once per result, e.g. to feed a DynamicResolutionController
+	[[nodiscard]] std::optional<float> take_ms() const;
+	[[nodiscard]] GPUTimerStats get_stats() const;
+
+private:
+	// reads the results GL has made available, oldest first
+	void _poll() const;
+};
+
+}  // namespace gfxutils
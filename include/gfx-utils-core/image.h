@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace gfxutils {
+
+enum class ImageElementType {
+	U8,
+	F16,  // IEEE 754 binary16 bit patterns (uint16_t)
+	F32
+};
+
+// applied by Image::convert() to the color channels, alpha stays linear
+enum class ColorConversion {
+	NONE,
+	SRGB_TO_LINEAR,
+	LINEAR_TO_SRGB
+};
+
+[[nodiscard]] size_t get_image_element_size(ImageElementType element_type);
+
+// CPU-side image, rows are stored top to bottom, `get_row_stride()` bytes apart
+// the storage of images allocated here starts at a DATA_ALIGNMENT boundary, so the SIMD kernels of
+// convert() and swizzle() (see image_kernels.h) run on aligned rows when the stride keeps them aligned
+class Image {
+public:
+	// deleter of the pixel storage, so that buffers allocated by codecs (e.g. stb) can be adopted without a copy
+	using Deleter = void (*)(void *);
+
+	static constexpr size_t DATA_ALIGNMENT = 64;
+
+private:
+	size_t _Width = 0;
+	size_t _Height = 0;
+	size_t _Channels = 0;
+	ImageElementType _ElementType = ImageElementType::U8;
+	size_t _RowStride = 0;  // in bytes
+	std::unique_ptr<uint8_t, Deleter> _Data{ nullptr, std::free };
+
+public:
+	Image() = default;
+	// row_alignment > 1 pads every row to a multiple of it (and of the pixel size, so that GL can address the rows
+	// with GL_UNPACK_ROW_LENGTH), e.g. DATA_ALIGNMENT to keep all rows aligned for SIMD
+	Image(size_t width, size_t height, size_t channels, ImageElementType element_type, size_t row_alignment = 1);
+
+	// takes the ownership of `data`, which must be tightly packed
+	[[nodiscard]] static Image adopt(void *data, size_t width, size_t height, size_t channels, ImageElementType element_type, Deleter deleter);
+
+	[[nodiscard]] size_t get_width() const { return _Width; }
+	[[nodiscard]] size_t get_height() const { return _Height; }
+	[[nodiscard]] size_t get_channels() const { return _Channels; }
+	[[nodiscard]] ImageElementType get_element_type() const { return _ElementType; }
+	[[nodiscard]] size_t get_pixel_size() const { return _Channels * get_image_element_size(_ElementType); }
+	[[nodiscard]] size_t get_row_stride() const { return _RowStride; }
+	[[nodiscard]] size_t get_size_bytes() const { return _RowStride * _Height; }
+	[[nodiscard]] bool empty() const { return _Data == nullptr; }
+	// i.e. no row padding, the pixels are one contiguous block
+	[[nodiscard]] bool is_packed() const { return _RowStride == _Width * get_pixel_size(); }
+
+	[[nodiscard]] uint8_t *data() { return _Data.get(); }
+	[[nodiscard]] const uint8_t *data() const { return _Data.get(); }
+	[[nodiscard]] uint8_t *row(size_t y) { return _Data.get() + (y * _RowStride); }
+	[[nodiscard]] const uint8_t *row(size_t y) const { return _Data.get() + (y * _RowStride); }
+
+	// returns a packed copy with the given element type, U8 maps to [0.0, 1.0] (float values are clamped when converted to U8)
+	[[nodiscard]] Image convert(ImageElementType element_type, ColorConversion color_conversion = ColorConversion::NONE) const;
+	// returns a packed copy with order.size() channels, channel i taken from channel order[i], e.g. { 2, 1, 0, 3 } for BGRA <-> RGBA
+	[[nodiscard]] Image swizzle(const std::vector<size_t> &order) const;
+	// in place, without an extra copy of the image
+	void flip_vertically();
+
+	// copies the (width x height) region at (x0, y0) into `dst` as packed rows, pixels outside the image repeat the nearest edge pixel
+	// bottom_up: the last row is copied first, the order GL expects
+	void copy_region_clamped(ptrdiff_t x0, ptrdiff_t y0, size_t width, size_t height, uint8_t *dst, bool bottom_up = false) const;
+};
+
+}  // namespace gfxutils
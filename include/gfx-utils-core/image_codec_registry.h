@@ -0,0 +1,42 @@
+#pragma once
+
+#include <gfx-utils-core/image.h>
+#include <gfx-utils-core/interfaces/image_codec.h>
+#include <gfx-utils-core/interfaces/singleton.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gfxutils {
+
+class ImageCodecRegistry : public Singleton<ImageCodecRegistry> {
+private:
+	std::vector<std::shared_ptr<IImageCodec>> _Codecs;
+
+public:
+	ImageCodecRegistry();
+
+	// codecs registered later take precedence over earlier ones for the same extension
+	void register_codec(const std::shared_ptr<IImageCodec> &codec);
+
+	[[nodiscard]] std::shared_ptr<IImageCodec> find_codec(const std::string &codec_name) const;
+	[[nodiscard]] std::shared_ptr<IImageCodec> find_decoder_by_extension(const std::string &file_path) const;
+	[[nodiscard]] std::shared_ptr<IImageCodec> find_encoder_by_extension(const std::string &file_path) const;
+
+	// returns an empty image on failure
+	[[nodiscard]] Image decode(const std::string &file_path, const std::string &codec_name = "") const;
+	// empty codec_name: pick the codec by the extension of `file_path`
+	bool encode(const std::string &file_path, const Image &image, const std::string &codec_name = "") const;
+
+	// streaming access, falls back to decoding / encoding the whole image in memory if the codec can't stream
+	// returns nullptr on failure
+	[[nodiscard]] std::unique_ptr<IImageReader> open_reader(const std::string &file_path, const std::string &codec_name = "") const;
+	[[nodiscard]] std::unique_ptr<IImageWriter> open_writer(const std::string &file_path,
+	                                                        size_t width,
+	                                                        size_t height,
+	                                                        size_t n_channels,
+	                                                        const std::string &codec_name = "") const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/image_codec.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gfxutils {
+
+// decode-only fallback for everything stb_image understands
+class StbImageCodec : public IImageCodec {
+public:
+	[[nodiscard]] std::string get_name() const override { return "stb"; }
+	[[nodiscard]] std::vector<std::string> get_extensions() const override;
+	[[nodiscard]] bool can_decode() const override { return true; }
+	[[nodiscard]] bool can_encode() const override { return false; }
+	[[nodiscard]] ImageElementType get_encode_element_type() const override { return ImageElementType::U8; }
+
+	[[nodiscard]] Image decode(const std::string &file_path) const override;
+	bool encode(const std::string &file_path, const Image &image) const override;
+};
+
+// 8-bit PNG, rows are filtered and deflated in parallel strips
+// streaming reads support non-interlaced gray / RGB / gray-alpha / RGBA files with 8 or 16 bits per channel
+class PngCodec : public IImageCodec {
+private:
+	int _CompressionLevel;
+	size_t _NumThreads;
+
+public:
+	// n_threads == 0: use all hardware threads
+	explicit PngCodec(int compression_level = 6, size_t n_threads = 0);
+
+	[[nodiscard]] std::string get_name() const override { return "png"; }
+	[[nodiscard]] std::vector<std::string> get_extensions() const override { return { ".png" }; }
+	[[nodiscard]] bool can_decode() const override { return true; }
+	[[nodiscard]] bool can_encode() const override { return true; }
+	[[nodiscard]] ImageElementType get_encode_element_type() const override { return ImageElementType::U8; }
+
+	[[nodiscard]] Image decode(const std::string &file_path) const override;
+	bool encode(const std::string &file_path, const Image &image) const override;
+
+	[[nodiscard]] std::unique_ptr<IImageReader> open_reader(const std::string &file_path) const override;
+	[[nodiscard]] std::unique_ptr<IImageWriter> open_writer(const std::string &file_path, size_t width, size_t height, size_t n_channels) const override;
+};
+
+// "Quite OK Image Format", fast lossless 8-bit RGB(A)
+class QoiCodec : public IImageCodec {
+public:
+	[[nodiscard]] std::string get_name() const override { return "qoi"; }
+	[[nodiscard]] std::vector<std::string> get_extensions() const override { return { ".qoi" }; }
+	[[nodiscard]] bool can_decode() const override { return true; }
+	[[nodiscard]] bool can_encode() const override { return true; }
+	[[nodiscard]] ImageElementType get_encode_element_type() const override { return ImageElementType::U8; }
+
+	[[nodiscard]] Image decode(const std::string &file_path) const override;
+	bool encode(const std::string &file_path, const Image &image) const override;
+};
+
+// portable float map, 32-bit float RGB / grayscale, alpha is dropped on encode
+class PfmCodec : public IImageCodec {
+public:
+	[[nodiscard]] std::string get_name() const override { return "pfm"; }
+	[[nodiscard]] std::vector<std::string> get_extensions() const override { return { ".pfm" }; }
+	[[nodiscard]] bool can_decode() const override { return true; }
+	[[nodiscard]] bool can_encode() const override { return true; }
+	[[nodiscard]] ImageElementType get_encode_element_type() const override { return ImageElementType::F32; }
+
+	[[nodiscard]] Image decode(const std::string &file_path) const override;
+	bool encode(const std::string &file_path, const Image &image) const override;
+
+	[[nodiscard]] std::unique_ptr<IImageReader> open_reader(const std::string &file_path) const override;
+	[[nodiscard]] std::unique_ptr<IImageWriter> open_writer(const std::string &file_path, size_t width, size_t height, size_t n_channels) const override;
+};
+
+// radiance RGBE, float RGB in a quarter of the PFM size
+class HdrCodec : public IImageCodec {
+public:
+	[[nodiscard]] std::string get_name() const override { return "hdr"; }
+	[[nodiscard]] std::vector<std::string> get_extensions() const override { return { ".hdr" }; }
+	[[nodiscard]] bool can_decode() const override { return true; }
+	[[nodiscard]] bool can_encode() const override { return true; }
+	[[nodiscard]] ImageElementType get_encode_element_type() const override { return ImageElementType::F32; }
+
+	[[nodiscard]] Image decode(const std::string &file_path) const override;
+	bool encode(const std::string &file_path, const Image &image) const override;
+};
+
+}  // namespace gfxutils
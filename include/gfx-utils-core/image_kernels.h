@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gfxutils {
+
+// row kernels behind Image::convert() / Image::swizzle(), picked once at startup for the running CPU
+// element counts are per row (i.e. width * channels), pointers need no particular alignment
+enum class ImageKernelISA {
+	SCALAR,
+	SSE2,
+	AVX2  // AVX2 + F16C
+};
+
+[[nodiscard]] ImageKernelISA get_image_kernel_isa();
+[[nodiscard]] const char *get_image_kernel_isa_name(ImageKernelISA isa);
+
+// U8 <-> F32 maps [0, 255] <-> [0.0, 1.0], values are clamped and rounded to nearest
+void convert_u8_to_f32(const uint8_t *src, float *dst, size_t n_elements);
+void convert_f32_to_u8(const float *src, uint8_t *dst, size_t n_elements);
+// F16 elements are IEEE 754 binary16 bit patterns, rounded to nearest even
+void convert_f32_to_f16(const float *src, uint16_t *dst, size_t n_elements);
+void convert_f16_to_f32(const uint16_t *src, float *dst, size_t n_elements);
+
+// sRGB transfer function on the color channels only: the last channel of 2- and 4-channel pixels is alpha and stays linear
+// the U8 variants are table lookups, the float ones evaluate the exact curve
+void convert_srgb_u8_to_linear_f32(const uint8_t *src, float *dst, size_t n_pixels, size_t n_channels);
+void convert_linear_f32_to_srgb_u8(const float *src, uint8_t *dst, size_t n_pixels, size_t n_channels);
+void convert_srgb_to_linear_f32(float *data, size_t n_pixels, size_t n_channels);
+void convert_linear_to_srgb_f32(float *data, size_t n_pixels, size_t n_channels);
+
+// dst pixel channel i = src pixel channel order[i], e.g. { 2, 1, 0, 3 } turns BGRA into RGBA
+void swizzle_pixels(const uint8_t *src, uint8_t *dst, size_t n_pixels, size_t element_size, size_t n_src_channels, const size_t *order, size_t n_dst_channels);
+
+}  // namespace gfxutils
@@ -16,8 +16,14 @@ public:
 
 	[[nodiscard]] std::string get_name() const { return _Name; }
 
-	BuildTarget build() const {
-		return static_cast<const Derived *>(this)->_build();
+	BuildTarget build() const & {
+		return static_cast<const Derived &>(*this)._build();
+	}
+
+	// lets the builder hand its buffers over to the build target instead of copying them,
+	// builders without a `_build() &&` overload fall back to `_build() const &`
+	BuildTarget build() && {
+		return static_cast<Derived &&>(*this)._build();
 	}
 };
 
@@ -8,7 +8,12 @@ template<typename Derived>
 class IExportableResource {
 public:
 	void export_to_file(const std::string file_path) const {
-		static_cast<const Derived *>(this)->_export_to_file(file_path);
+		static_cast<const Derived *>(this)->_export_to_file(file_path, "");
+	}
+
+	// explicitly pick the codec by its name (see `ImageCodecRegistry`) rather than by the file extension
+	void export_to_file(const std::string file_path, const std::string &codec_name) const {
+		static_cast<const Derived *>(this)->_export_to_file(file_path, codec_name);
 	}
 
 protected:
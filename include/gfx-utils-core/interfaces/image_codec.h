@@ -0,0 +1,38 @@
+#pragma once
+
+#include <gfx-utils-core/image.h>
+#include <gfx-utils-core/interfaces/image_stream.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gfxutils {
+
+class IImageCodec {
+public:
+	virtual ~IImageCodec() = default;
+
+	[[nodiscard]] virtual std::string get_name() const = 0;
+	// lower-case, with the leading dot, e.g. ".png"
+	[[nodiscard]] virtual std::vector<std::string> get_extensions() const = 0;
+
+	[[nodiscard]] virtual bool can_decode() const = 0;
+	[[nodiscard]] virtual bool can_encode() const = 0;
+
+	// the element type the codec stores natively, images of other types are converted before encoding
+	[[nodiscard]] virtual ImageElementType get_encode_element_type() const = 0;
+
+	// NOTE: decoded images are always RGBA
+	[[nodiscard]] virtual Image decode(const std::string &file_path) const = 0;
+	virtual bool encode(const std::string &file_path, const Image &image) const = 0;
+
+	// band-by-band access for images too large to be held in memory at once, nullptr if the codec (or the file) doesn't support it
+	[[nodiscard]] virtual std::unique_ptr<IImageReader> open_reader(const std::string &file_path [[maybe_unused]]) const { return nullptr; }
+	[[nodiscard]] virtual std::unique_ptr<IImageWriter> open_writer(const std::string &file_path [[maybe_unused]],
+	                                                                size_t width [[maybe_unused]],
+	                                                                size_t height [[maybe_unused]],
+	                                                                size_t n_channels [[maybe_unused]]) const { return nullptr; }
+};
+
+}  // namespace gfxutils
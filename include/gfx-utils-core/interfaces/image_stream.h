@@ -0,0 +1,35 @@
+#pragma once
+
+#include <gfx-utils-core/image.h>
+
+#include <cstddef>
+
+namespace gfxutils {
+
+// sequential access to an image file that may not fit into memory, rows top to bottom
+class IImageReader {
+public:
+	virtual ~IImageReader() = default;
+
+	[[nodiscard]] virtual size_t get_width() const = 0;
+	[[nodiscard]] virtual size_t get_height() const = 0;
+	[[nodiscard]] virtual ImageElementType get_element_type() const = 0;
+
+	// reads the next `n_rows` rows as RGBA (fewer at the end of the image), returns an empty image on failure
+	[[nodiscard]] virtual Image read_rows(size_t n_rows) = 0;
+};
+
+class IImageWriter {
+public:
+	virtual ~IImageWriter() = default;
+
+	// rows of other element types are converted before encoding
+	[[nodiscard]] virtual ImageElementType get_element_type() const = 0;
+
+	// appends `rows` below the rows written so far, the width and channel count must match the ones the writer was opened with
+	virtual bool write_rows(const Image &rows) = 0;
+	// must be called once all rows are written, the file is incomplete otherwise
+	virtual bool finish() = 0;
+};
+
+}  // namespace gfxutils
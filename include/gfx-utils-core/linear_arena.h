@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace gfxutils {
+
+// bump allocator over one fixed block, for short-lived data that is dropped all at once (e.g. everything built during a frame)
+// allocations are never freed individually and never move, reset() makes the whole block available again
+// NOTE: only for trivially destructible types, their destructors are never called
+class LinearArena {
+private:
+	std::unique_ptr<std::byte[]> _Data;
+	size_t _Capacity;
+	size_t _Head = 0;
+	size_t _PeakBytes = 0;
+
+public:
+	explicit LinearArena(size_t capacity_bytes)
+	    : _Data(std::make_unique<std::byte[]>(capacity_bytes)), _Capacity(capacity_bytes) {
+	}
+
+	LinearArena(const LinearArena &) = delete;
+	LinearArena &operator=(const LinearArena &) = delete;
+
+	// returns nullptr if the arena is exhausted
+	// alignment must be a power of two
+	[[nodiscard]] void *allocate(size_t n_bytes, size_t alignment = alignof(std::max_align_t)) {
+		auto base = reinterpret_cast<uintptr_t>(_Data.get());
+		size_t offset = ((base + _Head + alignment - 1) & ~(alignment - 1)) - base;
+		if (offset + n_bytes > _Capacity) {
+			return nullptr;
+		}
+
+		_Head = offset + n_bytes;
+		_PeakBytes = std::max(_PeakBytes, _Head);
+		return _Data.get() + offset;
+	}
+
+	// uninitialized storage for n objects of T, nullptr if the arena is exhausted
+	template<typename T>
+	[[nodiscard]] T *allocate(size_t n = 1) {
+		static_assert(std::is_trivially_destructible_v<T>, "the arena never calls destructors");
+		return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void reset() {
+		_Head = 0;
+	}
+
+	[[nodiscard]] size_t get_used_bytes() const { return _Head; }
+	[[nodiscard]] size_t get_capacity() const { return _Capacity; }
+	// high-water mark since construction, e.g. to size the arena
+	[[nodiscard]] size_t get_peak_bytes() const { return _PeakBytes; }
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace gfxutils {
+
+// read-only memory mapping of a whole file, pages are loaded by the OS on first access
+class MappedFile {
+private:
+	const uint8_t *_Data = nullptr;
+	size_t _SizeBytes = 0;
+#ifdef _WIN32
+	void *_FileHandle = nullptr;
+	void *_MappingHandle = nullptr;
+#else
+	int _FileDescriptor = -1;
+#endif
+
+public:
+	MappedFile() = default;
+	// check is_open() for failures
+	explicit MappedFile(const std::string &file_path);
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	[[nodiscard]] bool is_open() const { return _Data != nullptr; }
+	[[nodiscard]] std::span<const uint8_t> get_data() const { return { _Data, _SizeBytes }; }
+
+private:
+	void _close();
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/thread_pool.h>
+#include <gfx-utils-core/vertex_buffer.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace gfxutils {
+
+// an imported mesh, optimized (see optimize_mesh()) and packed for upload
+// vertex attributes: position (location 0, vec3), normal (location 1, vec3), texture coordinates (location 2, vec2)
+// NOTE: may be moved between threads, `_Storage` keeps the memory the spans view alive
+struct MeshData {
+	std::vector<VertexAttributeInfo> _Attributes;
+	std::span<const uint8_t> _VertexData;  // in the GPU layout of `_Attributes`, see pack_vertices()
+	std::span<const uint8_t> _IndexData;
+	GLenum _IndexType = GL_UNSIGNED_INT;  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	size_t _NumVertices = 0;
+	size_t _NumIndices = 0;
+	glm::vec3 _BoundsMin{ 0.0f };
+	glm::vec3 _BoundsMax{ 0.0f };
+	bool _IsFromCache = false;
+	std::shared_ptr<const void> _Storage;  // the parsed buffers, or the mapping of the cache file
+
+	[[nodiscard]] bool empty() const { return _NumIndices == 0; }
+};
+
+// imports OBJ and glTF 2.0 (.gltf and .glb) triangle meshes on worker threads
+// every primitive of a file is merged into one mesh (glTF node transforms applied), materials are ignored,
+// missing normals are replaced by face normals and missing texture coordinates by 0, glTF texture coordinates are
+// flipped to the bottom-left origin of GL (and of the textures built from image files)
+// with a cache directory, the optimized and packed result is written there in a binary format that is mapped back on
+// later loads, so that loading a cached mesh is a file mapping followed by an upload; entries are keyed by the absolute
+// path, size and modification time of the source file, so edited files are imported again
+class MeshLoader : public IBuildTarget<MeshLoader> {
+private:
+	std::shared_ptr<ThreadPool> _ThreadPool;  // shared with the copies of the loader
+	std::string _CacheDir;
+
+public:
+	class MeshLoaderBuilder : public IBuilder<MeshLoaderBuilder, MeshLoader> {
+	private:
+		size_t _NumThreads = 0;
+		std::string _CacheDir;
+
+	public:
+		MeshLoaderBuilder(const std::string &name);
+
+		// 0: use all hardware threads
+		MeshLoaderBuilder &set_thread_count(size_t n_threads);
+		// created if it doesn't exist, default: empty, i.e. no cache
+		MeshLoaderBuilder &set_cache_dir(const std::string &cache_dir);
+
+		[[nodiscard]] MeshLoader _build() const;
+	};
+
+	// picks the importer by the extension (.obj, .gltf or .glb), the result is empty on failure
+	// submitting several files parses them in parallel
+	[[nodiscard]] std::future<MeshData> load_async(const std::string &file_path) const;
+	// load_async() + build_vertex_buffer(), an incomplete vertex buffer on failure
+	// NOTE: blocks, and must be called on the GL thread
+	[[nodiscard]] VertexBuffer load(const std::string &file_path) const;
+};
+
+// uploads the mesh as is, must be called on the GL thread
+[[nodiscard]] VertexBuffer build_vertex_buffer(const std::string &name, const MeshData &mesh);
+
+}  // namespace gfxutils
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace gfxutils {
+
+// an indexed triangle list, vertices are interleaved floats as VertexBufferBuilder takes them
+struct IndexedMesh {
+	std::vector<float> _Vertices;
+	std::vector<uint32_t> _Indices;
+	size_t _VertexSize = 0;  // in floats
+
+	[[nodiscard]] size_t get_vertex_count() const { return _VertexSize == 0 ? 0 : _Vertices.size() / _VertexSize; }
+};
+
+// turns a non-indexed triangle list into an indexed one, merging bitwise identical vertices
+[[nodiscard]] IndexedMesh deduplicate_vertices(std::span<const float> vertices, size_t vertex_size);
+
+// reorders the triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007), in linear time
+// `cache_size` is the FIFO size the order is tuned for, ~16 is a safe guess for most GPUs
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t n_vertices, size_t cache_size = 16);
+
+// reorders the vertices by first use in the index buffer, so that vertex fetches walk memory forwards,
+// and drops the vertices no triangle references
+void optimize_vertex_fetch(IndexedMesh &mesh);
+
+// deduplicate_vertices() + optimize_vertex_cache() + optimize_vertex_fetch()
+[[nodiscard]] IndexedMesh optimize_mesh(std::span<const float> vertices, size_t vertex_size, size_t cache_size = 16);
+
+// average cache miss ratio: vertex shader invocations per triangle with a FIFO cache of `cache_size`,
+// between 0.5 (ideal) and 3 (no reuse)
+[[nodiscard]] float get_acmr(std::span<const uint32_t> indices, size_t n_vertices, size_t cache_size = 16);
+
+}  // namespace gfxutils
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <gfx-utils-core/shader_types.h>
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace gfxutils {
+
+// a per-pixel pass of a post processing chain (tonemapping, color grading, ...), written as a GLSL snippet rather than
+// a whole shader: uniforms and helpers as needed, and
+//     vec3 pointwise(vec3 color)
+// mapping the linear color of a pixel to its output, without #version, inputs, outputs or main()
+// consecutive pointwise passes run in one generated shader, so the chain skips the render targets between them
+// NOTE: only `pointwise` is renamed per pass, helpers of fused passes share a scope and need distinct names
+struct PointwisePass {
+	std::string _Name;
+	std::string _Source;
+};
+
+// the shader running `passes` back to back, with the interface of the other post processing shaders
+// (u_input_texture_sampler, u_window_size, u_input_uv_scale):
+// - FRAGMENT_SHADER: for a fullscreen quad whose vertex shader outputs `m_uv`
+// - COMPUTE_SHADER: 8x8 work groups writing the image bound to unit 0, up to u_window_size
+// returns an empty string for other types
+[[nodiscard]] std::string generate_pointwise_shader(std::span<const PointwisePass> passes, ShaderType type);
+
+// how many passes from the front of `passes` fit in one generated shader: GLSL can't declare a uniform twice,
+// so the run stops before a pass redeclaring a uniform of the previous ones, e.g. the same pass twice; at least 1
+[[nodiscard]] size_t get_fusible_pass_count(std::span<const PointwisePass> passes);
+
+}  // namespace gfxutils
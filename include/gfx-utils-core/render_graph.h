@@ -0,0 +1,219 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/render_pass.h>
+#include <gfx-utils-core/render_pass_config.h>
+#include <gfx-utils-core/render_target_pool.h>
+#include <gfx-utils-core/storage_buffer.h>
+#include <gfx-utils-core/texture.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+enum class RenderGraphPassType {
+	RASTER,   // runs inside the render pass made of its attachments (the default FBO if it has none)
+	COMPUTE,
+	TRANSFER  // copies, uploads and read backs, runs outside of any render pass like compute passes
+};
+
+// how a pass accesses a resource, decides the memory barriers in front of the pass
+enum class RenderGraphUsage {
+	// reads
+	SAMPLED,     // texture() / texelFetch()
+	IMAGE_LOAD,  // imageLoad()
+	STORAGE_READ,
+	UNIFORM,
+	VERTEX,
+	INDEX,
+	INDIRECT,  // draw / dispatch indirect commands
+	COPY_SRC,  // glCopy*, glGet*SubData, read backs
+	// writes
+	IMAGE_STORE,    // imageStore() / image atomics, incoherent
+	STORAGE_WRITE,  // SSBO writes / atomics, incoherent
+	COLOR_ATTACHMENT,
+	DEPTH_ATTACHMENT,
+	COPY_DST  // glCopy*, glClear*, *SubData uploads
+};
+
+// a virtual resource of a render graph, valid until the graph is reset
+struct RenderGraphResource {
+	size_t _Index = SIZE_MAX;
+
+	[[nodiscard]] bool is_valid() const {
+		return _Index != SIZE_MAX;
+	}
+};
+
+struct RenderGraphStats {
+	size_t _NumPasses = 0;
+	size_t _NumCulledPasses = 0;
+	size_t _NumBarriers = 0;           // glMemoryBarrier calls per execution
+	size_t _NumTransientTextures = 0;  // declared and used by a pass that isn't culled
+	size_t _NumPhysicalTextures = 0;   // the textures backing them after aliasing
+	size_t _PhysicalTextureBytes = 0;
+	size_t _NumCompiles = 0;
+};
+
+// passes declare the resources they read and write, and run in declaration order once the graph is compiled:
+//   - passes whose writes nobody reads are culled, unless they write an imported resource, an output or have side effects
+//   - glMemoryBarrier is issued in front of a pass only for the bits its accesses need after incoherent writes
+//     (image stores, storage buffer writes) of earlier passes, each bit once until the next such write
+//   - transient textures whose lifetimes don't overlap share the same texture if their descriptions match
+// the graph is compiled again only when its topology changes (passes, accesses, resources or resolved sizes),
+// so it can either be declared once or reset and declared again every frame
+// NOTE: a write discards the previous contents of a resource, a pass that keeps them (e.g. blends into a target or
+// updates part of a buffer) declares a read as well
+class RenderGraph : public IBuildTarget<RenderGraph> {
+private:
+	struct State;
+
+public:
+	// what the execute callback of a pass gets: the physical resources behind its virtual ones
+	class Context {
+	private:
+		const State *_State;
+		size_t _ScheduleIndex;
+
+	public:
+		Context(const State *state, size_t schedule_index);
+
+		[[nodiscard]] const Texture &get_texture(RenderGraphResource resource) const;
+		[[nodiscard]] GLuint get_buffer(RenderGraphResource resource) const;
+		// the render pass of a raster pass, already in use while the callback runs
+		[[nodiscard]] const RenderPass &get_render_pass() const;
+	};
+
+	using ExecuteFunc = std::function<void(const Context &)>;
+
+	// declares the accesses of a pass, valid until the graph is reset
+	class Pass {
+	private:
+		State *_State;
+		size_t _PassIndex;
+
+	public:
+		Pass(State *state, size_t pass_index);
+
+		Pass &read(RenderGraphResource resource, RenderGraphUsage usage);
+		// color attachments are bound in the order they are written
+		Pass &write(RenderGraphResource resource, RenderGraphUsage usage);
+		// never culled, e.g. it reads back results or presents
+		// otherwise a pass is culled unless it writes an imported or output resource, or one a later pass reads;
+		// raster passes without attachments draw to the default framebuffer and are never culled either
+		Pass &set_side_effect();
+		// raster passes only, default: no depth test, no sRGB
+		// transient attachments loaded with LoadOp::LOAD get DONT_CARE at their first use, and DISCARD after their last one
+		Pass &set_config(const RenderPassConfig &config);
+		Pass &set_execute(ExecuteFunc func);
+	};
+
+private:
+	struct ResourceNode {
+		std::string _Name;
+		bool _IsImported;
+		bool _IsBuffer;
+		bool _IsOutput = false;
+		RenderTargetDesc _Desc;  // transient textures, window scale resolved at compile time
+		std::optional<Texture> _ImportedTexture;
+		GLuint _ImportedBuffer = 0;
+	};
+
+	struct Access {
+		size_t _ResourceIndex;
+		RenderGraphUsage _Usage;
+		bool _IsWrite;
+	};
+
+	struct PassNode {
+		std::string _Name;
+		RenderGraphPassType _Type;
+		std::vector<Access> _Accesses;
+		bool _HasSideEffect = false;
+		RenderPassConfig _Config{ false, false };
+		ExecuteFunc _Execute;
+	};
+
+	struct PhysicalTexture {
+		RenderTargetDesc _Desc;
+		Texture _Texture;
+		size_t _SizeBytes;
+	};
+
+	struct CompiledPass {
+		size_t _PassIndex;
+		GLbitfield _Barriers;
+		std::optional<RenderPass> _RenderPass;  // raster passes
+		// raster passes whose (color / depth) attachments are transient textures starting / ending their lifetime there
+		bool _IsColorUndefined = false;
+		bool _IsColorDead = false;
+		bool _IsDepthUndefined = false;
+		bool _IsDepthDead = false;
+	};
+
+	struct State {
+		std::string _Name;
+		std::vector<ResourceNode> _Resources;
+		std::vector<PassNode> _Passes;
+
+		// valid while _CompiledHash matches the declared topology
+		uint64_t _CompiledHash = 0;
+		bool _IsCompiled = false;
+		std::vector<CompiledPass> _Schedule;
+		std::vector<PhysicalTexture> _PhysicalTextures;
+		std::vector<size_t> _PhysicalTextureIndices;  // per resource, SIZE_MAX if not backed by a physical texture
+		RenderGraphStats _Stats;
+
+		int _WindowWidth = 0;
+		int _WindowHeight = 0;
+	};
+
+	std::shared_ptr<State> _State;  // shared with the window size callback and the copies of the graph
+
+public:
+	class RenderGraphBuilder : public IBuilder<RenderGraphBuilder, RenderGraph> {
+	public:
+		RenderGraphBuilder(const std::string &name);
+
+		[[nodiscard]] RenderGraph _build() const;
+	};
+
+	// NOTE: the graph keeps a reference, the texture / buffer must stay alive while the graph uses it
+	RenderGraphResource import_texture(const std::string &name, const Texture &texture) const;
+	RenderGraphResource import_buffer(const std::string &name, GLuint buffer_handle) const;
+	RenderGraphResource import_buffer(const std::string &name, const StorageBuffer &buffer) const;
+	// a texture owned by the graph, alive from its first to its last access in the schedule
+	// the filter is GL_NEAREST and the contents are undefined before the first write
+	RenderGraphResource create_texture(const std::string &name, const RenderTargetDesc &desc) const;
+	// keeps the passes writing `resource` alive, e.g. a transient texture read outside the graph
+	void set_output(RenderGraphResource resource) const;
+
+	Pass add_pass(const std::string &name, RenderGraphPassType type) const;
+
+	// drops the declared passes and resources, the compiled schedule and its textures are kept
+	// until a compile finds a different topology
+	void reset() const;
+	// compiles the schedule if the topology changed since the last compile
+	void compile() const;
+	// compiles if needed, then runs the passes of the schedule with their barriers
+	void execute() const;
+
+	// the physical texture behind `resource` after compile(), e.g. to display an output
+	[[nodiscard]] const Texture &get_texture(RenderGraphResource resource) const;
+	[[nodiscard]] RenderGraphStats get_stats() const;
+
+private:
+	RenderGraphResource _add_resource(ResourceNode &&node) const;
+	[[nodiscard]] uint64_t _hash_topology() const;
+	void _release_physical_resources() const;
+};
+
+}  // namespace gfxutils
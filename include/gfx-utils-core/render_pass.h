@@ -41,13 +41,22 @@ public:
 		RenderPassBuilder &add_color_attachment(const Texture &texture, bool clear_before_use, const glm::vec4 &clear_value_rgba = {});
 		RenderPassBuilder &set_depth_attachment(const Texture &texture);
 
-		[[nodiscard]] RenderPass _build() const;
+		[[nodiscard]] RenderPass _build() const &;
+		// moves the attachments into the render pass
+		[[nodiscard]] RenderPass _build() &&;
+
+	private:
+		void _create_framebuffer(RenderPass &res) const;
 	};
 
-	// NOTE: depth_test flag is ONLY meaningful when writing to default FBO
-	// depth attachment(if any) will always be cleared regardless of this flag
+	// sets the viewport to the (scaled) render area, applies the load ops, runs `callback`, then applies the store ops
 	void use(const RenderPassConfig &render_pass_config, const std::function<void()> &callback) const;
 
+	// the size of the smallest attachment, or the window for the default FBO
+	[[nodiscard]] glm::ivec2 get_render_area() const;
+	// the render area scaled by `resolution_scale`, at least 1x1, i.e. the viewport use() sets
+	[[nodiscard]] glm::ivec2 get_viewport_size(float resolution_scale) const;
+
 private:
 	RenderPass() = default;
 };
@@ -1,10 +1,37 @@
 #pragma once
 
+#include <optional>
+
 namespace gfxutils {
 
+// what an attachment holds when the pass starts
+enum class LoadOp {
+	LOAD,      // the contents of the previous passes
+	CLEAR,     // the clear value of the attachment
+	DONT_CARE  // undefined, for passes overwriting every pixel
+};
+
+// what an attachment holds after the pass, DISCARD maps to glInvalidateFramebuffer
+// e.g. depth only needed while drawing, so tilers and software rasterizers don't write it back
+enum class StoreOp {
+	STORE,
+	DISCARD
+};
+
 struct RenderPassConfig {
 	bool _EnableDepthTest;
 	bool _EnableSRGB;
+
+	// std::nullopt: as the render pass was built, i.e. the clear flags of add_color_attachment, the default FBO is cleared
+	std::optional<LoadOp> _ColorLoadOp = std::nullopt;
+	StoreOp _ColorStoreOp = StoreOp::STORE;
+	// std::nullopt: cleared if the depth test is enabled, kept otherwise
+	std::optional<LoadOp> _DepthLoadOp = std::nullopt;
+	StoreOp _DepthStoreOp = StoreOp::STORE;
+
+	// dynamic resolution: the viewport covers this part (of each axis) of the render area, from its lower left corner
+	// NOTE: passes reading the result must only sample that part, see RenderPass::get_viewport_size
+	float _ResolutionScale = 1.0f;
 };
 
 }  // namespace gfxutils
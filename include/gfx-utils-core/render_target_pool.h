@@ -0,0 +1,113 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/render_pass.h>
+#include <gfx-utils-core/texture.h>
+
+#include <compare>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+struct RenderTargetDesc {
+	size_t _Width = 0;
+	size_t _Height = 0;
+	GLenum _InternalFormat = GL_RGBA32F;
+	size_t _Samples = 1;
+	// > 0: width and height are ignored and follow the window size times this factor, resolved at acquire time
+	float _WindowScale = 0.0f;
+
+	auto operator<=>(const RenderTargetDesc &) const = default;
+};
+
+// `desc` with the window scale (if any) turned into a size for the given window size
+[[nodiscard]] RenderTargetDesc resolve_render_target_desc(const RenderTargetDesc &desc, int window_width, int window_height);
+
+// a color target and the render pass drawing into it, valid until it is released (or the frame ends)
+struct PooledRenderTarget {
+	Texture _Texture;
+	RenderPass _RenderPass;
+	size_t _SlotIndex = 0;
+	size_t _Generation = 0;  // of the slot when acquired, so that a target released twice can't free the slot's next user
+};
+
+struct RenderTargetPoolStats {
+	size_t _NumSlots = 0;     // allocated targets, in use or idle
+	size_t _NumInUse = 0;
+	size_t _AllocatedBytes = 0;
+	size_t _PeakBytes = 0;    // of _AllocatedBytes since the pool was built
+};
+
+// hands out transient render targets keyed by (size, format, samples) and recycles them once released,
+// so the VRAM in use scales with the targets alive at the same time (e.g. the active effect chain)
+// rather than with everything that could be rendered
+// window-sized targets are reallocated lazily: after a resize, idle targets of the old size are freed by the next
+// acquire() or end_frame(), and targets still in use are freed when they are released
+// NOTE: pooled targets are shared, don't keep copies of `_Texture` / `_RenderPass` after releasing them
+class RenderTargetPool : public IBuildTarget<RenderTargetPool> {
+private:
+	struct Slot {
+		RenderTargetDesc _Desc;  // resolved, i.e. _WindowScale is 0
+		Texture _Texture;
+		std::optional<RenderPass> _RenderPass;
+		size_t _SizeBytes;
+		size_t _WindowGeneration;  // window size generation the target was allocated for, if window-sized
+		bool _IsWindowSized;
+		bool _IsInUse;
+		bool _IsAlive;
+		size_t _LastUsedFrame;
+		size_t _Generation;  // bumped every time the slot is handed out
+	};
+
+	struct State {
+		std::vector<Slot> _Slots;  // freed slots stay as tombstones so the indices of the others remain valid
+		size_t _FrameIndex = 0;
+		size_t _MaxIdleFrames;
+		int _WindowWidth = 0;
+		int _WindowHeight = 0;
+		size_t _WindowGeneration = 0;
+		size_t _AllocatedBytes = 0;
+		size_t _PeakBytes = 0;
+	};
+
+	std::shared_ptr<State> _State;  // shared with the window size callback and the copies of the pool
+
+public:
+	class RenderTargetPoolBuilder : public IBuilder<RenderTargetPoolBuilder, RenderTargetPool> {
+	private:
+		size_t _MaxIdleFrames = 2;
+
+	public:
+		RenderTargetPoolBuilder(const std::string &name);
+
+		// idle targets unused for more than this many frames are freed by end_frame()
+		RenderTargetPoolBuilder &set_max_idle_frames(size_t n_frames);
+
+		[[nodiscard]] RenderTargetPool _build() const;
+	};
+
+	// a target of a free slot matching `desc`, or a newly allocated one
+	// the filter is GL_NEAREST and the contents are undefined: the render pass doesn't clear them
+	[[nodiscard]] PooledRenderTarget acquire(const RenderTargetDesc &desc) const;
+	void release(const PooledRenderTarget &target) const;
+	// releases the targets still in use and frees the ones idle for too long, call once per frame
+	void end_frame() const;
+	// frees every idle target
+	void trim() const;
+
+	// `desc` with the window size resolved, i.e. the size acquire() would allocate
+	[[nodiscard]] RenderTargetDesc resolve(const RenderTargetDesc &desc) const;
+	[[nodiscard]] RenderTargetPoolStats get_stats() const;
+
+private:
+	void _free_slot(Slot &slot) const;
+	[[nodiscard]] bool _is_stale(const Slot &slot) const;
+};
+
+}  // namespace gfxutils
@@ -14,11 +14,13 @@ enum class ResourceType {
 	VAO,
 	VBO,
 	SSBO,
+	PBO,
 	TEXTURE,
 	VERTEX_SHADER,
 	FRAGMENT_SHADER,
 	COMPUTE_SHADER,
-	SHADER_PROGRAM
+	SHADER_PROGRAM,
+	QUERY
 };
 
 class ResourceManager : public Singleton<ResourceManager> {
@@ -28,11 +30,18 @@ private:
 	std::vector<std::pair<GLuint, std::function<void()>>> _TextureList;
 	std::vector<std::pair<GLuint, std::function<void()>>> _ShaderList;
 	std::vector<std::pair<GLuint, std::function<void()>>> _ShaderProgramList;
+	std::vector<std::pair<GLuint, std::function<void()>>> _QueryList;
 
 public:
 	// NOTE: the callback is called *right before* the resource is deleted
 	[[nodiscard]] GLuint alloc(ResourceType type, const std::function<void()> callback = []() {});
+	// frees a single resource before shutdown, e.g. for pooled resources that are trimmed or reallocated
+	// NOTE: every object sharing the handle is left dangling
+	void release(ResourceType type, GLuint handle);
 	void free();
+
+private:
+	[[nodiscard]] std::vector<std::pair<GLuint, std::function<void()>>> &_get_list(ResourceType type);
 };
 
 }  // namespace gfxutils
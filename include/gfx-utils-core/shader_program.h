@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -21,6 +23,8 @@ private:
 	GLuint _Program;
 	std::unordered_map<std::string, GLint> _MapUniformNameToLocation;
 	std::vector<UniformInfo> _UniformInfoVec;
+	std::vector<StorageBlockInfo> _StorageBlockInfoVec;
+	std::array<size_t, 3> _WorkGroupSize{};  // compute programs only
 
 public:
 	class ShaderProgramBuilder : public IBuilder<ShaderProgramBuilder, ShaderProgram> {
@@ -40,10 +44,22 @@ public:
 	void set_uniform(const std::string &name, const glm::mat4 &matrix);
 	void set_uniform(const std::string &name, const glm::vec2 &vector);
 	void set_uniform(const std::string &name, const glm::vec3 &vector);
+	// -1 (ignored by glUniform*) if the program has no active uniform of this name
 	GLint get_uniform_location(const std::string &name);
+	// same as get_uniform_location(), the uniform map is never modified after the build so it is safe on any thread
+	[[nodiscard]] GLint find_uniform_location(const std::string &name) const;
 	std::vector<UniformInfo> get_all_uniform_info() const;
+	std::vector<StorageBlockInfo> get_all_storage_block_info() const;
+	// std::nullopt if the program has no active storage block of this name
+	std::optional<StorageBlockInfo> get_storage_block_info(const std::string &block_name) const;
+	// the local size declared by a compute program, all 0 for other programs
+	[[nodiscard]] std::array<size_t, 3> get_work_group_size() const;
+	// work groups covering width x height x depth invocations, rounded up, for glDispatchCompute
+	[[nodiscard]] std::array<size_t, 3> get_group_count(size_t width, size_t height = 1, size_t depth = 1) const;
 
 	void use() const;
+
+	[[nodiscard]] GLuint _get_handle() const;
 };
 
 }  // namespace gfxutils
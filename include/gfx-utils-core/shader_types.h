@@ -18,7 +18,9 @@ enum class ShaderDataType {
 	MAT2,
 	MAT3,
 	MAT4,
-	SAMPLER_2D
+	SAMPLER_2D,
+	SAMPLER_2D_ARRAY,
+	IMAGE_2D
 };
 
 }  // namespace gfxutils
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+namespace gfxutils {
+
+// std430 base alignment and size of the GLSL counterpart of scalar and glm types, see the GLSL spec 7.6.2.2
+template<typename T>
+struct Std430Traits {
+	static constexpr bool is_known = false;
+};
+
+template<typename T>
+    requires(std::is_same_v<T, float> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> || std::is_same_v<T, double>)
+struct Std430Traits<T> {
+	static constexpr bool is_known = true;
+	static constexpr size_t alignment = sizeof(T);
+	static constexpr size_t size = sizeof(T);
+};
+
+// vec2 aligns to 2 components, vec3 and vec4 to 4
+template<glm::length_t L, typename T, glm::qualifier Q>
+struct Std430Traits<glm::vec<L, T, Q>> {
+	static constexpr bool is_known = Std430Traits<T>::is_known;
+	static constexpr size_t alignment = (L == 2 ? 2 : 4) * sizeof(T);
+	static constexpr size_t size = L * sizeof(T);
+};
+
+// column-major: an array of C column vectors
+template<glm::length_t C, glm::length_t R, typename T, glm::qualifier Q>
+struct Std430Traits<glm::mat<C, R, T, Q>> {
+	static constexpr bool is_known = Std430Traits<T>::is_known;
+	static constexpr size_t alignment = Std430Traits<glm::vec<R, T, Q>>::alignment;
+	static constexpr size_t size = C * ((Std430Traits<glm::vec<R, T, Q>>::size + alignment - 1) / alignment * alignment);
+};
+
+template<typename T>
+inline constexpr size_t std430_alignment_v = Std430Traits<T>::alignment;
+
+// whether a C++ array of T has the same layout as a std430 array of its GLSL counterpart
+// false for glm::vec3 and glm::mat3, whose std430 array strides are padded to 16 bytes (use vec4 / mat3x4, or a struct)
+// structs can't be inspected member by member: they only need to be plain data of a multiple of 4 bytes here,
+// their members are checked with GFXUTILS_STD430_CHECK_MEMBER and their stride when bound to a program
+template<typename T>
+consteval bool is_std430_array_compatible() {
+	if constexpr (Std430Traits<T>::is_known) {
+		constexpr auto alignment = Std430Traits<T>::alignment;
+		return sizeof(T) == (Std430Traits<T>::size + alignment - 1) / alignment * alignment;
+	} else {
+		return std::is_class_v<T> && std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T> && sizeof(T) % 4 == 0;
+	}
+}
+
+}  // namespace gfxutils
+
+// checks that a member of a struct mirrored in a std430 block sits at a multiple of its base alignment, as in GLSL,
+// e.g. GFXUTILS_STD430_CHECK_MEMBER(Particle, _Velocity) fails if a glm::vec4 follows a single float
+#define GFXUTILS_STD430_CHECK_MEMBER(Struct, member)                                                             \
+	static_assert(offsetof(Struct, member) % ::gfxutils::std430_alignment_v<decltype(Struct::member)> == 0, \
+	              #Struct "::" #member " is not at its std430 offset, add padding before it")
@@ -4,17 +4,47 @@
 #include <gfx-utils-core/interfaces/builder.h>
 
 #include <cstdint>
+#include <future>
 #include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
 namespace gfxutils {
 
+// a range of a storage buffer copied back to the CPU
+// `_Data` views a persistently mapped staging buffer, which is recycled once every copy of the readback is destroyed
+// NOTE: may be read and destroyed on any thread, but must not outlive the storage buffer it was read from
+struct StorageBufferReadback {
+	std::span<const uint8_t> _Data;
+	std::shared_ptr<const void> _Staging;
+};
+
 class StorageBuffer : public IBuildTarget<StorageBuffer> {
 private:
+	struct StagingBuffer {
+		GLuint _BufferHandle;
+		const uint8_t *_MappedData;
+		size_t _SizeBytes;
+	};
+
+	struct PendingRead {
+		std::shared_ptr<StagingBuffer> _Staging;
+		size_t _SizeBytes;
+		GLsync _Fence;
+		std::promise<StorageBufferReadback> _Promise;
+	};
+
+	struct ReadbackState {
+		std::vector<std::shared_ptr<StagingBuffer>> _StagingBuffers;  // in use while referenced outside of this list
+		std::vector<PendingRead> _PendingReads;
+	};
+
 	GLuint _StorageBufferHandle;
 	size_t _BufferSizeBytes;
+	std::shared_ptr<ReadbackState> _ReadbackState;  // shared with the copies of the buffer and its release callback
 
 public:
 	class StorageBufferBuilder : public IBuilder<StorageBufferBuilder, StorageBuffer> {
@@ -30,7 +60,21 @@ public:
 	};
 
 	void bind(size_t binding_point) const;
-	void set_data(const uint8_t *data, size_t n_bytes) const;
+	// writes n_bytes at `offset`, in bytes
+	void set_data(const uint8_t *data, size_t n_bytes, size_t offset = 0) const;
+
+	// copies [offset, offset + n_bytes) into a staging buffer after the commands issued so far (e.g. the dispatch writing it),
+	// the future becomes ready in the first poll_async_reads() after the GPU is done, the CPU never waits for it here
+	// NOTE: don't block on the future on the GL thread without polling, nothing else completes it
+	[[nodiscard]] std::future<StorageBufferReadback> read_async(size_t offset, size_t n_bytes) const;
+	// completes the reads the GPU has finished, call once per frame on the GL thread
+	// wait: block until all pending reads are done, e.g. at the end of a batch
+	void poll_async_reads(bool wait = false) const;
+	[[nodiscard]] size_t get_pending_read_count() const;
+
+	[[nodiscard]] size_t get_size() const;
+
+	[[nodiscard]] GLuint _get_handle() const;
 };
 
 }  // namespace gfxutils
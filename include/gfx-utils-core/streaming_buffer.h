@@ -0,0 +1,86 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+// a range of the streaming buffer written by the CPU this frame, valid until the frame ends
+struct StreamingAllocation {
+	uint8_t *_Data = nullptr;  // persistently mapped, writes are visible to the GPU without flushing
+	size_t _Offset = 0;        // in bytes from the start of the buffer, for bind_range() or vertex / index offsets
+	size_t _SizeBytes = 0;
+
+	[[nodiscard]] bool empty() const { return _Data == nullptr; }
+};
+
+struct StreamingBufferStats {
+	size_t _NumFrames = 0;
+	size_t _NumStalls = 0;       // frames whose region was still read by the GPU, i.e. the CPU had to wait
+	size_t _PeakFrameBytes = 0;  // largest amount allocated in one frame, including alignment padding
+};
+
+// stall-free streaming of per-frame data (particles, instances, parameters, ...) into one persistently mapped buffer
+// the buffer is split into `n_regions` frame regions used round-robin, each frame sub-allocates from its region with a
+// bump allocator, and end_frame() fences the region so that it is only rewritten once the GPU is done reading it
+// NOTE: with N regions the CPU may run N - 1 frames ahead, allocations of a frame must fit into one region
+class StreamingBuffer : public IBuildTarget<StreamingBuffer> {
+private:
+	struct State {
+		GLuint _BufferHandle = 0;
+		uint8_t *_MappedData = nullptr;
+		size_t _RegionSizeBytes = 0;
+		size_t _Alignment = 1;
+		size_t _RegionIndex = 0;
+		size_t _Head = 0;                // bump pointer in the current region
+		std::vector<GLsync> _Fences;     // one per region, nullptr while not in flight
+		StreamingBufferStats _Stats;
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the buffer and its release callback
+
+public:
+	class StreamingBufferBuilder : public IBuilder<StreamingBufferBuilder, StreamingBuffer> {
+	private:
+		size_t _RegionSizeBytes = 0;
+		size_t _NumRegions = 3;
+
+	public:
+		StreamingBufferBuilder(const std::string &name);
+
+		// the budget of one frame
+		StreamingBufferBuilder &set_region_size(size_t region_size_bytes);
+		// frames in flight, 3 covers double-buffered swap chains with the driver queuing one more frame
+		StreamingBufferBuilder &set_region_count(size_t n_regions);
+
+		[[nodiscard]] StreamingBuffer _build() const;
+	};
+
+	// `alignment` 0: the larger of the SSBO and UBO offset alignments, so that every allocation can be bound
+	// returns an empty allocation if the current region is exhausted
+	[[nodiscard]] StreamingAllocation allocate(size_t n_bytes, size_t alignment = 0) const;
+	// allocates and copies `data`
+	[[nodiscard]] StreamingAllocation upload(std::span<const uint8_t> data, size_t alignment = 0) const;
+
+	// target: GL_SHADER_STORAGE_BUFFER or GL_UNIFORM_BUFFER
+	void bind_range(GLenum target, size_t binding_point, const StreamingAllocation &allocation) const;
+
+	// fences the current region after the commands using it and moves on to the next one,
+	// waiting for the GPU if it still reads that region; call once per frame after the last draw using this frame's data
+	void end_frame() const;
+
+	[[nodiscard]] size_t get_region_size() const;
+	[[nodiscard]] const StreamingBufferStats &get_stats() const;
+
+	[[nodiscard]] GLuint _get_handle() const;
+};
+
+}  // namespace gfxutils
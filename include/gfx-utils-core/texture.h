@@ -1,11 +1,13 @@
 #pragma once
 
+#include <gfx-utils-core/image.h>
 #include <gfx-utils-core/interfaces/build_target.h>
 #include <gfx-utils-core/interfaces/builder.h>
 #include <gfx-utils-core/interfaces/exportable_resource.h>
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -19,6 +21,11 @@ enum class TextureFormat {
 	// todo
 };
 
+// size in bytes of one pixel in the client memory layout described by (cpu_format, cpu_comp_type)
+[[nodiscard]] size_t get_cpu_pixel_size(GLenum cpu_format, GLenum cpu_comp_type);
+// bytes per texel of the usual render target formats, for VRAM accounting only
+[[nodiscard]] size_t get_internal_format_size(GLenum internal_format);
+
 struct TextureInfo {
 	size_t _Width;
 	size_t _Height;
@@ -26,6 +33,9 @@ struct TextureInfo {
 	GLenum _CPUFormat;
 	GLenum _CPUCompType;
 	GLint _Filter;
+	GLenum _Target = GL_TEXTURE_2D;  // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY or GL_TEXTURE_2D_MULTISAMPLE
+	size_t _Layers = 1;
+	size_t _Samples = 1;
 };
 
 class Texture : public IBuildTarget<Texture>,
@@ -35,9 +45,16 @@ private:
 	TextureInfo _Info;
 
 public:
+	// region updates of at least this many bytes are staged through a shared pixel unpack buffer,
+	// smaller ones are uploaded straight from client memory
+	static constexpr size_t PBO_UPLOAD_THRESHOLD = 256 << 10;
+
 	class TextureBuilder : public IBuilder<TextureBuilder, Texture> {
 	private:
-		std::vector<uint8_t> _Data;
+		// at most one CPU copy of the pixels is held: either owned here, or borrowed from the caller
+		std::vector<uint8_t> _OwnedData;
+		Image _Image;                    // uploaded with its own channel count and element type
+		std::span<const uint8_t> _Data;  // views `_OwnedData`, `_Image` or caller-owned memory
 		bool _IsSizeSet = false;
 		bool _IsDataSet = false;
 		bool _IsFormatSet = false;
@@ -48,19 +65,56 @@ public:
 	public:
 		TextureBuilder(const std::string &name);
 
+		// `_Data` may point into `_OwnedData` or `_Image`, so copying would leave it dangling
+		TextureBuilder(const TextureBuilder &) = delete;
+		TextureBuilder(TextureBuilder &&) = default;
+
 		TextureBuilder &set_size(size_t width, size_t height);
 		TextureBuilder &set_format(GLenum internal_format, GLenum cpu_format = GL_RGBA, GLenum cpu_comp_type = GL_UNSIGNED_BYTE);
 		TextureBuilder &set_filter(GLint filter);
-		TextureBuilder &set_data(const std::vector<uint8_t> &data);
-		TextureBuilder &set_data_from_file(const std::string &file_path);
+		// makes a GL_TEXTURE_2D_ARRAY, input data (if any) holds the layers one after another
+		TextureBuilder &set_layers(size_t n_layers);
+		// n_samples > 1 makes a GL_TEXTURE_2D_MULTISAMPLE render target, which can't hold input data and ignores the filter
+		TextureBuilder &set_samples(size_t n_samples);
+		// NOTE: the data is NOT copied, it must stay alive until the texture is built
+		TextureBuilder &set_data(std::span<const uint8_t> data);
+		TextureBuilder &set_data(std::vector<uint8_t> &&data);
+		// the size is taken from the image
+		TextureBuilder &set_data(Image &&image);
+		// empty codec_name: pick the codec by the file extension
+		// color_conversion is applied on the CPU, converting 8-bit files to F16 (e.g. SRGB_TO_LINEAR for color images read into float textures)
+		TextureBuilder &set_data_from_file(const std::string &file_path, const std::string &codec_name = "", ColorConversion color_conversion = ColorConversion::NONE);
 
-		[[nodiscard]] Texture _build() const;
+		[[nodiscard]] Texture _build() const &;
+		// releases the CPU-side pixels right after the upload
+		[[nodiscard]] Texture _build() &&;
 	};
 
 	void use(size_t texture_unit) const;
+	// binds level 0 (every layer of an array) to an image unit for imageLoad / imageStore, in the texture's internal format
+	// access: GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE
+	void bind_image(size_t image_unit, GLenum access = GL_READ_WRITE) const;
+
+	// uploads `image` into one layer (layer 0 for 2D textures) at the given offset, rows bottom to top as GL expects
+	void update_layer(size_t layer, size_t x_offset, size_t y_offset, const Image &image) const;
+	// uploads a width x height block of tightly packed pixels in the texture's CPU format (see set_format) at (x, y)
+	void update_region(size_t x, size_t y, size_t width, size_t height, std::span<const uint8_t> data, size_t layer = 0) const;
+	// uploads the (x, y, width, height) region of `image` to the same region of the texture, e.g. the dirty rectangles
+	// of a CPU copy that mirrors the texture: `image` has the size of the texture and its rows in GL order, bottom to top
+	void update_region(const Image &image, size_t x, size_t y, size_t width, size_t height, size_t layer = 0) const;
+
+	// reads back level 0 (of the given layer) as packed RGBA, rows top to bottom
+	[[nodiscard]] Image read_to_image(ImageElementType element_type, size_t layer = 0) const;
+
+	[[nodiscard]] const TextureInfo &get_info() const;
 
 	[[nodiscard]] GLuint _get_handle() const;
-	void _export_to_file(const std::string &file_path) const;
+	// the readback precision follows the codec, so float targets keep their HDR data in float formats (e.g. .pfm, .hdr)
+	void _export_to_file(const std::string &file_path, const std::string &codec_name) const;
+
+private:
+	// `data` points at the first pixel of the region, its rows are `row_stride` bytes apart
+	void _upload_region(size_t layer, size_t x, size_t y, size_t width, size_t height, GLenum cpu_format, GLenum cpu_comp_type, const uint8_t *data, size_t row_stride) const;
 };
 
 }  // namespace gfxutils
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <gfx-utils-core/atlas_packer.h>
+#include <gfx-utils-core/image.h>
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/texture.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+struct TextureAtlasEntry {
+	std::string _Name;
+	AtlasRegion _Region;  // `_Page` is the layer of the array texture
+};
+
+// many small images packed into the layers of one GL_TEXTURE_2D_ARRAY, so they can be drawn with a single bind
+// the edge texels of every image are extruded into its padding, so GL_LINEAR lookups on the edges of a region's UV rect
+// repeat the edge; with set_padding(0) inset the UV rect by half a texel on each side instead
+class TextureAtlas : public IBuildTarget<TextureAtlas> {
+private:
+	Texture _Texture;
+	std::vector<TextureAtlasEntry> _Entries;
+	std::unordered_map<std::string, size_t> _MapNameToEntry;
+
+public:
+	class TextureAtlasBuilder : public IBuilder<TextureAtlasBuilder, TextureAtlas> {
+	private:
+		size_t _PageWidth = 2048;
+		size_t _PageHeight = 2048;
+		size_t _Padding = 1;
+		GLenum _InternalFormat = GL_RGBA8;
+		GLint _Filter = GL_LINEAR;
+		std::vector<std::pair<std::string, Image>> _Images;
+
+	public:
+		TextureAtlasBuilder(const std::string &name);
+
+		TextureAtlasBuilder &set_page_size(size_t width, size_t height);
+		TextureAtlasBuilder &set_padding(size_t padding);
+		TextureAtlasBuilder &set_format(GLenum internal_format);
+		TextureAtlasBuilder &set_filter(GLint filter);
+		// rows top to bottom, as decoded by the image codecs
+		TextureAtlasBuilder &add_image(const std::string &image_name, Image &&image);
+		TextureAtlasBuilder &add_image_from_file(const std::string &image_name, const std::string &file_path);
+
+		[[nodiscard]] TextureAtlas _build() const;
+	};
+
+	void use(size_t texture_unit) const;
+
+	[[nodiscard]] const Texture &get_texture() const;
+	[[nodiscard]] const std::vector<TextureAtlasEntry> &get_entries() const;
+	// returns nullptr if there is no such image
+	[[nodiscard]] const TextureAtlasEntry *find_entry(const std::string &image_name) const;
+};
+
+}  // namespace gfxutils
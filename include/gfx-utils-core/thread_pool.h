@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gfxutils {
+
+// fixed set of worker threads running submitted tasks in FIFO order
+// NOTE: tasks must not touch GL, the context is only current on the thread that created it
+class ThreadPool {
+private:
+	std::vector<std::thread> _Workers;
+	std::queue<std::function<void()>> _Tasks;
+	bool _IsStopping = false;
+	std::mutex _Mutex;
+	std::condition_variable _HasTask;
+
+public:
+	// n_threads == 0: use all hardware threads
+	explicit ThreadPool(size_t n_threads = 0);
+	// finishes the queued tasks before joining the workers
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	template<typename Func>
+	[[nodiscard]] std::future<std::invoke_result_t<Func>> submit(Func &&func) {
+		// std::function needs a copyable callable, hence the shared_ptr around the move-only packaged_task
+		auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Func>()>>(std::forward<Func>(func));
+		auto res = task->get_future();
+		{
+			std::lock_guard lock(_Mutex);
+			_Tasks.emplace([task]() { (*task)(); });
+		}
+		_HasTask.notify_one();
+		return res;
+	}
+
+	[[nodiscard]] size_t get_thread_count() const;
+
+private:
+	void _worker_loop();
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/texture.h>
+
+#include <array>
+#include <functional>
+#include <string>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+struct TiledProcessingStats {
+	size_t _Width = 0;
+	size_t _Height = 0;
+	size_t _NumTiles = 0;
+	double _Seconds = 0.0;
+};
+
+// runs a GPU processing step over image files of any size (e.g. larger than GL_MAX_TEXTURE_SIZE):
+// the input is streamed band by band, cut into overlapping tiles with an apron for the kernel radius,
+// and the centers of the processed tiles are stitched into the output file as the bands complete
+// reading the next band, uploading / processing / reading back tiles and writing the previous band overlap,
+// and memory stays at a few bands of (width x tile size) pixels whatever the height of the image
+// NOTE: codecs without streaming support fall back to holding the whole image, see ImageCodecRegistry::open_reader()
+class TiledImageProcessor : public IBuildTarget<TiledImageProcessor> {
+public:
+	// receives the input tile, rows bottom to top as usual, `get_tile_texture_size()` texels wide and high including the apron
+	// (which holds the neighbouring pixels, or the replicated border at the image edges), and returns the processed
+	// texture, which must have the same size; the viewport covers the tile while the function runs
+	using TileFunc = std::function<const Texture &(const Texture &input_tile)>;
+
+private:
+	size_t _TileSize;
+	size_t _Apron;
+	Texture _InputTile;
+	std::array<GLuint, 2> _UploadPBOs;  // double buffered, so staging the next tile doesn't wait for the previous upload
+	std::array<GLuint, 2> _ReadbackPBOs;
+
+public:
+	class TiledImageProcessorBuilder : public IBuilder<TiledImageProcessorBuilder, TiledImageProcessor> {
+	private:
+		size_t _TileSize = 2048;
+		size_t _Apron = 16;
+		GLenum _InternalFormat = GL_RGBA32F;
+
+	public:
+		TiledImageProcessorBuilder(const std::string &name);
+
+		// the size of the output region of a tile, shrunk if the tile and its apron exceed GL_MAX_TEXTURE_SIZE
+		TiledImageProcessorBuilder &set_tile_size(size_t tile_size);
+		// at least the radius of the widest kernel of the processing step, must be smaller than the tile size
+		TiledImageProcessorBuilder &set_apron(size_t apron);
+		TiledImageProcessorBuilder &set_format(GLenum internal_format);
+
+		[[nodiscard]] TiledImageProcessor _build() const;
+	};
+
+	[[nodiscard]] size_t get_tile_size() const;
+	[[nodiscard]] size_t get_apron() const;
+	// the size of the textures passed to and returned from the TileFunc
+	[[nodiscard]] size_t get_tile_texture_size() const;
+
+	// the output is always RGBA, empty codec names: pick the codecs by the file extensions
+	bool process(const std::string &input_path,
+	             const std::string &output_path,
+	             const TileFunc &tile_func,
+	             TiledProcessingStats *stats = nullptr,
+	             const std::string &input_codec_name = "",
+	             const std::string &output_codec_name = "") const;
+};
+
+}  // namespace gfxutils
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <gfx-utils-core/interfaces/build_target.h>
+#include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+#include <gfx-utils-core/shader_program.h>
+#include <gfx-utils-core/std430.h>
+#include <gfx-utils-core/storage_buffer.h>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <string>
+
+#include <glad/glad.h>
+
+namespace gfxutils {
+
+// a storage buffer holding an array of T, mirroring a GLSL block `layout(std430) buffer Block { T data[]; };`
+// writes are element ranges, and the buffer grows (reallocating and copying on the GPU) when written past its capacity
+// NOTE: growing replaces the underlying buffer: bind again afterwards, and reads still pending on the old one are dropped
+template<typename T>
+class TypedStorageBuffer : public IBuildTarget<TypedStorageBuffer<T>> {
+	static_assert(is_std430_array_compatible<T>(), "T doesn't have the std430 array layout of its GLSL counterpart, see std430.h");
+
+private:
+	struct State {
+		StorageBuffer _Buffer;
+		size_t _Capacity;  // in elements
+		size_t _Size;      // elements written so far, i.e. kept when growing
+	};
+
+	std::shared_ptr<State> _State;  // shared with the copies of the buffer
+
+public:
+	class TypedStorageBufferBuilder : public IBuilder<TypedStorageBufferBuilder, TypedStorageBuffer<T>> {
+	private:
+		size_t _Capacity = 0;
+		std::span<const T> _Data;
+
+	public:
+		TypedStorageBufferBuilder(const std::string &name)
+		    : IBuilder<TypedStorageBufferBuilder, TypedStorageBuffer<T>>(name) {
+		}
+
+		TypedStorageBufferBuilder &set_capacity(size_t n_elements) {
+			_Capacity = n_elements;
+			return *this;
+		}
+
+		// NOTE: the data is NOT copied, it must stay alive until the buffer is built
+		TypedStorageBufferBuilder &set_data(std::span<const T> data) {
+			_Data = data;
+			return *this;
+		}
+
+		[[nodiscard]] TypedStorageBuffer<T> _build() const {
+			TypedStorageBuffer<T> res;
+			res._set_name(this->_Name);
+
+			auto capacity = std::max<size_t>({ _Capacity, _Data.size(), 1 });
+			auto buffer = StorageBuffer::StorageBufferBuilder(this->_Name).set_size(capacity * sizeof(T)).build();
+			if (!buffer.is_complete()) {
+				return res;
+			}
+
+			res._State = std::make_shared<State>(State{ buffer, capacity, 0 });
+
+			res._set_complete();
+
+			// fits into the capacity, so it can't fail
+			if (!_Data.empty()) {
+				res.write(0, _Data);
+			}
+
+			return res;
+		}
+	};
+
+	// writes elements [first, first + elements.size()), growing the buffer to at least twice its capacity if needed
+	// returns false (and writes nothing) if the buffer couldn't grow
+	bool write(size_t first, std::span<const T> elements) const {
+		if (!this->is_complete()) {
+			return false;
+		}
+		if (elements.empty()) {
+			return true;
+		}
+
+		auto &state = *_State;
+		if (first + elements.size() > state._Capacity && !reserve(std::max(first + elements.size(), state._Capacity * 2))) {
+			g_logger->warn("TypedStorageBuffer ({}): failed to grow for elements [{}, {}): nothing is written", this->_Name, first, first + elements.size());
+			return false;
+		}
+		state._Buffer.set_data(reinterpret_cast<const uint8_t *>(elements.data()), elements.size_bytes(), first * sizeof(T));
+		state._Size = std::max(state._Size, first + elements.size());
+		return true;
+	}
+
+	// reallocates the buffer for at least n_elements, keeping the elements written so far
+	// returns false (and keeps the current buffer) if the new one couldn't be allocated
+	bool reserve(size_t n_elements) const {
+		if (!this->is_complete()) {
+			return false;
+		}
+
+		auto &state = *_State;
+		if (n_elements <= state._Capacity) {
+			return true;
+		}
+
+		auto buffer = StorageBuffer::StorageBufferBuilder(this->_Name).set_size(n_elements * sizeof(T)).build();
+		if (!buffer.is_complete()) {
+			return false;
+		}
+
+		glCopyNamedBufferSubData(state._Buffer._get_handle(), buffer._get_handle(), 0, 0, static_cast<GLsizeiptr>(state._Size * sizeof(T)));
+		ResourceManager::instance().release(ResourceType::SSBO, state._Buffer._get_handle());
+
+		g_logger->info("TypedStorageBuffer ({}): grew from {} to {} elements", this->_Name, state._Capacity, n_elements);
+
+		state._Buffer = buffer;
+		state._Capacity = n_elements;
+		return true;
+	}
+
+	void bind(size_t binding_point) const {
+		if (!this->is_complete()) {
+			return;
+		}
+
+		_State->_Buffer.bind(binding_point);
+	}
+
+	// binds to the binding point of the program's storage block `block_name`, after checking that the block's
+	// runtime-sized array starts at offset 0 and that its stride is sizeof(T); returns false (and doesn't bind) otherwise
+	bool bind(const ShaderProgram &program, const std::string &block_name) const {
+		if (!this->is_complete()) {
+			return false;
+		}
+
+		auto block_info = program.get_storage_block_info(block_name);
+		if (!block_info.has_value()) {
+			g_logger->warn("TypedStorageBuffer ({}): program {} has no active storage block '{}'", this->_Name, program.get_name(), block_name);
+			return false;
+		}
+		if (block_info->_ArrayStride != sizeof(T) || block_info->_ArrayOffset != 0) {
+			g_logger->warn("TypedStorageBuffer ({}): storage block '{}' of program {} has an array stride of {} at offset {}, but the element size is {}",
+			               this->_Name,
+			               block_name,
+			               program.get_name(),
+			               block_info->_ArrayStride,
+			               block_info->_ArrayOffset,
+			               sizeof(T));
+			return false;
+		}
+
+		bind(block_info->_Binding);
+		return true;
+	}
+
+	[[nodiscard]] size_t size() const { return this->is_complete() ? _State->_Size : 0; }
+	[[nodiscard]] size_t capacity() const { return this->is_complete() ? _State->_Capacity : 0; }
+
+	// e.g. for StorageBuffer::read_async(), valid until the buffer grows
+	// an incomplete StorageBuffer if this buffer is incomplete
+	[[nodiscard]] const StorageBuffer &get_buffer() const {
+		static const StorageBuffer empty_buffer{};
+		return this->is_complete() ? _State->_Buffer : empty_buffer;
+	}
+};
+
+}  // namespace gfxutils
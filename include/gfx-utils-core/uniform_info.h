@@ -2,6 +2,7 @@
 
 #include <gfx-utils-core/shader_types.h>
 
+#include <cstddef>
 #include <string>
 
 namespace gfxutils {
@@ -11,4 +12,13 @@ struct UniformInfo {
 	ShaderDataType _Type;
 };
 
+// layout of a shader storage block as linked, in bytes
+struct StorageBlockInfo {
+	std::string _Name;
+	size_t _Binding;
+	size_t _DataSize;     // minimum buffer size, with one element in the runtime-sized array if there is one
+	size_t _ArrayOffset;  // of the runtime-sized array member, if any
+	size_t _ArrayStride;  // 0 if the block has no runtime-sized array
+};
+
 }  // namespace gfxutils
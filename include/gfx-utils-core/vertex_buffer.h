@@ -2,34 +2,125 @@
 
 #include <gfx-utils-core/interfaces/build_target.h>
 #include <gfx-utils-core/interfaces/builder.h>
+#include <gfx-utils-core/mesh_optimizer.h>
 
 #include <glad/glad.h>
 
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace gfxutils {
 
+// how an attribute is stored on the GPU, the input data is always float and converted at build time
+// normalized formats read back as floats in the shader
+enum class VertexAttributeFormat {
+	FLOAT,
+	HALF,
+	SNORM16,            // [-1, 1], e.g. positions in a unit box, tangents
+	UNORM8,             // [0, 1], e.g. colors
+	INT_2_10_10_10_REV  // 3 or 4 components in [-1, 1] packed into 4 bytes (10 bits for xyz, 2 for w), e.g. normals
+};
+
+struct VertexAttributeInfo {
+	size_t _NumComponents;
+	VertexAttributeFormat _Format;
+	size_t _Divisor = 0;  // 0: per vertex, n: advances every n instances
+};
+
+// size in bytes of one attribute of n_components in the given format, before padding
+[[nodiscard]] size_t get_vertex_attribute_size(VertexAttributeFormat format, size_t n_components);
+// size in bytes of one vertex in the GPU layout of `attributes`, i.e. with every attribute padded to 4 bytes
+[[nodiscard]] size_t get_vertex_stride(const std::vector<VertexAttributeInfo> &attributes);
+// converts interleaved float vertices to the GPU layout of `attributes`, e.g. to cache it (see VertexBufferBuilder's packed data)
+[[nodiscard]] std::vector<uint8_t> pack_vertices(std::span<const float> data, const std::vector<VertexAttributeInfo> &attributes);
+
 class VertexBuffer : public IBuildTarget<VertexBuffer> {
 private:
 	GLuint _VAO;
 	GLuint _VBO;
+	GLuint _EBO = 0;
+	GLuint _InstanceVBO = 0;
+	size_t _NumVertices = 0;
+	size_t _NumIndices = 0;
+	size_t _NumInstances = 0;
+	GLenum _IndexType = GL_UNSIGNED_INT;
+	GLenum _Usage = GL_STATIC_DRAW;
+	std::vector<VertexAttributeInfo> _InstanceAttributes;  // to pack the instance data again on updates
 
 public:
 	class VertexBufferBuilder : public IBuilder<VertexBufferBuilder, VertexBuffer> {
 	private:
-		const std::vector<float> &_Data;
-		std::vector<size_t> _AttrSizes;
+		std::vector<float> _OwnedData;
+		std::span<const float> _Data;  // views `_OwnedData` or caller-owned memory
+		std::vector<uint32_t> _OwnedIndices;
+		std::span<const uint32_t> _Indices;  // views `_OwnedIndices` or caller-owned memory
+		std::span<const uint16_t> _ShortIndices;
+		std::span<const uint8_t> _PackedData;
+		bool _IsPacked = false;
+		std::vector<float> _OwnedInstanceData;
+		std::span<const float> _InstanceData;  // views `_OwnedInstanceData` or caller-owned memory
+		std::vector<VertexAttributeInfo> _Attributes;
+		std::vector<VertexAttributeInfo> _InstanceAttributes;
+		GLenum _Usage = GL_STATIC_DRAW;
 
 	public:
-		VertexBufferBuilder(const std::string &name, const std::vector<float> &data);
+		// NOTE: the data is NOT copied, it must stay alive until the vertex buffer is built
+		VertexBufferBuilder(const std::string &name, std::span<const float> data);
+		VertexBufferBuilder(const std::string &name, std::vector<float> &&data);
+		// vertices and indices of e.g. optimize_mesh()
+		VertexBufferBuilder(const std::string &name, IndexedMesh &&mesh);
+		// vertices already in the GPU layout of the attributes added afterwards (see pack_vertices()), uploaded as is
+		// NOTE: the data is NOT copied, it must stay alive until the vertex buffer is built
+		VertexBufferBuilder(const std::string &name, std::span<const uint8_t> packed_data);
+
+		// `_Data` may point into `_OwnedData`, so copying would leave it dangling
+		VertexBufferBuilder(const VertexBufferBuilder &) = delete;
+		VertexBufferBuilder(VertexBufferBuilder &&) = default;
 
-		VertexBufferBuilder &add_attribute(size_t n_bytes);
+		// attributes are interleaved floats in the input, in the order they are added
+		// in the buffer each attribute starts at a 4-byte boundary, as GL wants for packed formats
+		VertexBufferBuilder &add_attribute(size_t n_components, VertexAttributeFormat format = VertexAttributeFormat::FLOAT);
+		// stored as 16-bit indices if every index fits, 32-bit otherwise
+		// NOTE: the indices are NOT copied, they must stay alive until the vertex buffer is built
+		VertexBufferBuilder &set_indices(std::span<const uint32_t> indices);
+		VertexBufferBuilder &set_indices(std::vector<uint32_t> &&indices);
+		// uploaded as is
+		VertexBufferBuilder &set_indices(std::span<const uint16_t> indices);
+
+		// per-instance attributes live in a buffer of their own, interleaved like the vertex attributes,
+		// their locations follow the ones of the vertex attributes
+		VertexBufferBuilder &add_instance_attribute(size_t n_components, VertexAttributeFormat format = VertexAttributeFormat::FLOAT, size_t divisor = 1);
+		// NOTE: the data is NOT copied, it must stay alive until the vertex buffer is built
+		VertexBufferBuilder &set_instance_data(std::span<const float> data);
+		VertexBufferBuilder &set_instance_data(std::vector<float> &&data);
+
+		// e.g. GL_DYNAMIC_DRAW for buffers rewritten often, default: GL_STATIC_DRAW
+		VertexBufferBuilder &set_usage(GLenum usage);
 
 		[[nodiscard]] VertexBuffer _build() const;
 	};
 
 	void use() const;
+	// binds the vertex array and draws every vertex, through the index buffer if there is one
+	void draw(GLenum mode = GL_TRIANGLES) const;
+	// draws n_instances instances of every vertex, instance attributes are read from `first_instance` on
+	void draw_instanced(size_t n_instances, GLenum mode = GL_TRIANGLES, size_t first_instance = 0) const;
+
+	// replaces the per-instance data, in the layout given by add_instance_attribute()
+	void update_instance_data(std::span<const float> data);
+
+	[[nodiscard]] size_t get_vertex_count() const;
+	[[nodiscard]] size_t get_index_count() const;
+	// instances in the instance data, 0 without instance attributes
+	[[nodiscard]] size_t get_instance_count() const;
+	[[nodiscard]] bool is_indexed() const;
+	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	[[nodiscard]] GLenum get_index_type() const;
+
+	// the vertex array object
+	[[nodiscard]] GLuint _get_handle() const;
 };
 
 }  // namespace gfxutils
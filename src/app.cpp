@@ -1,5 +1,6 @@
 #include <gfx-utils-core/app.h>
 
+#include <gfx-utils-core/gl_state_cache.h>
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/resource_manager.h>
 
@@ -19,7 +20,7 @@ namespace gfxutils {
 void App::init(const std::string &title, int width, int height) {
 	g_logger->info("App: initializing app...");
 
-	_init_window(title, width, height);
+	_init_window(title, width, height, true);
 	_init_opengl();
 	_init_IMGUI();
 	_init_IMGUI_styles();
@@ -27,6 +28,13 @@ void App::init(const std::string &title, int width, int height) {
 	_init_callbacks();
 }
 
+bool App::init_headless() {
+	g_logger->info("App: initializing headless app...");
+
+	_IsHeadless = true;
+	return _init_window("gfx-utils (headless)", 1, 1, false) && _init_opengl();
+}
+
 void App::run(const std::function<void(float)> &callback) {
 	g_logger->info("App: running main loop...");
 
@@ -44,6 +52,7 @@ void App::run(const std::function<void(float)> &callback) {
 
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		GLStateCache::instance().invalidate();  // the ImGui renderer sets its own state, restoring most of it with raw GL calls
 
 		glfwPollEvents();
 		glfwSwapBuffers(_Window);
@@ -65,7 +74,9 @@ void App::run(const std::function<void(float)> &callback) {
 void App::shutdown() {
 	g_logger->info("App: shutting down app...");
 
-	_shutdown_IMGUI();
+	if (!_IsHeadless) {
+		_shutdown_IMGUI();
+	}
 	_shutdown_window();
 }
 
@@ -134,7 +145,7 @@ void App::_init_callbacks() {
 		_WindowWidth = width;
 		_WindowHeight = height;
 
-		glViewport(0, 0, width, height);
+		GLStateCache::instance().set_viewport(0, 0, width, height);
 	});
 
 	register_on_key_func([&](int key, int scan_code [[maybe_unused]], int action, int mods [[maybe_unused]]) {
@@ -151,7 +162,7 @@ void App::_init_callbacks() {
 	});
 }
 
-void App::_init_window(const std::string &title, int width, int height) {
+bool App::_init_window(const std::string &title, int width, int height, bool visible) {
 	_WindowTitle = title;
 	_WindowWidth = width;
 	_WindowHeight = height;
@@ -162,32 +173,42 @@ void App::_init_window(const std::string &title, int width, int height) {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, config::opengl_ver_minor);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_SAMPLES, 4);
+	glfwWindowHint(GLFW_SRGB_CAPABLE, GLFW_TRUE);  // lets render passes with `_EnableSRGB` encode linear colors on write
+	glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
 	_Window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
 	if (_Window == nullptr) {
 		g_logger->error("App: failed to create window");
-		return;
+		return false;
 	}
 
 	glfwMakeContextCurrent(_Window);
 
+	if (!visible) {
+		return true;
+	}
+
 	// center the window
 	const auto *vidmode = glfwGetVideoMode(glfwGetPrimaryMonitor());
 	glfwSetWindowPos(_Window, (vidmode->width - _WindowWidth) / 2, (vidmode->height - _WindowHeight) / 2);
 
 	glfwSetInputMode(_Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	return true;
 }
 
-void App::_init_opengl() const {
+bool App::_init_opengl() const {
 	if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) == 0) {
 		g_logger->error("App: fail to init opengl");
-		return;
+		return false;
 	}
 
-	glEnable(GL_MULTISAMPLE);
+	GLStateCache::instance().set_capability(GL_MULTISAMPLE, true);
 
 	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-	glViewport(0, 0, _WindowWidth, _WindowHeight);
+	GLStateCache::instance().set_viewport(0, 0, _WindowWidth, _WindowHeight);
+
+	return true;
 }
 
 void App::_init_IMGUI() {
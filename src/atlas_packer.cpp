@@ -0,0 +1,136 @@
+#include <gfx-utils-core/atlas_packer.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace gfxutils {
+
+AtlasPacker::AtlasPacker(size_t page_width, size_t page_height, size_t padding)
+    : _PageWidth(page_width)
+    , _PageHeight(page_height)
+    , _Padding(padding) {
+}
+
+std::optional<AtlasRegion> AtlasPacker::pack(size_t width, size_t height) {
+	if (width + (2 * _Padding) > _PageWidth || height + (2 * _Padding) > _PageHeight) {
+		return std::nullopt;
+	}
+
+	for (size_t page = 0; page < _Pages.size(); page++) {
+		if (auto region = _pack_into_page(page, width, height)) {
+			return region;
+		}
+	}
+
+	_Pages.push_back({ SkylineNode{ 0, 0, _PageWidth } });
+	return _pack_into_page(_Pages.size() - 1, width, height);
+}
+
+std::vector<std::optional<AtlasRegion>> AtlasPacker::pack_all(const std::vector<std::pair<size_t, size_t>> &sizes) {
+	std::vector<size_t> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+		return sizes[lhs].second > sizes[rhs].second;
+	});
+
+	std::vector<std::optional<AtlasRegion>> res(sizes.size());
+	for (auto i : order) {
+		res[i] = pack(sizes[i].first, sizes[i].second);
+	}
+	return res;
+}
+
+size_t AtlasPacker::get_page_count() const {
+	return _Pages.size();
+}
+
+size_t AtlasPacker::get_page_width() const {
+	return _PageWidth;
+}
+
+size_t AtlasPacker::get_page_height() const {
+	return _PageHeight;
+}
+
+std::optional<AtlasRegion> AtlasPacker::_pack_into_page(size_t page, size_t width, size_t height) {
+	auto &skyline = _Pages[page];
+	size_t padded_width = width + (2 * _Padding);
+	size_t padded_height = height + (2 * _Padding);
+
+	// bottom-left heuristic: lowest top edge first, then the leftmost one
+	size_t best_index = skyline.size();
+	size_t best_y = 0;
+	size_t best_top = std::numeric_limits<size_t>::max();
+
+	for (size_t i = 0; i < skyline.size(); i++) {
+		size_t x = skyline[i]._X;
+		if (x + padded_width > _PageWidth) {
+			break;  // nodes are sorted by x
+		}
+
+		// the rectangle rests on the highest node it spans
+		size_t y = 0;
+		for (size_t j = i, width_left = padded_width; width_left > 0; j++) {
+			y = std::max(y, skyline[j]._Y);
+			width_left -= std::min(width_left, skyline[j]._Width);
+		}
+
+		if (y + padded_height <= _PageHeight && y + padded_height < best_top) {
+			best_index = i;
+			best_y = y;
+			best_top = y + padded_height;
+		}
+	}
+
+	if (best_index == skyline.size()) {
+		return std::nullopt;
+	}
+
+	size_t x = skyline[best_index]._X;
+	skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(best_index), SkylineNode{ x, best_top, padded_width });
+
+	// shrink or remove the nodes now covered by the new one
+	for (size_t i = best_index + 1; i < skyline.size();) {
+		size_t covered_end = skyline[i - 1]._X + skyline[i - 1]._Width;
+		if (skyline[i]._X >= covered_end) {
+			break;
+		}
+
+		size_t shrink = covered_end - skyline[i]._X;
+		if (shrink >= skyline[i]._Width) {
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+		} else {
+			skyline[i]._X += shrink;
+			skyline[i]._Width -= shrink;
+			break;
+		}
+	}
+
+	// merge neighbours at the same height
+	for (size_t i = 0; i + 1 < skyline.size();) {
+		if (skyline[i]._Y == skyline[i + 1]._Y) {
+			skyline[i]._Width += skyline[i + 1]._Width;
+			skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i + 1));
+		} else {
+			i++;
+		}
+	}
+
+	auto page_width = static_cast<float>(_PageWidth);
+	auto page_height = static_cast<float>(_PageHeight);
+
+	AtlasRegion region;
+	region._Page = page;
+	region._X = x + _Padding;
+	region._Y = best_y + _Padding;
+	region._Width = width;
+	region._Height = height;
+	region._UVRect = glm::vec4(static_cast<float>(region._X) / page_width,
+	                           static_cast<float>(region._Y) / page_height,
+	                           static_cast<float>(region._X + width) / page_width,
+	                           static_cast<float>(region._Y + height) / page_height);
+	return region;
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,401 @@
+#include <gfx-utils-core/batch_image_processor.h>
+
+#include <gfx-utils-core/bounded_queue.h>
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/image_codec_registry.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+#include <gfx-utils-core/thread_pool.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <thread>
+#include <vector>
+
+namespace gfxutils {
+
+namespace {
+
+struct DecodedImage {
+	size_t _JobIndex;
+	Image _Image;
+};
+
+struct ProcessedImage {
+	size_t _JobIndex;
+	Image _Image;
+};
+
+// an image in the GPU stage, its output is complete once every tile has been read back
+struct InFlightImage {
+	size_t _JobIndex;
+	Image _Output;
+	size_t _NumTilesLeft;
+};
+
+struct PendingTile {
+	GLuint _PBO;
+	GLsync _Fence;
+	InFlightImage *_Dst;
+	size_t _X;
+	size_t _Y;
+	size_t _Width;
+	size_t _Height;
+};
+
+GLenum get_gl_comp_type(ImageElementType element_type) {
+	return (element_type == ImageElementType::F32 ? GL_FLOAT : GL_UNSIGNED_BYTE);
+}
+
+void resolve_tile(const PendingTile &tile) {
+	GLenum wait_result = GL_TIMEOUT_EXPIRED;
+	while (wait_result == GL_TIMEOUT_EXPIRED) {
+		wait_result = glClientWaitSync(tile._Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+	}
+	glDeleteSync(tile._Fence);
+
+	auto &output = tile._Dst->_Output;
+	size_t pixel_size = output.get_pixel_size();
+	size_t row_size = tile._Width * pixel_size;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, tile._PBO);
+	const auto *src = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(row_size * tile._Height), GL_MAP_READ_BIT));
+	if (src != nullptr) {
+		// read back bottom row first
+		for (size_t y = 0; y < tile._Height; y++) {
+			std::memcpy(output.row(tile._Y + tile._Height - 1 - y) + (tile._X * pixel_size), src + (y * row_size), row_size);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	tile._Dst->_NumTilesLeft--;
+}
+
+}  // namespace
+
+BatchImageProcessor::BatchImageProcessorBuilder::BatchImageProcessorBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_tile_size(size_t tile_size) {
+	_TileSize = tile_size;
+	return *this;
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_apron(size_t apron) {
+	_Apron = apron;
+	return *this;
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_format(GLenum internal_format) {
+	_InternalFormat = internal_format;
+	return *this;
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_thread_count(size_t n_decode_threads, size_t n_encode_threads) {
+	_NumDecodeThreads = n_decode_threads;
+	_NumEncodeThreads = n_encode_threads;
+	return *this;
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_queue_capacity(size_t capacity) {
+	_QueueCapacity = capacity;
+	return *this;
+}
+
+BatchImageProcessor::BatchImageProcessorBuilder &BatchImageProcessor::BatchImageProcessorBuilder::set_tiles_in_flight(size_t n_tiles) {
+	_NumTilesInFlight = n_tiles;
+	return *this;
+}
+
+BatchImageProcessor BatchImageProcessor::BatchImageProcessorBuilder::_build() const {
+	BatchImageProcessor res;
+
+	res._set_name(_Name);
+
+	GLint max_texture_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+	res._Apron = _Apron;
+	res._TileSize = std::min(_TileSize, static_cast<size_t>(max_texture_size) - std::min(2 * _Apron, static_cast<size_t>(max_texture_size)));
+	if (res._TileSize == 0 || _Apron >= res._TileSize) {
+		g_logger->warn("BatchImageProcessor::BatchImageProcessorBuilder ({}): apron ({}) must be smaller than the tile size ({}), processor won't be built",
+		               _Name,
+		               _Apron,
+		               res._TileSize);
+		return res;
+	}
+
+	size_t half_hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+	res._NumDecodeThreads = (_NumDecodeThreads != 0 ? _NumDecodeThreads : half_hardware_threads);
+	res._NumEncodeThreads = (_NumEncodeThreads != 0 ? _NumEncodeThreads : half_hardware_threads);
+	res._QueueCapacity = std::max<size_t>(1, _QueueCapacity);
+
+	size_t tile_texture_size = res.get_tile_texture_size();
+	res._InputTile = Texture::TextureBuilder(std::format("{}/input_tile", _Name))
+	                     .set_size(tile_texture_size, tile_texture_size)
+	                     .set_format(_InternalFormat)
+	                     .set_filter(GL_NEAREST)
+	                     .build();
+
+	// sized for RGBA32F, the largest pixel any codec decodes to
+	constexpr size_t max_pixel_size = 4 * sizeof(float);
+	size_t n_slots = std::max<size_t>(1, _NumTilesInFlight);
+	for (size_t i = 0; i < n_slots; i++) {
+		GLuint upload_pbo = ResourceManager::instance().alloc(ResourceType::PBO);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(tile_texture_size * tile_texture_size * max_pixel_size), nullptr, GL_STREAM_DRAW);
+		res._UploadPBOs.push_back(upload_pbo);
+
+		GLuint readback_pbo = ResourceManager::instance().alloc(ResourceType::PBO);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(res._TileSize * res._TileSize * max_pixel_size), nullptr, GL_STREAM_READ);
+		res._ReadbackPBOs.push_back(readback_pbo);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	g_logger->info("BatchImageProcessor::BatchImageProcessorBuilder ({}): successfully built with {}x{} tiles, {} decode / {} encode thread(s)",
+	               _Name,
+	               res._TileSize,
+	               res._TileSize,
+	               res._NumDecodeThreads,
+	               res._NumEncodeThreads);
+
+	res._set_complete();
+
+	return res;
+}
+
+size_t BatchImageProcessor::get_tile_size() const {
+	return _TileSize;
+}
+
+size_t BatchImageProcessor::get_apron() const {
+	return _Apron;
+}
+
+size_t BatchImageProcessor::get_tile_texture_size() const {
+	return _TileSize + 2 * _Apron;
+}
+
+bool BatchImageProcessor::process(const std::vector<BatchJob> &jobs, const TileFunc &tile_func, BatchProcessingStats *stats) const {
+	if (!is_complete()) {
+		g_logger->warn("BatchImageProcessor ({}): processor is incomplete", _Name);
+		return false;
+	}
+
+	auto start_time = std::chrono::steady_clock::now();
+	auto &registry = ImageCodecRegistry::instance();
+	size_t tile_texture_size = get_tile_texture_size();
+
+	BoundedQueue<DecodedImage> decoded_queue(_QueueCapacity);
+	BoundedQueue<ProcessedImage> processed_queue(_QueueCapacity);
+	std::atomic<size_t> n_encode_failed = 0;
+	std::atomic<bool> is_aborted = false;
+
+	// declared after the queues: the workers are joined before the queues they block on go away
+	ThreadPool decode_pool(_NumDecodeThreads);
+	ThreadPool encode_pool(_NumEncodeThreads);
+
+	// decode: one task per file, a task blocks on the queue while the GPU stage is behind
+	std::vector<std::future<void>> decode_tasks;
+	decode_tasks.reserve(jobs.size());
+	for (size_t i = 0; i < jobs.size(); i++) {
+		decode_tasks.push_back(decode_pool.submit([&, i]() {
+			Image image;
+			if (!is_aborted) {
+				image = registry.decode(jobs[i]._InputPath);
+			}
+			decoded_queue.push({ i, std::move(image) });
+		}));
+	}
+
+	// encode: long-running workers draining the queue until it is closed
+	std::vector<std::future<void>> encode_tasks;
+	for (size_t i = 0; i < encode_pool.get_thread_count(); i++) {
+		encode_tasks.push_back(encode_pool.submit([&]() {
+			while (auto processed = processed_queue.pop()) {
+				if (!registry.encode(jobs[processed->_JobIndex]._OutputPath, processed->_Image)) {
+					n_encode_failed++;
+				}
+			}
+		}));
+	}
+
+	// GPU stage, on this thread since it owns the context
+	std::array<GLint, 4> prev_viewport{};
+	glGetIntegerv(GL_VIEWPORT, prev_viewport.data());
+	GLStateCache::instance().set_viewport(0, 0, static_cast<GLsizei>(tile_texture_size), static_cast<GLsizei>(tile_texture_size));
+
+	std::deque<InFlightImage> in_flight_images;
+	std::deque<PendingTile> pending_tiles;
+	size_t next_slot = 0;
+	std::vector<uint8_t> client_staging;  // only used if an upload PBO can't be mapped
+	size_t n_tiles = 0;
+	size_t n_pixels = 0;
+	size_t n_processed = 0;
+
+	// waits for the oldest tile, and hands the images completed by it over to the encoders
+	auto retire_oldest_tile = [&]() {
+		resolve_tile(pending_tiles.front());
+		pending_tiles.pop_front();
+
+		while (!in_flight_images.empty() && in_flight_images.front()._NumTilesLeft == 0) {
+			auto &image = in_flight_images.front();
+			n_pixels += image._Output.get_width() * image._Output.get_height();
+			n_processed++;
+			processed_queue.push({ image._JobIndex, std::move(image._Output) });
+			in_flight_images.pop_front();
+		}
+	};
+
+	for (size_t n = 0; n < jobs.size() && !is_aborted; n++) {
+		auto decoded = decoded_queue.pop();
+		const auto &job = jobs[decoded->_JobIndex];
+		const auto &image = decoded->_Image;
+		if (image.empty()) {
+			g_logger->warn("BatchImageProcessor ({}): failed to decode {}", _Name, job._InputPath);
+			continue;
+		}
+
+		auto encoder = registry.find_encoder_by_extension(job._OutputPath);
+		if (encoder == nullptr) {
+			g_logger->warn("BatchImageProcessor ({}): no encoder available for {}", _Name, job._OutputPath);
+			continue;
+		}
+
+		size_t width = image.get_width();
+		size_t height = image.get_height();
+		size_t n_tiles_x = (width + _TileSize - 1) / _TileSize;
+		size_t n_tiles_y = (height + _TileSize - 1) / _TileSize;
+		ImageElementType output_type = encoder->get_encode_element_type();
+
+		in_flight_images.push_back({ decoded->_JobIndex, Image(width, height, 4, output_type), n_tiles_x * n_tiles_y });
+		auto &dst = in_flight_images.back();
+
+		for (size_t ty = 0; ty < n_tiles_y && !is_aborted; ty++) {
+			for (size_t tx = 0; tx < n_tiles_x; tx++, n_tiles++) {
+				if (pending_tiles.size() == _ReadbackPBOs.size()) {
+					retire_oldest_tile();
+				}
+
+				size_t x0 = tx * _TileSize;
+				size_t y0 = ty * _TileSize;
+				GLuint upload_pbo = _UploadPBOs[next_slot];
+				GLuint readback_pbo = _ReadbackPBOs[next_slot];
+				next_slot = (next_slot + 1) % _ReadbackPBOs.size();
+
+				// upload, invalidating lets the driver hand out fresh storage if the previous upload from this slot is still queued
+				size_t upload_size = tile_texture_size * tile_texture_size * image.get_pixel_size();
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo);
+				auto *staging = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+				                                                        0,
+				                                                        static_cast<GLsizeiptr>(upload_size),
+				                                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+				if (staging == nullptr) {
+					// fall back to a (synchronous) upload from client memory rather than processing a stale tile
+					if (client_staging.empty()) {
+						g_logger->warn("BatchImageProcessor ({}): failed to map an upload PBO, uploading from client memory", _Name);
+					}
+					glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+					client_staging.resize(upload_size);
+				}
+				image.copy_region_clamped(static_cast<ptrdiff_t>(x0) - static_cast<ptrdiff_t>(_Apron),
+				                          static_cast<ptrdiff_t>(y0) - static_cast<ptrdiff_t>(_Apron),
+				                          tile_texture_size,
+				                          tile_texture_size,
+				                          staging != nullptr ? staging : client_staging.data(),
+				                          true);
+				if (staging != nullptr) {
+					glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				}
+				glTextureSubImage2D(_InputTile._get_handle(),
+				                    0,
+				                    0,
+				                    0,
+				                    static_cast<GLsizei>(tile_texture_size),
+				                    static_cast<GLsizei>(tile_texture_size),
+				                    GL_RGBA,
+				                    get_gl_comp_type(image.get_element_type()),
+				                    staging != nullptr ? nullptr : client_staging.data());
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+				// process
+				const auto &output_tile = tile_func(_InputTile);
+				const auto &output_info = output_tile.get_info();
+				if (output_info._Width != tile_texture_size || output_info._Height != tile_texture_size) {
+					g_logger->warn("BatchImageProcessor ({}): processed tile is {}x{}, expected {}x{}, aborting",
+					               _Name,
+					               output_info._Width,
+					               output_info._Height,
+					               tile_texture_size,
+					               tile_texture_size);
+					is_aborted = true;
+					break;
+				}
+
+				// read back the center of the tile asynchronously, it is waited for `_ReadbackPBOs.size()` tiles later
+				size_t tile_width = std::min(_TileSize, width - x0);
+				size_t tile_height = std::min(_TileSize, height - y0);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbo);
+				glGetTextureSubImage(output_tile._get_handle(),
+				                     0,
+				                     static_cast<GLint>(_Apron),
+				                     static_cast<GLint>(tile_texture_size - _Apron - tile_height),
+				                     0,
+				                     static_cast<GLsizei>(tile_width),
+				                     static_cast<GLsizei>(tile_height),
+				                     1,
+				                     GL_RGBA,
+				                     get_gl_comp_type(output_type),
+				                     static_cast<GLsizei>(tile_width * tile_height * dst._Output.get_pixel_size()),
+				                     nullptr);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+				pending_tiles.push_back({ readback_pbo, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), &dst, x0, y0, tile_width, tile_height });
+			}
+		}
+	}
+
+	while (!pending_tiles.empty()) {
+		retire_oldest_tile();
+	}
+	GLStateCache::instance().set_viewport(prev_viewport[0], prev_viewport[1], prev_viewport[2], prev_viewport[3]);
+
+	// unblocks the decoders left behind by an abort, and stops the encoders once they have drained the queue
+	decoded_queue.close();
+	processed_queue.close();
+	for (auto &task : encode_tasks) {
+		task.wait();
+	}
+
+	// images left unprocessed by an abort count as failed
+	BatchProcessingStats res;
+	res._NumImages = n_processed - n_encode_failed;
+	res._NumFailed = jobs.size() - res._NumImages;
+	res._NumPixels = n_pixels;
+	res._NumTiles = n_tiles;
+	res._Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	if (stats != nullptr) {
+		*stats = res;
+	}
+
+	g_logger->info("BatchImageProcessor ({}): {} image(s) processed, {} failed, {:.3f}s, {:.2f} images/s, {:.2f} MP/s",
+	               _Name,
+	               res._NumImages,
+	               res._NumFailed,
+	               res._Seconds,
+	               res.get_images_per_second(),
+	               res.get_megapixels_per_second());
+
+	return res._NumFailed == 0;
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,223 @@
+#include <gfx-utils-core/image_codecs.h>
+
+#include <gfx-utils-core/logger.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <vector>
+
+namespace gfxutils {
+
+namespace {
+
+float byte_swap(float value) {
+	auto bits = std::bit_cast<uint32_t>(value);
+	bits = ((bits & 0x000000ffu) << 24) | ((bits & 0x0000ff00u) << 8) | ((bits & 0x00ff0000u) >> 8) | ((bits & 0xff000000u) >> 24);
+	return std::bit_cast<float>(bits);
+}
+
+// PFM stores rows from bottom to top, so the top band of the image sits at the end of the file: both sides seek
+class PfmReader : public IImageReader {
+private:
+	std::string _FilePath;
+	std::ifstream _In;
+	size_t _Width = 0;
+	size_t _Height = 0;
+	size_t _ChannelsInFile = 0;
+	bool _NeedSwap = false;
+	std::streamoff _DataOffset = 0;
+	size_t _RowsRead = 0;
+
+public:
+	explicit PfmReader(const std::string &file_path)
+	    : _FilePath(file_path)
+	    , _In(file_path, std::ios::binary) {
+	}
+
+	bool open() {
+		if (!_In) {
+			return false;
+		}
+
+		std::string magic;
+		float scale = 0.0f;
+		_In >> magic >> _Width >> _Height >> scale;
+		_In.get();  // exactly one whitespace character after the header
+
+		if (magic == "PF") {
+			_ChannelsInFile = 3;
+		} else if (magic == "Pf") {
+			_ChannelsInFile = 1;
+		} else {
+			g_logger->warn("PfmCodec: {} is not a PFM file", _FilePath);
+			return false;
+		}
+
+		bool file_is_little_endian = scale < 0.0f;
+		_NeedSwap = file_is_little_endian != (std::endian::native == std::endian::little);
+		_DataOffset = _In.tellg();
+
+		return static_cast<bool>(_In);
+	}
+
+	[[nodiscard]] size_t get_width() const override {
+		return _Width;
+	}
+
+	[[nodiscard]] size_t get_height() const override {
+		return _Height;
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return ImageElementType::F32;
+	}
+
+	[[nodiscard]] Image read_rows(size_t n_rows) override {
+		n_rows = std::min(n_rows, _Height - _RowsRead);
+		if (n_rows == 0) {
+			return {};
+		}
+
+		// the band is contiguous in the file, in reverse row order
+		size_t row_size = _Width * _ChannelsInFile;
+		std::vector<float> buffer(n_rows * row_size);
+		auto first_file_row = static_cast<std::streamoff>(_Height - _RowsRead - n_rows);
+		_In.seekg(_DataOffset + first_file_row * static_cast<std::streamoff>(row_size * sizeof(float)));
+		if (!_In.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(float)))) {
+			g_logger->warn("PfmCodec: unexpected end of file in {}", _FilePath);
+			return {};
+		}
+
+		if (_NeedSwap) {
+			for (auto &value : buffer) {
+				value = byte_swap(value);
+			}
+		}
+
+		Image res(_Width, n_rows, 4, ImageElementType::F32);
+		for (size_t y = 0; y < n_rows; y++) {
+			const float *src_row = &buffer[(n_rows - 1 - y) * row_size];
+			auto *dst = reinterpret_cast<float *>(res.row(y));
+			for (size_t x = 0; x < _Width; x++) {
+				const float *src = &src_row[x * _ChannelsInFile];
+				dst[(x * 4) + 0] = src[0];
+				dst[(x * 4) + 1] = src[_ChannelsInFile == 3 ? 1 : 0];
+				dst[(x * 4) + 2] = src[_ChannelsInFile == 3 ? 2 : 0];
+				dst[(x * 4) + 3] = 1.0f;
+			}
+		}
+
+		_RowsRead += n_rows;
+		return res;
+	}
+};
+
+class PfmWriter : public IImageWriter {
+private:
+	std::string _FilePath;
+	std::ofstream _Out;
+	size_t _Width;
+	size_t _Height;
+	size_t _Channels;
+	size_t _ChannelsInFile;
+	std::streamoff _DataOffset = 0;
+	size_t _RowsWritten = 0;
+
+public:
+	PfmWriter(const std::string &file_path, size_t width, size_t height, size_t n_channels)
+	    : _FilePath(file_path)
+	    , _Out(file_path, std::ios::binary)
+	    , _Width(width)
+	    , _Height(height)
+	    , _Channels(n_channels)
+	    , _ChannelsInFile(n_channels == 1 ? 1 : 3) {
+	}
+
+	bool write_header() {
+		if (!_Out || _Channels < 1 || _Channels > 4) {
+			return false;
+		}
+
+		float scale = (std::endian::native == std::endian::little ? -1.0f : 1.0f);
+		_Out << std::format("{}\n{} {}\n{}\n", _ChannelsInFile == 3 ? "PF" : "Pf", _Width, _Height, scale);
+		_DataOffset = _Out.tellp();
+
+		return static_cast<bool>(_Out);
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return ImageElementType::F32;
+	}
+
+	bool write_rows(const Image &rows) override {
+		if (rows.get_element_type() != ImageElementType::F32) {
+			return write_rows(rows.convert(ImageElementType::F32));
+		}
+
+		if (rows.get_width() != _Width || rows.get_channels() != _Channels || _RowsWritten + rows.get_height() > _Height) {
+			g_logger->warn("PfmCodec: rows of unexpected size written to {}", _FilePath);
+			return false;
+		}
+
+		size_t n_rows = rows.get_height();
+		size_t row_size = _Width * _ChannelsInFile;
+		size_t n_copy = std::min(_Channels, _ChannelsInFile);
+
+		std::vector<float> buffer(n_rows * row_size, 0.0f);
+		for (size_t y = 0; y < n_rows; y++) {
+			const auto *src = reinterpret_cast<const float *>(rows.row(y));
+			float *dst = &buffer[(n_rows - 1 - y) * row_size];
+			if (_Channels == _ChannelsInFile) {
+				std::memcpy(dst, src, row_size * sizeof(float));
+			} else {
+				for (size_t x = 0; x < _Width; x++) {
+					std::memcpy(&dst[x * _ChannelsInFile], &src[x * _Channels], n_copy * sizeof(float));
+				}
+			}
+		}
+
+		auto first_file_row = static_cast<std::streamoff>(_Height - _RowsWritten - n_rows);
+		_Out.seekp(_DataOffset + first_file_row * static_cast<std::streamoff>(row_size * sizeof(float)));
+		_Out.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(float)));
+		_RowsWritten += n_rows;
+
+		return static_cast<bool>(_Out);
+	}
+
+	bool finish() override {
+		if (_RowsWritten != _Height) {
+			g_logger->warn("PfmCodec: only {} of {} rows were written to {}", _RowsWritten, _Height, _FilePath);
+			return false;
+		}
+
+		_Out.flush();
+		return static_cast<bool>(_Out);
+	}
+};
+
+}  // namespace
+
+Image PfmCodec::decode(const std::string &file_path) const {
+	auto reader = open_reader(file_path);
+	return (reader != nullptr ? reader->read_rows(reader->get_height()) : Image{});
+}
+
+bool PfmCodec::encode(const std::string &file_path, const Image &image) const {
+	auto writer = open_writer(file_path, image.get_width(), image.get_height(), image.get_channels());
+	return writer != nullptr && writer->write_rows(image) && writer->finish();
+}
+
+std::unique_ptr<IImageReader> PfmCodec::open_reader(const std::string &file_path) const {
+	auto reader = std::make_unique<PfmReader>(file_path);
+	return (reader->open() ? std::move(reader) : nullptr);
+}
+
+std::unique_ptr<IImageWriter> PfmCodec::open_writer(const std::string &file_path, size_t width, size_t height, size_t n_channels) const {
+	auto writer = std::make_unique<PfmWriter>(file_path, width, height, n_channels);
+	return (writer->write_header() ? std::move(writer) : nullptr);
+}
+
+}  // namespace gfxutils
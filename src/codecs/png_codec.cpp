@@ -0,0 +1,526 @@
+#include <gfx-utils-core/image_codecs.h>
+
+#include <gfx-utils-core/logger.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+// the encoder splits the image into horizontal strips, each strip is filtered and deflated on its own thread
+// every strip but the last ends with a sync flush, so the raw deflate streams concatenate into one valid stream
+// (the same trick pigz uses), and the zlib adler32 trailer is stitched together with adler32_combine
+// the writer takes the image band by band, so images larger than memory can be encoded as they are produced
+
+namespace gfxutils {
+
+namespace {
+
+constexpr std::array<uint8_t, 8> PNG_SIGNATURE{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+constexpr size_t MIN_ROWS_PER_STRIP = 64;
+constexpr size_t MAX_IDAT_CHUNK_SIZE = 1 << 20;
+
+struct PngStrip {
+	size_t _RowBegin = 0;
+	size_t _RowEnd = 0;
+	std::vector<uint8_t> _Compressed;
+	uLong _Adler = 1;
+	uLong _FilteredSize = 0;
+	bool _Ok = false;
+};
+
+void write_u32_be(std::ofstream &fout, uint32_t value) {
+	std::array<uint8_t, 4> bytes{
+		static_cast<uint8_t>(value >> 24),
+		static_cast<uint8_t>(value >> 16),
+		static_cast<uint8_t>(value >> 8),
+		static_cast<uint8_t>(value)
+	};
+	fout.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+void write_chunk(std::ofstream &fout, const char *type, const uint8_t *data, size_t size) {
+	write_u32_be(fout, static_cast<uint32_t>(size));
+	fout.write(type, 4);
+	if (size != 0) {
+		fout.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+	}
+
+	uLong crc = crc32(0, reinterpret_cast<const Bytef *>(type), 4);
+	if (size != 0) {
+		crc = crc32(crc, data, static_cast<uInt>(size));
+	}
+	write_u32_be(fout, static_cast<uint32_t>(crc));
+}
+
+uint8_t paeth_predictor(int a, int b, int c) {
+	int p = a + b - c;
+	int pa = std::abs(p - a);
+	int pb = std::abs(p - b);
+	int pc = std::abs(p - c);
+	if (pa <= pb && pa <= pc) {
+		return static_cast<uint8_t>(a);
+	}
+	return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// picks the filter with the minimum sum of absolute differences (the heuristic suggested by the PNG spec)
+void filter_row(const uint8_t *row, const uint8_t *prev_row, size_t row_size, size_t bpp, uint8_t *out, std::vector<uint8_t> &scratch) {
+	scratch.resize(row_size);
+
+	uint64_t best_score = UINT64_MAX;
+	for (uint8_t filter = 0; filter < 5; filter++) {
+		uint64_t score = 0;
+		for (size_t i = 0; i < row_size; i++) {
+			int a = (i >= bpp ? row[i - bpp] : 0);
+			int b = (prev_row != nullptr ? prev_row[i] : 0);
+			int c = (i >= bpp && prev_row != nullptr ? prev_row[i - bpp] : 0);
+
+			uint8_t predicted = 0;
+			switch (filter) {
+			case 1: predicted = static_cast<uint8_t>(a); break;
+			case 2: predicted = static_cast<uint8_t>(b); break;
+			case 3: predicted = static_cast<uint8_t>((a + b) >> 1); break;
+			case 4: predicted = paeth_predictor(a, b, c); break;
+			default: break;
+			}
+
+			scratch[i] = static_cast<uint8_t>(row[i] - predicted);
+			score += static_cast<uint64_t>(std::abs(static_cast<int8_t>(scratch[i])));
+		}
+
+		if (score < best_score) {
+			best_score = score;
+			out[0] = filter;
+			std::copy(scratch.begin(), scratch.end(), out + 1);
+		}
+	}
+}
+
+// `prev_row` is the row above the first row of `rows`, nullptr at the top of the image
+void encode_strip(const Image &rows, const uint8_t *prev_row, int compression_level, bool is_last, PngStrip &strip) {
+	size_t row_size = rows.get_width() * rows.get_channels();
+	size_t bpp = rows.get_channels();
+
+	std::vector<uint8_t> filtered((strip._RowEnd - strip._RowBegin) * (row_size + 1));
+	std::vector<uint8_t> scratch;
+	for (size_t y = strip._RowBegin; y < strip._RowEnd; y++) {
+		const uint8_t *row_above = (y == 0 ? prev_row : rows.row(y - 1));
+		filter_row(rows.row(y), row_above, row_size, bpp, &filtered[(y - strip._RowBegin) * (row_size + 1)], scratch);
+	}
+
+	strip._FilteredSize = static_cast<uLong>(filtered.size());
+	strip._Adler = adler32(adler32(0, nullptr, 0), filtered.data(), static_cast<uInt>(filtered.size()));
+
+	z_stream zs{};
+	// negative window bits: raw deflate, the zlib header and trailer are written by the caller
+	if (deflateInit2(&zs, compression_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		return;
+	}
+
+	strip._Compressed.resize(deflateBound(&zs, static_cast<uLong>(filtered.size())) + 16);
+	zs.next_in = filtered.data();
+	zs.avail_in = static_cast<uInt>(filtered.size());
+	zs.next_out = strip._Compressed.data();
+	zs.avail_out = static_cast<uInt>(strip._Compressed.size());
+
+	int ret = deflate(&zs, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+	strip._Ok = (is_last ? ret == Z_STREAM_END : ret == Z_OK) && zs.avail_in == 0;
+	strip._Compressed.resize(zs.total_out);
+
+	deflateEnd(&zs);
+}
+
+uint32_t read_u32_be(const uint8_t *bytes) {
+	return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+	       (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+// bands are encoded as they arrive, so only one band and the compressed output of the current IDAT chunk are held in memory
+class PngWriter : public IImageWriter {
+private:
+	std::string _FilePath;
+	std::ofstream _Out;
+	size_t _Width;
+	size_t _Height;
+	size_t _Channels;
+	int _CompressionLevel;
+	size_t _NumThreads;
+
+	size_t _RowsWritten = 0;
+	std::vector<uint8_t> _PrevRow;  // the last row of the previous band, the filters of the next band predict from it
+	std::vector<uint8_t> _PendingIDAT{ 0x78, 0x9c };  // zlib header: deflate, 32K window, default level
+	uLong _Adler = 1;
+
+public:
+	PngWriter(const std::string &file_path, size_t width, size_t height, size_t n_channels, int compression_level, size_t n_threads)
+	    : _FilePath(file_path)
+	    , _Out(file_path, std::ios::binary)
+	    , _Width(width)
+	    , _Height(height)
+	    , _Channels(n_channels)
+	    , _CompressionLevel(compression_level)
+	    , _NumThreads(n_threads != 0 ? n_threads : std::max<size_t>(1, std::thread::hardware_concurrency())) {
+	}
+
+	bool write_header() {
+		if (!_Out || _Channels < 1 || _Channels > 4 || _Width == 0 || _Height == 0) {
+			return false;
+		}
+
+		_Out.write(reinterpret_cast<const char *>(PNG_SIGNATURE.data()), PNG_SIGNATURE.size());
+
+		static constexpr std::array<uint8_t, 5> color_types{ 0, 0, 4, 2, 6 };  // indexed by the channel count
+		std::array<uint8_t, 13> ihdr{
+			static_cast<uint8_t>(_Width >> 24), static_cast<uint8_t>(_Width >> 16), static_cast<uint8_t>(_Width >> 8), static_cast<uint8_t>(_Width),
+			static_cast<uint8_t>(_Height >> 24), static_cast<uint8_t>(_Height >> 16), static_cast<uint8_t>(_Height >> 8), static_cast<uint8_t>(_Height),
+			8,  // bit depth
+			color_types[_Channels],
+			0,  // compression method
+			0,  // filter method
+			0   // interlace method
+		};
+		write_chunk(_Out, "IHDR", ihdr.data(), ihdr.size());
+
+		return static_cast<bool>(_Out);
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return ImageElementType::U8;
+	}
+
+	bool write_rows(const Image &rows) override {
+		if (rows.get_element_type() != ImageElementType::U8) {
+			return write_rows(rows.convert(ImageElementType::U8));
+		}
+
+		if (rows.get_width() != _Width || rows.get_channels() != _Channels || _RowsWritten + rows.get_height() > _Height) {
+			g_logger->warn("PngCodec: rows of unexpected size written to {}", _FilePath);
+			return false;
+		}
+
+		size_t n_rows = rows.get_height();
+		if (n_rows == 0) {
+			return true;
+		}
+
+		bool is_last_band = (_RowsWritten + n_rows == _Height);
+		size_t n_strips = std::clamp<size_t>(n_rows / MIN_ROWS_PER_STRIP, 1, _NumThreads);
+		size_t rows_per_strip = (n_rows + n_strips - 1) / n_strips;
+		const uint8_t *prev_row = (_PrevRow.empty() ? nullptr : _PrevRow.data());
+
+		std::vector<PngStrip> strips(n_strips);
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < n_strips; i++) {
+			strips[i]._RowBegin = i * rows_per_strip;
+			strips[i]._RowEnd = std::min(n_rows, (i + 1) * rows_per_strip);
+			if (i + 1 < n_strips) {
+				workers.emplace_back(encode_strip, std::cref(rows), prev_row, _CompressionLevel, false, std::ref(strips[i]));
+			}
+		}
+		encode_strip(rows, prev_row, _CompressionLevel, is_last_band, strips.back());  // the calling thread takes the last strip
+		for (auto &worker : workers) {
+			worker.join();
+		}
+
+		if (!std::all_of(strips.begin(), strips.end(), [](const PngStrip &strip) { return strip._Ok; })) {
+			g_logger->warn("PngCodec: failed to deflate image data for {}", _FilePath);
+			return false;
+		}
+
+		for (const auto &strip : strips) {
+			_PendingIDAT.insert(_PendingIDAT.end(), strip._Compressed.begin(), strip._Compressed.end());
+			_Adler = adler32_combine(_Adler, strip._Adler, static_cast<z_off_t>(strip._FilteredSize));
+		}
+
+		// flush full chunks, the remainder waits for the next band
+		size_t n_flushed = 0;
+		for (; _PendingIDAT.size() - n_flushed >= MAX_IDAT_CHUNK_SIZE; n_flushed += MAX_IDAT_CHUNK_SIZE) {
+			write_chunk(_Out, "IDAT", _PendingIDAT.data() + n_flushed, MAX_IDAT_CHUNK_SIZE);
+		}
+		_PendingIDAT.erase(_PendingIDAT.begin(), _PendingIDAT.begin() + static_cast<std::ptrdiff_t>(n_flushed));
+
+		const uint8_t *last_row = rows.row(n_rows - 1);
+		_PrevRow.assign(last_row, last_row + _Width * _Channels);
+		_RowsWritten += n_rows;
+
+		return static_cast<bool>(_Out);
+	}
+
+	bool finish() override {
+		if (_RowsWritten != _Height) {
+			g_logger->warn("PngCodec: only {} of {} rows were written to {}", _RowsWritten, _Height, _FilePath);
+			return false;
+		}
+
+		for (int shift = 24; shift >= 0; shift -= 8) {
+			_PendingIDAT.push_back(static_cast<uint8_t>(_Adler >> shift));
+		}
+		for (size_t offset = 0; offset < _PendingIDAT.size(); offset += MAX_IDAT_CHUNK_SIZE) {
+			write_chunk(_Out, "IDAT", _PendingIDAT.data() + offset, std::min(MAX_IDAT_CHUNK_SIZE, _PendingIDAT.size() - offset));
+		}
+		_PendingIDAT.clear();
+		write_chunk(_Out, "IEND", nullptr, 0);
+
+		_Out.flush();
+		return static_cast<bool>(_Out);
+	}
+};
+
+// inflates the IDAT stream incrementally and unfilters one row at a time
+class PngReader : public IImageReader {
+private:
+	std::string _FilePath;
+	std::ifstream _In;
+	size_t _Width = 0;
+	size_t _Height = 0;
+	uint8_t _BitDepth = 0;
+	size_t _ChannelsInFile = 0;
+	size_t _BytesPerPixel = 0;
+	size_t _RowSize = 0;
+
+	z_stream _Stream{};
+	bool _IsStreamInit = false;
+	std::vector<uint8_t> _InputBuffer;
+	uint32_t _ChunkBytesLeft = 0;  // of the current IDAT chunk
+	bool _IsLastIDAT = false;
+
+	std::vector<uint8_t> _PrevRow;
+	std::vector<uint8_t> _CurrRow;  // filter type byte + row data
+	size_t _RowsRead = 0;
+
+	bool _read_chunk_header(uint32_t &length, std::array<char, 4> &type) {
+		std::array<uint8_t, 4> length_bytes{};
+		if (!_In.read(reinterpret_cast<char *>(length_bytes.data()), 4) || !_In.read(type.data(), 4)) {
+			return false;
+		}
+		length = read_u32_be(length_bytes.data());
+		return true;
+	}
+
+	// refills the inflate input from the current IDAT chunk, or moves on to the next one
+	bool _refill_input() {
+		while (_ChunkBytesLeft == 0) {
+			if (_IsLastIDAT) {
+				return false;
+			}
+
+			uint32_t length = 0;
+			std::array<char, 4> type{};
+			_In.seekg(4, std::ios::cur);  // CRC of the previous chunk
+			if (!_read_chunk_header(length, type)) {
+				return false;
+			}
+			if (std::string_view(type.data(), 4) != "IDAT") {
+				_IsLastIDAT = true;  // IDAT chunks are consecutive
+				return false;
+			}
+			_ChunkBytesLeft = length;
+		}
+
+		size_t n_bytes = std::min<size_t>(_ChunkBytesLeft, _InputBuffer.size());
+		if (!_In.read(reinterpret_cast<char *>(_InputBuffer.data()), static_cast<std::streamsize>(n_bytes))) {
+			return false;
+		}
+		_ChunkBytesLeft -= static_cast<uint32_t>(n_bytes);
+
+		_Stream.next_in = _InputBuffer.data();
+		_Stream.avail_in = static_cast<uInt>(n_bytes);
+		return true;
+	}
+
+	bool _inflate_row() {
+		_Stream.next_out = _CurrRow.data();
+		_Stream.avail_out = static_cast<uInt>(_CurrRow.size());
+
+		while (_Stream.avail_out > 0) {
+			if (_Stream.avail_in == 0 && !_refill_input()) {
+				return false;
+			}
+
+			int ret = inflate(&_Stream, Z_NO_FLUSH);
+			if (ret == Z_STREAM_END) {
+				return _Stream.avail_out == 0;
+			}
+			if (ret != Z_OK && ret != Z_BUF_ERROR) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void _unfilter_row() {
+		uint8_t filter = _CurrRow[0];
+		uint8_t *row = _CurrRow.data() + 1;
+		const uint8_t *prev = _PrevRow.data();
+
+		for (size_t i = 0; i < _RowSize; i++) {
+			int a = (i >= _BytesPerPixel ? row[i - _BytesPerPixel] : 0);
+			int b = prev[i];
+			int c = (i >= _BytesPerPixel ? prev[i - _BytesPerPixel] : 0);
+
+			switch (filter) {
+			case 1: row[i] = static_cast<uint8_t>(row[i] + a); break;
+			case 2: row[i] = static_cast<uint8_t>(row[i] + b); break;
+			case 3: row[i] = static_cast<uint8_t>(row[i] + ((a + b) >> 1)); break;
+			case 4: row[i] = static_cast<uint8_t>(row[i] + paeth_predictor(a, b, c)); break;
+			default: break;
+			}
+		}
+	}
+
+public:
+	explicit PngReader(const std::string &file_path)
+	    : _FilePath(file_path)
+	    , _In(file_path, std::ios::binary)
+	    , _InputBuffer(1 << 16) {
+	}
+
+	~PngReader() override {
+		if (_IsStreamInit) {
+			inflateEnd(&_Stream);
+		}
+	}
+
+	PngReader(const PngReader &) = delete;
+	PngReader &operator=(const PngReader &) = delete;
+
+	// parses the chunks up to the first IDAT, false if the file can't be streamed
+	bool open() {
+		std::array<uint8_t, 8> signature{};
+		if (!_In.read(reinterpret_cast<char *>(signature.data()), signature.size()) || signature != PNG_SIGNATURE) {
+			return false;
+		}
+
+		uint32_t length = 0;
+		std::array<char, 4> type{};
+		if (!_read_chunk_header(length, type) || std::string_view(type.data(), 4) != "IHDR" || length != 13) {
+			return false;
+		}
+
+		std::array<uint8_t, 13> ihdr{};
+		if (!_In.read(reinterpret_cast<char *>(ihdr.data()), ihdr.size())) {
+			return false;
+		}
+		_Width = read_u32_be(&ihdr[0]);
+		_Height = read_u32_be(&ihdr[4]);
+		_BitDepth = ihdr[8];
+		uint8_t color_type = ihdr[9];
+		uint8_t interlace = ihdr[12];
+
+		switch (color_type) {
+		case 0: _ChannelsInFile = 1; break;
+		case 2: _ChannelsInFile = 3; break;
+		case 4: _ChannelsInFile = 2; break;
+		case 6: _ChannelsInFile = 4; break;
+		default: return false;  // palette
+		}
+		if ((_BitDepth != 8 && _BitDepth != 16) || interlace != 0 || _Width == 0 || _Height == 0) {
+			return false;
+		}
+
+		_BytesPerPixel = _ChannelsInFile * _BitDepth / 8;
+		_RowSize = _Width * _BytesPerPixel;
+		_PrevRow.assign(_RowSize, 0);
+		_CurrRow.resize(_RowSize + 1);
+
+		// skip ancillary chunks
+		_In.seekg(4, std::ios::cur);  // CRC of IHDR
+		while (true) {
+			if (!_read_chunk_header(length, type)) {
+				return false;
+			}
+			if (std::string_view(type.data(), 4) == "IDAT") {
+				_ChunkBytesLeft = length;
+				break;
+			}
+			_In.seekg(static_cast<std::streamoff>(length) + 4, std::ios::cur);
+		}
+
+		_IsStreamInit = (inflateInit(&_Stream) == Z_OK);
+		return _IsStreamInit;
+	}
+
+	[[nodiscard]] size_t get_width() const override {
+		return _Width;
+	}
+
+	[[nodiscard]] size_t get_height() const override {
+		return _Height;
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return ImageElementType::U8;
+	}
+
+	[[nodiscard]] Image read_rows(size_t n_rows) override {
+		n_rows = std::min(n_rows, _Height - _RowsRead);
+		if (n_rows == 0) {
+			return {};
+		}
+
+		Image res(_Width, n_rows, 4, ImageElementType::U8);
+		size_t sample_size = _BitDepth / 8;  // 16-bit samples are big-endian, keep the most significant byte
+
+		for (size_t y = 0; y < n_rows; y++) {
+			if (!_inflate_row()) {
+				g_logger->warn("PngCodec: corrupted image data in {}", _FilePath);
+				return {};
+			}
+			_unfilter_row();
+
+			const uint8_t *src = _CurrRow.data() + 1;
+			uint8_t *dst = res.row(y);
+			for (size_t x = 0; x < _Width; x++, src += _BytesPerPixel, dst += 4) {
+				uint8_t v0 = src[0];
+				uint8_t v1 = (_ChannelsInFile > 1 ? src[sample_size] : v0);
+				uint8_t v2 = (_ChannelsInFile > 2 ? src[2 * sample_size] : v0);
+				switch (_ChannelsInFile) {
+				case 1: dst[0] = dst[1] = dst[2] = v0; dst[3] = 255; break;
+				case 2: dst[0] = dst[1] = dst[2] = v0; dst[3] = v1; break;
+				case 3: dst[0] = v0; dst[1] = v1; dst[2] = v2; dst[3] = 255; break;
+				default: dst[0] = v0; dst[1] = v1; dst[2] = v2; dst[3] = src[3 * sample_size]; break;
+				}
+			}
+
+			std::copy(_CurrRow.begin() + 1, _CurrRow.end(), _PrevRow.begin());
+		}
+
+		_RowsRead += n_rows;
+		return res;
+	}
+};
+
+}  // namespace
+
+PngCodec::PngCodec(int compression_level, size_t n_threads)
+    : _CompressionLevel(compression_level)
+    , _NumThreads(n_threads) {
+}
+
+Image PngCodec::decode(const std::string &file_path) const {
+	return StbImageCodec().decode(file_path);
+}
+
+bool PngCodec::encode(const std::string &file_path, const Image &image) const {
+	// the whole image is encoded as a single band
+	auto writer = open_writer(file_path, image.get_width(), image.get_height(), image.get_channels());
+	return writer != nullptr && writer->write_rows(image) && writer->finish();
+}
+
+std::unique_ptr<IImageReader> PngCodec::open_reader(const std::string &file_path) const {
+	auto reader = std::make_unique<PngReader>(file_path);
+	return (reader->open() ? std::move(reader) : nullptr);
+}
+
+std::unique_ptr<IImageWriter> PngCodec::open_writer(const std::string &file_path, size_t width, size_t height, size_t n_channels) const {
+	auto writer = std::make_unique<PngWriter>(file_path, width, height, n_channels, _CompressionLevel, _NumThreads);
+	return (writer->write_header() ? std::move(writer) : nullptr);
+}
+
+}  // namespace gfxutils
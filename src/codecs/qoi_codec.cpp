@@ -0,0 +1,210 @@
+#include <gfx-utils-core/image_codecs.h>
+
+#include <gfx-utils-core/logger.h>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// reference: https://qoiformat.org/qoi-specification.pdf
+
+namespace gfxutils {
+
+namespace {
+
+constexpr uint8_t QOI_OP_INDEX = 0x00;  // 00xxxxxx
+constexpr uint8_t QOI_OP_DIFF = 0x40;   // 01xxxxxx
+constexpr uint8_t QOI_OP_LUMA = 0x80;   // 10xxxxxx
+constexpr uint8_t QOI_OP_RUN = 0xc0;    // 11xxxxxx
+constexpr uint8_t QOI_OP_RGB = 0xfe;
+constexpr uint8_t QOI_OP_RGBA = 0xff;
+constexpr uint8_t QOI_MASK_2 = 0xc0;
+
+constexpr size_t QOI_HEADER_SIZE = 14;
+constexpr std::array<uint8_t, 8> QOI_PADDING{ 0, 0, 0, 0, 0, 0, 0, 1 };
+// the limit of the reference decoder, keeps width * height * 4 far from overflowing
+constexpr size_t QOI_PIXELS_MAX = 400'000'000;
+
+struct QoiPixel {
+	uint8_t r = 0;
+	uint8_t g = 0;
+	uint8_t b = 0;
+	uint8_t a = 0;
+
+	bool operator==(const QoiPixel &) const = default;
+};
+
+size_t qoi_hash(const QoiPixel &px) {
+	return ((px.r * 3) + (px.g * 5) + (px.b * 7) + (px.a * 11)) % 64;
+}
+
+void write_u32_be(std::vector<uint8_t> &out, uint32_t value) {
+	out.push_back(static_cast<uint8_t>(value >> 24));
+	out.push_back(static_cast<uint8_t>(value >> 16));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t read_u32_be(const uint8_t *in) {
+	return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) | (static_cast<uint32_t>(in[2]) << 8) | in[3];
+}
+
+}  // namespace
+
+Image QoiCodec::decode(const std::string &file_path) const {
+	std::ifstream fin(file_path, std::ios::binary);
+	if (!fin) {
+		return {};
+	}
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+	if (bytes.size() < QOI_HEADER_SIZE + QOI_PADDING.size() || std::memcmp(bytes.data(), "qoif", 4) != 0) {
+		g_logger->warn("QoiCodec: {} is not a QOI file", file_path);
+		return {};
+	}
+
+	size_t width = read_u32_be(&bytes[4]);
+	size_t height = read_u32_be(&bytes[8]);
+	// the size comes from the file, check it before allocating
+	if (width == 0 || height == 0 || height > (QOI_PIXELS_MAX - 1) / width) {  // i.e. width * height >= QOI_PIXELS_MAX
+		g_logger->warn("QoiCodec: {} has an invalid size ({}x{})", file_path, width, height);
+		return {};
+	}
+
+	Image res(width, height, 4, ImageElementType::U8);
+	auto *dst = res.data();
+
+	std::array<QoiPixel, 64> index{};
+	QoiPixel px{ 0, 0, 0, 255 };
+	size_t run = 0;
+	size_t pos = QOI_HEADER_SIZE;
+	size_t chunks_end = bytes.size() - QOI_PADDING.size();
+
+	for (size_t i = 0, n_pixels = width * height; i < n_pixels; i++) {
+		if (run > 0) {
+			--run;
+		} else if (pos < chunks_end) {
+			uint8_t b1 = bytes[pos++];
+
+			if (b1 == QOI_OP_RGB) {
+				px.r = bytes[pos++];
+				px.g = bytes[pos++];
+				px.b = bytes[pos++];
+			} else if (b1 == QOI_OP_RGBA) {
+				px.r = bytes[pos++];
+				px.g = bytes[pos++];
+				px.b = bytes[pos++];
+				px.a = bytes[pos++];
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_INDEX) {
+				px = index[b1];
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_DIFF) {
+				px.r = static_cast<uint8_t>(px.r + ((b1 >> 4) & 0x03) - 2);
+				px.g = static_cast<uint8_t>(px.g + ((b1 >> 2) & 0x03) - 2);
+				px.b = static_cast<uint8_t>(px.b + (b1 & 0x03) - 2);
+			} else if ((b1 & QOI_MASK_2) == QOI_OP_LUMA) {
+				uint8_t b2 = bytes[pos++];
+				int vg = (b1 & 0x3f) - 32;
+				px.r = static_cast<uint8_t>(px.r + vg - 8 + ((b2 >> 4) & 0x0f));
+				px.g = static_cast<uint8_t>(px.g + vg);
+				px.b = static_cast<uint8_t>(px.b + vg - 8 + (b2 & 0x0f));
+			} else {
+				run = b1 & 0x3f;
+			}
+
+			index[qoi_hash(px)] = px;
+		}
+
+		dst[(i * 4) + 0] = px.r;
+		dst[(i * 4) + 1] = px.g;
+		dst[(i * 4) + 2] = px.b;
+		dst[(i * 4) + 3] = px.a;
+	}
+
+	return res;
+}
+
+bool QoiCodec::encode(const std::string &file_path, const Image &image) const {
+	size_t width = image.get_width();
+	size_t height = image.get_height();
+	size_t n_channels = image.get_channels();
+	if (n_channels != 3 && n_channels != 4) {
+		g_logger->warn("QoiCodec: only RGB and RGBA images can be encoded, got {} channel(s)", n_channels);
+		return false;
+	}
+
+	std::vector<uint8_t> out;
+	out.reserve(QOI_HEADER_SIZE + (width * height * (n_channels + 1)) + QOI_PADDING.size());  // worst case
+
+	out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+	write_u32_be(out, static_cast<uint32_t>(width));
+	write_u32_be(out, static_cast<uint32_t>(height));
+	out.push_back(static_cast<uint8_t>(n_channels));
+	out.push_back(0);  // sRGB with linear alpha, informative only
+
+	std::array<QoiPixel, 64> index{};
+	QoiPixel px_prev{ 0, 0, 0, 255 };
+	uint8_t run = 0;
+
+	for (size_t y = 0; y < height; y++) {
+		const uint8_t *src = image.row(y);
+		for (size_t x = 0; x < width; x++, src += n_channels) {
+			QoiPixel px{ src[0], src[1], src[2], n_channels == 4 ? src[3] : px_prev.a };
+
+			if (px == px_prev) {
+				++run;
+				if (run == 62 || (y == height - 1 && x == width - 1)) {
+					out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0) {
+				out.push_back(static_cast<uint8_t>(QOI_OP_RUN | (run - 1)));
+				run = 0;
+			}
+
+			size_t index_pos = qoi_hash(px);
+			if (index[index_pos] == px) {
+				out.push_back(static_cast<uint8_t>(QOI_OP_INDEX | index_pos));
+			} else {
+				index[index_pos] = px;
+
+				if (px.a == px_prev.a) {
+					auto vr = static_cast<int8_t>(px.r - px_prev.r);
+					auto vg = static_cast<int8_t>(px.g - px_prev.g);
+					auto vb = static_cast<int8_t>(px.b - px_prev.b);
+					auto vg_r = static_cast<int8_t>(vr - vg);
+					auto vg_b = static_cast<int8_t>(vb - vg);
+
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						out.push_back(static_cast<uint8_t>(QOI_OP_DIFF | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2)));
+					} else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8) {
+						out.push_back(static_cast<uint8_t>(QOI_OP_LUMA | (vg + 32)));
+						out.push_back(static_cast<uint8_t>(((vg_r + 8) << 4) | (vg_b + 8)));
+					} else {
+						out.insert(out.end(), { QOI_OP_RGB, px.r, px.g, px.b });
+					}
+				} else {
+					out.insert(out.end(), { QOI_OP_RGBA, px.r, px.g, px.b, px.a });
+				}
+			}
+
+			px_prev = px;
+		}
+	}
+
+	out.insert(out.end(), QOI_PADDING.begin(), QOI_PADDING.end());
+
+	std::ofstream fout(file_path, std::ios::binary);
+	if (!fout) {
+		return false;
+	}
+	fout.write(reinterpret_cast<const char *>(out.data()), static_cast<std::streamsize>(out.size()));
+
+	return static_cast<bool>(fout);
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,64 @@
+#include <gfx-utils-core/image_codecs.h>
+
+#include <gfx-utils-core/logger.h>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Weverything"
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image.h>
+#include <stb_image_write.h>
+#pragma clang diagnostic pop
+
+namespace gfxutils {
+
+std::vector<std::string> StbImageCodec::get_extensions() const {
+	return { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".psd", ".gif", ".pic", ".pnm", ".ppm", ".pgm" };
+}
+
+Image StbImageCodec::decode(const std::string &file_path) const {
+	int width = 0;
+	int height = 0;
+	int n_channels_actual = 0;
+
+	// the 5th argument `req_comp` == 4: force in RGBA 4 channel format
+	uint8_t *data = stbi_load(file_path.c_str(), &width, &height, &n_channels_actual, 4);
+	if (data == nullptr) {
+		g_logger->warn("StbImageCodec: failed to decode {}: {}", file_path, stbi_failure_reason());
+		return {};
+	}
+
+	return Image::adopt(data, static_cast<size_t>(width), static_cast<size_t>(height), 4, ImageElementType::U8, stbi_image_free);
+}
+
+bool StbImageCodec::encode(const std::string &file_path [[maybe_unused]], const Image &image [[maybe_unused]]) const {
+	return false;
+}
+
+Image HdrCodec::decode(const std::string &file_path) const {
+	int width = 0;
+	int height = 0;
+	int n_channels_actual = 0;
+
+	float *data = stbi_loadf(file_path.c_str(), &width, &height, &n_channels_actual, 4);
+	if (data == nullptr) {
+		g_logger->warn("HdrCodec: failed to decode {}: {}", file_path, stbi_failure_reason());
+		return {};
+	}
+
+	return Image::adopt(data, static_cast<size_t>(width), static_cast<size_t>(height), 4, ImageElementType::F32, stbi_image_free);
+}
+
+bool HdrCodec::encode(const std::string &file_path, const Image &image) const {
+	if (!image.is_packed() || image.get_element_type() != ImageElementType::F32) {
+		return encode(file_path, image.convert(ImageElementType::F32));  // stb wants packed rows
+	}
+
+	return stbi_write_hdr(file_path.c_str(),
+	                      static_cast<int>(image.get_width()),
+	                      static_cast<int>(image.get_height()),
+	                      static_cast<int>(image.get_channels()),
+	                      reinterpret_cast<const float *>(image.data())) != 0;
+}
+
+}  // namespace gfxutils
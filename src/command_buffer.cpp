@@ -0,0 +1,311 @@
+#include <gfx-utils-core/command_buffer.h>
+
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/logger.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gfxutils {
+
+namespace {
+
+// the key packs pass (8 bits), program (16 bits), texture set (24 bits) and vertex array (16 bits), most significant first
+// GL names rarely exceed 16 bits, and a collision only costs a state change, never correctness
+uint64_t make_sort_key(uint8_t pass, GLuint program, uint32_t textures_hash, GLuint vertex_array) {
+	return (static_cast<uint64_t>(pass) << 56) |
+	       (static_cast<uint64_t>(program & 0xffff) << 40) |
+	       (static_cast<uint64_t>(textures_hash & 0xffffff) << 16) |
+	       static_cast<uint64_t>(vertex_array & 0xffff);
+}
+
+}  // namespace
+
+void CommandBuffer::set_pass(uint8_t pass, GLbitfield barriers) {
+	_Pass = pass;
+	_PassBarriers[pass] |= barriers;
+}
+
+void CommandBuffer::set_program(const ShaderProgram &program) {
+	_Program = &program;
+	_BoundUniforms.clear();
+}
+
+void CommandBuffer::set_texture(size_t texture_unit, const Texture &texture) {
+	if (texture_unit >= MAX_TEXTURE_UNITS) {
+		g_logger->warn("CommandBuffer: texture unit {} is out of range (at most {} units), the texture is ignored", texture_unit, MAX_TEXTURE_UNITS);
+		return;
+	}
+	_BoundTextures[texture_unit] = { texture._get_handle(), texture.get_info()._Target, static_cast<uint8_t>(texture_unit) };
+}
+
+void CommandBuffer::set_vertex_buffer(const VertexBuffer &vertex_buffer) {
+	_VertexBuffer = &vertex_buffer;
+}
+
+void CommandBuffer::set_uniform(const std::string &name, int scalar) {
+	float data;
+	std::memcpy(&data, &scalar, sizeof(data));
+	_set_uniform(name, UniformType::INT, &data, 1);
+}
+
+void CommandBuffer::set_uniform(const std::string &name, float scalar) {
+	_set_uniform(name, UniformType::FLOAT, &scalar, 1);
+}
+
+void CommandBuffer::set_uniform(const std::string &name, const glm::vec2 &vector) {
+	_set_uniform(name, UniformType::VEC2, &vector[0], 2);
+}
+
+void CommandBuffer::set_uniform(const std::string &name, const glm::vec3 &vector) {
+	_set_uniform(name, UniformType::VEC3, &vector[0], 3);
+}
+
+void CommandBuffer::set_uniform(const std::string &name, const glm::vec4 &vector) {
+	_set_uniform(name, UniformType::VEC4, &vector[0], 4);
+}
+
+void CommandBuffer::set_uniform(const std::string &name, const glm::mat4 &matrix) {
+	_set_uniform(name, UniformType::MAT4, &matrix[0][0], 16);
+}
+
+void CommandBuffer::draw(GLenum mode) {
+	draw_instanced(0, mode, 0);
+}
+
+void CommandBuffer::draw_instanced(size_t n_instances, GLenum mode, size_t first_instance) {
+	if (_VertexBuffer == nullptr) {
+		g_logger->warn("CommandBuffer: draw without a vertex buffer is ignored");
+		return;
+	}
+
+	auto &command = _record(CommandType::DRAW, _VertexBuffer->_get_handle());
+	command._Mode = mode;
+	command._IndexType = _VertexBuffer->is_indexed() ? _VertexBuffer->get_index_type() : 0;
+	command._Count = static_cast<uint32_t>(_VertexBuffer->is_indexed() ? _VertexBuffer->get_index_count() : _VertexBuffer->get_vertex_count());
+	command._NumInstances = static_cast<uint32_t>(n_instances);
+	command._FirstInstance = static_cast<uint32_t>(first_instance);
+}
+
+void CommandBuffer::dispatch(size_t n_groups_x, size_t n_groups_y, size_t n_groups_z) {
+	auto &command = _record(CommandType::DISPATCH, 0);
+	command._NumGroups = { static_cast<uint32_t>(n_groups_x), static_cast<uint32_t>(n_groups_y), static_cast<uint32_t>(n_groups_z) };
+}
+
+void CommandBuffer::append(CommandBuffer &&other) {
+	auto first_texture = static_cast<uint32_t>(_Textures.size());
+	auto first_uniform = static_cast<uint32_t>(_Uniforms.size());
+	for (auto &command : other._Commands) {
+		command._FirstTexture += first_texture;
+		command._FirstUniform += first_uniform;
+	}
+
+	_IsSorted = _IsSorted && other._IsSorted && (_Commands.empty() || other._Commands.empty() || _Commands.back()._SortKey <= other._Commands.front()._SortKey);
+	_Commands.insert(_Commands.end(), other._Commands.begin(), other._Commands.end());
+	_Textures.insert(_Textures.end(), other._Textures.begin(), other._Textures.end());
+	_Uniforms.insert(_Uniforms.end(), other._Uniforms.begin(), other._Uniforms.end());
+	for (size_t i = 0; i < MAX_PASSES; i++) {
+		_PassBarriers[i] |= other._PassBarriers[i];
+	}
+
+	other.clear();
+}
+
+void CommandBuffer::sort() {
+	if (_IsSorted) {
+		return;
+	}
+	// stable, so commands with the same state keep the order they were recorded in
+	std::stable_sort(_Commands.begin(), _Commands.end(), [](const Command &lhs, const Command &rhs) { return lhs._SortKey < rhs._SortKey; });
+	_IsSorted = true;
+}
+
+void CommandBuffer::submit() {
+	sort();
+
+	auto &gl_state_cache = GLStateCache::instance();
+	_Stats = {};
+	_Stats._NumCommands = _Commands.size();
+
+	auto is_same_binding = [](const TextureBinding &lhs, const TextureBinding &rhs) {
+		return lhs._Texture == rhs._Texture && lhs._Unit == rhs._Unit;
+	};
+	auto is_same_uniform = [](const Uniform &lhs, const Uniform &rhs) {
+		return lhs._Location == rhs._Location && lhs._Type == rhs._Type && lhs._Data == rhs._Data;
+	};
+
+	// the barriers of the passes before `end_pass` not issued yet, merged into one call, so that the barriers of passes
+	// without commands aren't lost
+	size_t next_barrier_pass = 0;
+	auto issue_barriers = [&](size_t end_pass) {
+		GLbitfield barriers = 0;
+		for (; next_barrier_pass < end_pass; next_barrier_pass++) {
+			barriers |= _PassBarriers[next_barrier_pass];
+		}
+		if (barriers != 0) {
+			glMemoryBarrier(barriers);
+		}
+	};
+
+	const Command *prev = nullptr;
+	for (const auto &command : _Commands) {
+		if (command._Pass >= next_barrier_pass) {
+			issue_barriers(command._Pass + 1);
+		}
+
+		bool is_same_program = prev != nullptr && command._Program == prev->_Program;
+		if (!is_same_program) {
+			gl_state_cache.use_program(command._Program);
+			++_Stats._NumProgramChanges;
+		}
+
+		auto textures_begin = _Textures.begin() + command._FirstTexture;
+		bool is_same_textures = prev != nullptr && command._NumTextures == prev->_NumTextures &&
+		                        std::equal(textures_begin, textures_begin + command._NumTextures, _Textures.begin() + prev->_FirstTexture, is_same_binding);
+		if (!is_same_textures) {
+			for (auto iter = textures_begin; iter != textures_begin + command._NumTextures; ++iter) {
+				gl_state_cache.bind_texture(iter->_Unit, iter->_Target, iter->_Texture);
+			}
+			++_Stats._NumTextureChanges;
+		}
+
+		// uniforms are program state, identical values for the same program are uploaded once
+		auto uniforms_begin = _Uniforms.begin() + command._FirstUniform;
+		bool is_same_uniforms = is_same_program && command._NumUniforms == prev->_NumUniforms &&
+		                        std::equal(uniforms_begin, uniforms_begin + command._NumUniforms, _Uniforms.begin() + prev->_FirstUniform, is_same_uniform);
+		if (!is_same_uniforms) {
+			for (auto iter = uniforms_begin; iter != uniforms_begin + command._NumUniforms; ++iter) {
+				const auto *data = iter->_Data.data();
+				switch (iter->_Type) {
+				case UniformType::INT: {
+					GLint value;
+					std::memcpy(&value, data, sizeof(value));
+					glUniform1i(iter->_Location, value);
+					break;
+				}
+				case UniformType::FLOAT:
+					glUniform1fv(iter->_Location, 1, data);
+					break;
+				case UniformType::VEC2:
+					glUniform2fv(iter->_Location, 1, data);
+					break;
+				case UniformType::VEC3:
+					glUniform3fv(iter->_Location, 1, data);
+					break;
+				case UniformType::VEC4:
+					glUniform4fv(iter->_Location, 1, data);
+					break;
+				case UniformType::MAT4:
+					glUniformMatrix4fv(iter->_Location, 1, GL_FALSE, data);
+					break;
+				}
+			}
+		}
+
+		if (command._Type == CommandType::DISPATCH) {
+			glDispatchCompute(command._NumGroups[0], command._NumGroups[1], command._NumGroups[2]);
+			prev = &command;
+			continue;
+		}
+
+		if (prev == nullptr || prev->_Type != CommandType::DRAW || command._VertexArray != prev->_VertexArray) {
+			gl_state_cache.bind_vertex_array(command._VertexArray);
+			++_Stats._NumVertexArrayChanges;
+		}
+
+		auto count = static_cast<GLsizei>(command._Count);
+		if (command._NumInstances == 0) {
+			if (command._IndexType != 0) {
+				glDrawElements(command._Mode, count, command._IndexType, nullptr);
+			} else {
+				glDrawArrays(command._Mode, 0, count);
+			}
+		} else {
+			auto n_instances = static_cast<GLsizei>(command._NumInstances);
+			if (command._IndexType != 0) {
+				glDrawElementsInstancedBaseInstance(command._Mode, count, command._IndexType, nullptr, n_instances, command._FirstInstance);
+			} else {
+				glDrawArraysInstancedBaseInstance(command._Mode, 0, count, n_instances, command._FirstInstance);
+			}
+		}
+		prev = &command;
+	}
+	issue_barriers(MAX_PASSES);
+}
+
+void CommandBuffer::clear() {
+	_Commands.clear();
+	_Textures.clear();
+	_Uniforms.clear();
+	_PassBarriers.fill(0);
+	_IsSorted = true;
+
+	_Pass = 0;
+	_Program = nullptr;
+	_BoundTextures.fill({});
+	_BoundUniforms.clear();
+	_VertexBuffer = nullptr;
+}
+
+size_t CommandBuffer::get_command_count() const {
+	return _Commands.size();
+}
+
+CommandBufferStats CommandBuffer::get_stats() const {
+	return _Stats;
+}
+
+void CommandBuffer::_set_uniform(const std::string &name, UniformType type, const float *data, size_t n_floats) {
+	if (_Program == nullptr) {
+		g_logger->warn("CommandBuffer: uniform \"{}\" is set without a program, it is ignored", name);
+		return;
+	}
+
+	auto location = _Program->find_uniform_location(name);
+	if (location < 0) {
+		return;
+	}
+
+	auto iter = std::ranges::find_if(_BoundUniforms, [&](const Uniform &uniform) { return uniform._Location == location; });
+	if (iter == _BoundUniforms.end()) {
+		iter = _BoundUniforms.insert(_BoundUniforms.end(), Uniform{ location, type, {} });
+	}
+	iter->_Type = type;
+	iter->_Data = {};
+	std::copy_n(data, n_floats, iter->_Data.begin());
+}
+
+CommandBuffer::Command &CommandBuffer::_record(CommandType type, GLuint vertex_array) {
+	Command command{};
+	command._Type = type;
+	command._VertexArray = vertex_array;
+	command._Pass = _Pass;
+	command._Program = _Program != nullptr ? _Program->_get_handle() : 0;
+
+	// FNV-1a over the bound textures, only its low 24 bits go into the key
+	uint32_t textures_hash = 2166136261u;
+	command._FirstTexture = static_cast<uint32_t>(_Textures.size());
+	for (const auto &binding : _BoundTextures) {
+		if (binding._Texture == 0) {
+			continue;
+		}
+		_Textures.push_back(binding);
+		textures_hash = (textures_hash ^ binding._Texture) * 16777619u;
+		textures_hash = (textures_hash ^ binding._Unit) * 16777619u;
+		++command._NumTextures;
+	}
+	if (command._NumTextures == 0) {
+		textures_hash = 0;
+	}
+
+	command._FirstUniform = static_cast<uint32_t>(_Uniforms.size());
+	command._NumUniforms = static_cast<uint8_t>(std::min<size_t>(_BoundUniforms.size(), 0xff));
+	_Uniforms.insert(_Uniforms.end(), _BoundUniforms.begin(), _BoundUniforms.begin() + command._NumUniforms);
+
+	command._SortKey = make_sort_key(command._Pass, command._Program, textures_hash, vertex_array);
+
+	_IsSorted = _IsSorted && (_Commands.empty() || _Commands.back()._SortKey <= command._SortKey);
+	return _Commands.emplace_back(command);
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,391 @@
+#include <gfx-utils-core/debug_draw.h>
+
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace gfxutils {
+
+namespace {
+
+constexpr const char *DEBUG_DRAW_VERTEX_SHADER = R"(#version 460 core
+
+layout(location = 0) in vec3 i_pos;
+layout(location = 1) in vec4 i_color;
+
+uniform mat4 u_transform;
+
+out vec4 m_color;
+
+void main() {
+    m_color = i_color;
+    gl_Position = u_transform * vec4(i_pos, 1.0);
+}
+)";
+
+constexpr const char *DEBUG_DRAW_FRAGMENT_SHADER = R"(#version 460 core
+
+in vec4 m_color;
+
+out vec4 o_color;
+
+void main() {
+    o_color = m_color;
+}
+)";
+
+uint32_t pack_color(const glm::vec4 &color) {
+	auto to_u8 = [](float x) { return static_cast<uint32_t>(std::lround(std::clamp(x, 0.0f, 1.0f) * 255.0f)); };
+	return to_u8(color.r) | (to_u8(color.g) << 8) | (to_u8(color.b) << 16) | (to_u8(color.a) << 24);
+}
+
+glm::vec3 transform_point(const glm::mat4 &transform, const glm::vec3 &point) {
+	glm::vec4 res = transform * glm::vec4(point, 1.0f);
+	return glm::vec3(res.x, res.y, res.z) / res.w;
+}
+
+}  // namespace
+
+DebugDraw::DebugDrawBuilder::DebugDrawBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+DebugDraw::DebugDrawBuilder &DebugDraw::DebugDrawBuilder::set_arena_size(size_t arena_size_bytes) {
+	_ArenaSizeBytes = arena_size_bytes;
+	return *this;
+}
+
+DebugDraw::DebugDrawBuilder &DebugDraw::DebugDrawBuilder::set_point_size(float point_size) {
+	_PointSize = point_size;
+	return *this;
+}
+
+DebugDraw DebugDraw::DebugDrawBuilder::_build() const {
+	DebugDraw res;
+
+	res._set_name(_Name);
+
+	if (_ArenaSizeBytes < sizeof(Chunk)) {
+		g_logger->warn("DebugDraw::DebugDrawBuilder ({}): arena size ({} bytes) is below one chunk ({} bytes): debug draw won't be built", _Name, _ArenaSizeBytes, sizeof(Chunk));
+		return res;
+	}
+
+	auto vertex_shader = Shader::ShaderBuilder(_Name + "_vs").set_type(ShaderType::VERTEX_SHADER).set_source(DEBUG_DRAW_VERTEX_SHADER).build();
+	auto fragment_shader = Shader::ShaderBuilder(_Name + "_fs").set_type(ShaderType::FRAGMENT_SHADER).set_source(DEBUG_DRAW_FRAGMENT_SHADER).build();
+	auto shader_program = ShaderProgram::ShaderProgramBuilder(_Name + "_shader_program").add_shader(vertex_shader).add_shader(fragment_shader).build();
+	if (!shader_program.is_complete()) {
+		g_logger->warn("DebugDraw::DebugDrawBuilder ({}): failed to build the shader program: debug draw won't be built", _Name);
+		return res;
+	}
+
+	// at most every vertex of the arena is uploaded in a frame
+	auto streaming_buffer = StreamingBuffer::StreamingBufferBuilder(_Name + "_streaming_buffer").set_region_size(_ArenaSizeBytes).build();
+	if (!streaming_buffer.is_complete()) {
+		return res;
+	}
+
+	res._State = std::make_shared<State>(_ArenaSizeBytes);
+	auto &state = *res._State;
+	state._StreamingBuffer = streaming_buffer;
+	state._ShaderProgram = shader_program;
+	state._PointSize = _PointSize;
+
+	// the vertex buffer binding moves with every frame's allocation, the format stays
+	state._VAO = ResourceManager::instance().alloc(ResourceType::VAO);
+	auto &gl_state_cache = GLStateCache::instance();
+	gl_state_cache.bind_vertex_array(state._VAO);
+	glVertexArrayAttribFormat(state._VAO, 0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, _Pos));
+	glVertexArrayAttribFormat(state._VAO, 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Vertex, _Color));
+	glVertexArrayAttribBinding(state._VAO, 0, 0);
+	glVertexArrayAttribBinding(state._VAO, 1, 0);
+	glEnableVertexArrayAttrib(state._VAO, 0);
+	glEnableVertexArrayAttrib(state._VAO, 1);
+	gl_state_cache.bind_vertex_array(0);
+
+	g_logger->info("DebugDraw::DebugDrawBuilder ({}): successfully built debug draw ({} bytes per frame)", _Name, _ArenaSizeBytes);
+
+	res._set_complete();
+
+	return res;
+}
+
+void DebugDraw::set_depth_test(bool enable) const {
+	_State->_DepthTest = enable;
+}
+
+void DebugDraw::point(const glm::vec3 &pos, const glm::vec4 &color) const {
+	if (auto *vertices = _push(_get_world_space(), POINTS, 1); vertices != nullptr) {
+		vertices[0] = { pos, pack_color(color) };
+	}
+}
+
+void DebugDraw::line(const glm::vec3 &from, const glm::vec3 &to, const glm::vec4 &color) const {
+	if (auto *vertices = _push(_get_world_space(), LINES, 2); vertices != nullptr) {
+		auto packed_color = pack_color(color);
+		vertices[0] = { from, packed_color };
+		vertices[1] = { to, packed_color };
+	}
+}
+
+void DebugDraw::triangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, const glm::vec4 &color) const {
+	if (auto *vertices = _push(_get_world_space(), TRIANGLES, 3); vertices != nullptr) {
+		auto packed_color = pack_color(color);
+		vertices[0] = { a, packed_color };
+		vertices[1] = { b, packed_color };
+		vertices[2] = { c, packed_color };
+	}
+}
+
+void DebugDraw::box(const glm::vec3 &min, const glm::vec3 &max, const glm::vec4 &color) const {
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++) {
+		corners[i] = glm::vec3((i & 1) != 0 ? max.x : min.x, (i & 2) != 0 ? max.y : min.y, (i & 4) != 0 ? max.z : min.z);
+	}
+
+	// every pair of corners differing in one bit
+	for (int i = 0; i < 8; i++) {
+		for (int bit = 1; bit < 8; bit <<= 1) {
+			if ((i & bit) == 0) {
+				line(corners[i], corners[i | bit], color);
+			}
+		}
+	}
+}
+
+void DebugDraw::box(const glm::mat4 &transform, const glm::vec4 &color) const {
+	glm::vec3 corners[8];
+	for (int i = 0; i < 8; i++) {
+		corners[i] = transform_point(transform, glm::vec3((i & 1) != 0 ? 1.0f : -1.0f, (i & 2) != 0 ? 1.0f : -1.0f, (i & 4) != 0 ? 1.0f : -1.0f));
+	}
+
+	for (int i = 0; i < 8; i++) {
+		for (int bit = 1; bit < 8; bit <<= 1) {
+			if ((i & bit) == 0) {
+				line(corners[i], corners[i | bit], color);
+			}
+		}
+	}
+}
+
+void DebugDraw::circle(const glm::vec3 &center, const glm::vec3 &normal, float radius, const glm::vec4 &color, size_t n_segments) const {
+	n_segments = std::max<size_t>(n_segments, 3);
+
+	// any orthonormal basis of the circle's plane
+	glm::vec3 n = glm::normalize(normal);
+	glm::vec3 helper = std::abs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 u = glm::normalize(glm::cross(n, helper));
+	glm::vec3 v = glm::cross(n, u);
+
+	glm::vec3 prev = center + u * radius;
+	for (size_t i = 1; i <= n_segments; i++) {
+		float angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(n_segments);
+		glm::vec3 curr = center + (u * std::cos(angle) + v * std::sin(angle)) * radius;
+		line(prev, curr, color);
+		prev = curr;
+	}
+}
+
+void DebugDraw::sphere(const glm::vec3 &center, float radius, const glm::vec4 &color, size_t n_segments) const {
+	circle(center, glm::vec3(1.0f, 0.0f, 0.0f), radius, color, n_segments);
+	circle(center, glm::vec3(0.0f, 1.0f, 0.0f), radius, color, n_segments);
+	circle(center, glm::vec3(0.0f, 0.0f, 1.0f), radius, color, n_segments);
+}
+
+void DebugDraw::axes(const glm::mat4 &transform, float size) const {
+	glm::vec3 origin = transform_point(transform, glm::vec3(0.0f));
+	line(origin, transform_point(transform, glm::vec3(size, 0.0f, 0.0f)), glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+	line(origin, transform_point(transform, glm::vec3(0.0f, size, 0.0f)), glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+	line(origin, transform_point(transform, glm::vec3(0.0f, 0.0f, size)), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+void DebugDraw::overlay_line(const glm::vec2 &from, const glm::vec2 &to, const glm::vec4 &color) const {
+	if (auto *vertices = _push(SCREEN, LINES, 2); vertices != nullptr) {
+		auto packed_color = pack_color(color);
+		vertices[0] = { glm::vec3(from.x, from.y, 0.0f), packed_color };
+		vertices[1] = { glm::vec3(to.x, to.y, 0.0f), packed_color };
+	}
+}
+
+void DebugDraw::overlay_rect(const glm::vec2 &min, const glm::vec2 &max, const glm::vec4 &color, bool filled) const {
+	glm::vec3 corners[4] = {
+		glm::vec3(min.x, min.y, 0.0f),
+		glm::vec3(max.x, min.y, 0.0f),
+		glm::vec3(max.x, max.y, 0.0f),
+		glm::vec3(min.x, max.y, 0.0f)
+	};
+	auto packed_color = pack_color(color);
+
+	if (filled) {
+		if (auto *vertices = _push(SCREEN, TRIANGLES, 6); vertices != nullptr) {
+			for (int i : { 0, 1, 2, 0, 2, 3 }) {
+				*vertices++ = { corners[i], packed_color };
+			}
+		}
+	} else if (auto *vertices = _push(SCREEN, LINES, 8); vertices != nullptr) {
+		for (int i = 0; i < 4; i++) {
+			*vertices++ = { corners[i], packed_color };
+			*vertices++ = { corners[(i + 1) % 4], packed_color };
+		}
+	}
+}
+
+void DebugDraw::flush(const glm::mat4 &view_projection, const glm::vec2 &screen_size) const {
+	auto &state = *_State;
+
+	size_t n_vertices = 0;
+	for (const auto &batch : state._Batches) {
+		n_vertices += batch._NumVertices;
+	}
+
+	state._Stats._NumVertices = 0;
+	state._Stats._NumDrawCalls = 0;
+	state._Stats._NumDropped = state._NumDropped;
+	state._Stats._PeakArenaBytes = state._Arena.get_peak_bytes();
+	if (state._NumDropped > 0) {
+		g_logger->warn("DebugDraw ({}): dropped {} primitive(s), the arena is full", _Name, state._NumDropped);
+	}
+
+	// every path ends the frame of the streaming buffer, so that its regions keep cycling once per flush
+	if (n_vertices == 0) {
+		state._StreamingBuffer.end_frame();
+		clear();
+		return;
+	}
+
+	// a single upload: every batch is copied behind the previous one
+	auto allocation = state._StreamingBuffer.allocate(n_vertices * sizeof(Vertex), sizeof(Vertex));
+	if (allocation.empty()) {
+		constexpr size_t vertices_per_primitive[N_BATCH_PRIMITIVES] = { 1, 2, 3 };  // points, lines, triangles
+		size_t n_primitives = 0;
+		for (size_t i = 0; i < state._Batches.size(); i++) {
+			n_primitives += state._Batches[i]._NumVertices / vertices_per_primitive[i % N_BATCH_PRIMITIVES];
+		}
+		state._Stats._NumDropped += n_primitives;
+		g_logger->warn("DebugDraw ({}): the streaming buffer is full, {} primitive(s) dropped", _Name, n_primitives);
+		state._StreamingBuffer.end_frame();
+		clear();
+		return;
+	}
+
+	std::array<size_t, N_BATCH_SPACES * N_BATCH_PRIMITIVES> first_vertices;
+	auto *dst = reinterpret_cast<Vertex *>(allocation._Data);
+	size_t n_copied = 0;
+	for (size_t i = 0; i < state._Batches.size(); i++) {
+		first_vertices[i] = n_copied;
+		for (const auto *chunk = state._Batches[i]._Head; chunk != nullptr; chunk = chunk->_Next) {
+			std::memcpy(dst + n_copied, chunk->_Vertices, chunk->_Size * sizeof(Vertex));
+			n_copied += chunk->_Size;
+		}
+	}
+
+	// debug primitives blend over the scene without occluding it
+	auto &gl_state_cache = GLStateCache::instance();
+	bool was_depth_test_enabled = gl_state_cache.is_enabled(GL_DEPTH_TEST);
+	bool was_blend_enabled = gl_state_cache.is_enabled(GL_BLEND);
+	GLboolean was_depth_write_enabled = GL_TRUE;
+	GLint blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha;
+	GLfloat point_size;
+	glGetBooleanv(GL_DEPTH_WRITEMASK, &was_depth_write_enabled);
+	glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src_rgb);
+	glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst_rgb);
+	glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_src_alpha);
+	glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_dst_alpha);
+	glGetFloatv(GL_POINT_SIZE, &point_size);
+
+	glDepthMask(GL_FALSE);
+	gl_state_cache.set_capability(GL_BLEND, true);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glPointSize(state._PointSize);
+
+	gl_state_cache.bind_vertex_array(state._VAO);
+	glBindVertexBuffer(0, state._StreamingBuffer._get_handle(), static_cast<GLintptr>(allocation._Offset), sizeof(Vertex));
+	state._ShaderProgram.use();
+
+	constexpr GLenum modes[N_BATCH_PRIMITIVES] = { GL_POINTS, GL_LINES, GL_TRIANGLES };
+	glm::mat4 screen_projection = glm::ortho(0.0f, screen_size.x, screen_size.y, 0.0f, -1.0f, 1.0f);
+	for (size_t space = 0; space < N_BATCH_SPACES; space++) {
+		bool has_vertices = false;
+		for (size_t primitive = 0; primitive < N_BATCH_PRIMITIVES; primitive++) {
+			has_vertices |= state._Batches[space * N_BATCH_PRIMITIVES + primitive]._NumVertices > 0;
+		}
+		if (!has_vertices) {
+			continue;
+		}
+
+		state._ShaderProgram.set_uniform("u_transform", space == SCREEN ? screen_projection : view_projection);
+		gl_state_cache.set_capability(GL_DEPTH_TEST, space == WORLD_DEPTH_TESTED);
+
+		for (size_t primitive = 0; primitive < N_BATCH_PRIMITIVES; primitive++) {
+			size_t batch_index = space * N_BATCH_PRIMITIVES + primitive;
+			if (state._Batches[batch_index]._NumVertices == 0) {
+				continue;
+			}
+
+			glDrawArrays(modes[primitive], static_cast<GLint>(first_vertices[batch_index]), static_cast<GLsizei>(state._Batches[batch_index]._NumVertices));
+			state._Stats._NumDrawCalls++;
+		}
+	}
+
+	gl_state_cache.bind_vertex_array(0);
+	glPointSize(point_size);
+	glBlendFuncSeparate(blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha);
+	gl_state_cache.set_capability(GL_BLEND, was_blend_enabled);
+	gl_state_cache.set_capability(GL_DEPTH_TEST, was_depth_test_enabled);
+	glDepthMask(was_depth_write_enabled);
+
+	state._Stats._NumVertices = n_vertices;
+	state._StreamingBuffer.end_frame();
+	clear();
+}
+
+void DebugDraw::clear() const {
+	auto &state = *_State;
+	state._Arena.reset();
+	state._Batches.fill({});
+	state._NumDropped = 0;
+}
+
+const DebugDrawStats &DebugDraw::get_stats() const {
+	return _State->_Stats;
+}
+
+DebugDraw::Vertex *DebugDraw::_push(BatchSpace space, BatchPrimitive primitive, size_t n_vertices) const {
+	auto &state = *_State;
+	auto &batch = state._Batches[static_cast<size_t>(space) * N_BATCH_PRIMITIVES + static_cast<size_t>(primitive)];
+
+	// a primitive never straddles two chunks
+	if (batch._Tail == nullptr || batch._Tail->_Size + n_vertices > Chunk::CAPACITY) {
+		auto *chunk = state._Arena.allocate<Chunk>();
+		if (chunk == nullptr) {
+			state._NumDropped++;
+			return nullptr;
+		}
+
+		chunk->_Size = 0;
+		chunk->_Next = nullptr;
+		if (batch._Tail == nullptr) {
+			batch._Head = chunk;
+		} else {
+			batch._Tail->_Next = chunk;
+		}
+		batch._Tail = chunk;
+	}
+
+	Vertex *res = batch._Tail->_Vertices + batch._Tail->_Size;
+	batch._Tail->_Size += n_vertices;
+	batch._NumVertices += n_vertices;
+	return res;
+}
+
+DebugDraw::BatchSpace DebugDraw::_get_world_space() const {
+	return _State->_DepthTest ? WORLD_DEPTH_TESTED : WORLD;
+}
+
+}  // namespace gfxutils
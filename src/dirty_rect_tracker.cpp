@@ -0,0 +1,114 @@
+#include <gfx-utils-core/dirty_rect_tracker.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace gfxutils {
+
+namespace {
+
+DirtyRect get_bounding_rect(const DirtyRect &a, const DirtyRect &b) {
+	size_t x0 = std::min(a._X, b._X);
+	size_t y0 = std::min(a._Y, b._Y);
+	size_t x1 = std::max(a._X + a._Width, b._X + b._Width);
+	size_t y1 = std::max(a._Y + a._Height, b._Y + b._Height);
+	return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+// texels the bounding box uploads on top of the two rectangles, overlaps count twice so nested rectangles are free
+size_t get_merge_cost(const DirtyRect &a, const DirtyRect &b) {
+	auto bounding_area = get_bounding_rect(a, b).get_area();
+	auto separate_area = a.get_area() + b.get_area();
+	return bounding_area > separate_area ? bounding_area - separate_area : 0;
+}
+
+}  // namespace
+
+DirtyRectTracker::DirtyRectTracker(size_t width, size_t height, size_t max_rects)
+    : _Width(width)
+    , _Height(height)
+    , _MaxRects(std::max<size_t>(max_rects, 1)) {
+}
+
+void DirtyRectTracker::add(size_t x, size_t y, size_t width, size_t height) {
+	if (x >= _Width || y >= _Height) {
+		return;
+	}
+	width = std::min(width, _Width - x);
+	height = std::min(height, _Height - y);
+	if (width == 0 || height == 0) {
+		return;
+	}
+
+	_Rects.push_back({ x, y, width, height });
+	_merge_overlapping(_Rects.size() - 1);
+
+	while (_Rects.size() > _MaxRects) {
+		size_t best_cost = std::numeric_limits<size_t>::max();
+		std::pair<size_t, size_t> best_pair;
+		for (size_t i = 0; i < _Rects.size(); i++) {
+			for (size_t j = i + 1; j < _Rects.size(); j++) {
+				if (auto cost = get_merge_cost(_Rects[i], _Rects[j]); cost < best_cost) {
+					best_cost = cost;
+					best_pair = { i, j };
+				}
+			}
+		}
+
+		auto [i, j] = best_pair;
+		_Rects[i] = get_bounding_rect(_Rects[i], _Rects[j]);
+		_Rects.erase(_Rects.begin() + static_cast<std::ptrdiff_t>(j));
+		_merge_overlapping(i);
+	}
+}
+
+void DirtyRectTracker::add_all() {
+	_Rects.assign(1, { 0, 0, _Width, _Height });
+}
+
+std::vector<DirtyRect> DirtyRectTracker::take() {
+	return std::exchange(_Rects, {});
+}
+
+void DirtyRectTracker::clear() {
+	_Rects.clear();
+}
+
+bool DirtyRectTracker::empty() const {
+	return _Rects.empty();
+}
+
+const std::vector<DirtyRect> &DirtyRectTracker::get_rects() const {
+	return _Rects;
+}
+
+size_t DirtyRectTracker::get_dirty_area() const {
+	size_t res = 0;
+	for (const auto &rect : _Rects) {
+		res += rect.get_area();
+	}
+	return res;
+}
+
+// a grown rectangle may now absorb others, repeat until it is stable
+void DirtyRectTracker::_merge_overlapping(size_t index) {
+	for (bool merged = true; merged;) {
+		merged = false;
+		for (size_t i = 0; i < _Rects.size(); i++) {
+			if (i == index || get_merge_cost(_Rects[index], _Rects[i]) > 0) {
+				continue;
+			}
+
+			_Rects[index] = get_bounding_rect(_Rects[index], _Rects[i]);
+			_Rects.erase(_Rects.begin() + static_cast<std::ptrdiff_t>(i));
+			if (i < index) {
+				--index;
+			}
+			merged = true;
+			break;
+		}
+	}
+}
+
+}  // namespace gfxutils
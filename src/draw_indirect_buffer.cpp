@@ -0,0 +1,131 @@
+#include <gfx-utils-core/draw_indirect_buffer.h>
+
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <algorithm>
+
+namespace gfxutils {
+
+DrawIndirectBuffer::DrawIndirectBufferBuilder::DrawIndirectBufferBuilder(const std::string &name)
+    : IBuilder<DrawIndirectBufferBuilder, DrawIndirectBuffer>(name) {
+}
+
+DrawIndirectBuffer::DrawIndirectBufferBuilder &DrawIndirectBuffer::DrawIndirectBufferBuilder::set_capacity(size_t n_commands) {
+	_Capacity = n_commands;
+	return *this;
+}
+
+DrawIndirectBuffer DrawIndirectBuffer::DrawIndirectBufferBuilder::_build() const {
+	DrawIndirectBuffer res;
+
+	res._set_name(_Name);
+
+	auto capacity_bytes = std::max<size_t>(_Capacity, 1) * sizeof(DrawElementsIndirectCommand);
+
+	GLuint handle = ResourceManager::instance().alloc(ResourceType::VBO);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, handle);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(capacity_bytes), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	res._State = std::make_shared<State>(State{ handle, capacity_bytes, 0, false });
+
+	g_logger->info("DrawIndirectBuffer::DrawIndirectBufferBuilder ({}): successfully built draw indirect buffer ({} bytes)", _Name, capacity_bytes);
+
+	res._set_complete();
+
+	return res;
+}
+
+void DrawIndirectBuffer::set_commands(std::span<const DrawArraysIndirectCommand> commands) const {
+	_set_commands(commands.data(), commands.size(), sizeof(DrawArraysIndirectCommand), false);
+}
+
+void DrawIndirectBuffer::set_commands(std::span<const DrawElementsIndirectCommand> commands) const {
+	_set_commands(commands.data(), commands.size(), sizeof(DrawElementsIndirectCommand), true);
+}
+
+void DrawIndirectBuffer::_set_commands(const void *data, size_t n_commands, size_t command_size, bool is_indexed) const {
+	auto &state = *_State;
+	auto n_bytes = n_commands * command_size;
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, state._BufferHandle);
+	if (n_bytes > state._CapacityBytes) {
+		state._CapacityBytes = std::max(n_bytes, state._CapacityBytes * 2);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(state._CapacityBytes), nullptr, GL_DYNAMIC_DRAW);
+		g_logger->info("DrawIndirectBuffer ({}): grew to {} bytes", _Name, state._CapacityBytes);
+	}
+	if (data != nullptr && n_bytes > 0) {
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(n_bytes), data);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	state._NumCommands = n_commands;
+	state._IsIndexed = is_indexed;
+}
+
+void DrawIndirectBuffer::set_command_count(size_t n_commands, bool is_indexed) const {
+	_set_commands(nullptr, n_commands, is_indexed ? sizeof(DrawElementsIndirectCommand) : sizeof(DrawArraysIndirectCommand), is_indexed);
+}
+
+void DrawIndirectBuffer::bind(size_t binding_point) const {
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, static_cast<GLuint>(binding_point), _State->_BufferHandle);
+}
+
+void DrawIndirectBuffer::draw(const VertexBuffer &vertex_buffer, GLenum mode) const {
+	const auto &state = *_State;
+	if (state._NumCommands == 0 || !_check_vertex_buffer(vertex_buffer)) {
+		return;
+	}
+
+	vertex_buffer.use();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, state._BufferHandle);
+	if (state._IsIndexed) {
+		glMultiDrawElementsIndirect(mode, vertex_buffer.get_index_type(), nullptr, static_cast<GLsizei>(state._NumCommands), 0);
+	} else {
+		glMultiDrawArraysIndirect(mode, nullptr, static_cast<GLsizei>(state._NumCommands), 0);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void DrawIndirectBuffer::draw_indirect_count(const VertexBuffer &vertex_buffer, const StorageBuffer &count_buffer, size_t count_offset, GLenum mode) const {
+	const auto &state = *_State;
+	if (state._NumCommands == 0 || !_check_vertex_buffer(vertex_buffer)) {
+		return;
+	}
+
+	vertex_buffer.use();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, state._BufferHandle);
+	glBindBuffer(GL_PARAMETER_BUFFER, count_buffer._get_handle());
+	auto count_offset_gl = static_cast<GLintptr>(count_offset);
+	auto max_count = static_cast<GLsizei>(state._NumCommands);
+	if (state._IsIndexed) {
+		glMultiDrawElementsIndirectCount(mode, vertex_buffer.get_index_type(), nullptr, count_offset_gl, max_count, 0);
+	} else {
+		glMultiDrawArraysIndirectCount(mode, nullptr, count_offset_gl, max_count, 0);
+	}
+	glBindBuffer(GL_PARAMETER_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool DrawIndirectBuffer::_check_vertex_buffer(const VertexBuffer &vertex_buffer) const {
+	if (_State->_IsIndexed != vertex_buffer.is_indexed()) {
+		g_logger->warn("DrawIndirectBuffer ({}): {} commands can't draw vertex buffer {}, which is {}indexed",
+		               _Name,
+		               _State->_IsIndexed ? "indexed" : "non-indexed",
+		               vertex_buffer.get_name(),
+		               vertex_buffer.is_indexed() ? "" : "not ");
+		return false;
+	}
+	return true;
+}
+
+size_t DrawIndirectBuffer::get_command_count() const {
+	return _State->_NumCommands;
+}
+
+GLuint DrawIndirectBuffer::_get_handle() const {
+	return _State->_BufferHandle;
+}
+
+}  // namespace gfxutils
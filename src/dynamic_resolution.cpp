@@ -0,0 +1,75 @@
+#include <gfx-utils-core/dynamic_resolution.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gfxutils {
+
+namespace {
+
+constexpr float SMOOTHING = 0.25f;    // weight of a new timing in the moving average
+constexpr float DEAD_ZONE = 0.05f;    // relative scale change ignored, so the scale doesn't jitter around the target
+constexpr float STEP = 0.5f;          // part of the way to the ideal scale taken per update
+constexpr float QUANTIZATION = 64.0f;  // scales are multiples of 1 / QUANTIZATION
+
+}  // namespace
+
+DynamicResolutionController::DynamicResolutionController(float target_ms, float min_scale, float max_scale)
+    : _TargetMs(target_ms)
+    , _Scale(1.0f) {
+	set_scale_range(min_scale, max_scale);
+	_Scale = _MaxScale;
+}
+
+void DynamicResolutionController::set_target_ms(float target_ms) {
+	_TargetMs = target_ms;
+}
+
+void DynamicResolutionController::set_scale_range(float min_scale, float max_scale) {
+	_MinScale = std::clamp(std::min(min_scale, max_scale), 1.0f / QUANTIZATION, 1.0f);
+	_MaxScale = std::clamp(std::max(min_scale, max_scale), 1.0f / QUANTIZATION, 1.0f);
+	_Scale = std::clamp(_Scale, _MinScale, _MaxScale);
+}
+
+float DynamicResolutionController::update(std::optional<float> gpu_ms) {
+	if (!gpu_ms.has_value() || *gpu_ms <= 0.0f || _TargetMs <= 0.0f) {
+		return _Scale;
+	}
+
+	_SmoothedMs = _SmoothedMs.has_value() ? std::lerp(*_SmoothedMs, *gpu_ms, SMOOTHING) : *gpu_ms;
+
+	auto ideal_scale = std::clamp(_Scale * std::sqrt(_TargetMs / *_SmoothedMs), _MinScale, _MaxScale);
+	bool is_at_limit = ideal_scale == _MinScale || ideal_scale == _MaxScale;  // reached exactly, the dead zone would stop short of it
+	if (ideal_scale == _Scale || (!is_at_limit && std::abs(ideal_scale - _Scale) <= DEAD_ZONE * _Scale)) {
+		return _Scale;
+	}
+
+	auto next_scale = std::round(std::lerp(_Scale, ideal_scale, STEP) * QUANTIZATION) / QUANTIZATION;
+	if (next_scale == _Scale) {  // less than half a step away
+		next_scale += std::copysign(1.0f / QUANTIZATION, ideal_scale - _Scale);
+	}
+	next_scale = std::clamp(next_scale, _MinScale, _MaxScale);
+	// the average predicts the new scale, rather than waiting for the timings of the old one to fade out
+	*_SmoothedMs *= (next_scale * next_scale) / (_Scale * _Scale);
+	_Scale = next_scale;
+	return _Scale;
+}
+
+void DynamicResolutionController::reset() {
+	_Scale = _MaxScale;
+	_SmoothedMs.reset();
+}
+
+float DynamicResolutionController::get_scale() const {
+	return _Scale;
+}
+
+float DynamicResolutionController::get_target_ms() const {
+	return _TargetMs;
+}
+
+std::optional<float> DynamicResolutionController::get_smoothed_ms() const {
+	return _SmoothedMs;
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,794 @@
+#include <gfx-utils-core/effect_chain.h>
+
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/render_pass_config.h>
+#include <gfx-utils-core/resource_manager.h>
+#include <gfx-utils-core/vertices.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include <json/json.h>
+
+namespace gfxutils {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// set by the chain itself, not exposed as parameters
+bool is_chain_uniform(const std::string &name) {
+	return name == "u_input_texture_sampler" || name == "u_window_size" || name == "u_input_uv_scale" || name == "u_output_image";
+}
+
+// the smallest of RGBA8, R11F_G11F_B10F, RGBA16F and RGBA32F meeting the "precision", "range" and "alpha" of a pass
+// node (see effect_chain.h), GL_NONE if it declares no precision; `error` is set for unknown values
+GLenum get_declared_format(const Json::Value &pass_node, std::string &error) {
+	if (!pass_node.isMember("precision")) {
+		return GL_NONE;
+	}
+
+	auto precision = pass_node["precision"].asString();
+	auto range = pass_node.get("range", "hdr").asString();
+	bool has_alpha = pass_node["alpha"].asBool();
+	if (range != "ldr" && range != "hdr" && range != "signed") {
+		error = std::format("unknown range '{}'", range);
+		return GL_NONE;
+	}
+
+	if (precision == "high") {
+		return GL_RGBA32F;
+	}
+	if (precision == "medium") {
+		return GL_RGBA16F;
+	}
+	if (precision == "low") {
+		if (range == "ldr") {
+			return GL_RGBA8;
+		}
+		// unsigned floats without alpha
+		return range == "hdr" && !has_alpha ? GL_R11F_G11F_B10F : GL_RGBA16F;
+	}
+	error = std::format("unknown precision '{}'", precision);
+	return GL_NONE;
+}
+
+// -1 if the file doesn't exist
+int64_t get_write_time(const std::string &path) {
+	std::error_code error;
+	auto time = fs::last_write_time(path, error);
+	return error ? -1 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+}  // namespace
+
+EffectChain::EffectChainBuilder::EffectChainBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+EffectChain::EffectChainBuilder &EffectChain::EffectChainBuilder::set_config_file(const std::string &config_path) {
+	_ConfigPath = config_path;
+	return *this;
+}
+
+EffectChain::EffectChainBuilder &EffectChain::EffectChainBuilder::set_shader_root(const std::string &shader_root) {
+	_ShaderRoot = shader_root;
+	return *this;
+}
+
+EffectChain EffectChain::EffectChainBuilder::_build() const {
+	EffectChain res;
+
+	res._set_name(_Name);
+
+	res._State = std::make_shared<State>();
+	auto &state = *res._State;
+	state._ConfigPath = _ConfigPath;
+	state._ShaderRoot = _ShaderRoot.empty() ? (fs::path(_ConfigPath).parent_path() / "shader").string() : _ShaderRoot;
+	if (!res._load_config()) {
+		g_logger->warn("EffectChain::EffectChainBuilder ({}): failed to load config file {}: chain won't be built", _Name, _ConfigPath);
+		return res;
+	}
+
+	state._QuadVertexBuffer = VertexBuffer::VertexBufferBuilder(std::format("{}_fullscreen_quad", _Name), g_screen_quad_vertices)
+	                              .add_attribute(2)  // position (vec2)
+	                              .add_attribute(2)  // texture coordinates (vec2)
+	                              .build();
+
+	g_logger->info("EffectChain::EffectChainBuilder ({}): successfully built chain with {} effects", _Name, state._Effects.size());
+
+	res._set_complete();
+
+	return res;
+}
+
+std::vector<std::string> EffectChain::get_categories() const {
+	return is_complete() ? _State->_Categories : std::vector<std::string>{};
+}
+
+std::vector<std::string> EffectChain::get_effect_names(const std::string &category) const {
+	std::vector<std::string> res;
+	if (is_complete()) {
+		for (const auto &effect : _State->_Effects) {
+			if (effect._Category == category) {
+				res.push_back(effect._Name);
+			}
+		}
+	}
+	return res;
+}
+
+bool EffectChain::set_effects(const std::vector<std::string> &effect_names) const {
+	if (!is_complete()) {
+		return false;
+	}
+
+	auto &state = *_State;
+	std::vector<size_t> selection;
+	for (const auto &effect_name : effect_names) {
+		auto iter = std::ranges::find_if(state._Effects, [&](const Effect &effect) { return effect._Name == effect_name; });
+		if (iter == state._Effects.end()) {
+			g_logger->warn("EffectChain ({}): effect '{}' doesn't exist", _Name, effect_name);
+			return false;
+		}
+		selection.push_back(static_cast<size_t>(iter - state._Effects.begin()));
+	}
+
+	if (selection != state._Selection) {
+		state._Selection = selection;
+		state._IsDirty = true;
+	}
+	return true;
+}
+
+std::vector<std::string> EffectChain::get_effects() const {
+	std::vector<std::string> res;
+	if (is_complete()) {
+		for (auto effect_index : _State->_Selection) {
+			res.push_back(_State->_Effects[effect_index]._Name);
+		}
+	}
+	return res;
+}
+
+void EffectChain::set_prefer_compute(bool prefer_compute) const {
+	if (is_complete() && _State->_PreferCompute != prefer_compute) {
+		_State->_PreferCompute = prefer_compute;
+		_State->_IsDirty = true;
+	}
+}
+
+void EffectChain::set_fusion_enabled(bool is_fusion_enabled) const {
+	if (is_complete() && _State->_IsFusionEnabled != is_fusion_enabled) {
+		_State->_IsFusionEnabled = is_fusion_enabled;
+		_State->_IsDirty = true;
+	}
+}
+
+void EffectChain::set_auto_precision_enabled(bool is_auto_precision_enabled) const {
+	if (is_complete()) {
+		_State->_IsAutoPrecisionEnabled = is_auto_precision_enabled;
+	}
+}
+
+std::vector<EffectParameter> EffectChain::get_parameters(const std::string &effect_name) const {
+	if (is_complete()) {
+		for (const auto &effect : _State->_Effects) {
+			if (effect._Name == effect_name) {
+				return effect._Parameters;
+			}
+		}
+	}
+	return {};
+}
+
+bool EffectChain::set_parameter(const std::string &effect_name, const std::string &parameter_name, const glm::vec4 &value) const {
+	if (!is_complete()) {
+		return false;
+	}
+
+	for (auto &effect : _State->_Effects) {
+		if (effect._Name != effect_name) {
+			continue;
+		}
+		for (auto &parameter : effect._Parameters) {
+			if (parameter._Name == parameter_name) {
+				parameter._Value = value;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+std::optional<PooledRenderTarget> EffectChain::execute(const Texture &input,
+                                                       glm::vec2 &uv_scale,
+                                                       const RenderTargetPool &pool,
+                                                       const RenderTargetDesc &target_desc,
+                                                       float resolution_scale) const {
+	if (!is_complete()) {
+		return std::nullopt;
+	}
+	return _execute(input, uv_scale, pool, target_desc, resolution_scale, _State->_IsAutoPrecisionEnabled);
+}
+
+std::optional<float> EffectChain::validate_precision(const Texture &input, const RenderTargetPool &pool, const RenderTargetDesc &target_desc) const {
+	if (!is_complete()) {
+		return std::nullopt;
+	}
+
+	auto run = [&](bool is_auto_precision_enabled) -> std::optional<Image> {
+		glm::vec2 uv_scale(1.0f);
+		auto output = _execute(input, uv_scale, pool, target_desc, 1.0f, is_auto_precision_enabled);
+		if (!output.has_value()) {
+			return std::nullopt;
+		}
+		auto image = output->_Texture.read_to_image(ImageElementType::F32);
+		pool.release(*output);
+		return image;
+	};
+	auto reduced_output = run(true);
+	auto full_output = run(false);
+	if (!reduced_output.has_value() || !full_output.has_value()) {
+		return std::nullopt;
+	}
+
+	float max_error = 0.0f;
+	for (size_t y = 0; y < full_output->get_height(); y++) {
+		const auto *reduced_row = reinterpret_cast<const float *>(reduced_output->row(y));
+		const auto *full_row = reinterpret_cast<const float *>(full_output->row(y));
+		for (size_t x = 0; x < full_output->get_width(); x++) {
+			for (size_t c = 0; c < 3; c++) {  // R11F_G11F_B10F reads back an alpha of 1
+				max_error = std::max(max_error, std::abs(reduced_row[4 * x + c] - full_row[4 * x + c]));
+			}
+		}
+	}
+
+	return max_error;
+}
+
+std::optional<PooledRenderTarget> EffectChain::_execute(const Texture &input,
+                                                        glm::vec2 &uv_scale,
+                                                        const RenderTargetPool &pool,
+                                                        const RenderTargetDesc &target_desc,
+                                                        float resolution_scale,
+                                                        bool is_auto_precision_enabled) const {
+	if (_State->_IsDirty) {
+		_compile();
+	}
+
+	auto &state = *_State;
+	if (state._Steps.empty()) {
+		return std::nullopt;
+	}
+
+	RenderPassConfig render_pass_config;
+	render_pass_config._EnableDepthTest = false;
+	render_pass_config._EnableSRGB = false;
+	render_pass_config._ColorLoadOp = LoadOp::DONT_CARE;  // the quad covers every pixel
+	render_pass_config._ResolutionScale = resolution_scale;
+
+	// ping-pong: each pass renders into the target of the pass before the previous one, or one of its own format
+	std::array<std::optional<PooledRenderTarget>, 2> targets;
+	const Texture *pass_input = &input;
+	for (size_t i = 0; i < state._Steps.size(); i++) {
+		auto &step = state._Steps[i];
+		auto step_target_desc = target_desc;
+		if (is_auto_precision_enabled && step._Format != GL_NONE) {
+			step_target_desc._InternalFormat = step._Format;
+		}
+
+		auto &target_slot = targets[i % 2];
+		if (target_slot.has_value() && target_slot->_Texture.get_info()._InternalFormat != step_target_desc._InternalFormat) {
+			pool.release(*target_slot);
+			target_slot.reset();
+		}
+		if (!target_slot.has_value()) {
+			target_slot = pool.acquire(step_target_desc);
+		}
+		auto &target = *target_slot;
+		auto viewport_size = glm::vec2(target._RenderPass.get_viewport_size(resolution_scale));
+		auto render_area = glm::vec2(target._RenderPass.get_render_area());
+
+		auto [timer_iter, is_new_timer] = state._Timers.try_emplace(std::format("{}|{}", step._Name, step._IsCompute ? "cs" : "fs"));
+		if (is_new_timer) {
+			timer_iter->second = GPUTimer::GPUTimerBuilder(std::format("{}_timer", step._Name)).build();
+		}
+		auto &timer = timer_iter->second;
+
+		auto set_inputs = [&]() {
+			auto &shader_program = step._ShaderProgram;
+			shader_program.use();
+			shader_program.set_uniform("u_window_size", viewport_size);
+			shader_program.set_uniform("u_input_uv_scale", uv_scale);
+			shader_program.set_uniform("u_input_texture_sampler", 0);
+			_apply_parameters(step);
+			pass_input->use(0);
+		};
+
+		timer.begin();
+		if (step._IsCompute) {
+			set_inputs();
+			target._Texture.bind_image(0, GL_WRITE_ONLY);
+			auto n_groups = step._ShaderProgram.get_group_count(static_cast<size_t>(viewport_size.x), static_cast<size_t>(viewport_size.y));
+			glDispatchCompute(static_cast<GLuint>(n_groups[0]), static_cast<GLuint>(n_groups[1]), 1);
+			// the output is sampled by the next pass or the caller, read back, or rendered into again two passes later
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+		} else {
+			target._RenderPass.use(render_pass_config, [&]() {
+				state._QuadVertexBuffer.use();
+				set_inputs();
+
+				glDrawArrays(GL_TRIANGLES, 0, 6);
+			});
+		}
+		timer.end();
+
+		uv_scale = viewport_size / render_area;
+		pass_input = &target._Texture;
+	}
+
+	auto &unused_target = targets[state._Steps.size() % 2];
+	if (unused_target.has_value()) {
+		pool.release(*unused_target);
+	}
+	return targets[(state._Steps.size() - 1) % 2];
+}
+
+std::vector<EffectPassStats> EffectChain::get_pass_stats() const {
+	if (!is_complete()) {
+		return {};
+	}
+	if (_State->_IsDirty) {
+		_compile();
+	}
+
+	std::vector<EffectPassStats> res;
+	for (const auto &step : _State->_Steps) {
+		EffectPassStats stats;
+		stats._Name = step._Name;
+		stats._IsCompute = step._IsCompute;
+		stats._NumConfigPasses = step._NumConfigPasses;
+		stats._Format = _State->_IsAutoPrecisionEnabled ? step._Format : GL_NONE;
+		if (auto iter = _State->_Timers.find(std::format("{}|{}", step._Name, step._IsCompute ? "cs" : "fs")); iter != _State->_Timers.end()) {
+			stats._GPUMs = iter->second.get_ms();
+		}
+		res.push_back(stats);
+	}
+	return res;
+}
+
+bool EffectChain::reload() const {
+	return is_complete() && _load_config();
+}
+
+bool EffectChain::poll_changes() const {
+	if (!is_complete()) {
+		return false;
+	}
+
+	for (const auto &[path, write_time] : _State->_WatchedFiles) {
+		if (get_write_time(path) != write_time) {
+			return reload();
+		}
+	}
+	return false;
+}
+
+bool EffectChain::_load_config() const {
+	auto &state = *_State;
+
+	// a config being saved may be caught half written, its next write time triggers another reload
+	auto config_write_time = get_write_time(state._ConfigPath);
+	auto fail = [&](const std::string &reason) {
+		g_logger->warn("EffectChain ({}): failed to load config file {}: {}", _Name, state._ConfigPath, reason);
+		if (state._WatchedFiles.empty()) {
+			state._WatchedFiles.emplace_back(state._ConfigPath, config_write_time);
+		} else {
+			state._WatchedFiles.front().second = config_write_time;
+		}
+		return false;
+	};
+
+	std::ifstream config_file_in(state._ConfigPath);
+	if (!config_file_in) {
+		return fail("it does not exist");
+	}
+	Json::Value config_root;
+	Json::CharReaderBuilder reader_builder;
+	std::string errors;
+	if (!Json::parseFromStream(reader_builder, config_file_in, &config_root, &errors) || !config_root.isObject()) {
+		return fail(errors.empty() ? "not an object" : errors);
+	}
+
+	std::vector<std::pair<std::string, int64_t>> watched_files{ { state._ConfigPath, config_write_time } };
+	auto get_shader_path = [&](const Json::Value &path_node) {
+		auto path = (fs::path(state._ShaderRoot) / path_node.asString()).string();
+		watched_files.emplace_back(path, get_write_time(path));
+		return path;
+	};
+
+	auto get_pass_format = [&](const std::string &pass_name, const Json::Value &pass_node) {
+		std::string error;
+		auto format = get_declared_format(pass_node, error);
+		if (!error.empty()) {
+			g_logger->warn("EffectChain ({}): pass '{}' declares an {}: the format of the target description will be used", _Name, pass_name, error);
+		}
+		return format;
+	};
+
+	// a pass of the live effect with the same signature, whose programs are still valid
+	auto find_live_pass = [](const Effect *live_effect, bool is_compute, const std::string &signature) -> const Pass * {
+		if (live_effect != nullptr) {
+			for (const auto &pass : is_compute ? live_effect->_ComputePasses : live_effect->_RenderPasses) {
+				if (pass._Signature == signature) {
+					return &pass;
+				}
+			}
+		}
+		return nullptr;
+	};
+
+	// every program linked by this load, the ones that don't end up in a kept effect are released below
+	std::vector<GLuint> built_program_handles;
+	auto load_program = [&](const std::string &pass_name, std::initializer_list<std::pair<ShaderType, std::string>> shaders) {
+		ShaderProgram::ShaderProgramBuilder shader_program_builder(std::format("{}_shader_program", pass_name));
+		for (const auto &[shader_type, path] : shaders) {
+			auto shader = Shader::ShaderBuilder(std::format("{}_{}", pass_name, shader_type == ShaderType::VERTEX_SHADER ? "vs" : (shader_type == ShaderType::FRAGMENT_SHADER ? "fs" : "cs")))
+			                  .set_type(shader_type)
+			                  .set_source_from_file(path)
+			                  .build();
+			if (!shader.is_complete()) {
+				return ShaderProgram{};  // a program would still link without the failed stage
+			}
+			shader_program_builder.add_shader(shader);
+		}
+		auto shader_program = shader_program_builder.build();
+		// the builder allocates the program before linking it, so the handle is valid even if the link failed
+		built_program_handles.push_back(shader_program._get_handle());
+		return shader_program;
+	};
+
+	// the uniforms of a pass the user can tune, with the initial values of the program
+	auto add_parameters = [](Effect &effect, ShaderProgram &shader_program) {
+		for (const auto &uniform_info : shader_program.get_all_uniform_info()) {
+			auto type = uniform_info._Type;
+			if (is_chain_uniform(uniform_info._Name) ||
+			    (type != ShaderDataType::INT && type != ShaderDataType::FLOAT && type != ShaderDataType::VEC2 && type != ShaderDataType::VEC3) ||
+			    std::ranges::any_of(effect._Parameters, [&](const EffectParameter &parameter) { return parameter._Name == uniform_info._Name; })) {
+				continue;
+			}
+
+			EffectParameter parameter;
+			parameter._Name = uniform_info._Name;
+			parameter._Type = type;
+			auto location = shader_program.find_uniform_location(uniform_info._Name);
+			if (type == ShaderDataType::INT) {
+				GLint value = 0;
+				glGetUniformiv(shader_program._get_handle(), location, &value);
+				parameter._Value.x = static_cast<float>(value);
+			} else {
+				std::array<float, 4> value{};
+				glGetUniformfv(shader_program._get_handle(), location, value.data());
+				parameter._Value = glm::vec4(value[0], value[1], value[2], value[3]);
+			}
+			effect._Parameters.push_back(parameter);
+		}
+	};
+
+	std::vector<std::string> categories;
+	std::vector<Effect> effects;
+	size_t n_built_passes = 0;
+	size_t n_kept_passes = 0;
+	for (const auto &category : config_root.getMemberNames()) {
+		for (const auto &effect_node : config_root[category]) {
+			Effect effect;
+			effect._Name = effect_node["fx_name"].asString();
+			effect._Category = category;
+
+			auto live_iter = std::ranges::find_if(state._Effects, [&](const Effect &live_effect) { return live_effect._Name == effect._Name; });
+			const Effect *live_effect = live_iter != state._Effects.end() ? &*live_iter : nullptr;
+
+			bool is_loaded = !effect_node["render_passes"].empty();
+			for (const auto &render_pass_node : effect_node["render_passes"]) {
+				Pass pass;
+				pass._Name = render_pass_node["pass_name"].asString();
+				pass._VsPath = get_shader_path(render_pass_node["vs_path"]);
+				auto vs_write_time = watched_files.back().second;
+				auto fs_path = get_shader_path(render_pass_node["fs_path"]);
+				bool is_pointwise = render_pass_node["pointwise"].asBool();
+				pass._Format = get_pass_format(pass._Name, render_pass_node);
+				pass._Signature = std::format("{}|{}@{}|{}@{}|{}|{}", pass._Name, pass._VsPath, vs_write_time, fs_path, watched_files.back().second, is_pointwise, pass._Format);
+
+				if (const auto *live_pass = find_live_pass(live_effect, false, pass._Signature); live_pass != nullptr) {
+					pass = *live_pass;
+					n_kept_passes++;
+				} else if (is_pointwise) {
+					std::ifstream snippet_in(fs_path);
+					std::stringstream snippet_ss;
+					snippet_ss << snippet_in.rdbuf();
+					pass._Pointwise = PointwisePass{ pass._Name, snippet_ss.str() };
+					n_built_passes++;
+				} else {
+					pass._ShaderProgram = load_program(pass._Name, { { ShaderType::VERTEX_SHADER, pass._VsPath }, { ShaderType::FRAGMENT_SHADER, fs_path } });
+					n_built_passes++;
+				}
+
+				if (pass._Pointwise.has_value()) {
+					// the program of the pass alone (cached, also for kept passes): checks the snippet and gives its parameters
+					auto shader_program = _get_pointwise_program({ &pass }, false);
+					is_loaded = shader_program.is_complete();
+					if (is_loaded) {
+						add_parameters(effect, shader_program);
+					}
+				} else {
+					is_loaded = pass._ShaderProgram.is_complete();
+					if (is_loaded) {
+						add_parameters(effect, pass._ShaderProgram);
+					}
+				}
+				if (!is_loaded) {
+					break;
+				}
+				effect._RenderPasses.push_back(pass);
+			}
+			if (!is_loaded) {
+				if (live_effect != nullptr) {
+					g_logger->warn("EffectChain ({}): effect '{}' has no render passes or they failed to build: its previous version will be kept", _Name, effect._Name);
+					effects.push_back(*live_effect);
+				} else {
+					g_logger->warn("EffectChain ({}): effect '{}' has no render passes or they failed to build: effect will be skipped", _Name, effect._Name);
+				}
+				continue;
+			}
+
+			for (const auto &compute_pass_node : effect_node["compute_passes"]) {
+				Pass pass;
+				pass._Name = compute_pass_node["pass_name"].asString();
+				auto cs_path = get_shader_path(compute_pass_node["cs_path"]);
+				pass._Format = get_pass_format(pass._Name, compute_pass_node);
+				pass._Signature = std::format("{}|{}@{}|{}", pass._Name, cs_path, watched_files.back().second, pass._Format);
+				pass._IsCompute = true;
+
+				if (const auto *live_pass = find_live_pass(live_effect, true, pass._Signature); live_pass != nullptr) {
+					pass = *live_pass;
+					n_kept_passes++;
+				} else {
+					pass._ShaderProgram = load_program(pass._Name, { { ShaderType::COMPUTE_SHADER, cs_path } });
+					n_built_passes++;
+				}
+				if (!pass._ShaderProgram.is_complete()) {
+					g_logger->warn("EffectChain ({}): compute implementation of effect '{}' failed to build: its render passes will be used instead", _Name, effect._Name);
+					effect._ComputePasses.clear();
+					break;
+				}
+				add_parameters(effect, pass._ShaderProgram);
+				effect._ComputePasses.push_back(pass);
+			}
+
+			// the values set on the live effect, for the parameters it still declares
+			if (live_effect != nullptr) {
+				for (auto &parameter : effect._Parameters) {
+					for (const auto &live_parameter : live_effect->_Parameters) {
+						if (live_parameter._Name == parameter._Name && live_parameter._Type == parameter._Type) {
+							parameter._Value = live_parameter._Value;
+						}
+					}
+				}
+			}
+
+			effects.push_back(effect);
+		}
+		categories.push_back(category);
+	}
+
+	// the selection by name, without the effects that were removed
+	std::vector<size_t> selection;
+	for (auto effect_index : state._Selection) {
+		const auto &effect_name = state._Effects[effect_index]._Name;
+		auto iter = std::ranges::find_if(effects, [&](const Effect &effect) { return effect._Name == effect_name; });
+		if (iter == effects.end()) {
+			g_logger->warn("EffectChain ({}): effect '{}' was removed from the config: it's no longer selected", _Name, effect_name);
+			continue;
+		}
+		selection.push_back(static_cast<size_t>(iter - effects.begin()));
+	}
+
+	// the programs of the passes that were rebuilt or removed, and of the passes built by this load but then dropped
+	// with their effect (a failed effect, or a compute implementation that fell back to the render passes)
+	std::unordered_set<GLuint> program_handles;
+	auto for_each_program = [](const std::vector<Effect> &effect_vec, const auto &callback) {
+		for (const auto &effect : effect_vec) {
+			for (const auto *passes : { &effect._RenderPasses, &effect._ComputePasses }) {
+				for (const auto &pass : *passes) {
+					if (pass._ShaderProgram.is_complete()) {
+						callback(pass._ShaderProgram._get_handle());
+					}
+				}
+			}
+		}
+	};
+	for_each_program(effects, [&](GLuint handle) { program_handles.insert(handle); });
+	for_each_program(state._Effects, [&](GLuint handle) {
+		if (program_handles.insert(handle).second) {
+			ResourceManager::instance().release(ResourceType::SHADER_PROGRAM, handle);
+		}
+	});
+	for (auto handle : built_program_handles) {
+		if (program_handles.insert(handle).second) {
+			ResourceManager::instance().release(ResourceType::SHADER_PROGRAM, handle);
+		}
+	}
+
+	bool is_reload = !state._WatchedFiles.empty();
+	state._Categories = std::move(categories);
+	state._Effects = std::move(effects);
+	state._Selection = std::move(selection);
+	state._WatchedFiles = std::move(watched_files);
+	state._IsDirty = true;
+
+	// the generated programs of passes that are gone or changed
+	std::unordered_set<std::string> signatures;
+	for (const auto &effect : state._Effects) {
+		for (const auto &pass : effect._RenderPasses) {
+			signatures.insert(pass._Signature);
+		}
+	}
+	std::erase_if(state._GeneratedPrograms, [&](const auto &entry) {
+		std::stringstream key_ss(entry.first);
+		std::string signature;
+		std::getline(key_ss, signature);  // the variant
+		while (std::getline(key_ss, signature)) {
+			if (!signatures.contains(signature)) {
+				if (entry.second.is_complete()) {
+					ResourceManager::instance().release(ResourceType::SHADER_PROGRAM, entry.second._get_handle());
+				}
+				return true;
+			}
+		}
+		return false;
+	});
+
+	if (is_reload) {
+		g_logger->info("EffectChain ({}): reloaded config file {}: {} passes rebuilt, {} kept", _Name, state._ConfigPath, n_built_passes, n_kept_passes);
+	}
+	return true;
+}
+
+void EffectChain::_compile() const {
+	auto &state = *_State;
+
+	// the passes of the selection, with the index of their effect
+	std::vector<std::pair<const Pass *, size_t>> passes;
+	for (auto effect_index : state._Selection) {
+		for (const auto &pass : _get_passes(state._Effects[effect_index])) {
+			passes.emplace_back(&pass, effect_index);
+		}
+	}
+
+	state._Steps.clear();
+	for (size_t i = 0; i < passes.size();) {
+		auto [pass, effect_index] = passes[i];
+		if (!pass->_Pointwise.has_value()) {
+			Step step;
+			step._Name = pass->_Name;
+			step._ShaderProgram = pass->_ShaderProgram;
+			step._IsCompute = pass->_IsCompute;
+			step._EffectIndices = { effect_index };
+			step._Format = pass->_Format;
+			state._Steps.push_back(step);
+			i++;
+			continue;
+		}
+
+		std::vector<PointwisePass> snippets;
+		for (size_t j = i; j < passes.size() && passes[j].first->_Pointwise.has_value(); j++) {
+			snippets.push_back(*passes[j].first->_Pointwise);
+		}
+
+		auto make_step = [&](size_t n_passes) {
+			Step step;
+			step._IsCompute = state._PreferCompute;
+			step._NumConfigPasses = n_passes;
+			std::vector<const Pass *> run;
+			for (size_t j = i; j < i + n_passes; j++) {
+				run.push_back(passes[j].first);
+				step._Name += (j == i ? "" : "+") + passes[j].first->_Name;
+				if (step._EffectIndices.empty() || step._EffectIndices.back() != passes[j].second) {
+					step._EffectIndices.push_back(passes[j].second);
+				}
+			}
+			step._ShaderProgram = _get_pointwise_program(run, step._IsCompute);
+			step._Format = run.back()->_Format;
+			return step;
+		};
+
+		size_t n_passes = state._IsFusionEnabled ? get_fusible_pass_count(snippets) : 1;
+		auto step = make_step(n_passes);
+		if (!step._ShaderProgram.is_complete() && n_passes > 1) {  // e.g. helpers with the same name, the first pass runs alone
+			n_passes = 1;
+			step = make_step(n_passes);
+		}
+		if (step._ShaderProgram.is_complete()) {
+			state._Steps.push_back(step);
+		}
+		i += n_passes;
+	}
+
+	state._IsDirty = false;
+}
+
+ShaderProgram EffectChain::_get_pointwise_program(const std::vector<const Pass *> &run, bool is_compute) const {
+	std::string key = is_compute ? "cs" : "fs";
+	std::string name;
+	std::vector<PointwisePass> snippets;
+	for (const auto *pass : run) {
+		key += "\n" + pass->_Signature;
+		name += (name.empty() ? "" : "+") + pass->_Name;
+		snippets.push_back(*pass->_Pointwise);
+	}
+
+	auto &programs = _State->_GeneratedPrograms;
+	if (auto iter = programs.find(key); iter != programs.end()) {
+		return iter->second;
+	}
+
+	auto shader_type = is_compute ? ShaderType::COMPUTE_SHADER : ShaderType::FRAGMENT_SHADER;
+	auto generated_shader = Shader::ShaderBuilder(std::format("{}_{}", name, is_compute ? "cs" : "fs"))
+	                            .set_type(shader_type)
+	                            .set_source(generate_pointwise_shader(snippets, shader_type))
+	                            .build();
+
+	ShaderProgram res;
+	if (generated_shader.is_complete()) {  // a program would still link with the vertex shader alone
+		ShaderProgram::ShaderProgramBuilder shader_program_builder(std::format("{}_shader_program", name));
+		if (!is_compute) {
+			shader_program_builder.add_shader(Shader::ShaderBuilder(std::format("{}_vs", name))
+			                                      .set_type(ShaderType::VERTEX_SHADER)
+			                                      .set_source_from_file(run.front()->_VsPath)
+			                                      .build());
+		}
+		res = shader_program_builder.add_shader(generated_shader).build();
+	}
+
+	programs.emplace(key, res);
+	return res;
+}
+
+const std::vector<EffectChain::Pass> &EffectChain::_get_passes(const Effect &effect) const {
+	return _State->_PreferCompute && !effect._ComputePasses.empty() ? effect._ComputePasses : effect._RenderPasses;
+}
+
+void EffectChain::_apply_parameters(Step &step) const {
+	for (auto effect_index : step._EffectIndices) {
+		for (const auto &parameter : _State->_Effects[effect_index]._Parameters) {
+			if (step._ShaderProgram.find_uniform_location(parameter._Name) == -1) {
+				continue;
+			}
+			switch (parameter._Type) {
+			case ShaderDataType::INT:
+				step._ShaderProgram.set_uniform(parameter._Name, static_cast<int>(parameter._Value.x));
+				break;
+			case ShaderDataType::FLOAT:
+				step._ShaderProgram.set_uniform(parameter._Name, parameter._Value.x);
+				break;
+			case ShaderDataType::VEC2:
+				step._ShaderProgram.set_uniform(parameter._Name, glm::vec2(parameter._Value.x, parameter._Value.y));
+				break;
+			case ShaderDataType::VEC3:
+				step._ShaderProgram.set_uniform(parameter._Name, glm::vec3(parameter._Value.x, parameter._Value.y, parameter._Value.z));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
+}  // namespace gfxutils
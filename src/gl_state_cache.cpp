@@ -0,0 +1,176 @@
+#include <gfx-utils-core/gl_state_cache.h>
+
+namespace gfxutils {
+
+GLStateCache::GLStateCache() {
+	invalidate();
+}
+
+void GLStateCache::use_program(GLuint program) {
+	if (_Program == program) {
+		++_Stats._NumSkipped;
+		return;
+	}
+	glUseProgram(program);
+	_Program = program;
+	++_Stats._NumCalls;
+}
+
+void GLStateCache::bind_vertex_array(GLuint vertex_array) {
+	if (_VertexArray == vertex_array) {
+		++_Stats._NumSkipped;
+		return;
+	}
+	glBindVertexArray(vertex_array);
+	_VertexArray = vertex_array;
+	++_Stats._NumCalls;
+}
+
+void GLStateCache::bind_framebuffer(GLenum target, GLuint framebuffer) {
+	bool is_draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+	bool is_read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+	if ((!is_draw || _DrawFramebuffer == framebuffer) && (!is_read || _ReadFramebuffer == framebuffer)) {
+		++_Stats._NumSkipped;
+		return;
+	}
+	glBindFramebuffer(target, framebuffer);
+	if (is_draw) {
+		_DrawFramebuffer = framebuffer;
+	}
+	if (is_read) {
+		_ReadFramebuffer = framebuffer;
+	}
+	++_Stats._NumCalls;
+}
+
+void GLStateCache::bind_texture(size_t texture_unit, GLenum target, GLuint texture) {
+	auto target_index = _get_target_index(target);
+	if (texture_unit < MAX_TEXTURE_UNITS && target_index < N_TEXTURE_TARGETS && _Textures[texture_unit][target_index] == texture) {
+		++_Stats._NumSkipped;
+		return;
+	}
+
+	_set_active_texture_unit(texture_unit);
+	glBindTexture(target, texture);
+	if (texture_unit < MAX_TEXTURE_UNITS && target_index < N_TEXTURE_TARGETS) {
+		_Textures[texture_unit][target_index] = texture;
+	}
+	++_Stats._NumCalls;
+}
+
+void GLStateCache::bind_texture(GLenum target, GLuint texture) {
+	bind_texture(_ActiveTextureUnit == UNKNOWN ? 0 : _ActiveTextureUnit, target, texture);
+}
+
+void GLStateCache::set_viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	std::array<GLint, 4> viewport{ x, y, width, height };
+	if (_Viewport == viewport) {
+		++_Stats._NumSkipped;
+		return;
+	}
+	glViewport(x, y, width, height);
+	_Viewport = viewport;
+	++_Stats._NumCalls;
+}
+
+void GLStateCache::set_capability(GLenum capability, bool enabled) {
+	auto iter = _Capabilities.find(capability);
+	if (iter != _Capabilities.end() && iter->second == enabled) {
+		++_Stats._NumSkipped;
+		return;
+	}
+
+	if (enabled) {
+		glEnable(capability);
+	} else {
+		glDisable(capability);
+	}
+	_Capabilities[capability] = enabled;
+	++_Stats._NumCalls;
+}
+
+bool GLStateCache::is_enabled(GLenum capability) {
+	auto iter = _Capabilities.find(capability);
+	if (iter != _Capabilities.end()) {
+		return iter->second;
+	}
+	bool enabled = glIsEnabled(capability) == GL_TRUE;
+	_Capabilities[capability] = enabled;
+	return enabled;
+}
+
+void GLStateCache::forget_program(GLuint program) {
+	if (_Program == program) {
+		_Program = UNKNOWN;
+	}
+}
+
+void GLStateCache::forget_vertex_array(GLuint vertex_array) {
+	if (_VertexArray == vertex_array) {
+		_VertexArray = UNKNOWN;
+	}
+}
+
+void GLStateCache::forget_framebuffer(GLuint framebuffer) {
+	if (_DrawFramebuffer == framebuffer) {
+		_DrawFramebuffer = UNKNOWN;
+	}
+	if (_ReadFramebuffer == framebuffer) {
+		_ReadFramebuffer = UNKNOWN;
+	}
+}
+
+void GLStateCache::forget_texture(GLuint texture) {
+	for (auto &unit_textures : _Textures) {
+		for (auto &unit_texture : unit_textures) {
+			if (unit_texture == texture) {
+				unit_texture = UNKNOWN;
+			}
+		}
+	}
+}
+
+void GLStateCache::invalidate() {
+	_Program = UNKNOWN;
+	_VertexArray = UNKNOWN;
+	_DrawFramebuffer = UNKNOWN;
+	_ReadFramebuffer = UNKNOWN;
+	_ActiveTextureUnit = UNKNOWN;
+	for (auto &unit_textures : _Textures) {
+		unit_textures.fill(UNKNOWN);
+	}
+	_Viewport = { 0, 0, -1, -1 };
+	_Capabilities.clear();
+}
+
+GLStateCacheStats GLStateCache::get_stats() const {
+	return _Stats;
+}
+
+void GLStateCache::reset_stats() {
+	_Stats = {};
+}
+
+size_t GLStateCache::_get_target_index(GLenum target) {
+	switch (target) {
+	case GL_TEXTURE_2D:
+		return 0;
+	case GL_TEXTURE_2D_ARRAY:
+		return 1;
+	case GL_TEXTURE_2D_MULTISAMPLE:
+		return 2;
+	default:
+		return N_TEXTURE_TARGETS;
+	}
+}
+
+void GLStateCache::_set_active_texture_unit(size_t texture_unit) {
+	if (_ActiveTextureUnit == texture_unit) {
+		return;
+	}
+	glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + texture_unit));
+	_ActiveTextureUnit = texture_unit;
+	++_Stats._NumCalls;
+}
+
+}  // namespace gfxutils
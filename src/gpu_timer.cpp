@@ -0,0 +1,124 @@
+#include <gfx-utils-core/gpu_timer.h>
+
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+namespace gfxutils {
+
+GPUTimer::GPUTimerBuilder::GPUTimerBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+GPUTimer::GPUTimerBuilder &GPUTimer::GPUTimerBuilder::set_query_count(size_t n_queries) {
+	_NumQueries = n_queries;
+	return *this;
+}
+
+GPUTimer GPUTimer::GPUTimerBuilder::_build() const {
+	GPUTimer res;
+
+	res._set_name(_Name);
+
+	if (_NumQueries == 0) {
+		g_logger->warn("GPUTimer::GPUTimerBuilder ({}): query count is 0: timer won't be built", _Name);
+		return res;
+	}
+
+	res._State = std::make_shared<State>();
+	for (size_t i = 0; i < 2 * _NumQueries; i++) {
+		res._State->_Queries.push_back(ResourceManager::instance().alloc(ResourceType::QUERY));
+	}
+
+	g_logger->info("GPUTimer::GPUTimerBuilder ({}): successfully built timer with {} queries", _Name, 2 * _NumQueries);
+
+	res._set_complete();
+
+	return res;
+}
+
+void GPUTimer::begin() const {
+	if (!is_complete()) {
+		return;
+	}
+
+	_poll();
+
+	auto &state = *_State;
+	if (state._IsRunning) {
+		g_logger->warn("GPUTimer ({}): begin() called twice without end()", _Name);
+		return;
+	}
+	auto n_measurements = state._Queries.size() / 2;
+	if (state._NumPending == n_measurements) {
+		++state._Stats._NumSkipped;
+		return;
+	}
+
+	auto measurement_index = (state._OldestPending + state._NumPending) % n_measurements;
+	glQueryCounter(state._Queries[2 * measurement_index], GL_TIMESTAMP);
+	state._IsRunning = true;
+}
+
+void GPUTimer::end() const {
+	if (!is_complete() || !_State->_IsRunning) {
+		return;
+	}
+
+	auto &state = *_State;
+	auto measurement_index = (state._OldestPending + state._NumPending) % (state._Queries.size() / 2);
+	glQueryCounter(state._Queries[2 * measurement_index + 1], GL_TIMESTAMP);
+	state._IsRunning = false;
+	++state._NumPending;
+}
+
+std::optional<float> GPUTimer::get_ms() const {
+	if (!is_complete()) {
+		return std::nullopt;
+	}
+	_poll();
+	return _State->_LastMs;
+}
+
+std::optional<float> GPUTimer::take_ms() const {
+	if (!is_complete()) {
+		return std::nullopt;
+	}
+	_poll();
+	if (!_State->_HasNewResult) {
+		return std::nullopt;
+	}
+	_State->_HasNewResult = false;
+	return _State->_LastMs;
+}
+
+GPUTimerStats GPUTimer::get_stats() const {
+	return is_complete() ? _State->_Stats : GPUTimerStats{};
+}
+
+void GPUTimer::_poll() const {
+	auto &state = *_State;
+	while (state._NumPending > 0) {
+		auto begin_query = state._Queries[2 * state._OldestPending];
+		auto end_query = state._Queries[2 * state._OldestPending + 1];
+
+		// the end timestamp is written after the begin one
+		GLint is_available = GL_FALSE;
+		glGetQueryObjectiv(end_query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+		if (is_available == GL_FALSE) {
+			break;
+		}
+
+		GLuint64 begin_ns = 0;
+		GLuint64 end_ns = 0;
+		glGetQueryObjectui64v(begin_query, GL_QUERY_RESULT, &begin_ns);
+		glGetQueryObjectui64v(end_query, GL_QUERY_RESULT, &end_ns);
+		state._LastMs = static_cast<float>(static_cast<double>(end_ns - begin_ns) / 1e6);
+		state._HasNewResult = true;
+		++state._Stats._NumResults;
+
+		state._OldestPending = (state._OldestPending + 1) % (state._Queries.size() / 2);
+		--state._NumPending;
+	}
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,203 @@
+#include <gfx-utils-core/image.h>
+
+#include <gfx-utils-core/image_kernels.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace gfxutils {
+
+namespace {
+
+size_t round_up(size_t value, size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+void *alloc_aligned(size_t size) {
+	size = round_up(std::max<size_t>(size, 1), Image::DATA_ALIGNMENT);  // std::aligned_alloc wants a multiple of the alignment
+#ifdef _MSC_VER
+	return _aligned_malloc(size, Image::DATA_ALIGNMENT);
+#else
+	return std::aligned_alloc(Image::DATA_ALIGNMENT, size);
+#endif
+}
+
+void free_aligned(void *ptr) {
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+// converts a row of n_pixels pixels to F32, applying SRGB_TO_LINEAR if requested
+void row_to_f32(const uint8_t *src, ImageElementType src_type, float *dst, size_t n_pixels, size_t n_channels, ColorConversion color_conversion) {
+	size_t n_elements = n_pixels * n_channels;
+	bool to_linear = color_conversion == ColorConversion::SRGB_TO_LINEAR;
+
+	switch (src_type) {
+	case ImageElementType::U8:
+		if (to_linear) {
+			convert_srgb_u8_to_linear_f32(src, dst, n_pixels, n_channels);  // table lookup, no need for a second pass
+			return;
+		}
+		convert_u8_to_f32(src, dst, n_elements);
+		break;
+	case ImageElementType::F16:
+		convert_f16_to_f32(reinterpret_cast<const uint16_t *>(src), dst, n_elements);
+		break;
+	default:
+		if (reinterpret_cast<const uint8_t *>(dst) != src) {
+			std::memcpy(dst, src, n_elements * sizeof(float));
+		}
+		break;
+	}
+
+	if (to_linear) {
+		convert_srgb_to_linear_f32(dst, n_pixels, n_channels);
+	}
+}
+
+// converts a F32 row to dst_type, applying LINEAR_TO_SRGB if requested, `src` may be modified
+void row_from_f32(float *src, uint8_t *dst, ImageElementType dst_type, size_t n_pixels, size_t n_channels, ColorConversion color_conversion) {
+	size_t n_elements = n_pixels * n_channels;
+	bool to_srgb = color_conversion == ColorConversion::LINEAR_TO_SRGB;
+
+	if (dst_type == ImageElementType::U8) {
+		if (to_srgb) {
+			convert_linear_f32_to_srgb_u8(src, dst, n_pixels, n_channels);  // table lookup as well
+		} else {
+			convert_f32_to_u8(src, dst, n_elements);
+		}
+		return;
+	}
+
+	if (to_srgb) {
+		convert_linear_to_srgb_f32(src, n_pixels, n_channels);
+	}
+
+	if (dst_type == ImageElementType::F16) {
+		convert_f32_to_f16(src, reinterpret_cast<uint16_t *>(dst), n_elements);
+	} else if (reinterpret_cast<uint8_t *>(src) != dst) {
+		std::memcpy(dst, src, n_elements * sizeof(float));
+	}
+}
+
+}  // namespace
+
+size_t get_image_element_size(ImageElementType element_type) {
+	switch (element_type) {
+	case ImageElementType::U8:
+		return sizeof(uint8_t);
+	case ImageElementType::F16:
+		return sizeof(uint16_t);
+	case ImageElementType::F32:
+		return sizeof(float);
+	default:
+		return 0;
+	}
+}
+
+Image::Image(size_t width, size_t height, size_t channels, ImageElementType element_type, size_t row_alignment)
+    : _Width(width)
+    , _Height(height)
+    , _Channels(channels)
+    , _ElementType(element_type)
+    , _RowStride(round_up(width * get_pixel_size(), std::lcm(std::max<size_t>(row_alignment, 1), std::max<size_t>(get_pixel_size(), 1))))
+    , _Data(static_cast<uint8_t *>(alloc_aligned(_RowStride * height)), free_aligned) {
+}
+
+Image Image::adopt(void *data, size_t width, size_t height, size_t channels, ImageElementType element_type, Deleter deleter) {
+	Image res;
+	res._Width = width;
+	res._Height = height;
+	res._Channels = channels;
+	res._ElementType = element_type;
+	res._RowStride = width * channels * get_image_element_size(element_type);
+	res._Data = std::unique_ptr<uint8_t, Deleter>(static_cast<uint8_t *>(data), deleter);
+	return res;
+}
+
+Image Image::convert(ImageElementType element_type, ColorConversion color_conversion) const {
+	Image res(_Width, _Height, _Channels, element_type);
+	if (empty()) {
+		return res;
+	}
+
+	if (element_type == _ElementType && color_conversion == ColorConversion::NONE) {
+		for (size_t y = 0; y < _Height; y++) {
+			std::memcpy(res.row(y), row(y), res.get_row_stride());
+		}
+		return res;
+	}
+
+	// every other conversion goes through F32, in place when the destination is F32 already
+	std::vector<float> scratch(element_type == ImageElementType::F32 ? 0 : _Width * _Channels);
+	for (size_t y = 0; y < _Height; y++) {
+		float *row_f32 = (scratch.empty() ? reinterpret_cast<float *>(res.row(y)) : scratch.data());
+		row_to_f32(row(y), _ElementType, row_f32, _Width, _Channels, color_conversion);
+		row_from_f32(row_f32, res.row(y), element_type, _Width, _Channels, color_conversion);
+	}
+
+	return res;
+}
+
+Image Image::swizzle(const std::vector<size_t> &order) const {
+	if (empty() || std::any_of(order.begin(), order.end(), [&](size_t c) { return c >= _Channels; })) {
+		return {};
+	}
+
+	Image res(_Width, _Height, order.size(), _ElementType);
+	for (size_t y = 0; y < _Height; y++) {
+		swizzle_pixels(row(y), res.row(y), _Width, get_image_element_size(_ElementType), _Channels, order.data(), order.size());
+	}
+
+	return res;
+}
+
+void Image::flip_vertically() {
+	if (empty()) {
+		return;
+	}
+
+	for (size_t y = 0; y < _Height / 2; y++) {
+		uint8_t *top = row(y);
+		std::swap_ranges(top, top + _RowStride, row(_Height - 1 - y));
+	}
+}
+
+void Image::copy_region_clamped(ptrdiff_t x0, ptrdiff_t y0, size_t width, size_t height, uint8_t *dst, bool bottom_up) const {
+	if (empty()) {
+		return;
+	}
+
+	size_t pixel_size = get_pixel_size();
+	auto image_width = static_cast<ptrdiff_t>(_Width);
+	auto region_width = static_cast<ptrdiff_t>(width);
+
+	// the part of each row inside the image is one memcpy, the rest repeats the edge pixels
+	ptrdiff_t x_begin = std::clamp<ptrdiff_t>(x0, 0, image_width);
+	ptrdiff_t x_end = std::clamp<ptrdiff_t>(x0 + region_width, 0, image_width);
+	auto n_left = static_cast<size_t>(std::clamp<ptrdiff_t>(-x0, 0, region_width));
+	auto n_inside = static_cast<size_t>(std::max<ptrdiff_t>(x_end - x_begin, 0));
+	size_t n_right = width - n_left - n_inside;
+
+	for (size_t r = 0; r < height; r++) {
+		auto src_y = static_cast<size_t>(std::clamp<ptrdiff_t>(y0 + static_cast<ptrdiff_t>(r), 0, static_cast<ptrdiff_t>(_Height) - 1));
+		const uint8_t *src = row(src_y);
+		uint8_t *dst_row = dst + ((bottom_up ? height - 1 - r : r) * width * pixel_size);
+
+		for (size_t i = 0; i < n_left; i++) {
+			std::memcpy(dst_row + (i * pixel_size), src, pixel_size);
+		}
+		std::memcpy(dst_row + (n_left * pixel_size), src + (static_cast<size_t>(x_begin) * pixel_size), n_inside * pixel_size);
+		const uint8_t *right_pixel = src + ((_Width - 1) * pixel_size);
+		for (size_t i = 0; i < n_right; i++) {
+			std::memcpy(dst_row + ((n_left + n_inside + i) * pixel_size), right_pixel, pixel_size);
+		}
+	}
+}
+
+}  // namespace gfxutils
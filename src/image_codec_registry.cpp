@@ -0,0 +1,220 @@
+#include <gfx-utils-core/image_codec_registry.h>
+
+#include <gfx-utils-core/image_codecs.h>
+#include <gfx-utils-core/logger.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+namespace gfxutils {
+
+namespace {
+
+std::string get_lower_extension(const std::string &file_path) {
+	auto ext = std::filesystem::path(file_path).extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) {
+		return static_cast<char>(std::tolower(ch));
+	});
+	return ext;
+}
+
+// fallbacks for codecs without streaming support, they hold the whole image
+class InMemoryImageReader : public IImageReader {
+private:
+	Image _Image;
+	size_t _RowsRead = 0;
+
+public:
+	explicit InMemoryImageReader(Image &&image)
+	    : _Image(std::move(image)) {
+	}
+
+	[[nodiscard]] size_t get_width() const override {
+		return _Image.get_width();
+	}
+
+	[[nodiscard]] size_t get_height() const override {
+		return _Image.get_height();
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return _Image.get_element_type();
+	}
+
+	[[nodiscard]] Image read_rows(size_t n_rows) override {
+		n_rows = std::min(n_rows, _Image.get_height() - _RowsRead);
+		if (n_rows == 0) {
+			return {};
+		}
+
+		Image res(_Image.get_width(), n_rows, _Image.get_channels(), _Image.get_element_type());
+		size_t row_size = _Image.get_width() * _Image.get_pixel_size();
+		for (size_t y = 0; y < n_rows; y++) {
+			std::memcpy(res.row(y), _Image.row(_RowsRead + y), row_size);
+		}
+
+		_RowsRead += n_rows;
+		return res;
+	}
+};
+
+class InMemoryImageWriter : public IImageWriter {
+private:
+	std::string _FilePath;
+	std::shared_ptr<IImageCodec> _Codec;
+	Image _Image;
+	size_t _RowsWritten = 0;
+
+public:
+	InMemoryImageWriter(const std::string &file_path, const std::shared_ptr<IImageCodec> &codec, size_t width, size_t height, size_t n_channels)
+	    : _FilePath(file_path)
+	    , _Codec(codec)
+	    , _Image(width, height, n_channels, codec->get_encode_element_type()) {
+	}
+
+	[[nodiscard]] ImageElementType get_element_type() const override {
+		return _Image.get_element_type();
+	}
+
+	bool write_rows(const Image &rows) override {
+		if (rows.get_element_type() != _Image.get_element_type()) {
+			return write_rows(rows.convert(_Image.get_element_type()));
+		}
+
+		if (rows.get_width() != _Image.get_width() || rows.get_channels() != _Image.get_channels() ||
+		    _RowsWritten + rows.get_height() > _Image.get_height()) {
+			g_logger->warn("ImageCodecRegistry: rows of unexpected size written to {}", _FilePath);
+			return false;
+		}
+
+		size_t row_size = _Image.get_width() * _Image.get_pixel_size();
+		for (size_t y = 0; y < rows.get_height(); y++) {
+			std::memcpy(_Image.row(_RowsWritten + y), rows.row(y), row_size);
+		}
+
+		_RowsWritten += rows.get_height();
+		return true;
+	}
+
+	bool finish() override {
+		return _RowsWritten == _Image.get_height() && _Codec->encode(_FilePath, _Image);
+	}
+};
+
+}  // namespace
+
+ImageCodecRegistry::ImageCodecRegistry() {
+	register_codec(std::make_shared<StbImageCodec>());
+	register_codec(std::make_shared<PngCodec>());
+	register_codec(std::make_shared<QoiCodec>());
+	register_codec(std::make_shared<PfmCodec>());
+	register_codec(std::make_shared<HdrCodec>());
+}
+
+void ImageCodecRegistry::register_codec(const std::shared_ptr<IImageCodec> &codec) {
+	_Codecs.push_back(codec);
+}
+
+std::shared_ptr<IImageCodec> ImageCodecRegistry::find_codec(const std::string &codec_name) const {
+	for (auto it = _Codecs.rbegin(); it != _Codecs.rend(); ++it) {
+		if ((*it)->get_name() == codec_name) {
+			return *it;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<IImageCodec> ImageCodecRegistry::find_decoder_by_extension(const std::string &file_path) const {
+	auto ext = get_lower_extension(file_path);
+	for (auto it = _Codecs.rbegin(); it != _Codecs.rend(); ++it) {
+		auto exts = (*it)->get_extensions();
+		if ((*it)->can_decode() && std::find(exts.begin(), exts.end(), ext) != exts.end()) {
+			return *it;
+		}
+	}
+	return nullptr;
+}
+
+std::shared_ptr<IImageCodec> ImageCodecRegistry::find_encoder_by_extension(const std::string &file_path) const {
+	auto ext = get_lower_extension(file_path);
+	for (auto it = _Codecs.rbegin(); it != _Codecs.rend(); ++it) {
+		auto exts = (*it)->get_extensions();
+		if ((*it)->can_encode() && std::find(exts.begin(), exts.end(), ext) != exts.end()) {
+			return *it;
+		}
+	}
+	return nullptr;
+}
+
+Image ImageCodecRegistry::decode(const std::string &file_path, const std::string &codec_name) const {
+	auto codec = (codec_name.empty() ? find_decoder_by_extension(file_path) : find_codec(codec_name));
+	if (codec == nullptr || !codec->can_decode()) {
+		g_logger->warn("ImageCodecRegistry: no decoder available for {}", file_path);
+		return {};
+	}
+
+	auto image = codec->decode(file_path);
+	if (image.empty()) {
+		g_logger->warn("ImageCodecRegistry: codec '{}' failed to decode {}", codec->get_name(), file_path);
+	}
+	return image;
+}
+
+bool ImageCodecRegistry::encode(const std::string &file_path, const Image &image, const std::string &codec_name) const {
+	auto codec = (codec_name.empty() ? find_encoder_by_extension(file_path) : find_codec(codec_name));
+	if (codec == nullptr || !codec->can_encode()) {
+		g_logger->warn("ImageCodecRegistry: no encoder available for {}", file_path);
+		return false;
+	}
+
+	bool ok = false;
+	if (image.get_element_type() == codec->get_encode_element_type()) {
+		ok = codec->encode(file_path, image);
+	} else {
+		ok = codec->encode(file_path, image.convert(codec->get_encode_element_type()));
+	}
+
+	if (!ok) {
+		g_logger->warn("ImageCodecRegistry: codec '{}' failed to encode {}", codec->get_name(), file_path);
+	}
+	return ok;
+}
+
+std::unique_ptr<IImageReader> ImageCodecRegistry::open_reader(const std::string &file_path, const std::string &codec_name) const {
+	auto codec = (codec_name.empty() ? find_decoder_by_extension(file_path) : find_codec(codec_name));
+	if (codec == nullptr || !codec->can_decode()) {
+		g_logger->warn("ImageCodecRegistry: no decoder available for {}", file_path);
+		return nullptr;
+	}
+
+	if (auto reader = codec->open_reader(file_path)) {
+		return reader;
+	}
+
+	g_logger->info("ImageCodecRegistry: codec '{}' can't stream {}, decoding it as a whole", codec->get_name(), file_path);
+	auto image = decode(file_path, codec->get_name());
+	return (image.empty() ? nullptr : std::make_unique<InMemoryImageReader>(std::move(image)));
+}
+
+std::unique_ptr<IImageWriter> ImageCodecRegistry::open_writer(const std::string &file_path,
+                                                              size_t width,
+                                                              size_t height,
+                                                              size_t n_channels,
+                                                              const std::string &codec_name) const {
+	auto codec = (codec_name.empty() ? find_encoder_by_extension(file_path) : find_codec(codec_name));
+	if (codec == nullptr || !codec->can_encode()) {
+		g_logger->warn("ImageCodecRegistry: no encoder available for {}", file_path);
+		return nullptr;
+	}
+
+	if (auto writer = codec->open_writer(file_path, width, height, n_channels)) {
+		return writer;
+	}
+
+	g_logger->info("ImageCodecRegistry: codec '{}' can't stream {}, encoding it as a whole", codec->get_name(), file_path);
+	return std::make_unique<InMemoryImageWriter>(file_path, codec, width, height, n_channels);
+}
+
+}  // namespace gfxutils
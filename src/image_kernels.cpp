@@ -0,0 +1,398 @@
+#include <gfx-utils-core/image_kernels.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GFXUTILS_IMAGE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define GFXUTILS_TARGET_AVX2
+#else
+#define GFXUTILS_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+#endif
+
+namespace gfxutils {
+
+namespace {
+
+// scalar kernels, also used for the tails of the SIMD ones
+
+uint8_t f32_to_u8(float value) {
+	// same as the SIMD paths: truncation after +0.5
+	return static_cast<uint8_t>((std::clamp(value, 0.0f, 1.0f) * 255.0f) + 0.5f);
+}
+
+// https://gist.github.com/rygorous/2156668 (float_to_half_fast3_rtne / half_to_float)
+uint16_t f32_to_f16(float value) {
+	constexpr uint32_t F32_INFINITY = 255u << 23;
+	constexpr uint32_t F16_MAX = (127u + 16u) << 23;
+	constexpr uint32_t DENORM_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	uint32_t bits = std::bit_cast<uint32_t>(value);
+	uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	uint16_t res = 0;
+	if (bits >= F16_MAX) {  // overflow to infinity, NaN stays NaN
+		res = (bits > F32_INFINITY ? 0x7e00 : 0x7c00);
+	} else if (bits < (113u << 23)) {  // subnormal or zero: let the FPU round the mantissa
+		float shifted = std::bit_cast<float>(bits) + std::bit_cast<float>(DENORM_MAGIC);
+		res = static_cast<uint16_t>(std::bit_cast<uint32_t>(shifted) - DENORM_MAGIC);
+	} else {
+		uint32_t is_mantissa_odd = (bits >> 13) & 1;
+		bits -= 112u << 23;  // rebias the exponent
+		bits += 0xfff + is_mantissa_odd;
+		res = static_cast<uint16_t>(bits >> 13);
+	}
+
+	return static_cast<uint16_t>(res | (sign >> 16));
+}
+
+float f16_to_f32(uint16_t value) {
+	constexpr uint32_t SHIFTED_EXPONENT = 0x7c00u << 13;
+
+	uint32_t bits = (value & 0x7fffu) << 13;
+	uint32_t exponent = bits & SHIFTED_EXPONENT;
+	bits += (127u - 15u) << 23;
+
+	if (exponent == SHIFTED_EXPONENT) {  // infinity or NaN
+		bits += (128u - 16u) << 23;
+	} else if (exponent == 0) {  // subnormal or zero: renormalize
+		bits += 1u << 23;
+		bits = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) - std::bit_cast<float>(113u << 23));
+	}
+
+	return std::bit_cast<float>(bits | ((value & 0x8000u) << 16));
+}
+
+float srgb_to_linear(float value) {
+	return (value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f));
+}
+
+float linear_to_srgb(float value) {
+	value = std::clamp(value, 0.0f, 1.0f);
+	return (value <= 0.0031308f ? value * 12.92f : (1.055f * std::pow(value, 1.0f / 2.4f)) - 0.055f);
+}
+
+// linear -> sRGB U8 through a table indexed by the quantized linear value,
+// 4096 entries keep the step below one U8 level even at the steep start of the curve
+constexpr size_t LINEAR_TO_SRGB_LUT_SIZE = 4096;
+
+const std::array<float, 256> &get_srgb_to_linear_lut() {
+	static const auto lut = []() {
+		std::array<float, 256> res{};
+		for (size_t i = 0; i < res.size(); i++) {
+			res[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+		}
+		return res;
+	}();
+	return lut;
+}
+
+const std::array<uint8_t, LINEAR_TO_SRGB_LUT_SIZE> &get_linear_to_srgb_lut() {
+	static const auto lut = []() {
+		std::array<uint8_t, LINEAR_TO_SRGB_LUT_SIZE> res{};
+		for (size_t i = 0; i < res.size(); i++) {
+			res[i] = f32_to_u8(linear_to_srgb(static_cast<float>(i) / static_cast<float>(LINEAR_TO_SRGB_LUT_SIZE - 1)));
+		}
+		return res;
+	}();
+	return lut;
+}
+
+size_t get_color_channel_count(size_t n_channels) {
+	return (n_channels == 2 || n_channels == 4 ? n_channels - 1 : n_channels);
+}
+
+void convert_u8_to_f32_scalar(const uint8_t *src, float *dst, size_t n_elements) {
+	for (size_t i = 0; i < n_elements; i++) {
+		dst[i] = static_cast<float>(src[i]) * (1.0f / 255.0f);
+	}
+}
+
+void convert_f32_to_u8_scalar(const float *src, uint8_t *dst, size_t n_elements) {
+	for (size_t i = 0; i < n_elements; i++) {
+		dst[i] = f32_to_u8(src[i]);
+	}
+}
+
+void convert_f32_to_f16_scalar(const float *src, uint16_t *dst, size_t n_elements) {
+	for (size_t i = 0; i < n_elements; i++) {
+		dst[i] = f32_to_f16(src[i]);
+	}
+}
+
+void convert_f16_to_f32_scalar(const uint16_t *src, float *dst, size_t n_elements) {
+	for (size_t i = 0; i < n_elements; i++) {
+		dst[i] = f16_to_f32(src[i]);
+	}
+}
+
+void swizzle_u8x4_scalar(const uint8_t *src, uint8_t *dst, size_t n_pixels, const size_t *order) {
+	for (size_t i = 0; i < n_pixels; i++) {
+		std::array<uint8_t, 4> pixel;
+		std::memcpy(pixel.data(), src + (i * 4), 4);
+		for (size_t c = 0; c < 4; c++) {
+			dst[(i * 4) + c] = pixel[order[c]];
+		}
+	}
+}
+
+#ifdef GFXUTILS_IMAGE_KERNELS_X86
+
+// SSE2 is part of x86-64, so these need no dispatch
+
+void convert_u8_to_f32_sse2(const uint8_t *src, float *dst, size_t n_elements) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= n_elements; i += 16) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		__m128i words_lo = _mm_unpacklo_epi8(bytes, zero);
+		__m128i words_hi = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words_lo, zero)), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words_lo, zero)), scale));
+		_mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words_hi, zero)), scale));
+		_mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words_hi, zero)), scale));
+	}
+	convert_u8_to_f32_scalar(src + i, dst + i, n_elements - i);
+}
+
+void convert_f32_to_u8_sse2(const float *src, uint8_t *dst, size_t n_elements) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	auto to_i32 = [&](const float *ptr) {
+		__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(ptr), zero), one);
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+	};
+
+	size_t i = 0;
+	for (; i + 16 <= n_elements; i += 16) {
+		__m128i words_lo = _mm_packs_epi32(to_i32(src + i), to_i32(src + i + 4));
+		__m128i words_hi = _mm_packs_epi32(to_i32(src + i + 8), to_i32(src + i + 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(words_lo, words_hi));
+	}
+	convert_f32_to_u8_scalar(src + i, dst + i, n_elements - i);
+}
+
+GFXUTILS_TARGET_AVX2 void convert_u8_to_f32_avx2(const uint8_t *src, float *dst, size_t n_elements) {
+	const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= n_elements; i += 16) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		__m256i ints_lo = _mm256_cvtepu8_epi32(bytes);
+		__m256i ints_hi = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+		_mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(ints_lo), scale));
+		_mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(ints_hi), scale));
+	}
+	convert_u8_to_f32_scalar(src + i, dst + i, n_elements - i);
+}
+
+// lambdas don't inherit the target attribute, hence a function
+GFXUTILS_TARGET_AVX2 __m256i f32_to_u8_range_avx2(const float *ptr) {
+	__m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(ptr), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+	return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+}
+
+GFXUTILS_TARGET_AVX2 void convert_f32_to_u8_avx2(const float *src, uint8_t *dst, size_t n_elements) {
+	size_t i = 0;
+	for (; i + 32 <= n_elements; i += 32) {
+		// the packs work within 128-bit lanes, the permute puts the four 8-byte groups back in order
+		__m256i words_lo = _mm256_packs_epi32(f32_to_u8_range_avx2(src + i), f32_to_u8_range_avx2(src + i + 8));
+		__m256i words_hi = _mm256_packs_epi32(f32_to_u8_range_avx2(src + i + 16), f32_to_u8_range_avx2(src + i + 24));
+		__m256i bytes = _mm256_packus_epi16(words_lo, words_hi);
+		bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), bytes);
+	}
+	convert_f32_to_u8_sse2(src + i, dst + i, n_elements - i);
+}
+
+GFXUTILS_TARGET_AVX2 void convert_f32_to_f16_avx2(const float *src, uint16_t *dst, size_t n_elements) {
+	size_t i = 0;
+	for (; i + 8 <= n_elements; i += 8) {
+		__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), halves);
+	}
+	convert_f32_to_f16_scalar(src + i, dst + i, n_elements - i);
+}
+
+GFXUTILS_TARGET_AVX2 void convert_f16_to_f32_avx2(const uint16_t *src, float *dst, size_t n_elements) {
+	size_t i = 0;
+	for (; i + 8 <= n_elements; i += 8) {
+		__m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(halves));
+	}
+	convert_f16_to_f32_scalar(src + i, dst + i, n_elements - i);
+}
+
+GFXUTILS_TARGET_AVX2 void swizzle_u8x4_avx2(const uint8_t *src, uint8_t *dst, size_t n_pixels, const size_t *order) {
+	std::array<char, 32> shuffle{};
+	for (size_t i = 0; i < shuffle.size(); i++) {
+		shuffle[i] = static_cast<char>(((i % 16) / 4 * 4) + order[i % 4]);
+	}
+	const __m256i shuffle_mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffle.data()));
+
+	size_t i = 0;
+	for (; i + 8 <= n_pixels; i += 8) {
+		__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + (i * 4)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + (i * 4)), _mm256_shuffle_epi8(pixels, shuffle_mask));
+	}
+	swizzle_u8x4_scalar(src + (i * 4), dst + (i * 4), n_pixels - i, order);
+}
+
+bool detect_avx2() {
+#ifdef _MSC_VER
+	std::array<int, 4> regs{};
+	__cpuid(regs.data(), 0);
+	if (regs[0] < 7) {
+		return false;
+	}
+	__cpuid(regs.data(), 1);
+	bool has_f16c = (regs[2] & (1 << 29)) != 0;
+	bool has_os_avx = (regs[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;  // OSXSAVE, and the YMM state is enabled
+	__cpuidex(regs.data(), 7, 0);
+	bool has_avx2 = (regs[1] & (1 << 5)) != 0;
+	return has_f16c && has_os_avx && has_avx2;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+#endif
+
+struct ImageKernels {
+	ImageKernelISA _ISA = ImageKernelISA::SCALAR;
+	void (*_U8ToF32)(const uint8_t *, float *, size_t) = convert_u8_to_f32_scalar;
+	void (*_F32ToU8)(const float *, uint8_t *, size_t) = convert_f32_to_u8_scalar;
+	void (*_F32ToF16)(const float *, uint16_t *, size_t) = convert_f32_to_f16_scalar;
+	void (*_F16ToF32)(const uint16_t *, float *, size_t) = convert_f16_to_f32_scalar;
+	void (*_SwizzleU8x4)(const uint8_t *, uint8_t *, size_t, const size_t *) = swizzle_u8x4_scalar;
+};
+
+const ImageKernels &get_kernels() {
+	static const auto kernels = []() {
+		ImageKernels res;
+#ifdef GFXUTILS_IMAGE_KERNELS_X86
+		res._ISA = ImageKernelISA::SSE2;
+		res._U8ToF32 = convert_u8_to_f32_sse2;
+		res._F32ToU8 = convert_f32_to_u8_sse2;
+
+		if (detect_avx2()) {
+			res._ISA = ImageKernelISA::AVX2;
+			res._U8ToF32 = convert_u8_to_f32_avx2;
+			res._F32ToU8 = convert_f32_to_u8_avx2;
+			res._F32ToF16 = convert_f32_to_f16_avx2;
+			res._F16ToF32 = convert_f16_to_f32_avx2;
+			res._SwizzleU8x4 = swizzle_u8x4_avx2;
+		}
+#endif
+		return res;
+	}();
+	return kernels;
+}
+
+}  // namespace
+
+ImageKernelISA get_image_kernel_isa() {
+	return get_kernels()._ISA;
+}
+
+const char *get_image_kernel_isa_name(ImageKernelISA isa) {
+	switch (isa) {
+	case ImageKernelISA::SSE2:
+		return "SSE2";
+	case ImageKernelISA::AVX2:
+		return "AVX2";
+	default:
+		return "scalar";
+	}
+}
+
+void convert_u8_to_f32(const uint8_t *src, float *dst, size_t n_elements) {
+	get_kernels()._U8ToF32(src, dst, n_elements);
+}
+
+void convert_f32_to_u8(const float *src, uint8_t *dst, size_t n_elements) {
+	get_kernels()._F32ToU8(src, dst, n_elements);
+}
+
+void convert_f32_to_f16(const float *src, uint16_t *dst, size_t n_elements) {
+	get_kernels()._F32ToF16(src, dst, n_elements);
+}
+
+void convert_f16_to_f32(const uint16_t *src, float *dst, size_t n_elements) {
+	get_kernels()._F16ToF32(src, dst, n_elements);
+}
+
+void convert_srgb_u8_to_linear_f32(const uint8_t *src, float *dst, size_t n_pixels, size_t n_channels) {
+	const auto &lut = get_srgb_to_linear_lut();
+	size_t n_color_channels = get_color_channel_count(n_channels);
+	for (size_t i = 0; i < n_pixels; i++) {
+		for (size_t c = 0; c < n_channels; c++) {
+			uint8_t value = src[(i * n_channels) + c];
+			dst[(i * n_channels) + c] = (c < n_color_channels ? lut[value] : static_cast<float>(value) * (1.0f / 255.0f));
+		}
+	}
+}
+
+void convert_linear_f32_to_srgb_u8(const float *src, uint8_t *dst, size_t n_pixels, size_t n_channels) {
+	const auto &lut = get_linear_to_srgb_lut();
+	size_t n_color_channels = get_color_channel_count(n_channels);
+	for (size_t i = 0; i < n_pixels; i++) {
+		for (size_t c = 0; c < n_channels; c++) {
+			float value = src[(i * n_channels) + c];
+			if (c < n_color_channels) {
+				auto index = static_cast<size_t>((std::clamp(value, 0.0f, 1.0f) * static_cast<float>(LINEAR_TO_SRGB_LUT_SIZE - 1)) + 0.5f);
+				dst[(i * n_channels) + c] = lut[index];
+			} else {
+				dst[(i * n_channels) + c] = f32_to_u8(value);
+			}
+		}
+	}
+}
+
+void convert_srgb_to_linear_f32(float *data, size_t n_pixels, size_t n_channels) {
+	size_t n_color_channels = get_color_channel_count(n_channels);
+	for (size_t i = 0; i < n_pixels; i++) {
+		for (size_t c = 0; c < n_color_channels; c++) {
+			data[(i * n_channels) + c] = srgb_to_linear(data[(i * n_channels) + c]);
+		}
+	}
+}
+
+void convert_linear_to_srgb_f32(float *data, size_t n_pixels, size_t n_channels) {
+	size_t n_color_channels = get_color_channel_count(n_channels);
+	for (size_t i = 0; i < n_pixels; i++) {
+		for (size_t c = 0; c < n_color_channels; c++) {
+			data[(i * n_channels) + c] = linear_to_srgb(data[(i * n_channels) + c]);
+		}
+	}
+}
+
+void swizzle_pixels(const uint8_t *src, uint8_t *dst, size_t n_pixels, size_t element_size, size_t n_src_channels, const size_t *order, size_t n_dst_channels) {
+	if (element_size == 1 && n_src_channels == 4 && n_dst_channels == 4) {
+		get_kernels()._SwizzleU8x4(src, dst, n_pixels, order);
+		return;
+	}
+
+	size_t src_pixel_size = element_size * n_src_channels;
+	size_t dst_pixel_size = element_size * n_dst_channels;
+	for (size_t i = 0; i < n_pixels; i++) {
+		for (size_t c = 0; c < n_dst_channels; c++) {
+			std::memcpy(dst + (i * dst_pixel_size) + (c * element_size), src + (i * src_pixel_size) + (order[c] * element_size), element_size);
+		}
+	}
+}
+
+}  // namespace gfxutils
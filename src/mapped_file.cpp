@@ -0,0 +1,97 @@
+#include <gfx-utils-core/mapped_file.h>
+
+#include <gfx-utils-core/logger.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gfxutils {
+
+MappedFile::MappedFile(const std::string &file_path) {
+#ifdef _WIN32
+	_FileHandle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_FileHandle == INVALID_HANDLE_VALUE) {
+		_FileHandle = nullptr;
+		g_logger->warn("MappedFile: failed to open {}", file_path);
+		return;
+	}
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(_FileHandle, &file_size) == 0 || file_size.QuadPart == 0) {
+		g_logger->warn("MappedFile: {} is empty or its size can't be read", file_path);
+		_close();
+		return;
+	}
+
+	_MappingHandle = CreateFileMappingA(_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_MappingHandle != nullptr) {
+		_Data = static_cast<const uint8_t *>(MapViewOfFile(_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+	_SizeBytes = static_cast<size_t>(file_size.QuadPart);
+#else
+	_FileDescriptor = open(file_path.c_str(), O_RDONLY);
+	if (_FileDescriptor < 0) {
+		g_logger->warn("MappedFile: failed to open {}", file_path);
+		return;
+	}
+
+	struct stat file_stat;
+	if (fstat(_FileDescriptor, &file_stat) != 0 || file_stat.st_size == 0) {
+		g_logger->warn("MappedFile: {} is empty or its size can't be read", file_path);
+		_close();
+		return;
+	}
+
+	_SizeBytes = static_cast<size_t>(file_stat.st_size);
+	void *data = mmap(nullptr, _SizeBytes, PROT_READ, MAP_PRIVATE, _FileDescriptor, 0);
+	if (data != MAP_FAILED) {
+		_Data = static_cast<const uint8_t *>(data);
+	}
+#endif
+
+	if (_Data == nullptr) {
+		g_logger->warn("MappedFile: failed to map {}", file_path);
+		_close();
+	}
+}
+
+MappedFile::~MappedFile() {
+	_close();
+}
+
+void MappedFile::_close() {
+#ifdef _WIN32
+	if (_Data != nullptr) {
+		UnmapViewOfFile(_Data);
+	}
+	if (_MappingHandle != nullptr) {
+		CloseHandle(_MappingHandle);
+	}
+	if (_FileHandle != nullptr) {
+		CloseHandle(_FileHandle);
+	}
+	_MappingHandle = nullptr;
+	_FileHandle = nullptr;
+#else
+	if (_Data != nullptr) {
+		munmap(const_cast<uint8_t *>(_Data), _SizeBytes);
+	}
+	if (_FileDescriptor >= 0) {
+		close(_FileDescriptor);
+	}
+	_FileDescriptor = -1;
+#endif
+	_Data = nullptr;
+	_SizeBytes = 0;
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,958 @@
+#include <gfx-utils-core/mesh_loader.h>
+
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/mapped_file.h>
+#include <gfx-utils-core/mesh_optimizer.h>
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace gfxutils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// interleaved floats of the imported triangles before optimization: position, normal, texture coordinates
+constexpr size_t IMPORT_VERTEX_SIZE = 8;
+
+const std::vector<VertexAttributeInfo> &get_mesh_attributes() {
+	static const std::vector<VertexAttributeInfo> attributes = {
+		{ 3, VertexAttributeFormat::FLOAT, 0 },               // position
+		{ 3, VertexAttributeFormat::INT_2_10_10_10_REV, 0 },  // normal
+		{ 2, VertexAttributeFormat::FLOAT, 0 }                // texture coordinates
+	};
+	return attributes;
+}
+
+// bump when the layout of the cache file or the import changes, so that stale entries are imported again
+constexpr uint32_t MESH_CACHE_VERSION = 2;
+constexpr char MESH_CACHE_MAGIC[8] = { 'G', 'F', 'X', 'M', 'E', 'S', 'H', '\0' };
+constexpr size_t MESH_CACHE_MAX_ATTRIBUTES = 8;
+constexpr size_t MESH_CACHE_ALIGNMENT = 16;
+
+// followed by the vertex data and the index data, each at a 16-byte aligned offset
+struct MeshCacheHeader {
+	char _Magic[8];
+	uint32_t _Version;
+	uint32_t _IndexType;
+	uint64_t _SourceSize;
+	int64_t _SourceTime;
+	uint64_t _NumVertices;
+	uint64_t _NumIndices;
+	uint64_t _VertexOffset;
+	uint64_t _VertexBytes;
+	uint64_t _IndexOffset;
+	uint64_t _IndexBytes;
+	float _BoundsMin[3];
+	float _BoundsMax[3];
+	uint32_t _NumAttributes;
+	uint32_t _AttributeComponents[MESH_CACHE_MAX_ATTRIBUTES];
+	uint32_t _AttributeFormats[MESH_CACHE_MAX_ATTRIBUTES];
+};
+
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader>);
+
+struct SourceInfo {
+	std::string _AbsolutePath;
+	uint64_t _Size;
+	int64_t _Time;
+};
+
+size_t align_to(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+std::string get_lowercase_extension(const std::string &file_path) {
+	auto extension = fs::path(file_path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return extension;
+}
+
+std::optional<SourceInfo> get_source_info(const std::string &file_path) {
+	std::error_code error;
+	auto absolute_path = fs::absolute(file_path, error);
+	if (error) {
+		return std::nullopt;
+	}
+	auto size = fs::file_size(absolute_path, error);
+	if (error) {
+		return std::nullopt;
+	}
+	auto time = fs::last_write_time(absolute_path, error);
+	if (error) {
+		return std::nullopt;
+	}
+
+	return SourceInfo{ absolute_path.lexically_normal().string(), size, static_cast<int64_t>(time.time_since_epoch().count()) };
+}
+
+std::string get_cache_path(const std::string &cache_dir, const SourceInfo &source_info) {
+	// FNV-1a, the size and time are checked against the header anyway
+	uint64_t hash = 14695981039346656037ull;
+	auto hash_bytes = [&](const void *data, size_t n_bytes) {
+		for (size_t i = 0; i < n_bytes; i++) {
+			hash = (hash ^ static_cast<const uint8_t *>(data)[i]) * 1099511628211ull;
+		}
+	};
+	hash_bytes(source_info._AbsolutePath.data(), source_info._AbsolutePath.size());
+	hash_bytes(&MESH_CACHE_VERSION, sizeof(MESH_CACHE_VERSION));
+
+	return (fs::path(cache_dir) / std::format("{:016x}.mesh", hash)).string();
+}
+
+// triangles, IMPORT_VERTEX_SIZE floats per corner
+using TriangleList = std::vector<float>;
+
+void append_corner(TriangleList &triangles, const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2 &uv) {
+	triangles.insert(triangles.end(), { pos.x, pos.y, pos.z, normal.x, normal.y, normal.z, uv.x, uv.y });
+}
+
+glm::vec3 get_face_normal(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+	glm::vec3 normal = glm::cross(b - a, c - a);
+	float length = glm::length(normal);
+	return length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+// OBJ
+
+std::string_view next_token(std::string_view &line) {
+	size_t begin = line.find_first_not_of(" \t");
+	if (begin == std::string_view::npos) {
+		line = {};
+		return {};
+	}
+	size_t end = line.find_first_of(" \t", begin);
+	auto token = line.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin);
+	line = (end == std::string_view::npos ? std::string_view{} : line.substr(end));
+	return token;
+}
+
+template<typename T>
+bool parse_number(std::string_view token, T &value) {
+	auto [ptr, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+	return error == std::errc() && ptr == token.data() + token.size();
+}
+
+template<glm::length_t N>
+bool parse_floats(std::string_view line, glm::vec<N, float> &value) {
+	for (glm::length_t i = 0; i < N; i++) {
+		if (!parse_number(next_token(line), value[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 1-based, negative indices count back from the last element, returns -1 if out of range
+int64_t resolve_obj_index(std::string_view token, size_t n_elements) {
+	int64_t index = 0;
+	if (!parse_number(token, index)) {
+		return -1;
+	}
+	int64_t res = (index < 0 ? static_cast<int64_t>(n_elements) + index : index - 1);
+	return (res >= 0 && res < static_cast<int64_t>(n_elements)) ? res : -1;
+}
+
+std::optional<TriangleList> import_obj(const std::string &file_path) {
+	MappedFile file(file_path);
+	if (!file.is_open()) {
+		return std::nullopt;
+	}
+
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<glm::vec2> uvs;
+	TriangleList triangles;
+
+	struct Corner {
+		int64_t _Pos;
+		int64_t _UV;  // -1 if absent
+		int64_t _Normal;
+	};
+	std::vector<Corner> face;
+
+	std::string_view text(reinterpret_cast<const char *>(file.get_data().data()), file.get_data().size());
+	size_t line_number = 0;
+	while (!text.empty()) {
+		size_t line_end = text.find('\n');
+		auto line = text.substr(0, line_end);
+		text = (line_end == std::string_view::npos ? std::string_view{} : text.substr(line_end + 1));
+		line_number++;
+		if (!line.empty() && line.back() == '\r') {
+			line.remove_suffix(1);
+		}
+
+		auto keyword = next_token(line);
+		bool is_valid = true;
+		if (keyword == "v") {
+			is_valid = parse_floats(line, positions.emplace_back());
+		} else if (keyword == "vn") {
+			is_valid = parse_floats(line, normals.emplace_back());
+		} else if (keyword == "vt") {
+			is_valid = parse_floats(line, uvs.emplace_back());
+		} else if (keyword == "f") {
+			face.clear();
+			for (auto token = next_token(line); !token.empty() && is_valid; token = next_token(line)) {
+				// v, v/vt, v//vn or v/vt/vn
+				size_t first_slash = token.find('/');
+				size_t second_slash = (first_slash == std::string_view::npos ? std::string_view::npos : token.find('/', first_slash + 1));
+				Corner corner{ resolve_obj_index(token.substr(0, first_slash), positions.size()), -1, -1 };
+				if (first_slash != std::string_view::npos) {
+					auto uv_token = token.substr(first_slash + 1, second_slash == std::string_view::npos ? std::string_view::npos : second_slash - first_slash - 1);
+					if (!uv_token.empty()) {
+						corner._UV = resolve_obj_index(uv_token, uvs.size());
+						is_valid &= corner._UV >= 0;
+					}
+				}
+				if (second_slash != std::string_view::npos) {
+					corner._Normal = resolve_obj_index(token.substr(second_slash + 1), normals.size());
+					is_valid &= corner._Normal >= 0;
+				}
+				is_valid &= corner._Pos >= 0;
+				face.push_back(corner);
+			}
+			is_valid &= face.size() >= 3;
+
+			// fan triangulation, fine for the convex polygons exporters write
+			for (size_t i = 1; is_valid && i + 1 < face.size(); i++) {
+				const Corner *corners[3] = { &face[0], &face[i], &face[i + 1] };
+				glm::vec3 face_normal = get_face_normal(positions[corners[0]->_Pos], positions[corners[1]->_Pos], positions[corners[2]->_Pos]);
+				for (const auto *corner : corners) {
+					append_corner(triangles,
+					              positions[corner->_Pos],
+					              corner->_Normal >= 0 ? normals[corner->_Normal] : face_normal,
+					              corner->_UV >= 0 ? uvs[corner->_UV] : glm::vec2(0.0f));
+				}
+			}
+		}
+
+		if (!is_valid) {
+			g_logger->warn("MeshLoader: {}:{}: malformed '{}' statement", file_path, line_number, keyword);
+			return std::nullopt;
+		}
+	}
+
+	return triangles;
+}
+
+// glTF
+
+constexpr uint32_t GLB_MAGIC = 0x46546c67;       // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;  // "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;   // "BIN\0"
+
+constexpr int GLTF_MODE_TRIANGLES = 4;
+constexpr int GLTF_BYTE = 5120;
+constexpr int GLTF_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_SHORT = 5122;
+constexpr int GLTF_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_FLOAT = 5126;
+
+std::optional<std::vector<uint8_t>> decode_base64(std::string_view text) {
+	auto decode_char = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+') return 62;
+		if (c == '/') return 63;
+		return -1;
+	};
+
+	std::vector<uint8_t> res;
+	res.reserve(text.size() / 4 * 3);
+	uint32_t bits = 0;
+	int n_bits = 0;
+	for (char c : text) {
+		if (c == '=') {
+			break;
+		}
+		int value = decode_char(c);
+		if (value < 0) {
+			return std::nullopt;
+		}
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		n_bits += 6;
+		if (n_bits >= 8) {
+			n_bits -= 8;
+			res.push_back(static_cast<uint8_t>(bits >> n_bits));
+		}
+	}
+	return res;
+}
+
+std::optional<std::vector<uint8_t>> read_file(const fs::path &path) {
+	std::ifstream fin(path, std::ios::binary | std::ios::ate);
+	if (!fin) {
+		return std::nullopt;
+	}
+	std::vector<uint8_t> res(static_cast<size_t>(fin.tellg()));
+	fin.seekg(0);
+	fin.read(reinterpret_cast<char *>(res.data()), static_cast<std::streamsize>(res.size()));
+	if (!fin) {
+		return std::nullopt;
+	}
+	return res;
+}
+
+class GltfImporter {
+private:
+	std::string _FilePath;
+	Json::Value _Root;
+	std::vector<std::span<const uint8_t>> _Buffers;
+	std::vector<std::vector<uint8_t>> _OwnedBuffers;  // external and data URI buffers
+	std::unique_ptr<MappedFile> _File;  // views of a GLB point into it
+	TriangleList _Triangles;
+
+public:
+	explicit GltfImporter(const std::string &file_path)
+	    : _FilePath(file_path) {
+	}
+
+	std::optional<TriangleList> import() {
+		std::span<const uint8_t> glb_binary_chunk;
+		if (!_load_json(glb_binary_chunk) || !_load_buffers(glb_binary_chunk)) {
+			return std::nullopt;
+		}
+
+		const auto &scenes = _Root["scenes"];
+		if (scenes.empty()) {
+			// no scene: every mesh once, untransformed
+			for (Json::ArrayIndex i = 0; i < _Root["meshes"].size(); i++) {
+				if (!_import_mesh(_Root["meshes"][i], glm::mat4(1.0f))) {
+					return std::nullopt;
+				}
+			}
+		} else {
+			const auto &scene = scenes[_Root.get("scene", 0).asUInt()];
+			for (const auto &node_index : scene["nodes"]) {
+				if (!_import_node(node_index.asUInt(), glm::mat4(1.0f), 0)) {
+					return std::nullopt;
+				}
+			}
+		}
+
+		return std::move(_Triangles);
+	}
+
+private:
+	bool _fail(const std::string &message) const {
+		g_logger->warn("MeshLoader: {}: {}", _FilePath, message);
+		return false;
+	}
+
+	bool _load_json(std::span<const uint8_t> &glb_binary_chunk) {
+		_File = std::make_unique<MappedFile>(_FilePath);
+		if (!_File->is_open()) {
+			return false;
+		}
+
+		auto data = _File->get_data();
+		std::string_view json_text(reinterpret_cast<const char *>(data.data()), data.size());
+
+		uint32_t magic = 0;
+		if (data.size() >= sizeof(uint32_t)) {
+			std::memcpy(&magic, data.data(), sizeof(uint32_t));
+		}
+		if (magic == GLB_MAGIC) {
+			// 12-byte header, then chunks of { length, type, data } padded to 4 bytes
+			json_text = {};
+			size_t offset = 12;
+			while (offset + 8 <= data.size()) {
+				uint32_t chunk_header[2];
+				std::memcpy(chunk_header, data.data() + offset, sizeof(chunk_header));
+				if (offset + 8 + chunk_header[0] > data.size()) {
+					return _fail("truncated GLB chunk");
+				}
+				auto chunk = data.subspan(offset + 8, chunk_header[0]);
+				if (chunk_header[1] == GLB_CHUNK_JSON) {
+					json_text = std::string_view(reinterpret_cast<const char *>(chunk.data()), chunk.size());
+				} else if (chunk_header[1] == GLB_CHUNK_BIN) {
+					glb_binary_chunk = chunk;
+				}
+				offset += 8 + align_to(chunk_header[0], 4);
+			}
+		}
+
+		Json::CharReaderBuilder reader_builder;
+		std::unique_ptr<Json::CharReader> reader(reader_builder.newCharReader());
+		std::string errors;
+		if (!reader->parse(json_text.data(), json_text.data() + json_text.size(), &_Root, &errors)) {
+			return _fail(std::format("invalid JSON: {}", errors));
+		}
+		return true;
+	}
+
+	bool _load_buffers(std::span<const uint8_t> glb_binary_chunk) {
+		for (const auto &buffer : _Root["buffers"]) {
+			size_t byte_length = buffer["byteLength"].asUInt64();
+			if (!buffer.isMember("uri")) {
+				// the binary chunk of a GLB
+				if (glb_binary_chunk.size() < byte_length) {
+					return _fail("buffer without URI outside of a GLB binary chunk");
+				}
+				_Buffers.push_back(glb_binary_chunk.first(byte_length));
+				continue;
+			}
+
+			auto uri = buffer["uri"].asString();
+			std::optional<std::vector<uint8_t>> data;
+			if (uri.starts_with("data:")) {
+				auto comma = uri.find(',');
+				if (comma == std::string::npos || uri.find(";base64") > comma) {
+					return _fail("only base64 data URIs are supported");
+				}
+				data = decode_base64(std::string_view(uri).substr(comma + 1));
+			} else {
+				data = read_file(fs::path(_FilePath).parent_path() / fs::path(uri));
+			}
+			if (!data.has_value() || data->size() < byte_length) {
+				return _fail(std::format("failed to load buffer '{}'", uri.starts_with("data:") ? "data URI" : uri));
+			}
+
+			_OwnedBuffers.push_back(std::move(*data));
+			_Buffers.push_back(std::span<const uint8_t>(_OwnedBuffers.back()).first(byte_length));
+		}
+		return true;
+	}
+
+	bool _import_node(Json::ArrayIndex node_index, const glm::mat4 &parent_transform, size_t depth) {
+		const auto &nodes = _Root["nodes"];
+		if (node_index >= nodes.size() || depth > nodes.size()) {
+			return _fail("invalid node hierarchy");
+		}
+
+		const auto &node = nodes[node_index];
+		glm::mat4 transform = parent_transform * _get_local_transform(node);
+		if (node.isMember("mesh")) {
+			auto mesh_index = node["mesh"].asUInt();
+			if (mesh_index >= _Root["meshes"].size() || !_import_mesh(_Root["meshes"][mesh_index], transform)) {
+				return _fail(std::format("failed to import mesh {}", mesh_index));
+			}
+		}
+		for (const auto &child : node["children"]) {
+			if (!_import_node(child.asUInt(), transform, depth + 1)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static glm::mat4 _get_local_transform(const Json::Value &node) {
+		glm::mat4 res(1.0f);
+		if (node.isMember("matrix")) {
+			// column-major, like glm
+			for (int i = 0; i < 16; i++) {
+				res[i / 4][i % 4] = node["matrix"][i].asFloat();
+			}
+			return res;
+		}
+
+		// T * R * S
+		const auto &t = node["translation"];
+		const auto &r = node["rotation"];
+		const auto &s = node["scale"];
+		glm::vec3 translation = t.isArray() ? glm::vec3(t[0].asFloat(), t[1].asFloat(), t[2].asFloat()) : glm::vec3(0.0f);
+		glm::vec4 q = r.isArray() ? glm::vec4(r[0].asFloat(), r[1].asFloat(), r[2].asFloat(), r[3].asFloat()) : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		glm::vec3 scale = s.isArray() ? glm::vec3(s[0].asFloat(), s[1].asFloat(), s[2].asFloat()) : glm::vec3(1.0f);
+
+		res[0] = glm::vec4(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.z * q.w), 2.0f * (q.x * q.z - q.y * q.w), 0.0f) * scale.x;
+		res[1] = glm::vec4(2.0f * (q.x * q.y - q.z * q.w), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.x * q.w), 0.0f) * scale.y;
+		res[2] = glm::vec4(2.0f * (q.x * q.z + q.y * q.w), 2.0f * (q.y * q.z - q.x * q.w), 1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0.0f) * scale.z;
+		res[3] = glm::vec4(translation, 1.0f);
+		return res;
+	}
+
+	// reads element `index` of an accessor as floats, normalized integers are converted to [0, 1] / [-1, 1]
+	template<glm::length_t N>
+	bool _read_accessor(const Json::Value &accessor, std::initializer_list<int> component_types, std::vector<glm::vec<N, float>> &values) {
+		static const std::array<std::string, 4> type_names = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+		if (accessor["type"].asString() != type_names[N - 1] || accessor.isMember("sparse")) {
+			return _fail(std::format("unsupported accessor type '{}' (expected {}, sparse accessors aren't supported)", accessor["type"].asString(), type_names[N - 1]));
+		}
+
+		std::vector<double> components;
+		if (!_read_components(accessor, N, component_types, components)) {
+			return false;
+		}
+
+		values.resize(components.size() / N);
+		for (size_t i = 0; i < values.size(); i++) {
+			for (glm::length_t j = 0; j < N; j++) {
+				values[i][j] = static_cast<float>(components[i * N + j]);
+			}
+		}
+		return true;
+	}
+
+	// `component_types`: the ones the spec allows for the attribute
+	bool _read_components(const Json::Value &accessor, size_t n_components, std::initializer_list<int> component_types, std::vector<double> &components) {
+		const auto &buffer_views = _Root["bufferViews"];
+		auto view_index = accessor["bufferView"].asUInt();
+		if (!accessor.isMember("bufferView") || view_index >= buffer_views.size()) {
+			return _fail("accessor without a valid buffer view");
+		}
+
+		const auto &view = buffer_views[view_index];
+		auto buffer_index = view["buffer"].asUInt();
+		if (buffer_index >= _Buffers.size()) {
+			return _fail("buffer view without a valid buffer");
+		}
+
+		auto component_type = accessor["componentType"].asInt();
+		bool is_normalized = accessor.get("normalized", false).asBool();
+		// integer types stand in for float attributes only when normalized, and indices are never normalized
+		bool is_float_attribute = std::ranges::find(component_types, GLTF_FLOAT) != component_types.end();
+		if (std::ranges::find(component_types, component_type) == component_types.end() ||
+		    (component_type != GLTF_FLOAT && is_normalized != is_float_attribute)) {
+			return _fail(std::format("unsupported component type {}{}", component_type, is_normalized ? " (normalized)" : ""));
+		}
+		size_t component_size = 4;
+		if (component_type == GLTF_BYTE || component_type == GLTF_UNSIGNED_BYTE) {
+			component_size = 1;
+		} else if (component_type == GLTF_SHORT || component_type == GLTF_UNSIGNED_SHORT) {
+			component_size = 2;
+		}
+
+		// the sizes come from the file, so the checks are written not to overflow
+		size_t count = accessor["count"].asUInt64();
+		size_t element_size = component_size * n_components;
+		size_t stride = view.get("byteStride", 0).asUInt64();
+		stride = (stride == 0 ? element_size : stride);
+		size_t view_offset = view.get("byteOffset", 0).asUInt64();
+		size_t view_length = view["byteLength"].asUInt64();
+		size_t accessor_offset = accessor.get("byteOffset", 0).asUInt64();
+		const auto &buffer = _Buffers[buffer_index];
+		if (stride < element_size || view_offset > buffer.size() || view_length > buffer.size() - view_offset) {
+			return _fail("buffer view out of the bounds of its buffer");
+		}
+		if (count > 0 && (accessor_offset > view_length || element_size > view_length - accessor_offset ||
+		                  count - 1 > (view_length - accessor_offset - element_size) / stride)) {
+			return _fail("accessor out of the bounds of its buffer view");
+		}
+		size_t begin = view_offset + accessor_offset;
+
+		const uint8_t *data = buffer.data() + begin;
+		components.resize(count * n_components);
+		for (size_t i = 0; i < count; i++) {
+			for (size_t j = 0; j < n_components; j++) {
+				const uint8_t *src = data + i * stride + j * component_size;
+				double value = 0.0;
+				switch (component_type) {
+				case GLTF_BYTE: {
+					int8_t x;
+					std::memcpy(&x, src, 1);
+					value = is_normalized ? std::max(x / 127.0, -1.0) : x;
+					break;
+				}
+				case GLTF_UNSIGNED_BYTE:
+					value = is_normalized ? *src / 255.0 : *src;
+					break;
+				case GLTF_SHORT: {
+					int16_t x;
+					std::memcpy(&x, src, 2);
+					value = is_normalized ? std::max(x / 32767.0, -1.0) : x;
+					break;
+				}
+				case GLTF_UNSIGNED_SHORT: {
+					uint16_t x;
+					std::memcpy(&x, src, 2);
+					value = is_normalized ? x / 65535.0 : x;
+					break;
+				}
+				case GLTF_UNSIGNED_INT: {
+					uint32_t x;
+					std::memcpy(&x, src, 4);
+					value = x;
+					break;
+				}
+				default: {
+					float x;
+					std::memcpy(&x, src, 4);
+					value = x;
+					break;
+				}
+				}
+				components[i * n_components + j] = value;
+			}
+		}
+		return true;
+	}
+
+	bool _import_mesh(const Json::Value &mesh, const glm::mat4 &transform) {
+		glm::mat3 normal_transform = glm::transpose(glm::inverse(glm::mat3(transform)));
+		const auto &accessors = _Root["accessors"];
+
+		for (const auto &primitive : mesh["primitives"]) {
+			if (primitive.get("mode", GLTF_MODE_TRIANGLES).asInt() != GLTF_MODE_TRIANGLES) {
+				g_logger->warn("MeshLoader: {}: skipped a primitive that isn't a triangle list", _FilePath);
+				continue;
+			}
+
+			const auto &attributes = primitive["attributes"];
+			auto get_accessor = [&](const Json::Value &index) -> const Json::Value * {
+				return (index.isUInt() && index.asUInt() < accessors.size()) ? &accessors[index.asUInt()] : nullptr;
+			};
+
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec3> normals;
+			std::vector<glm::vec2> uvs;
+			const auto *position_accessor = get_accessor(attributes["POSITION"]);
+			if (position_accessor == nullptr || !_read_accessor(*position_accessor, { GLTF_FLOAT }, positions)) {
+				return _fail("primitive without valid positions");
+			}
+			if (attributes.isMember("NORMAL")) {
+				const auto *normal_accessor = get_accessor(attributes["NORMAL"]);
+				if (normal_accessor == nullptr || !_read_accessor(*normal_accessor, { GLTF_FLOAT }, normals) || normals.size() != positions.size()) {
+					return _fail("invalid normals");
+				}
+			}
+			if (attributes.isMember("TEXCOORD_0")) {
+				const auto *uv_accessor = get_accessor(attributes["TEXCOORD_0"]);
+				if (uv_accessor == nullptr || !_read_accessor(*uv_accessor, { GLTF_FLOAT, GLTF_UNSIGNED_BYTE, GLTF_UNSIGNED_SHORT }, uvs) ||
+				    uvs.size() != positions.size()) {
+					return _fail("invalid texture coordinates");
+				}
+				// glTF puts the origin of the texture coordinates at the top-left of the image, GL at the bottom-left
+				for (auto &uv : uvs) {
+					uv.y = 1.0f - uv.y;
+				}
+			}
+
+			std::vector<double> indices;
+			if (primitive.isMember("indices")) {
+				const auto *index_accessor = get_accessor(primitive["indices"]);
+				if (index_accessor == nullptr || !_read_components(*index_accessor, 1, { GLTF_UNSIGNED_BYTE, GLTF_UNSIGNED_SHORT, GLTF_UNSIGNED_INT }, indices)) {
+					return _fail("invalid indices");
+				}
+			} else {
+				indices.resize(positions.size());
+				for (size_t i = 0; i < indices.size(); i++) {
+					indices[i] = static_cast<double>(i);
+				}
+			}
+
+			for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+				size_t corners[3];
+				for (size_t j = 0; j < 3; j++) {
+					corners[j] = static_cast<size_t>(indices[i + j]);
+					if (corners[j] >= positions.size()) {
+						return _fail("index out of range");
+					}
+				}
+
+				glm::vec3 world_positions[3];
+				for (size_t j = 0; j < 3; j++) {
+					glm::vec4 pos = transform * glm::vec4(positions[corners[j]], 1.0f);
+					world_positions[j] = glm::vec3(pos.x, pos.y, pos.z);
+				}
+				glm::vec3 face_normal = get_face_normal(world_positions[0], world_positions[1], world_positions[2]);
+
+				for (size_t j = 0; j < 3; j++) {
+					glm::vec3 normal = face_normal;
+					if (!normals.empty()) {
+						normal = normal_transform * normals[corners[j]];
+						float length = glm::length(normal);
+						normal = length > 0.0f ? normal / length : face_normal;
+					}
+					append_corner(_Triangles, world_positions[j], normal, uvs.empty() ? glm::vec2(0.0f) : uvs[corners[j]]);
+				}
+			}
+		}
+		return true;
+	}
+};
+
+// the result of an import, owned by the MeshData
+struct MeshBuffers {
+	std::vector<uint8_t> _VertexData;
+	std::vector<uint8_t> _IndexData;
+};
+
+MeshData pack_mesh(const TriangleList &triangles) {
+	MeshData res;
+
+	auto mesh = optimize_mesh(triangles, IMPORT_VERTEX_SIZE);
+	auto buffers = std::make_shared<MeshBuffers>();
+	buffers->_VertexData = pack_vertices(mesh._Vertices, get_mesh_attributes());
+
+	uint32_t max_index = mesh._Indices.empty() ? 0 : *std::max_element(mesh._Indices.begin(), mesh._Indices.end());
+	if (max_index <= 0xffff) {
+		std::vector<uint16_t> short_indices(mesh._Indices.begin(), mesh._Indices.end());
+		buffers->_IndexData.resize(short_indices.size() * sizeof(uint16_t));
+		std::memcpy(buffers->_IndexData.data(), short_indices.data(), buffers->_IndexData.size());
+		res._IndexType = GL_UNSIGNED_SHORT;
+	} else {
+		buffers->_IndexData.resize(mesh._Indices.size() * sizeof(uint32_t));
+		std::memcpy(buffers->_IndexData.data(), mesh._Indices.data(), buffers->_IndexData.size());
+		res._IndexType = GL_UNSIGNED_INT;
+	}
+
+	res._Attributes = get_mesh_attributes();
+	res._VertexData = buffers->_VertexData;
+	res._IndexData = buffers->_IndexData;
+	res._NumVertices = mesh.get_vertex_count();
+	res._NumIndices = mesh._Indices.size();
+
+	if (res._NumVertices > 0) {
+		res._BoundsMin = glm::vec3(std::numeric_limits<float>::max());
+		res._BoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+		for (size_t i = 0; i < res._NumVertices; i++) {
+			const float *pos = mesh._Vertices.data() + i * IMPORT_VERTEX_SIZE;
+			res._BoundsMin = glm::min(res._BoundsMin, glm::vec3(pos[0], pos[1], pos[2]));
+			res._BoundsMax = glm::max(res._BoundsMax, glm::vec3(pos[0], pos[1], pos[2]));
+		}
+	}
+
+	res._Storage = std::move(buffers);
+	return res;
+}
+
+std::optional<MeshData> read_mesh_cache(const std::string &cache_path, const SourceInfo &source_info) {
+	if (!fs::exists(cache_path)) {
+		return std::nullopt;
+	}
+
+	auto file = std::make_shared<MappedFile>(cache_path);
+	if (!file->is_open()) {
+		return std::nullopt;
+	}
+
+	auto data = file->get_data();
+	MeshCacheHeader header;
+	if (data.size() < sizeof(header)) {
+		return std::nullopt;
+	}
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	bool is_valid = std::memcmp(header._Magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) == 0 &&
+	                header._Version == MESH_CACHE_VERSION &&
+	                header._SourceSize == source_info._Size &&
+	                header._SourceTime == source_info._Time &&
+	                header._NumAttributes > 0 &&
+	                header._NumAttributes <= MESH_CACHE_MAX_ATTRIBUTES &&
+	                (header._IndexType == GL_UNSIGNED_SHORT || header._IndexType == GL_UNSIGNED_INT);
+	if (!is_valid) {
+		return std::nullopt;
+	}
+
+	// a damaged entry is imported again rather than uploaded with sizes that don't match its data
+	MeshData res;
+	for (uint32_t i = 0; i < header._NumAttributes; i++) {
+		auto n_components = header._AttributeComponents[i];
+		auto format = header._AttributeFormats[i];
+		if (n_components < 1 || n_components > 4 || format > static_cast<uint32_t>(VertexAttributeFormat::INT_2_10_10_10_REV)) {
+			return std::nullopt;
+		}
+		res._Attributes.push_back({ n_components, static_cast<VertexAttributeFormat>(format), 0 });
+	}
+
+	size_t vertex_stride = get_vertex_stride(res._Attributes);
+	size_t index_size = (header._IndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t));
+	auto is_in_file = [&](uint64_t offset, uint64_t n_bytes) {
+		return offset % MESH_CACHE_ALIGNMENT == 0 && offset <= data.size() && n_bytes <= data.size() - offset;
+	};
+	is_valid = header._NumVertices <= header._VertexBytes / vertex_stride &&
+	           header._VertexBytes == header._NumVertices * vertex_stride &&
+	           header._NumIndices <= header._IndexBytes / index_size &&
+	           header._IndexBytes == header._NumIndices * index_size &&
+	           header._NumIndices % 3 == 0 &&
+	           is_in_file(header._VertexOffset, header._VertexBytes) &&
+	           is_in_file(header._IndexOffset, header._IndexBytes);
+	if (!is_valid) {
+		return std::nullopt;
+	}
+	res._VertexData = data.subspan(header._VertexOffset, header._VertexBytes);
+	res._IndexData = data.subspan(header._IndexOffset, header._IndexBytes);
+	res._IndexType = static_cast<GLenum>(header._IndexType);
+	res._NumVertices = header._NumVertices;
+	res._NumIndices = header._NumIndices;
+	res._BoundsMin = glm::vec3(header._BoundsMin[0], header._BoundsMin[1], header._BoundsMin[2]);
+	res._BoundsMax = glm::vec3(header._BoundsMax[0], header._BoundsMax[1], header._BoundsMax[2]);
+	res._IsFromCache = true;
+	res._Storage = std::move(file);
+	return res;
+}
+
+void write_mesh_cache(const std::string &cache_path, const SourceInfo &source_info, const MeshData &mesh) {
+	MeshCacheHeader header{};
+	std::memcpy(header._Magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+	header._Version = MESH_CACHE_VERSION;
+	header._IndexType = mesh._IndexType;
+	header._SourceSize = source_info._Size;
+	header._SourceTime = source_info._Time;
+	header._NumVertices = mesh._NumVertices;
+	header._NumIndices = mesh._NumIndices;
+	header._VertexOffset = align_to(sizeof(header), MESH_CACHE_ALIGNMENT);
+	header._VertexBytes = mesh._VertexData.size();
+	header._IndexOffset = align_to(header._VertexOffset + header._VertexBytes, MESH_CACHE_ALIGNMENT);
+	header._IndexBytes = mesh._IndexData.size();
+	for (int i = 0; i < 3; i++) {
+		header._BoundsMin[i] = mesh._BoundsMin[i];
+		header._BoundsMax[i] = mesh._BoundsMax[i];
+	}
+	header._NumAttributes = static_cast<uint32_t>(std::min(mesh._Attributes.size(), MESH_CACHE_MAX_ATTRIBUTES));
+	for (uint32_t i = 0; i < header._NumAttributes; i++) {
+		header._AttributeComponents[i] = static_cast<uint32_t>(mesh._Attributes[i]._NumComponents);
+		header._AttributeFormats[i] = static_cast<uint32_t>(mesh._Attributes[i]._Format);
+	}
+
+	std::vector<uint8_t> file_data(header._IndexOffset + header._IndexBytes, 0);
+	std::memcpy(file_data.data(), &header, sizeof(header));
+	std::memcpy(file_data.data() + header._VertexOffset, mesh._VertexData.data(), mesh._VertexData.size());
+	std::memcpy(file_data.data() + header._IndexOffset, mesh._IndexData.data(), mesh._IndexData.size());
+
+	// written next to the entry and renamed, so that a concurrent load never maps a partial file
+	auto temp_path = std::format("{}.{}.tmp", cache_path, std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	{
+		std::ofstream fout(temp_path, std::ios::binary | std::ios::trunc);
+		fout.write(reinterpret_cast<const char *>(file_data.data()), static_cast<std::streamsize>(file_data.size()));
+		if (!fout) {
+			g_logger->warn("MeshLoader: failed to write the cache entry {}", temp_path);
+			return;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(temp_path, cache_path, error);
+	if (error) {
+		g_logger->warn("MeshLoader: failed to write the cache entry {}: {}", cache_path, error.message());
+		fs::remove(temp_path, error);
+	}
+}
+
+MeshData load_mesh(const std::string &file_path, const std::string &cache_dir) {
+	auto source_info = get_source_info(file_path);
+	if (!source_info.has_value()) {
+		g_logger->warn("MeshLoader: {} does not exist", file_path);
+		return {};
+	}
+
+	std::string cache_path;
+	if (!cache_dir.empty()) {
+		cache_path = get_cache_path(cache_dir, *source_info);
+		if (auto cached = read_mesh_cache(cache_path, *source_info); cached.has_value()) {
+			return std::move(*cached);
+		}
+	}
+
+	auto extension = get_lowercase_extension(file_path);
+	std::optional<TriangleList> triangles;
+	if (extension == ".obj") {
+		triangles = import_obj(file_path);
+	} else if (extension == ".gltf" || extension == ".glb") {
+		triangles = GltfImporter(file_path).import();
+	} else {
+		g_logger->warn("MeshLoader: {}: unsupported format '{}'", file_path, extension);
+		return {};
+	}
+
+	if (!triangles.has_value()) {
+		return {};
+	}
+	if (triangles->empty()) {
+		g_logger->warn("MeshLoader: {}: the file has no triangles", file_path);
+		return {};
+	}
+
+	auto res = pack_mesh(*triangles);
+	if (!cache_path.empty()) {
+		write_mesh_cache(cache_path, *source_info, res);
+	}
+
+	g_logger->info("MeshLoader: imported {} ({} triangles, {} vertices)", file_path, res._NumIndices / 3, res._NumVertices);
+
+	return res;
+}
+
+}  // namespace
+
+MeshLoader::MeshLoaderBuilder::MeshLoaderBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+MeshLoader::MeshLoaderBuilder &MeshLoader::MeshLoaderBuilder::set_thread_count(size_t n_threads) {
+	_NumThreads = n_threads;
+	return *this;
+}
+
+MeshLoader::MeshLoaderBuilder &MeshLoader::MeshLoaderBuilder::set_cache_dir(const std::string &cache_dir) {
+	_CacheDir = cache_dir;
+	return *this;
+}
+
+MeshLoader MeshLoader::MeshLoaderBuilder::_build() const {
+	MeshLoader res;
+
+	res._set_name(_Name);
+
+	if (!_CacheDir.empty()) {
+		std::error_code error;
+		fs::create_directories(_CacheDir, error);
+		if (error) {
+			g_logger->warn("MeshLoader::MeshLoaderBuilder ({}): failed to create the cache directory {}: {}: mesh loader won't be built", _Name, _CacheDir, error.message());
+			return res;
+		}
+	}
+
+	res._ThreadPool = std::make_shared<ThreadPool>(_NumThreads);
+	res._CacheDir = _CacheDir;
+
+	g_logger->info("MeshLoader::MeshLoaderBuilder ({}): successfully built mesh loader ({} threads, cache: {})",
+	               _Name,
+	               res._ThreadPool->get_thread_count(),
+	               _CacheDir.empty() ? "none" : _CacheDir);
+
+	res._set_complete();
+
+	return res;
+}
+
+std::future<MeshData> MeshLoader::load_async(const std::string &file_path) const {
+	return _ThreadPool->submit([file_path, cache_dir = _CacheDir]() { return load_mesh(file_path, cache_dir); });
+}
+
+VertexBuffer MeshLoader::load(const std::string &file_path) const {
+	auto mesh = load_async(file_path).get();
+	return build_vertex_buffer(fs::path(file_path).filename().string(), mesh);
+}
+
+VertexBuffer build_vertex_buffer(const std::string &name, const MeshData &mesh) {
+	if (mesh.empty()) {
+		g_logger->warn("MeshLoader: mesh {} is empty: vertex buffer won't be built", name);
+		return {};
+	}
+
+	VertexBuffer::VertexBufferBuilder builder(name, mesh._VertexData);
+	for (const auto &attribute : mesh._Attributes) {
+		builder.add_attribute(attribute._NumComponents, attribute._Format);
+	}
+
+	std::span<const uint16_t> short_indices(reinterpret_cast<const uint16_t *>(mesh._IndexData.data()), mesh._IndexData.size() / sizeof(uint16_t));
+	std::span<const uint32_t> indices(reinterpret_cast<const uint32_t *>(mesh._IndexData.data()), mesh._IndexData.size() / sizeof(uint32_t));
+	if (mesh._IndexType == GL_UNSIGNED_SHORT) {
+		builder.set_indices(short_indices);
+	} else {
+		builder.set_indices(indices);
+	}
+
+	return builder.build();
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,178 @@
+#include <gfx-utils-core/mesh_optimizer.h>
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+namespace gfxutils {
+
+IndexedMesh deduplicate_vertices(std::span<const float> vertices, size_t vertex_size) {
+	IndexedMesh res;
+	res._VertexSize = vertex_size;
+	if (vertex_size == 0) {
+		return res;
+	}
+
+	size_t n_vertices = vertices.size() / vertex_size;
+	auto vertex_bytes = [&](size_t vertex) {
+		return std::string_view(reinterpret_cast<const char *>(vertices.data() + vertex * vertex_size), vertex_size * sizeof(float));
+	};
+
+	// keyed by the bytes of the first occurrence, which stay alive in `vertices`
+	std::unordered_map<std::string_view, uint32_t> vertex_to_index;
+	vertex_to_index.reserve(n_vertices);
+	res._Indices.reserve(n_vertices);
+	for (size_t i = 0; i < n_vertices; i++) {
+		auto [iter, is_new] = vertex_to_index.try_emplace(vertex_bytes(i), static_cast<uint32_t>(vertex_to_index.size()));
+		if (is_new) {
+			res._Vertices.insert(res._Vertices.end(), vertices.begin() + static_cast<std::ptrdiff_t>(i * vertex_size), vertices.begin() + static_cast<std::ptrdiff_t>((i + 1) * vertex_size));
+		}
+		res._Indices.push_back(iter->second);
+	}
+
+	return res;
+}
+
+void optimize_vertex_cache(std::span<uint32_t> indices, size_t n_vertices, size_t cache_size) {
+	size_t n_triangles = indices.size() / 3;
+	if (n_triangles == 0 || n_vertices == 0) {
+		return;
+	}
+
+	// vertex -> adjacent triangles, in CSR form
+	std::vector<uint32_t> live_count(n_vertices, 0);
+	for (size_t i = 0; i < n_triangles * 3; i++) {
+		++live_count[indices[i]];
+	}
+	std::vector<size_t> adjacency_offsets(n_vertices + 1, 0);
+	for (size_t v = 0; v < n_vertices; v++) {
+		adjacency_offsets[v + 1] = adjacency_offsets[v] + live_count[v];
+	}
+	std::vector<uint32_t> adjacency(adjacency_offsets[n_vertices]);
+	{
+		auto fill_offsets = adjacency_offsets;
+		for (size_t t = 0; t < n_triangles; t++) {
+			for (size_t k = 0; k < 3; k++) {
+				adjacency[fill_offsets[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+			}
+		}
+	}
+
+	// a vertex is in the cache if it was referenced less than `cache_size` misses ago
+	std::vector<size_t> cache_time(n_vertices, 0);
+	size_t timestamp = cache_size + 1;
+	std::vector<bool> is_emitted(n_triangles, false);
+	std::vector<uint32_t> dead_end_stack;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(n_triangles * 3);
+
+	size_t cursor = 0;
+	int64_t fanning_vertex = 0;
+	while (fanning_vertex >= 0) {
+		candidates.clear();
+
+		auto v = static_cast<size_t>(fanning_vertex);
+		for (size_t i = adjacency_offsets[v]; i < adjacency_offsets[v + 1]; i++) {
+			auto t = adjacency[i];
+			if (is_emitted[t]) {
+				continue;
+			}
+			for (size_t k = 0; k < 3; k++) {
+				auto u = indices[t * 3 + k];
+				output.push_back(u);
+				dead_end_stack.push_back(u);
+				candidates.push_back(u);
+				--live_count[u];
+				if (timestamp - cache_time[u] > cache_size) {
+					cache_time[u] = timestamp++;
+				}
+			}
+			is_emitted[t] = true;
+		}
+
+		// the candidate staying in the cache the longest after fanning it, if it is still in the cache by then
+		fanning_vertex = -1;
+		int64_t best_priority = -1;
+		for (auto u : candidates) {
+			if (live_count[u] == 0) {
+				continue;
+			}
+			int64_t priority = 0;
+			if (timestamp - cache_time[u] + 2 * live_count[u] <= cache_size) {
+				priority = static_cast<int64_t>(timestamp - cache_time[u]);
+			}
+			if (priority > best_priority) {
+				best_priority = priority;
+				fanning_vertex = u;
+			}
+		}
+
+		// dead end: go back to recently used vertices, then to any vertex left
+		while (fanning_vertex < 0 && !dead_end_stack.empty()) {
+			auto u = dead_end_stack.back();
+			dead_end_stack.pop_back();
+			if (live_count[u] > 0) {
+				fanning_vertex = u;
+			}
+		}
+		for (; fanning_vertex < 0 && cursor < n_vertices; cursor++) {
+			if (live_count[cursor] > 0) {
+				fanning_vertex = static_cast<int64_t>(cursor);
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(IndexedMesh &mesh) {
+	constexpr auto unassigned = std::numeric_limits<uint32_t>::max();
+
+	auto n_vertices = mesh.get_vertex_count();
+	std::vector<uint32_t> remap(n_vertices, unassigned);
+	std::vector<float> vertices;
+	vertices.reserve(mesh._Vertices.size());
+
+	uint32_t next_vertex = 0;
+	for (auto &index : mesh._Indices) {
+		if (remap[index] == unassigned) {
+			remap[index] = next_vertex++;
+			auto first = mesh._Vertices.begin() + static_cast<std::ptrdiff_t>(index * mesh._VertexSize);
+			vertices.insert(vertices.end(), first, first + static_cast<std::ptrdiff_t>(mesh._VertexSize));
+		}
+		index = remap[index];
+	}
+
+	mesh._Vertices = std::move(vertices);
+}
+
+IndexedMesh optimize_mesh(std::span<const float> vertices, size_t vertex_size, size_t cache_size) {
+	auto res = deduplicate_vertices(vertices, vertex_size);
+	optimize_vertex_cache(res._Indices, res.get_vertex_count(), cache_size);
+	optimize_vertex_fetch(res);
+	return res;
+}
+
+float get_acmr(std::span<const uint32_t> indices, size_t n_vertices, size_t cache_size) {
+	size_t n_triangles = indices.size() / 3;
+	if (n_triangles == 0) {
+		return 0.0f;
+	}
+
+	// FIFO: a vertex is a hit while less than `cache_size` misses happened since it entered
+	std::vector<size_t> cache_time(n_vertices, 0);
+	size_t timestamp = cache_size + 1;
+	size_t n_misses = 0;
+	for (size_t i = 0; i < n_triangles * 3; i++) {
+		auto v = indices[i];
+		if (timestamp - cache_time[v] > cache_size) {
+			cache_time[v] = timestamp++;
+			++n_misses;
+		}
+	}
+	return static_cast<float>(n_misses) / static_cast<float>(n_triangles);
+}
+
+}  // namespace gfxutils
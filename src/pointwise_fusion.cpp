@@ -0,0 +1,84 @@
+#include <gfx-utils-core/pointwise_fusion.h>
+
+#include <format>
+#include <regex>
+#include <unordered_set>
+
+namespace gfxutils {
+
+namespace {
+
+// the declarations every post processing shader shares, see assets/post_processing/shader
+constexpr const char *COMMON_DECLARATIONS = R"(uniform sampler2D u_input_texture_sampler;
+uniform vec2 u_window_size;
+uniform vec2 u_input_uv_scale;  // the part of the input holding the image, < 1 with dynamic resolution
+
+vec2 input_uv(vec2 uv) {
+    vec2 half_texel = 0.5 / u_window_size;
+    return clamp(uv, half_texel, 1.0 - half_texel) * u_input_uv_scale;
+}
+)";
+
+}  // namespace
+
+std::string generate_pointwise_shader(std::span<const PointwisePass> passes, ShaderType type) {
+	if (type != ShaderType::FRAGMENT_SHADER && type != ShaderType::COMPUTE_SHADER) {
+		return {};
+	}
+
+	std::string res = "#version 460 core\n\n";
+	if (type == ShaderType::FRAGMENT_SHADER) {
+		res += "in vec2 m_uv;\nout vec4 o_color;\n\n";
+	} else {
+		res += "layout(local_size_x = 8, local_size_y = 8) in;\n\n";
+		res += "layout(binding = 0) writeonly uniform image2D u_output_image;\n";
+	}
+	res += COMMON_DECLARATIONS;
+
+	// each snippet in its own source string number, so compile errors point at the line of the pass
+	for (size_t i = 0; i < passes.size(); i++) {
+		res += std::format("\n// {}\n#define pointwise pointwise_{}\n#line 1 {}\n{}\n#undef pointwise\n", passes[i]._Name, i, i + 1, passes[i]._Source);
+	}
+
+	res += "\nvoid main() {\n";
+	if (type == ShaderType::FRAGMENT_SHADER) {
+		res += "    vec3 color = texture(u_input_texture_sampler, input_uv(m_uv)).xyz;\n";
+	} else {
+		res += "    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);\n";
+		res += "    if(any(greaterThanEqual(vec2(pixel), u_window_size))) {\n        return;\n    }\n";
+		res += "    vec3 color = textureLod(u_input_texture_sampler, input_uv((vec2(pixel) + 0.5) / u_window_size), 0.0).xyz;\n";
+	}
+	for (size_t i = 0; i < passes.size(); i++) {
+		res += std::format("    color = pointwise_{}(color);\n", i);
+	}
+	if (type == ShaderType::FRAGMENT_SHADER) {
+		res += "    o_color = vec4(color, 1.0);\n";
+	} else {
+		res += "    imageStore(u_output_image, pixel, vec4(color, 1.0));\n";
+	}
+	res += "}\n";
+
+	return res;
+}
+
+size_t get_fusible_pass_count(std::span<const PointwisePass> passes) {
+	static const std::regex uniform_pattern(R"(\buniform\s+(?:(?:lowp|mediump|highp)\s+)?\w+\s+(\w+))");
+
+	std::unordered_set<std::string> uniform_names;
+	for (size_t i = 0; i < passes.size(); i++) {
+		std::unordered_set<std::string> pass_uniform_names;
+		for (auto it = std::sregex_iterator(passes[i]._Source.begin(), passes[i]._Source.end(), uniform_pattern); it != std::sregex_iterator(); ++it) {
+			pass_uniform_names.insert((*it)[1].str());
+		}
+
+		for (const auto &name : pass_uniform_names) {
+			if (i != 0 && uniform_names.contains(name)) {
+				return i;
+			}
+		}
+		uniform_names.insert(pass_uniform_names.begin(), pass_uniform_names.end());
+	}
+	return passes.size();
+}
+
+}  // namespace gfxutils
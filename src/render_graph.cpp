@@ -0,0 +1,623 @@
+#include <gfx-utils-core/render_graph.h>
+
+#include <gfx-utils-core/app.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+
+namespace gfxutils {
+
+namespace {
+
+bool is_write_usage(RenderGraphUsage usage) {
+	switch (usage) {
+	case RenderGraphUsage::IMAGE_STORE:
+	case RenderGraphUsage::STORAGE_WRITE:
+	case RenderGraphUsage::COLOR_ATTACHMENT:
+	case RenderGraphUsage::DEPTH_ATTACHMENT:
+	case RenderGraphUsage::COPY_DST:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool is_attachment_usage(RenderGraphUsage usage) {
+	return usage == RenderGraphUsage::COLOR_ATTACHMENT || usage == RenderGraphUsage::DEPTH_ATTACHMENT;
+}
+
+bool is_texture_usage(RenderGraphUsage usage) {
+	switch (usage) {
+	case RenderGraphUsage::SAMPLED:
+	case RenderGraphUsage::IMAGE_LOAD:
+	case RenderGraphUsage::IMAGE_STORE:
+	case RenderGraphUsage::COLOR_ATTACHMENT:
+	case RenderGraphUsage::DEPTH_ATTACHMENT:
+	case RenderGraphUsage::COPY_SRC:
+	case RenderGraphUsage::COPY_DST:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool is_buffer_usage(RenderGraphUsage usage) {
+	switch (usage) {
+	case RenderGraphUsage::STORAGE_READ:
+	case RenderGraphUsage::STORAGE_WRITE:
+	case RenderGraphUsage::UNIFORM:
+	case RenderGraphUsage::VERTEX:
+	case RenderGraphUsage::INDEX:
+	case RenderGraphUsage::INDIRECT:
+	case RenderGraphUsage::COPY_SRC:
+	case RenderGraphUsage::COPY_DST:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// writes that only become visible to later commands after a glMemoryBarrier
+bool is_incoherent_write(RenderGraphUsage usage) {
+	return usage == RenderGraphUsage::IMAGE_STORE || usage == RenderGraphUsage::STORAGE_WRITE;
+}
+
+// the barrier bit making incoherent writes visible to an access of this kind
+GLbitfield get_barrier_bit(RenderGraphUsage usage, bool is_buffer) {
+	switch (usage) {
+	case RenderGraphUsage::SAMPLED:
+		return GL_TEXTURE_FETCH_BARRIER_BIT;
+	case RenderGraphUsage::IMAGE_LOAD:
+	case RenderGraphUsage::IMAGE_STORE:
+		return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+	case RenderGraphUsage::STORAGE_READ:
+	case RenderGraphUsage::STORAGE_WRITE:
+		return GL_SHADER_STORAGE_BARRIER_BIT;
+	case RenderGraphUsage::UNIFORM:
+		return GL_UNIFORM_BARRIER_BIT;
+	case RenderGraphUsage::VERTEX:
+		return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT;
+	case RenderGraphUsage::INDEX:
+		return GL_ELEMENT_ARRAY_BARRIER_BIT;
+	case RenderGraphUsage::INDIRECT:
+		return GL_COMMAND_BARRIER_BIT;
+	case RenderGraphUsage::COLOR_ATTACHMENT:
+	case RenderGraphUsage::DEPTH_ATTACHMENT:
+		return GL_FRAMEBUFFER_BARRIER_BIT;
+	case RenderGraphUsage::COPY_SRC:
+	case RenderGraphUsage::COPY_DST:
+		return is_buffer ? GL_BUFFER_UPDATE_BARRIER_BIT : GL_TEXTURE_UPDATE_BARRIER_BIT;
+	}
+	return GL_ALL_BARRIER_BITS;
+}
+
+// FNV-1a
+void hash_bytes(uint64_t &hash, const void *data, size_t n_bytes) {
+	const auto *bytes = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < n_bytes; i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+}
+
+template<typename T>
+void hash_value(uint64_t &hash, const T &value) {
+	hash_bytes(hash, &value, sizeof(value));
+}
+
+}  // namespace
+
+RenderGraph::Context::Context(const State *state, size_t schedule_index)
+    : _State(state)
+    , _ScheduleIndex(schedule_index) {
+}
+
+const Texture &RenderGraph::Context::get_texture(RenderGraphResource resource) const {
+	static const Texture invalid_texture{};
+
+	if (resource._Index >= _State->_Resources.size() || _State->_Resources[resource._Index]._IsBuffer) {
+		g_logger->warn("RenderGraph ({}): resource #{} is not a texture of this graph", _State->_Name, resource._Index);
+		return invalid_texture;
+	}
+
+	const auto &node = _State->_Resources[resource._Index];
+	if (node._IsImported) {
+		return *node._ImportedTexture;
+	}
+	if (resource._Index >= _State->_PhysicalTextureIndices.size() || _State->_PhysicalTextureIndices[resource._Index] == SIZE_MAX) {
+		g_logger->warn("RenderGraph ({}): texture \"{}\" is not allocated, it is unused or the graph isn't compiled", _State->_Name, node._Name);
+		return invalid_texture;
+	}
+	return _State->_PhysicalTextures[_State->_PhysicalTextureIndices[resource._Index]]._Texture;
+}
+
+GLuint RenderGraph::Context::get_buffer(RenderGraphResource resource) const {
+	if (resource._Index >= _State->_Resources.size() || !_State->_Resources[resource._Index]._IsBuffer) {
+		g_logger->warn("RenderGraph ({}): resource #{} is not a buffer of this graph", _State->_Name, resource._Index);
+		return 0;
+	}
+	return _State->_Resources[resource._Index]._ImportedBuffer;
+}
+
+const RenderPass &RenderGraph::Context::get_render_pass() const {
+	return *_State->_Schedule[_ScheduleIndex]._RenderPass;
+}
+
+RenderGraph::Pass::Pass(State *state, size_t pass_index)
+    : _State(state)
+    , _PassIndex(pass_index) {
+}
+
+RenderGraph::Pass &RenderGraph::Pass::read(RenderGraphResource resource, RenderGraphUsage usage) {
+	auto &pass = _State->_Passes[_PassIndex];
+	if (resource._Index >= _State->_Resources.size()) {
+		g_logger->warn("RenderGraph ({}): pass \"{}\" reads an invalid resource, the read is ignored", _State->_Name, pass._Name);
+		return *this;
+	}
+	if (_State->_Resources[resource._Index]._IsBuffer ? !is_buffer_usage(usage) : !is_texture_usage(usage)) {
+		g_logger->warn("RenderGraph ({}): pass \"{}\" reads \"{}\" with a usage of the wrong resource kind, the read is ignored", _State->_Name, pass._Name, _State->_Resources[resource._Index]._Name);
+		return *this;
+	}
+
+	pass._Accesses.push_back({ resource._Index, usage, false });
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::write(RenderGraphResource resource, RenderGraphUsage usage) {
+	auto &pass = _State->_Passes[_PassIndex];
+	if (resource._Index >= _State->_Resources.size()) {
+		g_logger->warn("RenderGraph ({}): pass \"{}\" writes an invalid resource, the write is ignored", _State->_Name, pass._Name);
+		return *this;
+	}
+
+	const auto &node = _State->_Resources[resource._Index];
+	if (!is_write_usage(usage) || (node._IsBuffer ? !is_buffer_usage(usage) : !is_texture_usage(usage))) {
+		g_logger->warn("RenderGraph ({}): pass \"{}\" writes \"{}\" with a usage that can't write it, the write is ignored", _State->_Name, pass._Name, node._Name);
+		return *this;
+	}
+	if (is_attachment_usage(usage) && pass._Type != RenderGraphPassType::RASTER) {
+		g_logger->warn("RenderGraph ({}): non-raster pass \"{}\" can't render to \"{}\", the write is ignored", _State->_Name, pass._Name, node._Name);
+		return *this;
+	}
+
+	pass._Accesses.push_back({ resource._Index, usage, true });
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::set_side_effect() {
+	_State->_Passes[_PassIndex]._HasSideEffect = true;
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::set_config(const RenderPassConfig &config) {
+	_State->_Passes[_PassIndex]._Config = config;
+	return *this;
+}
+
+RenderGraph::Pass &RenderGraph::Pass::set_execute(ExecuteFunc func) {
+	_State->_Passes[_PassIndex]._Execute = std::move(func);
+	return *this;
+}
+
+RenderGraph::RenderGraphBuilder::RenderGraphBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+RenderGraph RenderGraph::RenderGraphBuilder::_build() const {
+	RenderGraph res;
+	res._set_name(_Name);
+
+	res._State = std::make_shared<State>();
+	res._State->_Name = _Name;
+
+	auto &app = App::instance();
+	std::tie(res._State->_WindowWidth, res._State->_WindowHeight) = app.get_window_size();
+
+	// window-sized textures change the topology hash, the next execute() compiles again
+	std::weak_ptr<State> weak_state = res._State;
+	app.register_on_window_size_func([weak_state](int width, int height) {
+		if (auto state = weak_state.lock(); state != nullptr) {
+			state->_WindowWidth = width;
+			state->_WindowHeight = height;
+		}
+	});
+
+	g_logger->info("RenderGraph::RenderGraphBuilder ({}): successfully built render graph", _Name);
+
+	res._set_complete();
+
+	return res;
+}
+
+RenderGraphResource RenderGraph::import_texture(const std::string &name, const Texture &texture) const {
+	ResourceNode node;
+	node._Name = name;
+	node._IsImported = true;
+	node._IsBuffer = false;
+	node._ImportedTexture = texture;
+	return _add_resource(std::move(node));
+}
+
+RenderGraphResource RenderGraph::import_buffer(const std::string &name, GLuint buffer_handle) const {
+	ResourceNode node;
+	node._Name = name;
+	node._IsImported = true;
+	node._IsBuffer = true;
+	node._ImportedBuffer = buffer_handle;
+	return _add_resource(std::move(node));
+}
+
+RenderGraphResource RenderGraph::import_buffer(const std::string &name, const StorageBuffer &buffer) const {
+	return import_buffer(name, buffer._get_handle());
+}
+
+RenderGraphResource RenderGraph::create_texture(const std::string &name, const RenderTargetDesc &desc) const {
+	ResourceNode node;
+	node._Name = name;
+	node._IsImported = false;
+	node._IsBuffer = false;
+	node._Desc = desc;
+	return _add_resource(std::move(node));
+}
+
+void RenderGraph::set_output(RenderGraphResource resource) const {
+	if (resource._Index >= _State->_Resources.size()) {
+		g_logger->warn("RenderGraph ({}): output is not a resource of this graph", _Name);
+		return;
+	}
+	_State->_Resources[resource._Index]._IsOutput = true;
+}
+
+RenderGraph::Pass RenderGraph::add_pass(const std::string &name, RenderGraphPassType type) const {
+	PassNode node;
+	node._Name = name;
+	node._Type = type;
+	_State->_Passes.push_back(std::move(node));
+	return { _State.get(), _State->_Passes.size() - 1 };
+}
+
+void RenderGraph::reset() const {
+	_State->_Resources.clear();
+	_State->_Passes.clear();
+}
+
+void RenderGraph::compile() const {
+	auto &state = *_State;
+
+	auto hash = _hash_topology();
+	if (state._IsCompiled && hash == state._CompiledHash) {
+		return;
+	}
+
+	_release_physical_resources();
+
+	size_t n_passes = state._Passes.size();
+	size_t n_resources = state._Resources.size();
+
+	// culling, backwards: a pass is needed if something later (or outside the graph) reads what it writes,
+	// a write not paired with a read of the same resource ends the dependency on the passes before it
+	std::vector<bool> is_pass_alive(n_passes, false);
+	std::vector<bool> is_needed(n_resources, false);
+	for (size_t i = n_passes; i-- > 0;) {
+		const auto &pass = state._Passes[i];
+
+		// a raster pass without attachments draws to the default framebuffer, i.e. presents
+		bool is_alive = pass._HasSideEffect ||
+		                (pass._Type == RenderGraphPassType::RASTER &&
+		                 std::ranges::none_of(pass._Accesses, [](const Access &access) { return is_attachment_usage(access._Usage); }));
+		for (const auto &access : pass._Accesses) {
+			const auto &node = state._Resources[access._ResourceIndex];
+			if (access._IsWrite && (node._IsImported || node._IsOutput || is_needed[access._ResourceIndex])) {
+				is_alive = true;
+			}
+		}
+		if (!is_alive) {
+			continue;
+		}
+		is_pass_alive[i] = true;
+
+		for (const auto &access : pass._Accesses) {
+			if (access._IsWrite) {
+				is_needed[access._ResourceIndex] = false;
+			}
+		}
+		for (const auto &access : pass._Accesses) {
+			if (!access._IsWrite) {
+				is_needed[access._ResourceIndex] = true;
+			}
+		}
+	}
+
+	// lifetimes of the transient textures over the schedule
+	std::vector<size_t> first_use(n_resources, SIZE_MAX);
+	std::vector<size_t> last_use(n_resources, 0);
+	std::vector<bool> is_written(n_resources, false);
+	for (size_t i = 0; i < n_passes; i++) {
+		if (!is_pass_alive[i]) {
+			continue;
+		}
+
+		auto schedule_index = state._Schedule.size();
+		state._Schedule.push_back({ i, 0, std::nullopt });
+
+		for (const auto &access : state._Passes[i]._Accesses) {
+			auto resource_index = access._ResourceIndex;
+			const auto &node = state._Resources[resource_index];
+			if (!access._IsWrite && !node._IsImported && !is_written[resource_index]) {
+				g_logger->warn("RenderGraph ({}): pass \"{}\" reads \"{}\" before any pass writes it, its contents are undefined", _Name, state._Passes[i]._Name, node._Name);
+			}
+			is_written[resource_index] = is_written[resource_index] || access._IsWrite;
+			first_use[resource_index] = std::min(first_use[resource_index], schedule_index);
+			last_use[resource_index] = std::max(last_use[resource_index], schedule_index);
+		}
+	}
+
+	// aliasing, greedy in the order of the first uses: a texture is reused once the last use of its previous owner is over
+	std::vector<size_t> transient_indices;
+	for (size_t i = 0; i < n_resources; i++) {
+		const auto &node = state._Resources[i];
+		if (!node._IsImported && !node._IsBuffer && first_use[i] != SIZE_MAX) {
+			transient_indices.push_back(i);
+		}
+	}
+	std::stable_sort(transient_indices.begin(), transient_indices.end(), [&](size_t lhs, size_t rhs) { return first_use[lhs] < first_use[rhs]; });
+
+	state._PhysicalTextureIndices.assign(n_resources, SIZE_MAX);
+	std::vector<size_t> physical_last_use;
+	for (auto resource_index : transient_indices) {
+		auto desc = resolve_render_target_desc(state._Resources[resource_index]._Desc, state._WindowWidth, state._WindowHeight);
+
+		size_t physical_index = SIZE_MAX;
+		for (size_t i = 0; i < state._PhysicalTextures.size(); i++) {
+			if (state._PhysicalTextures[i]._Desc == desc && physical_last_use[i] < first_use[resource_index]) {
+				physical_index = i;
+				break;
+			}
+		}
+
+		if (physical_index == SIZE_MAX) {
+			physical_index = state._PhysicalTextures.size();
+
+			auto texture_name = std::format("{}/{}x{}#{}", _Name, desc._Width, desc._Height, physical_index);
+			auto texture = Texture::TextureBuilder(texture_name)
+			                   .set_size(desc._Width, desc._Height)
+			                   .set_format(desc._InternalFormat)
+			                   .set_filter(GL_NEAREST)
+			                   .set_samples(desc._Samples)
+			                   .build();
+			auto size_bytes = desc._Width * desc._Height * desc._Samples * get_internal_format_size(desc._InternalFormat);
+			state._PhysicalTextures.push_back({ desc, texture, size_bytes });
+			physical_last_use.push_back(0);
+		}
+
+		state._PhysicalTextureIndices[resource_index] = physical_index;
+		physical_last_use[physical_index] = last_use[resource_index];
+	}
+
+	// barriers, tracked per physical resource since aliased textures share their memory
+	// the schedule is walked twice so the writes at the end of one execution are seen by the start of the next one
+	std::vector<size_t> memory_indices(n_resources);
+	for (size_t i = 0; i < n_resources; i++) {
+		memory_indices[i] = state._PhysicalTextureIndices[i] != SIZE_MAX ? state._PhysicalTextureIndices[i] : state._PhysicalTextures.size() + i;
+	}
+
+	constexpr size_t NEVER = SIZE_MAX;
+	std::vector<size_t> last_incoherent_write(state._PhysicalTextures.size() + n_resources, NEVER);
+	std::array<size_t, 32> last_barrier;
+	last_barrier.fill(NEVER);
+
+	size_t n_scheduled = state._Schedule.size();
+	for (size_t step = 0; step < n_scheduled * 2; step++) {
+		auto &compiled_pass = state._Schedule[step % n_scheduled];
+		const auto &accesses = state._Passes[compiled_pass._PassIndex]._Accesses;
+
+		GLbitfield barriers = 0;
+		for (const auto &access : accesses) {
+			auto write_step = last_incoherent_write[memory_indices[access._ResourceIndex]];
+			if (write_step == NEVER) {
+				continue;
+			}
+			auto bit = get_barrier_bit(access._Usage, state._Resources[access._ResourceIndex]._IsBuffer);
+			auto bit_index = static_cast<size_t>(std::countr_zero(bit));
+			if (bit_index >= last_barrier.size() || last_barrier[bit_index] == NEVER || last_barrier[bit_index] <= write_step) {
+				barriers |= bit;
+			}
+		}
+		for (auto bits = barriers; bits != 0; bits &= bits - 1) {
+			last_barrier[static_cast<size_t>(std::countr_zero(bits))] = step;
+		}
+		// a coherent overwrite after the barriers above leaves nothing incoherent behind, e.g. in an aliased texture
+		for (const auto &access : accesses) {
+			auto memory_index = memory_indices[access._ResourceIndex];
+			bool is_overwrite = access._IsWrite && std::ranges::none_of(accesses, [&](const Access &other) { return !other._IsWrite && other._ResourceIndex == access._ResourceIndex; });
+			if (is_overwrite && !is_incoherent_write(access._Usage) && last_incoherent_write[memory_index] != step) {
+				last_incoherent_write[memory_index] = NEVER;
+			}
+		}
+		for (const auto &access : accesses) {
+			if (is_incoherent_write(access._Usage)) {
+				last_incoherent_write[memory_indices[access._ResourceIndex]] = step;
+			}
+		}
+
+		// the second walk sees the steady state, which also covers the first execution
+		if (step >= n_scheduled) {
+			compiled_pass._Barriers = barriers;
+		}
+	}
+
+	// render passes from the attachments, in the order they are written
+	for (size_t i = 0; i < n_scheduled; i++) {
+		auto &compiled_pass = state._Schedule[i];
+		const auto &pass = state._Passes[compiled_pass._PassIndex];
+		if (pass._Type != RenderGraphPassType::RASTER) {
+			continue;
+		}
+
+		RenderPass::RenderPassBuilder render_pass_builder(std::format("{}/{}", _Name, pass._Name));
+		std::vector<size_t> attached_indices;
+		// whether every color attachment / the depth attachment is a transient texture starting / ending its lifetime here
+		bool are_colors_undefined = true;
+		bool are_colors_dead = true;
+		bool has_colors = false;
+		bool is_depth_undefined = false;
+		bool is_depth_dead = false;
+		for (const auto &access : pass._Accesses) {
+			if (!access._IsWrite || !is_attachment_usage(access._Usage) || std::ranges::find(attached_indices, access._ResourceIndex) != attached_indices.end()) {
+				continue;
+			}
+			attached_indices.push_back(access._ResourceIndex);
+
+			const auto &node = state._Resources[access._ResourceIndex];
+			bool is_read_here = std::ranges::any_of(pass._Accesses, [&](const Access &other) { return !other._IsWrite && other._ResourceIndex == access._ResourceIndex; });
+			bool is_undefined = !node._IsImported && first_use[access._ResourceIndex] == i && !is_read_here;
+			bool is_dead = !node._IsImported && !node._IsOutput && last_use[access._ResourceIndex] == i;
+
+			const auto &texture = Context(&state, i).get_texture({ access._ResourceIndex });
+			if (access._Usage == RenderGraphUsage::COLOR_ATTACHMENT) {
+				render_pass_builder.add_color_attachment(texture, false);
+				has_colors = true;
+				are_colors_undefined = are_colors_undefined && is_undefined;
+				are_colors_dead = are_colors_dead && is_dead;
+			} else {
+				render_pass_builder.set_depth_attachment(texture);
+				is_depth_undefined = is_undefined;
+				is_depth_dead = is_dead;
+			}
+		}
+		compiled_pass._RenderPass = render_pass_builder.build();
+
+		compiled_pass._IsColorUndefined = has_colors && are_colors_undefined;
+		compiled_pass._IsColorDead = has_colors && are_colors_dead;
+		compiled_pass._IsDepthUndefined = is_depth_undefined;
+		compiled_pass._IsDepthDead = is_depth_dead;
+	}
+
+	auto &stats = state._Stats;
+	stats._NumPasses = n_passes;
+	stats._NumCulledPasses = n_passes - n_scheduled;
+	stats._NumBarriers = static_cast<size_t>(std::ranges::count_if(state._Schedule, [](const CompiledPass &compiled_pass) { return compiled_pass._Barriers != 0; }));
+	stats._NumTransientTextures = transient_indices.size();
+	stats._NumPhysicalTextures = state._PhysicalTextures.size();
+	stats._PhysicalTextureBytes = 0;
+	for (const auto &physical_texture : state._PhysicalTextures) {
+		stats._PhysicalTextureBytes += physical_texture._SizeBytes;
+	}
+	++stats._NumCompiles;
+
+	state._CompiledHash = hash;
+	state._IsCompiled = true;
+
+	g_logger->info("RenderGraph ({}): compiled {} pass(es) ({} culled), {} barrier(s), {} transient texture(s) in {} texture(s), {:.2f}MB",
+	               _Name,
+	               n_scheduled,
+	               stats._NumCulledPasses,
+	               stats._NumBarriers,
+	               stats._NumTransientTextures,
+	               stats._NumPhysicalTextures,
+	               static_cast<double>(stats._PhysicalTextureBytes) / (1 << 20));
+}
+
+void RenderGraph::execute() const {
+	compile();
+
+	const auto &state = *_State;
+	for (size_t i = 0; i < state._Schedule.size(); i++) {
+		const auto &compiled_pass = state._Schedule[i];
+		const auto &pass = state._Passes[compiled_pass._PassIndex];
+
+		if (compiled_pass._Barriers != 0) {
+			glMemoryBarrier(compiled_pass._Barriers);
+		}
+
+		Context context(&state, i);
+		if (compiled_pass._RenderPass.has_value()) {
+			// only what the pass asked to keep is dropped, an explicit CLEAR stays
+			auto config = pass._Config;
+			if (compiled_pass._IsColorUndefined && config._ColorLoadOp.value_or(LoadOp::LOAD) == LoadOp::LOAD) {
+				config._ColorLoadOp = LoadOp::DONT_CARE;
+			}
+			if (compiled_pass._IsColorDead) {
+				config._ColorStoreOp = StoreOp::DISCARD;
+			}
+			if (compiled_pass._IsDepthUndefined && config._DepthLoadOp.value_or(config._EnableDepthTest ? LoadOp::CLEAR : LoadOp::LOAD) == LoadOp::LOAD) {
+				config._DepthLoadOp = LoadOp::DONT_CARE;
+			}
+			if (compiled_pass._IsDepthDead) {
+				config._DepthStoreOp = StoreOp::DISCARD;
+			}
+
+			compiled_pass._RenderPass->use(config, [&]() {
+				if (pass._Execute) {
+					pass._Execute(context);
+				}
+			});
+		} else if (pass._Execute) {
+			pass._Execute(context);
+		}
+	}
+}
+
+const Texture &RenderGraph::get_texture(RenderGraphResource resource) const {
+	return Context(_State.get(), SIZE_MAX).get_texture(resource);
+}
+
+RenderGraphStats RenderGraph::get_stats() const {
+	return _State->_Stats;
+}
+
+RenderGraphResource RenderGraph::_add_resource(ResourceNode &&node) const {
+	_State->_Resources.push_back(std::move(node));
+	return { _State->_Resources.size() - 1 };
+}
+
+uint64_t RenderGraph::_hash_topology() const {
+	const auto &state = *_State;
+
+	uint64_t hash = 14695981039346656037ull;
+	hash_value(hash, state._Resources.size());
+	for (const auto &node : state._Resources) {
+		hash_value(hash, node._IsImported);
+		hash_value(hash, node._IsBuffer);
+		hash_value(hash, node._IsOutput);
+		if (node._IsImported) {
+			hash_value(hash, node._IsBuffer ? node._ImportedBuffer : node._ImportedTexture->_get_handle());
+		} else {
+			auto desc = resolve_render_target_desc(node._Desc, state._WindowWidth, state._WindowHeight);
+			hash_value(hash, desc._Width);
+			hash_value(hash, desc._Height);
+			hash_value(hash, desc._InternalFormat);
+			hash_value(hash, desc._Samples);
+		}
+	}
+
+	hash_value(hash, state._Passes.size());
+	for (const auto &pass : state._Passes) {
+		hash_value(hash, pass._Type);
+		hash_value(hash, pass._HasSideEffect);
+		hash_value(hash, pass._Accesses.size());
+		for (const auto &access : pass._Accesses) {
+			hash_value(hash, access._ResourceIndex);
+			hash_value(hash, access._Usage);
+			hash_value(hash, access._IsWrite);
+		}
+	}
+
+	return hash;
+}
+
+void RenderGraph::_release_physical_resources() const {
+	auto &state = *_State;
+	for (const auto &physical_texture : state._PhysicalTextures) {
+		ResourceManager::instance().release(ResourceType::TEXTURE, physical_texture._Texture._get_handle());
+	}
+	state._PhysicalTextures.clear();
+	state._PhysicalTextureIndices.clear();
+	state._Schedule.clear();  // the FBOs go with the render passes
+	state._IsCompiled = false;
+}
+
+}  // namespace gfxutils
@@ -1,9 +1,27 @@
 #include <gfx-utils-core/render_pass.h>
 
+#include <gfx-utils-core/app.h>
+#include <gfx-utils-core/gl_state_cache.h>
 #include <gfx-utils-core/logger.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
 namespace gfxutils {
 
+namespace {
+
+// the framebuffer needn't be bound, the callback of RenderPass::use may have bound another one
+void invalidate_attachments(GLuint fbo, const std::vector<GLenum> &attachments) {
+	if (!attachments.empty()) {
+		glInvalidateNamedFramebufferData(fbo, static_cast<GLsizei>(attachments.size()), attachments.data());
+	}
+}
+
+}  // namespace
+
 RenderPass::RenderPassBuilder::RenderPassBuilder(const std::string &name)
     : IBuilder(name) {
 }
@@ -20,21 +38,44 @@ RenderPass::RenderPassBuilder &RenderPass::RenderPassBuilder::set_depth_attachme
 	return *this;
 }
 
-RenderPass RenderPass::RenderPassBuilder::_build() const {
+RenderPass RenderPass::RenderPassBuilder::_build() const & {
 	RenderPass res;
 
-	res._set_name(_Name);
-
-	size_t n_color_attachments = _ColorAttachments.size();
 	res._ColorAttachments = _ColorAttachments;
 	res._ColorAttachmentClearFlags = _ColorAttachmentClearFlags;
 	res._ColorAttachmentClearValues = _ColorAttachmentClearValues;
+	res._DepthAttachment = _DepthAttachment;
+
+	_create_framebuffer(res);
 
-	res._IsDefault = n_color_attachments == 0 && !_DepthAttachment.has_value();  // no attachments, fallback to default FBO
+	return res;
+}
 
+RenderPass RenderPass::RenderPassBuilder::_build() && {
+	RenderPass res;
+
+	res._ColorAttachments = std::move(_ColorAttachments);
+	res._ColorAttachmentClearFlags = std::move(_ColorAttachmentClearFlags);
+	res._ColorAttachmentClearValues = std::move(_ColorAttachmentClearValues);
+	res._DepthAttachment = std::move(_DepthAttachment);
+
+	_create_framebuffer(res);
+
+	return res;
+}
+
+void RenderPass::RenderPassBuilder::_create_framebuffer(RenderPass &res) const {
+	res._set_name(_Name);
+
+	size_t n_color_attachments = res._ColorAttachments.size();
+
+	res._IsDefault = n_color_attachments == 0 && !res._DepthAttachment.has_value();  // no attachments, fallback to default FBO
+
+	bool is_default = res._IsDefault;
 	auto *fbo_raw_handle = new GLuint(0);
 	res._FBO = std::shared_ptr<GLuint>(fbo_raw_handle, [=](GLuint *ptr) {
-		if (!res._IsDefault) {  // if fallback, the delete is handled by the window system, no need to manually delete it
+		if (!is_default) {  // if fallback, the delete is handled by the window system, no need to manually delete it
+			GLStateCache::instance().forget_framebuffer(*ptr);
 			glDeleteFramebuffers(1, ptr);
 		}
 		delete ptr;
@@ -42,11 +83,12 @@ RenderPass RenderPass::RenderPassBuilder::_build() const {
 
 	if (res._IsDefault) {
 		g_logger->info("RenderPass::RenderPassBuilder ({}): successfully built default render pass", _Name);
-		return res;
+		return;
 	}
 
+	auto &gl_state_cache = GLStateCache::instance();
 	glGenFramebuffers(1, res._FBO.get());
-	glBindFramebuffer(GL_FRAMEBUFFER, *res._FBO);
+	gl_state_cache.bind_framebuffer(GL_FRAMEBUFFER, *res._FBO);
 
 	std::vector<GLenum> attachments(n_color_attachments);
 
@@ -54,66 +96,117 @@ RenderPass RenderPass::RenderPassBuilder::_build() const {
 		auto texture_handle = res._ColorAttachments[i]._get_handle();
 		attachments[i] = static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i);
 		if (res._ColorAttachments[i].is_complete()) {
-			glFramebufferTexture2D(GL_FRAMEBUFFER, attachments[i], GL_TEXTURE_2D, texture_handle, 0);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, attachments[i], res._ColorAttachments[i].get_info()._Target, texture_handle, 0);
 		}
 	}
 
-	if (_DepthAttachment.has_value()) {
-		res._DepthAttachment = _DepthAttachment;
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, res._DepthAttachment->_get_handle(), 0);
+	if (res._DepthAttachment.has_value()) {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, res._DepthAttachment->get_info()._Target, res._DepthAttachment->_get_handle(), 0);
 	}
 
 	glDrawBuffers(static_cast<GLsizei>(n_color_attachments), attachments.data());
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
 		g_logger->warn("RenderPass::RenderPassBuilder ({}): framebuffer is not complete!", _Name);
-		return res;
+		return;
 	}
 
 	g_logger->info("RenderPass::RenderPassBuilder ({}): successfully built render pass with {} color attachment(s)", _Name, n_color_attachments);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	gl_state_cache.bind_framebuffer(GL_FRAMEBUFFER, 0);
 
 	res._set_complete();
-
-	return res;
 }
 
 void RenderPass::use(const RenderPassConfig &render_pass_config, const std::function<void()> &callback) const {
-	glBindFramebuffer(GL_FRAMEBUFFER, *_FBO);
-
-	if (render_pass_config._EnableSRGB) {
-		glEnable(GL_FRAMEBUFFER_SRGB);
+	auto &gl_state_cache = GLStateCache::instance();
+	gl_state_cache.bind_framebuffer(GL_FRAMEBUFFER, *_FBO);
+	gl_state_cache.set_capability(GL_FRAMEBUFFER_SRGB, render_pass_config._EnableSRGB);
+	gl_state_cache.set_capability(GL_DEPTH_TEST, render_pass_config._EnableDepthTest);
+
+	auto viewport_size = get_viewport_size(render_pass_config._ResolutionScale);
+	gl_state_cache.set_viewport(0, 0, viewport_size.x, viewport_size.y);
+
+	// the default FBO names its attachments differently, and may have no depth buffer we know of
+	bool has_depth = _IsDefault || _DepthAttachment.has_value();
+	GLenum depth_attachment = _IsDefault ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+	std::vector<GLenum> color_attachments;
+	if (_IsDefault) {
+		color_attachments.push_back(GL_COLOR);
 	} else {
-		glDisable(GL_FRAMEBUFFER_SRGB);
+		for (size_t i = 0; i < _ColorAttachments.size(); i++) {
+			color_attachments.push_back(static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i));
+		}
 	}
 
-	if (render_pass_config._EnableDepthTest) {
-		glEnable(GL_DEPTH_TEST);
-	} else {
-		glDisable(GL_DEPTH_TEST);
+	// load ops
+	std::vector<GLenum> dont_care_attachments;
+	auto depth_load_op = render_pass_config._DepthLoadOp.value_or(render_pass_config._EnableDepthTest ? LoadOp::CLEAR : LoadOp::LOAD);
+	if (has_depth && depth_load_op == LoadOp::CLEAR) {
+		glClear(GL_DEPTH_BUFFER_BIT);
+	} else if (has_depth && depth_load_op == LoadOp::DONT_CARE) {
+		dont_care_attachments.push_back(depth_attachment);
 	}
 
 	if (_IsDefault) {
-		if (render_pass_config._EnableDepthTest) {
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		} else {
+		auto color_load_op = render_pass_config._ColorLoadOp.value_or(LoadOp::CLEAR);
+		if (color_load_op == LoadOp::CLEAR) {
 			glClear(GL_COLOR_BUFFER_BIT);
+		} else if (color_load_op == LoadOp::DONT_CARE) {
+			dont_care_attachments.push_back(GL_COLOR);
 		}
 	} else {
-		if (render_pass_config._EnableDepthTest && _DepthAttachment.has_value()) {
-			glClear(GL_DEPTH_BUFFER_BIT);
-		}
-
-		size_t n_color_attachments = _ColorAttachments.size();
-		for (size_t i = 0; i < n_color_attachments; i++) {
-			if (_ColorAttachmentClearFlags[i]) {
+		for (size_t i = 0; i < _ColorAttachments.size(); i++) {
+			auto color_load_op = render_pass_config._ColorLoadOp.value_or(_ColorAttachmentClearFlags[i] ? LoadOp::CLEAR : LoadOp::LOAD);
+			if (color_load_op == LoadOp::CLEAR) {
 				glClearBufferfv(GL_COLOR, static_cast<GLint>(i), &_ColorAttachmentClearValues[i].r);
+			} else if (color_load_op == LoadOp::DONT_CARE) {
+				dont_care_attachments.push_back(color_attachments[i]);
 			}
 		}
 	}
+	invalidate_attachments(*_FBO, dont_care_attachments);
 
 	callback();
+
+	// store ops
+	std::vector<GLenum> discarded_attachments;
+	if (render_pass_config._ColorStoreOp == StoreOp::DISCARD) {
+		discarded_attachments = color_attachments;
+	}
+	if (has_depth && render_pass_config._DepthStoreOp == StoreOp::DISCARD) {
+		discarded_attachments.push_back(depth_attachment);
+	}
+	invalidate_attachments(*_FBO, discarded_attachments);
+}
+
+glm::ivec2 RenderPass::get_render_area() const {
+	if (_IsDefault) {
+		auto [width, height] = App::instance().get_window_size();
+		return { width, height };
+	}
+
+	// GL renders to the intersection of the attachments
+	glm::ivec2 res(std::numeric_limits<int>::max());
+	auto fit = [&](const Texture &texture) {
+		const auto &info = texture.get_info();
+		res = glm::min(res, glm::ivec2(static_cast<int>(info._Width), static_cast<int>(info._Height)));
+	};
+	for (const auto &color_attachment : _ColorAttachments) {
+		fit(color_attachment);
+	}
+	if (_DepthAttachment.has_value()) {
+		fit(*_DepthAttachment);
+	}
+	return res;
+}
+
+glm::ivec2 RenderPass::get_viewport_size(float resolution_scale) const {
+	auto render_area = get_render_area();
+	auto scale = [&](int size) {
+		return std::clamp(static_cast<int>(std::lround(static_cast<float>(size) * resolution_scale)), 1, std::max(size, 1));
+	};
+	return { scale(render_area.x), scale(render_area.y) };
 }
 
 }  // namespace gfxutils
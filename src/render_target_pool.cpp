@@ -0,0 +1,192 @@
+#include <gfx-utils-core/render_target_pool.h>
+
+#include <gfx-utils-core/app.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+
+namespace gfxutils {
+
+RenderTargetDesc resolve_render_target_desc(const RenderTargetDesc &desc, int window_width, int window_height) {
+	auto res = desc;
+	if (desc._WindowScale > 0.0f) {
+		// minimized windows report 0x0, keep the targets valid anyway
+		res._Width = std::max<size_t>(1, static_cast<size_t>(std::lround(static_cast<float>(window_width) * desc._WindowScale)));
+		res._Height = std::max<size_t>(1, static_cast<size_t>(std::lround(static_cast<float>(window_height) * desc._WindowScale)));
+		res._WindowScale = 0.0f;
+	}
+	res._Samples = std::max<size_t>(res._Samples, 1);
+	return res;
+}
+
+RenderTargetPool::RenderTargetPoolBuilder::RenderTargetPoolBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+RenderTargetPool::RenderTargetPoolBuilder &RenderTargetPool::RenderTargetPoolBuilder::set_max_idle_frames(size_t n_frames) {
+	_MaxIdleFrames = n_frames;
+	return *this;
+}
+
+RenderTargetPool RenderTargetPool::RenderTargetPoolBuilder::_build() const {
+	RenderTargetPool res;
+	res._set_name(_Name);
+
+	res._State = std::make_shared<State>();
+	res._State->_MaxIdleFrames = _MaxIdleFrames;
+
+	auto &app = App::instance();
+	std::tie(res._State->_WindowWidth, res._State->_WindowHeight) = app.get_window_size();
+
+	// only marks the window-sized targets as stale, they are reallocated when next acquired
+	std::weak_ptr<State> weak_state = res._State;
+	app.register_on_window_size_func([weak_state](int width, int height) {
+		if (auto state = weak_state.lock(); state != nullptr && (width != state->_WindowWidth || height != state->_WindowHeight)) {
+			state->_WindowWidth = width;
+			state->_WindowHeight = height;
+			++state->_WindowGeneration;
+		}
+	});
+
+	g_logger->info("RenderTargetPool::RenderTargetPoolBuilder ({}): successfully built render target pool", _Name);
+
+	res._set_complete();
+
+	return res;
+}
+
+RenderTargetDesc RenderTargetPool::resolve(const RenderTargetDesc &desc) const {
+	return resolve_render_target_desc(desc, _State->_WindowWidth, _State->_WindowHeight);
+}
+
+PooledRenderTarget RenderTargetPool::acquire(const RenderTargetDesc &desc) const {
+	auto &state = *_State;
+	auto resolved_desc = resolve(desc);
+
+	Slot *free_slot = nullptr;
+	size_t free_slot_index = 0;
+	for (size_t i = 0; i < state._Slots.size(); i++) {
+		auto &slot = state._Slots[i];
+		if (!slot._IsAlive || slot._IsInUse) {
+			continue;
+		}
+		if (_is_stale(slot)) {
+			_free_slot(slot);
+		} else if (free_slot == nullptr && slot._Desc == resolved_desc) {
+			free_slot = &slot;
+			free_slot_index = i;
+		}
+	}
+
+	if (free_slot == nullptr) {
+		// reuse a tombstone if any, the indices of the live slots must not change
+		auto iter = std::find_if(state._Slots.begin(), state._Slots.end(), [](const Slot &slot) { return !slot._IsAlive; });
+		if (iter == state._Slots.end()) {
+			iter = state._Slots.insert(state._Slots.end(), Slot{});
+		}
+		free_slot = &*iter;
+		free_slot_index = static_cast<size_t>(iter - state._Slots.begin());
+
+		auto target_name = std::format("{}/{}x{}#{}", _Name, resolved_desc._Width, resolved_desc._Height, free_slot_index);
+		auto texture = Texture::TextureBuilder(target_name)
+		                   .set_size(resolved_desc._Width, resolved_desc._Height)
+		                   .set_format(resolved_desc._InternalFormat)
+		                   .set_filter(GL_NEAREST)
+		                   .set_samples(resolved_desc._Samples)
+		                   .build();
+		auto render_pass = RenderPass::RenderPassBuilder(target_name)
+		                       .add_color_attachment(texture, false)
+		                       .build();
+
+		free_slot->_Desc = resolved_desc;
+		free_slot->_Texture = texture;
+		free_slot->_RenderPass = render_pass;
+		free_slot->_SizeBytes = resolved_desc._Width * resolved_desc._Height * resolved_desc._Samples * get_internal_format_size(resolved_desc._InternalFormat);
+		free_slot->_WindowGeneration = state._WindowGeneration;
+		free_slot->_IsWindowSized = desc._WindowScale > 0.0f;
+		free_slot->_IsAlive = true;
+
+		state._AllocatedBytes += free_slot->_SizeBytes;
+		state._PeakBytes = std::max(state._PeakBytes, state._AllocatedBytes);
+
+		g_logger->info("RenderTargetPool ({}): allocated {}x{} target, {:.2f}MB in the pool",
+		               _Name,
+		               resolved_desc._Width,
+		               resolved_desc._Height,
+		               static_cast<double>(state._AllocatedBytes) / (1 << 20));
+	}
+
+	free_slot->_IsInUse = true;
+	free_slot->_LastUsedFrame = state._FrameIndex;
+	++free_slot->_Generation;
+
+	return { free_slot->_Texture, *free_slot->_RenderPass, free_slot_index, free_slot->_Generation };
+}
+
+void RenderTargetPool::release(const PooledRenderTarget &target) const {
+	auto &state = *_State;
+	if (target._SlotIndex >= state._Slots.size() || !state._Slots[target._SlotIndex]._IsAlive ||
+	    state._Slots[target._SlotIndex]._Generation != target._Generation) {
+		g_logger->warn("RenderTargetPool ({}): released target is not from this pool", _Name);
+		return;
+	}
+
+	auto &slot = state._Slots[target._SlotIndex];
+	slot._IsInUse = false;
+	slot._LastUsedFrame = state._FrameIndex;
+	if (_is_stale(slot)) {
+		_free_slot(slot);
+	}
+}
+
+void RenderTargetPool::end_frame() const {
+	auto &state = *_State;
+	for (auto &slot : state._Slots) {
+		if (!slot._IsAlive) {
+			continue;
+		}
+		slot._IsInUse = false;
+		if (_is_stale(slot) || state._FrameIndex - slot._LastUsedFrame > state._MaxIdleFrames) {
+			_free_slot(slot);
+		}
+	}
+	++state._FrameIndex;
+}
+
+void RenderTargetPool::trim() const {
+	for (auto &slot : _State->_Slots) {
+		if (slot._IsAlive && !slot._IsInUse) {
+			_free_slot(slot);
+		}
+	}
+}
+
+RenderTargetPoolStats RenderTargetPool::get_stats() const {
+	RenderTargetPoolStats res;
+	for (const auto &slot : _State->_Slots) {
+		res._NumSlots += slot._IsAlive ? 1 : 0;
+		res._NumInUse += slot._IsAlive && slot._IsInUse ? 1 : 0;
+	}
+	res._AllocatedBytes = _State->_AllocatedBytes;
+	res._PeakBytes = _State->_PeakBytes;
+	return res;
+}
+
+void RenderTargetPool::_free_slot(Slot &slot) const {
+	ResourceManager::instance().release(ResourceType::TEXTURE, slot._Texture._get_handle());
+
+	_State->_AllocatedBytes -= slot._SizeBytes;
+	slot._Texture = {};
+	slot._RenderPass.reset();  // the FBO goes with the last copy of the render pass
+	slot._IsAlive = false;
+	slot._IsInUse = false;
+}
+
+bool RenderTargetPool::_is_stale(const Slot &slot) const {
+	return slot._IsWindowSized && slot._WindowGeneration != _State->_WindowGeneration;
+}
+
+}  // namespace gfxutils
@@ -1,9 +1,12 @@
 #include <gfx-utils-core/resource_manager.h>
 
+#include <gfx-utils-core/gl_state_cache.h>
 #include <gfx-utils-core/logger.h>
 
 #include <glad/glad.h>
 
+#include <algorithm>
+
 namespace gfxutils {
 
 GLuint ResourceManager::alloc(ResourceType type, const std::function<void()> callback) {
@@ -18,6 +21,7 @@ GLuint ResourceManager::alloc(ResourceType type, const std::function<void()> cal
 
 	case ResourceType::VBO:
 	case ResourceType::SSBO:
+	case ResourceType::PBO:
 		glGenBuffers(1, &handle);
 		_BufferList.emplace_back(handle, callback);
 		g_logger->info("ResourceManager: created buffer {}", handle);
@@ -53,6 +57,12 @@ GLuint ResourceManager::alloc(ResourceType type, const std::function<void()> cal
 		g_logger->info("ResourceManager: created shader program {}", handle);
 		break;
 
+	case ResourceType::QUERY:
+		glGenQueries(1, &handle);
+		_QueryList.emplace_back(handle, callback);
+		g_logger->info("ResourceManager: created query {}", handle);
+		break;
+
 	default:
 		break;
 	}
@@ -60,6 +70,72 @@ GLuint ResourceManager::alloc(ResourceType type, const std::function<void()> cal
 	return handle;
 }
 
+void ResourceManager::release(ResourceType type, GLuint handle) {
+	auto &list = _get_list(type);
+	auto iter = std::find_if(list.begin(), list.end(), [&](const auto &entry) { return entry.first == handle; });
+	if (iter == list.end()) {
+		g_logger->warn("ResourceManager: resource {} is not managed, or already released", handle);
+		return;
+	}
+
+	iter->second();
+
+	auto &gl_state_cache = GLStateCache::instance();
+	switch (type) {
+	case ResourceType::VAO:
+		gl_state_cache.forget_vertex_array(handle);
+		glDeleteVertexArrays(1, &handle);
+		break;
+	case ResourceType::VBO:
+	case ResourceType::SSBO:
+	case ResourceType::PBO:
+		glDeleteBuffers(1, &handle);
+		break;
+	case ResourceType::TEXTURE:
+		gl_state_cache.forget_texture(handle);
+		glDeleteTextures(1, &handle);
+		break;
+	case ResourceType::VERTEX_SHADER:
+	case ResourceType::FRAGMENT_SHADER:
+	case ResourceType::COMPUTE_SHADER:
+		glDeleteShader(handle);
+		break;
+	case ResourceType::SHADER_PROGRAM:
+		gl_state_cache.forget_program(handle);
+		glDeleteProgram(handle);
+		break;
+	case ResourceType::QUERY:
+		glDeleteQueries(1, &handle);
+		break;
+	default:
+		break;
+	}
+
+	list.erase(iter);
+	g_logger->info("ResourceManager: released resource {}", handle);
+}
+
+std::vector<std::pair<GLuint, std::function<void()>>> &ResourceManager::_get_list(ResourceType type) {
+	switch (type) {
+	case ResourceType::VAO:
+		return _VAOList;
+	case ResourceType::VBO:
+	case ResourceType::SSBO:
+	case ResourceType::PBO:
+		return _BufferList;
+	case ResourceType::TEXTURE:
+		return _TextureList;
+	case ResourceType::VERTEX_SHADER:
+	case ResourceType::FRAGMENT_SHADER:
+	case ResourceType::COMPUTE_SHADER:
+		return _ShaderList;
+	case ResourceType::QUERY:
+		return _QueryList;
+	default:
+		return _ShaderProgramList;
+	}
+}
+
 void ResourceManager::free() {
 	// unnecessary to free in inverse order, let the driver handles the rest!
 	for (const auto &[handle, callback] : _VAOList) {
@@ -82,6 +158,12 @@ void ResourceManager::free() {
 		callback();
 		glDeleteProgram(handle);
 	}
+	for (const auto &[handle, callback] : _QueryList) {
+		callback();
+		glDeleteQueries(1, &handle);
+	}
+
+	GLStateCache::instance().invalidate();
 }
 
 }  // namespace gfxutils
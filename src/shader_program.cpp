@@ -1,15 +1,18 @@
 #include <gfx-utils-core/shader_program.h>
 
+#include <gfx-utils-core/gl_state_cache.h>
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/resource_manager.h>
 
+#include <algorithm>
 #include <array>
 #include <format>
+#include <limits>
 
 namespace gfxutils {
 
 void ShaderProgram::use() const {
-	glUseProgram(_Program);
+	GLStateCache::instance().use_program(_Program);
 }
 
 void ShaderProgram::set_uniform(const std::string &name, int scalar) {
@@ -33,13 +36,30 @@ void ShaderProgram::set_uniform(const std::string &name, const glm::vec3 &vector
 }
 
 GLint ShaderProgram::get_uniform_location(const std::string &name) {
-	return _MapUniformNameToLocation[name];
+	return find_uniform_location(name);
+}
+
+GLint ShaderProgram::find_uniform_location(const std::string &name) const {
+	auto iter = _MapUniformNameToLocation.find(name);
+	return iter == _MapUniformNameToLocation.end() ? -1 : iter->second;
 }
 
 std::vector<UniformInfo> ShaderProgram::get_all_uniform_info() const {
 	return _UniformInfoVec;
 }
 
+std::vector<StorageBlockInfo> ShaderProgram::get_all_storage_block_info() const {
+	return _StorageBlockInfoVec;
+}
+
+std::optional<StorageBlockInfo> ShaderProgram::get_storage_block_info(const std::string &block_name) const {
+	auto iter = std::find_if(_StorageBlockInfoVec.begin(), _StorageBlockInfoVec.end(), [&](const StorageBlockInfo &info) { return info._Name == block_name; });
+	if (iter == _StorageBlockInfoVec.end()) {
+		return std::nullopt;
+	}
+	return *iter;
+}
+
 ShaderProgram::ShaderProgramBuilder::ShaderProgramBuilder(const std::string &name)
     : IBuilder(name) {
 }
@@ -72,6 +92,20 @@ ShaderProgram ShaderProgram::ShaderProgramBuilder::_build() const {
 		return res;
 	}
 
+	for (const auto &shader : _Shaders) {
+		GLint shader_type = 0;
+		if (shader.is_complete()) {
+			glGetShaderiv(shader._get_handle(), GL_SHADER_TYPE, &shader_type);
+		}
+		if (shader_type == GL_COMPUTE_SHADER) {
+			std::array<GLint, 3> work_group_size{};
+			glGetProgramiv(res._Program, GL_COMPUTE_WORK_GROUP_SIZE, work_group_size.data());
+			for (size_t i = 0; i < 3; i++) {
+				res._WorkGroupSize[i] = static_cast<size_t>(work_group_size[i]);
+			}
+		}
+	}
+
 	// detect all uniforms and cache them
 	GLint n_uniforms = 0;
 	glGetProgramiv(res._Program, GL_ACTIVE_UNIFORMS, &n_uniforms);
@@ -123,6 +157,12 @@ ShaderProgram ShaderProgram::ShaderProgramBuilder::_build() const {
 			case GL_SAMPLER_2D:
 				uniform_info._Type = ShaderDataType::SAMPLER_2D;
 				break;
+			case GL_SAMPLER_2D_ARRAY:
+				uniform_info._Type = ShaderDataType::SAMPLER_2D_ARRAY;
+				break;
+			case GL_IMAGE_2D:
+				uniform_info._Type = ShaderDataType::IMAGE_2D;
+				break;
 			default:  // other types will be implemented if needed
 				g_logger->warn("ShaderProgram::ShaderProgramBuilder ({}): detected unsupported uniform '{}' with type '{}'", _Name, uniform_name_str, uniform_type);
 				break;
@@ -134,6 +174,58 @@ ShaderProgram ShaderProgram::ShaderProgramBuilder::_build() const {
 		}
 	}
 
+	// detect all storage blocks, so that CPU-side structs can be checked against their std430 layout
+	GLint n_storage_blocks = 0;
+	glGetProgramInterfaceiv(res._Program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &n_storage_blocks);
+
+	for (GLint i = 0; i < n_storage_blocks; i++) {
+		constexpr std::array<GLenum, 4> block_props{ GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE, GL_NUM_ACTIVE_VARIABLES };
+		std::array<GLint, 4> block_values{};
+		glGetProgramResourceiv(res._Program, GL_SHADER_STORAGE_BLOCK, i, static_cast<GLsizei>(block_props.size()), block_props.data(), static_cast<GLsizei>(block_values.size()), nullptr, block_values.data());
+
+		std::vector<char> block_name_buffer(block_values[0]);
+		glGetProgramResourceName(res._Program, GL_SHADER_STORAGE_BLOCK, i, block_values[0], nullptr, block_name_buffer.data());
+
+		StorageBlockInfo block_info;
+		block_info._Name = block_name_buffer.data();
+		block_info._Binding = static_cast<size_t>(block_values[1]);
+		block_info._DataSize = static_cast<size_t>(block_values[2]);
+		block_info._ArrayOffset = 0;
+		block_info._ArrayStride = 0;
+
+		// the runtime-sized array is the last member: an array of a basic type is a single variable of array size 0,
+		// an array of structs has a variable per struct member, each with a top level array size of 0
+		constexpr GLenum active_variables_prop = GL_ACTIVE_VARIABLES;
+		std::vector<GLint> variable_indices(block_values[3]);
+		glGetProgramResourceiv(res._Program, GL_SHADER_STORAGE_BLOCK, i, 1, &active_variables_prop, block_values[3], nullptr, variable_indices.data());
+
+		size_t array_offset = std::numeric_limits<size_t>::max();
+		for (auto variable_index : variable_indices) {
+			constexpr std::array<GLenum, 5> variable_props{ GL_OFFSET, GL_ARRAY_SIZE, GL_ARRAY_STRIDE, GL_TOP_LEVEL_ARRAY_SIZE, GL_TOP_LEVEL_ARRAY_STRIDE };
+			std::array<GLint, 5> variable_values{};
+			glGetProgramResourceiv(res._Program, GL_BUFFER_VARIABLE, static_cast<GLuint>(variable_index), static_cast<GLsizei>(variable_props.size()), variable_props.data(), static_cast<GLsizei>(variable_values.size()), nullptr, variable_values.data());
+			if (variable_values[1] == 0) {
+				array_offset = std::min(array_offset, static_cast<size_t>(variable_values[0]));
+				block_info._ArrayStride = static_cast<size_t>(variable_values[2]);
+			} else if (variable_values[3] == 0) {
+				array_offset = std::min(array_offset, static_cast<size_t>(variable_values[0]));
+				block_info._ArrayStride = static_cast<size_t>(variable_values[4]);
+			}
+		}
+		if (block_info._ArrayStride != 0) {
+			block_info._ArrayOffset = array_offset;
+		}
+
+		g_logger->info("ShaderProgram::ShaderProgramBuilder ({}): detected storage block '{}' at binding {}, size = {}, array stride = {}",
+		               _Name,
+		               block_info._Name,
+		               block_info._Binding,
+		               block_info._DataSize,
+		               block_info._ArrayStride);
+
+		res._StorageBlockInfoVec.push_back(std::move(block_info));
+	}
+
 	g_logger->info("ShaderProgram::ShaderProgramBuilder ({}): successfully built shader program", _Name);
 
 	res._set_complete();
@@ -141,4 +233,21 @@ ShaderProgram ShaderProgram::ShaderProgramBuilder::_build() const {
 	return res;
 }
 
+std::array<size_t, 3> ShaderProgram::get_work_group_size() const {
+	return _WorkGroupSize;
+}
+
+std::array<size_t, 3> ShaderProgram::get_group_count(size_t width, size_t height, size_t depth) const {
+	std::array<size_t, 3> n_invocations{ width, height, depth };
+	std::array<size_t, 3> res{};
+	for (size_t i = 0; i < 3; i++) {
+		res[i] = _WorkGroupSize[i] == 0 ? 0 : (n_invocations[i] + _WorkGroupSize[i] - 1) / _WorkGroupSize[i];
+	}
+	return res;
+}
+
+GLuint ShaderProgram::_get_handle() const {
+	return _Program;
+}
+
 }  // namespace gfxutils
@@ -3,6 +3,8 @@
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/resource_manager.h>
 
+#include <algorithm>
+
 namespace gfxutils {
 
 StorageBuffer::StorageBufferBuilder::StorageBufferBuilder(const std::string &name)
@@ -21,7 +23,18 @@ StorageBuffer StorageBuffer::StorageBufferBuilder::_build() const {
 
 	res._BufferSizeBytes = _BufferSizeBytes;
 
-	res._StorageBufferHandle = ResourceManager::instance().alloc(ResourceType::SSBO);
+	res._ReadbackState = std::make_shared<ReadbackState>();
+
+	// fences of reads still in flight have to go before the context does
+	std::weak_ptr<ReadbackState> weak_readback_state = res._ReadbackState;
+	res._StorageBufferHandle = ResourceManager::instance().alloc(ResourceType::SSBO, [weak_readback_state]() {
+		if (auto readback_state = weak_readback_state.lock(); readback_state != nullptr) {
+			for (auto &pending_read : readback_state->_PendingReads) {
+				glDeleteSync(pending_read._Fence);
+			}
+			readback_state->_PendingReads.clear();  // broken promises
+		}
+	});
 
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, res._StorageBufferHandle);
 	// TODO: evaluate the usage on perf effects and consider if it's necessary to expose it
@@ -38,9 +51,103 @@ void StorageBuffer::bind(size_t binding_point) const {
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, static_cast<GLuint>(binding_point), _StorageBufferHandle);
 }
 
-void StorageBuffer::set_data(const uint8_t *data, size_t n_bytes) const {
+void StorageBuffer::set_data(const uint8_t *data, size_t n_bytes, size_t offset) const {
+	if (offset + n_bytes > _BufferSizeBytes) {
+		g_logger->warn("StorageBuffer ({}): write range [{}, {}) is out of range", _Name, offset, offset + n_bytes);
+		return;
+	}
+
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _StorageBufferHandle);
-	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(n_bytes), data);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(n_bytes), data);
+}
+
+std::future<StorageBufferReadback> StorageBuffer::read_async(size_t offset, size_t n_bytes) const {
+	std::promise<StorageBufferReadback> promise;
+	auto res = promise.get_future();
+
+	if (offset + n_bytes > _BufferSizeBytes || n_bytes == 0) {
+		g_logger->warn("StorageBuffer ({}): read range [{}, {}) is out of range or empty", _Name, offset, offset + n_bytes);
+		promise.set_value({});
+		return res;
+	}
+
+	auto &state = *_ReadbackState;
+
+	// the smallest idle staging buffer that is large enough, or a new one
+	std::shared_ptr<StagingBuffer> staging;
+	for (const auto &staging_buffer : state._StagingBuffers) {
+		if (staging_buffer.use_count() == 1 && staging_buffer->_SizeBytes >= n_bytes &&
+		    (staging == nullptr || staging_buffer->_SizeBytes < staging->_SizeBytes)) {
+			staging = staging_buffer;
+		}
+	}
+	if (staging == nullptr) {
+		// client storage: the driver may keep it in cached system memory, which is what CPU reads want
+		constexpr GLbitfield map_flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		auto handle = ResourceManager::instance().alloc(ResourceType::SSBO);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, handle);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(n_bytes), nullptr, map_flags | GL_CLIENT_STORAGE_BIT);
+		auto *mapped_data = static_cast<const uint8_t *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, static_cast<GLsizeiptr>(n_bytes), map_flags));
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		if (mapped_data == nullptr) {
+			g_logger->warn("StorageBuffer ({}): failed to map a staging buffer of {} bytes", _Name, n_bytes);
+			ResourceManager::instance().release(ResourceType::SSBO, handle);
+			promise.set_value({});
+			return res;
+		}
+
+		staging = std::make_shared<StagingBuffer>(StagingBuffer{ handle, mapped_data, n_bytes });
+		state._StagingBuffers.push_back(staging);
+	}
+
+	// compute shader writes are incoherent, make them visible to the copy
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glCopyNamedBufferSubData(_StorageBufferHandle, staging->_BufferHandle, static_cast<GLintptr>(offset), 0, static_cast<GLsizeiptr>(n_bytes));
+	auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();  // otherwise the fence may never be reached while only polled
+
+	state._PendingReads.push_back({ std::move(staging), n_bytes, fence, std::move(promise) });
+
+	return res;
+}
+
+void StorageBuffer::poll_async_reads(bool wait) const {
+	auto &pending_reads = _ReadbackState->_PendingReads;
+
+	// reads complete in submission order, stop at the first one still in flight
+	size_t n_done = 0;
+	for (; n_done < pending_reads.size(); n_done++) {
+		auto &pending_read = pending_reads[n_done];
+
+		GLenum wait_res = glClientWaitSync(pending_read._Fence, 0, 0);
+		while (wait && wait_res == GL_TIMEOUT_EXPIRED) {
+			wait_res = glClientWaitSync(pending_read._Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+		}
+		if (wait_res == GL_TIMEOUT_EXPIRED) {
+			break;
+		}
+		if (wait_res == GL_WAIT_FAILED) {
+			g_logger->warn("StorageBuffer ({}): waiting for a read failed", _Name);
+		}
+
+		glDeleteSync(pending_read._Fence);
+		std::span<const uint8_t> data(pending_read._Staging->_MappedData, pending_read._SizeBytes);
+		pending_read._Promise.set_value({ data, std::move(pending_read._Staging) });
+	}
+
+	pending_reads.erase(pending_reads.begin(), pending_reads.begin() + static_cast<std::ptrdiff_t>(n_done));
+}
+
+size_t StorageBuffer::get_pending_read_count() const {
+	return _ReadbackState->_PendingReads.size();
+}
+
+size_t StorageBuffer::get_size() const {
+	return _BufferSizeBytes;
+}
+
+GLuint StorageBuffer::_get_handle() const {
+	return _StorageBufferHandle;
 }
 
 }  // namespace gfxutils
@@ -0,0 +1,184 @@
+#include <gfx-utils-core/streaming_buffer.h>
+
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gfxutils {
+
+namespace {
+
+constexpr GLuint64 FENCE_WAIT_TIMEOUT_NS = 1'000'000;
+
+size_t align_up(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+StreamingBuffer::StreamingBufferBuilder::StreamingBufferBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+StreamingBuffer::StreamingBufferBuilder &StreamingBuffer::StreamingBufferBuilder::set_region_size(size_t region_size_bytes) {
+	_RegionSizeBytes = region_size_bytes;
+	return *this;
+}
+
+StreamingBuffer::StreamingBufferBuilder &StreamingBuffer::StreamingBufferBuilder::set_region_count(size_t n_regions) {
+	_NumRegions = n_regions;
+	return *this;
+}
+
+StreamingBuffer StreamingBuffer::StreamingBufferBuilder::_build() const {
+	StreamingBuffer res;
+
+	res._set_name(_Name);
+
+	if (_RegionSizeBytes == 0 || _NumRegions == 0) {
+		g_logger->warn("StreamingBuffer::StreamingBufferBuilder ({}): region size or count is 0: streaming buffer won't be built", _Name);
+		return res;
+	}
+
+	GLint ssbo_alignment = 1;
+	GLint ubo_alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &ssbo_alignment);
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ubo_alignment);
+
+	res._State = std::make_shared<State>();
+	auto &state = *res._State;
+	state._Alignment = static_cast<size_t>(std::max({ ssbo_alignment, ubo_alignment, 1 }));
+	// every region starts aligned, so offsets aligned within a region are aligned in the buffer
+	state._RegionSizeBytes = align_up(_RegionSizeBytes, state._Alignment);
+	state._Fences.assign(_NumRegions, nullptr);
+
+	// fences have to go before the context does, like the buffer itself
+	std::weak_ptr<State> weak_state = res._State;
+	state._BufferHandle = ResourceManager::instance().alloc(ResourceType::SSBO, [weak_state]() {
+		if (auto state = weak_state.lock(); state != nullptr) {
+			for (auto &fence : state->_Fences) {
+				if (fence != nullptr) {
+					glDeleteSync(fence);
+					fence = nullptr;
+				}
+			}
+			state->_MappedData = nullptr;  // deleting the buffer unmaps it
+		}
+	});
+
+	constexpr GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	auto buffer_size = static_cast<GLsizeiptr>(state._RegionSizeBytes * _NumRegions);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, state._BufferHandle);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, buffer_size, nullptr, map_flags);
+	state._MappedData = static_cast<uint8_t *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, buffer_size, map_flags));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (state._MappedData == nullptr) {
+		g_logger->warn("StreamingBuffer::StreamingBufferBuilder ({}): failed to map the buffer persistently: streaming buffer won't be built", _Name);
+		return res;
+	}
+
+	g_logger->info("StreamingBuffer::StreamingBufferBuilder ({}): successfully built streaming buffer ({} regions of {} bytes)",
+	               _Name,
+	               _NumRegions,
+	               state._RegionSizeBytes);
+
+	res._set_complete();
+
+	return res;
+}
+
+StreamingAllocation StreamingBuffer::allocate(size_t n_bytes, size_t alignment) const {
+	if (!is_complete()) {
+		return {};
+	}
+
+	auto &state = *_State;
+	if (state._MappedData == nullptr) {  // the buffer was freed with the context
+		return {};
+	}
+
+	auto offset = align_up(state._Head, alignment == 0 ? state._Alignment : alignment);
+	if (offset + n_bytes > state._RegionSizeBytes) {
+		g_logger->warn("StreamingBuffer ({}): {} bytes don't fit into the {} bytes left in this frame", _Name, n_bytes, state._RegionSizeBytes - state._Head);
+		return {};
+	}
+	state._Head = offset + n_bytes;
+	state._Stats._PeakFrameBytes = std::max(state._Stats._PeakFrameBytes, state._Head);
+
+	auto buffer_offset = state._RegionIndex * state._RegionSizeBytes + offset;
+	return { state._MappedData + buffer_offset, buffer_offset, n_bytes };
+}
+
+StreamingAllocation StreamingBuffer::upload(std::span<const uint8_t> data, size_t alignment) const {
+	auto res = allocate(data.size(), alignment);
+	if (!res.empty()) {
+		std::memcpy(res._Data, data.data(), data.size());
+	}
+	return res;
+}
+
+void StreamingBuffer::bind_range(GLenum target, size_t binding_point, const StreamingAllocation &allocation) const {
+	if (!is_complete()) {
+		return;
+	}
+
+	glBindBufferRange(target,
+	                  static_cast<GLuint>(binding_point),
+	                  _State->_BufferHandle,
+	                  static_cast<GLintptr>(allocation._Offset),
+	                  static_cast<GLsizeiptr>(allocation._SizeBytes));
+}
+
+void StreamingBuffer::end_frame() const {
+	if (!is_complete()) {
+		return;
+	}
+
+	auto &state = *_State;
+	if (state._MappedData == nullptr) {  // the buffer was freed with the context
+		return;
+	}
+
+	state._Fences[state._RegionIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	state._RegionIndex = (state._RegionIndex + 1) % state._Fences.size();
+	state._Head = 0;
+	++state._Stats._NumFrames;
+
+	auto &fence = state._Fences[state._RegionIndex];
+	if (fence == nullptr) {
+		return;
+	}
+
+	// the first wait only polls, a region that is still busy means the CPU got too far ahead
+	GLenum wait_res = glClientWaitSync(fence, 0, 0);
+	if (wait_res == GL_TIMEOUT_EXPIRED) {
+		++state._Stats._NumStalls;
+		do {
+			wait_res = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+		} while (wait_res == GL_TIMEOUT_EXPIRED);
+	}
+	if (wait_res == GL_WAIT_FAILED) {
+		g_logger->warn("StreamingBuffer ({}): waiting for the GPU failed", _Name);
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+size_t StreamingBuffer::get_region_size() const {
+	return is_complete() ? _State->_RegionSizeBytes : 0;
+}
+
+const StreamingBufferStats &StreamingBuffer::get_stats() const {
+	static const StreamingBufferStats empty_stats;
+	return is_complete() ? _State->_Stats : empty_stats;
+}
+
+GLuint StreamingBuffer::_get_handle() const {
+	return is_complete() ? _State->_BufferHandle : 0;
+}
+
+}  // namespace gfxutils
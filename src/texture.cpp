@@ -1,18 +1,133 @@
 #include <gfx-utils-core/texture.h>
 
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/image_codec_registry.h>
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/resource_manager.h>
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Weverything"
-#define STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include <stb_image.h>
-#include <stb_image_write.h>
-#pragma clang diagnostic pop
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <utility>
 
 namespace gfxutils {
 
+size_t get_cpu_pixel_size(GLenum cpu_format, GLenum cpu_comp_type) {
+	size_t n_components = 4;
+	switch (cpu_format) {
+	case GL_RED:
+	case GL_RED_INTEGER:
+	case GL_DEPTH_COMPONENT:
+		n_components = 1;
+		break;
+	case GL_RG:
+	case GL_RG_INTEGER:
+		n_components = 2;
+		break;
+	case GL_RGB:
+	case GL_BGR:
+	case GL_RGB_INTEGER:
+		n_components = 3;
+		break;
+	default:
+		break;
+	}
+
+	switch (cpu_comp_type) {
+	case GL_UNSIGNED_BYTE:
+	case GL_BYTE:
+		return n_components;
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+	case GL_HALF_FLOAT:
+		return n_components * 2;
+	default:  // 32-bit component types
+		return n_components * 4;
+	}
+}
+
+size_t get_internal_format_size(GLenum internal_format) {
+	switch (internal_format) {
+	case GL_R8:
+		return 1;
+	case GL_R16F:
+	case GL_RG8:
+		return 2;
+	case GL_RGB16F:
+		return 6;
+	case GL_RGBA16F:
+	case GL_RG32F:
+		return 8;
+	case GL_RGB32F:
+		return 12;
+	case GL_RGBA32F:
+		return 16;
+	default:  // GL_RGBA8, GL_R32F, GL_RG16F, GL_R11F_G11F_B10F, GL_DEPTH24_STENCIL8, ...
+		return 4;
+	}
+}
+
+namespace {
+
+std::pair<GLenum, GLenum> get_image_cpu_format(const Image &image) {
+	constexpr std::array<GLenum, 5> formats_by_channels{ GL_RED, GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	constexpr std::array<GLenum, 3> comp_types_by_element_type{ GL_UNSIGNED_BYTE, GL_HALF_FLOAT, GL_FLOAT };
+	return {
+		formats_by_channels[std::min<size_t>(image.get_channels(), 4)],
+		comp_types_by_element_type[static_cast<size_t>(image.get_element_type())]
+	};
+}
+
+// GL checks the CPU format against the internal format even without data, depth formats take depth CPU formats
+std::pair<GLenum, GLenum> get_depth_cpu_format(GLenum internal_format, GLenum cpu_format, GLenum cpu_comp_type) {
+	switch (internal_format) {
+	case GL_DEPTH_COMPONENT16:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32:
+	case GL_DEPTH_COMPONENT32F:
+		return { GL_DEPTH_COMPONENT, GL_FLOAT };
+	case GL_DEPTH24_STENCIL8:
+		return { GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8 };
+	case GL_DEPTH32F_STENCIL8:
+		return { GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV };
+	default:
+		return { cpu_format, cpu_comp_type };
+	}
+}
+
+// padded rows are addressed with GL_UNPACK_ROW_LENGTH, the Image constructor keeps the stride a multiple of the pixel size
+void set_unpack_row_length(const Image &image) {
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, image.is_packed() ? 0 : static_cast<GLint>(image.get_row_stride() / image.get_pixel_size()));
+}
+
+// one unpack buffer shared by all textures, orphaned on every staged upload so that the driver can hand out
+// fresh storage instead of waiting for the previous transfer; it only grows, to the largest upload so far
+struct UploadBuffer {
+	GLuint _Handle = 0;
+	size_t _SizeBytes = 0;
+};
+
+UploadBuffer g_upload_buffer;
+
+// binds the upload buffer and maps its first n_bytes for writing, nullptr (and nothing bound) on failure
+uint8_t *map_upload_buffer(size_t n_bytes) {
+	if (g_upload_buffer._Handle == 0) {
+		g_upload_buffer._Handle = ResourceManager::instance().alloc(ResourceType::PBO, []() { g_upload_buffer = {}; });
+	}
+	g_upload_buffer._SizeBytes = std::max(g_upload_buffer._SizeBytes, n_bytes);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_upload_buffer._Handle);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(g_upload_buffer._SizeBytes), nullptr, GL_STREAM_DRAW);
+	auto *res = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(n_bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if (res == nullptr) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	return res;
+}
+
+}  // namespace
+
 Texture::TextureBuilder::TextureBuilder(const std::string &name)
     : IBuilder(name) {
 }
@@ -38,25 +153,58 @@ Texture::TextureBuilder &Texture::TextureBuilder::set_filter(GLint filter) {
 	return *this;
 }
 
-Texture::TextureBuilder &Texture::TextureBuilder::set_data(const std::vector<uint8_t> &data) {
-	if (_IsSizeSet && data.size() == _Info._Width * _Info._Height) {
-		_Data = data;
-		_IsDataSet = true;
-	} else {
-		g_logger->warn("Texture ({}): texture size is not set or mismatchs with input data size", _Name);
+Texture::TextureBuilder &Texture::TextureBuilder::set_layers(size_t n_layers) {
+	_Info._Target = GL_TEXTURE_2D_ARRAY;
+	_Info._Layers = n_layers;
+	return *this;
+}
+
+Texture::TextureBuilder &Texture::TextureBuilder::set_samples(size_t n_samples) {
+	_Info._Samples = std::max<size_t>(n_samples, 1);
+	// only switching to or from multisampling changes the target, so that e.g. set_samples(1) keeps set_layers()
+	if (_Info._Samples > 1) {
+		_Info._Target = GL_TEXTURE_2D_MULTISAMPLE;
+	} else if (_Info._Target == GL_TEXTURE_2D_MULTISAMPLE) {
+		_Info._Target = (_Info._Layers > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D);
 	}
 	return *this;
 }
 
-Texture::TextureBuilder &Texture::TextureBuilder::set_data_from_file(const std::string &file_path) {
-	int width = 0;
-	int height = 0;
-	int n_channels_actual = 0;
+Texture::TextureBuilder &Texture::TextureBuilder::set_data(std::span<const uint8_t> data) {
+	_OwnedData = {};
+	_Image = {};
+	_Data = data;
+	_IsDataSet = true;
+	return *this;
+}
 
-	stbi_set_flip_vertically_on_load(1);
-	// the 4th argument `req_comp` == 4: force in RGBA 4 channel format
-	uint8_t *data = stbi_load(file_path.c_str(), &width, &height, &n_channels_actual, 4);
-	if (data == nullptr) {
+Texture::TextureBuilder &Texture::TextureBuilder::set_data(std::vector<uint8_t> &&data) {
+	_OwnedData = std::move(data);
+	_Image = {};
+	_Data = _OwnedData;
+	_IsDataSet = true;
+	return *this;
+}
+
+Texture::TextureBuilder &Texture::TextureBuilder::set_data(Image &&image) {
+	if (image.empty()) {
+		g_logger->warn("Texture ({}): input image is empty", _Name);
+		return *this;
+	}
+
+	_Info._Width = image.get_width();
+	_Info._Height = image.get_height();
+	_OwnedData = {};
+	_Image = std::move(image);
+	_Data = std::span<const uint8_t>(_Image.data(), _Image.get_size_bytes());
+	_IsDataSet = true;
+	_IsSizeSet = true;
+	return *this;
+}
+
+Texture::TextureBuilder &Texture::TextureBuilder::set_data_from_file(const std::string &file_path, const std::string &codec_name, ColorConversion color_conversion) {
+	auto image = ImageCodecRegistry::instance().decode(file_path, codec_name);
+	if (image.empty()) {
 		g_logger->warn("Texture ({}): failed to load texture from {}, maybe the path is incorrect, or the file is corrupted", _Name, file_path);
 		return *this;
 	}
@@ -64,23 +212,22 @@ Texture::TextureBuilder &Texture::TextureBuilder::set_data_from_file(const std::
 	g_logger->info("Texture ({}): loaded texture from {}", _Name, file_path);
 	g_logger->info("Texture ({}): texture info: width = {}, height = {}, n_channels = {}",
 	               _Name,
-	               width,
-	               height,
-	               n_channels_actual);
+	               image.get_width(),
+	               image.get_height(),
+	               image.get_channels());
 
-	_Info._Width = static_cast<size_t>(width);
-	_Info._Height = static_cast<size_t>(height);
-	_Data.assign(data, data + (_Info._Width * _Info._Height * 4));
-
-	stbi_image_free(data);
+	if (color_conversion != ColorConversion::NONE && !image.empty()) {
+		// e.g. 8-bit sRGB files are linearized into float, so that filtering and blending in a float texture are linear
+		image = image.convert(image.get_element_type() == ImageElementType::U8 ? ImageElementType::F16 : image.get_element_type(), color_conversion);
+	}
 
-	_IsDataSet = true;
-	_IsSizeSet = true;
+	// GL expects the first row at the bottom
+	image.flip_vertically();
 
-	return *this;
+	return set_data(std::move(image));
 }
 
-Texture Texture::TextureBuilder::_build() const {
+Texture Texture::TextureBuilder::_build() const & {
 	Texture res;
 
 	res._set_name(_Name);
@@ -95,31 +242,78 @@ Texture Texture::TextureBuilder::_build() const {
 		return res;
 	}
 
-	if (!_IsFilterSet) {
+	bool is_multisample = _Info._Target == GL_TEXTURE_2D_MULTISAMPLE;
+
+	if (!_IsFilterSet && !is_multisample) {
 		g_logger->warn("Texture ({}): texture filter is not set: texture won't be built", _Name);
 		return res;
 	}
 
+	if (_IsDataSet && is_multisample) {
+		g_logger->warn("Texture ({}): multisample textures can't be built with input data: texture won't be built", _Name);
+		return res;
+	}
+
+	GLenum cpu_format = _Info._CPUFormat;
+	GLenum cpu_comp_type = _Info._CPUCompType;
+	if (!_Image.empty()) {
+		std::tie(cpu_format, cpu_comp_type) = get_image_cpu_format(_Image);
+	} else if (!_IsDataSet) {
+		std::tie(cpu_format, cpu_comp_type) = get_depth_cpu_format(_Info._InternalFormat, cpu_format, cpu_comp_type);
+	}
+
+	if (_IsDataSet && _Data.size() < _Info._Width * _Info._Height * _Info._Layers * get_cpu_pixel_size(cpu_format, cpu_comp_type)) {
+		g_logger->warn("Texture ({}): input data size ({} bytes) mismatches with texture size: texture won't be built", _Name, _Data.size());
+		return res;
+	}
+
 	res._Info = _Info;
 
 	res._TextureHandle = ResourceManager::instance().alloc(ResourceType::TEXTURE);
 
-	const uint8_t *data_ptr = (_IsDataSet ? _Data.data() : nullptr);
-
-	glBindTexture(GL_TEXTURE_2D, res._TextureHandle);
-	glTexImage2D(GL_TEXTURE_2D,
-	             0,
-	             _Info._InternalFormat,
-	             static_cast<GLsizei>(_Info._Width),
-	             static_cast<GLsizei>(_Info._Height),
-	             0,
-	             _Info._CPUFormat,
-	             _Info._CPUCompType,
-	             data_ptr);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _Info._Filter);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _Info._Filter);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// tightly packed rows, e.g. RGB8 rows are not always 4-byte aligned
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (!_Image.empty()) {
+		set_unpack_row_length(_Image);
+	}
+	GLStateCache::instance().bind_texture(_Info._Target, res._TextureHandle);
+	if (_Info._Target == GL_TEXTURE_2D_ARRAY) {
+		glTexImage3D(GL_TEXTURE_2D_ARRAY,
+		             0,
+		             _Info._InternalFormat,
+		             static_cast<GLsizei>(_Info._Width),
+		             static_cast<GLsizei>(_Info._Height),
+		             static_cast<GLsizei>(_Info._Layers),
+		             0,
+		             cpu_format,
+		             cpu_comp_type,
+		             _IsDataSet ? _Data.data() : nullptr);
+	} else if (is_multisample) {
+		glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE,
+		                        static_cast<GLsizei>(_Info._Samples),
+		                        _Info._InternalFormat,
+		                        static_cast<GLsizei>(_Info._Width),
+		                        static_cast<GLsizei>(_Info._Height),
+		                        GL_TRUE);
+	} else {
+		glTexImage2D(GL_TEXTURE_2D,
+		             0,
+		             _Info._InternalFormat,
+		             static_cast<GLsizei>(_Info._Width),
+		             static_cast<GLsizei>(_Info._Height),
+		             0,
+		             cpu_format,
+		             cpu_comp_type,
+		             _IsDataSet ? _Data.data() : nullptr);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	if (!is_multisample) {  // sampler states are not allowed on multisample textures
+		glTexParameteri(_Info._Target, GL_TEXTURE_MIN_FILTER, _Info._Filter);
+		glTexParameteri(_Info._Target, GL_TEXTURE_MAG_FILTER, _Info._Filter);
+		glTexParameteri(_Info._Target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(_Info._Target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
 
 	g_logger->info("Texture::TextureBuilder ({}): successfully built texture", _Name);
 
@@ -128,30 +322,181 @@ Texture Texture::TextureBuilder::_build() const {
 	return res;
 }
 
+Texture Texture::TextureBuilder::_build() && {
+	auto res = std::as_const(*this)._build();
+
+	_OwnedData = {};
+	_Image = {};
+	_Data = {};
+	_IsDataSet = false;
+
+	return res;
+}
+
 void Texture::use(size_t texture_unit) const {
-	glActiveTexture(static_cast<GLenum>(GL_TEXTURE0 + texture_unit));
-	glBindTexture(GL_TEXTURE_2D, _TextureHandle);
+	GLStateCache::instance().bind_texture(texture_unit, _Info._Target, _TextureHandle);
+}
+
+void Texture::bind_image(size_t image_unit, GLenum access) const {
+	GLboolean is_layered = _Info._Target == GL_TEXTURE_2D_ARRAY ? GL_TRUE : GL_FALSE;
+	glBindImageTexture(static_cast<GLuint>(image_unit), _TextureHandle, 0, is_layered, 0, access, _Info._InternalFormat);
+}
+
+void Texture::update_layer(size_t layer, size_t x_offset, size_t y_offset, const Image &image) const {
+	if (layer >= _Info._Layers || x_offset + image.get_width() > _Info._Width || y_offset + image.get_height() > _Info._Height) {
+		g_logger->warn("Texture ({}): update region is out of range", _Name);
+		return;
+	}
+
+	auto [cpu_format, cpu_comp_type] = get_image_cpu_format(image);
+	_upload_region(layer, x_offset, y_offset, image.get_width(), image.get_height(), cpu_format, cpu_comp_type, image.data(), image.get_row_stride());
+}
+
+void Texture::update_region(size_t x, size_t y, size_t width, size_t height, std::span<const uint8_t> data, size_t layer) const {
+	if (layer >= _Info._Layers || x + width > _Info._Width || y + height > _Info._Height) {
+		g_logger->warn("Texture ({}): update region is out of range", _Name);
+		return;
+	}
+
+	size_t row_bytes = width * get_cpu_pixel_size(_Info._CPUFormat, _Info._CPUCompType);
+	if (data.size() < row_bytes * height) {
+		g_logger->warn("Texture ({}): update data size ({} bytes) is smaller than the {}x{} region", _Name, data.size(), width, height);
+		return;
+	}
+
+	_upload_region(layer, x, y, width, height, _Info._CPUFormat, _Info._CPUCompType, data.data(), row_bytes);
+}
+
+void Texture::update_region(const Image &image, size_t x, size_t y, size_t width, size_t height, size_t layer) const {
+	if (image.get_width() != _Info._Width || image.get_height() != _Info._Height) {
+		g_logger->warn("Texture ({}): image size ({}x{}) mismatches with texture size", _Name, image.get_width(), image.get_height());
+		return;
+	}
+	if (layer >= _Info._Layers || x + width > _Info._Width || y + height > _Info._Height) {
+		g_logger->warn("Texture ({}): update region is out of range", _Name);
+		return;
+	}
+
+	auto [cpu_format, cpu_comp_type] = get_image_cpu_format(image);
+	const auto *first_pixel = image.data() + y * image.get_row_stride() + x * image.get_pixel_size();
+	_upload_region(layer, x, y, width, height, cpu_format, cpu_comp_type, first_pixel, image.get_row_stride());
+}
+
+void Texture::_upload_region(size_t layer, size_t x, size_t y, size_t width, size_t height, GLenum cpu_format, GLenum cpu_comp_type, const uint8_t *data, size_t row_stride) const {
+	if (_Info._Target == GL_TEXTURE_2D_MULTISAMPLE) {
+		g_logger->warn("Texture ({}): multisample textures can't be updated from the CPU", _Name);
+		return;
+	}
+	if (width == 0 || height == 0) {
+		return;
+	}
+
+	size_t pixel_size = get_cpu_pixel_size(cpu_format, cpu_comp_type);
+	size_t row_bytes = width * pixel_size;
+	size_t n_bytes = row_bytes * height;
+
+	// large regions are packed into the upload buffer, the copy out of it runs asynchronously to the CPU
+	const uint8_t *source = data;
+	bool is_staged = false;
+	if (n_bytes >= PBO_UPLOAD_THRESHOLD) {
+		if (auto *staging = map_upload_buffer(n_bytes); staging != nullptr) {
+			if (row_stride == row_bytes) {
+				std::memcpy(staging, data, n_bytes);
+			} else {
+				for (size_t i = 0; i < height; i++) {
+					std::memcpy(staging + i * row_bytes, data + i * row_stride, row_bytes);
+				}
+			}
+			if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+				source = nullptr;  // offset 0 into the bound unpack buffer
+				row_stride = row_bytes;
+				is_staged = true;
+			} else {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);  // the buffer contents got lost, upload from client memory
+			}
+		}
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, row_stride == row_bytes ? 0 : static_cast<GLint>(row_stride / pixel_size));
+	GLStateCache::instance().bind_texture(_Info._Target, _TextureHandle);
+	if (_Info._Target == GL_TEXTURE_2D_ARRAY) {
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY,
+		                0,
+		                static_cast<GLint>(x),
+		                static_cast<GLint>(y),
+		                static_cast<GLint>(layer),
+		                static_cast<GLsizei>(width),
+		                static_cast<GLsizei>(height),
+		                1,
+		                cpu_format,
+		                cpu_comp_type,
+		                source);
+	} else {
+		glTexSubImage2D(GL_TEXTURE_2D,
+		                0,
+		                static_cast<GLint>(x),
+		                static_cast<GLint>(y),
+		                static_cast<GLsizei>(width),
+		                static_cast<GLsizei>(height),
+		                cpu_format,
+		                cpu_comp_type,
+		                source);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	if (is_staged) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+}
+
+const TextureInfo &Texture::get_info() const {
+	return _Info;
 }
 
 GLuint Texture::_get_handle() const {
 	return _TextureHandle;
 }
 
-void Texture::_export_to_file(const std::string &file_path [[maybe_unused]]) const {
-	std::vector<uint8_t> data(_Info._Width * _Info._Height * 4);
+Image Texture::read_to_image(ImageElementType element_type, size_t layer) const {
+	Image image(_Info._Width, _Info._Height, 4, element_type);
+	auto [cpu_format, cpu_comp_type] = get_image_cpu_format(image);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTextureSubImage(_TextureHandle,
+	                     0,
+	                     0,
+	                     0,
+	                     static_cast<GLint>(layer),
+	                     static_cast<GLsizei>(_Info._Width),
+	                     static_cast<GLsizei>(_Info._Height),
+	                     1,
+	                     cpu_format,
+	                     cpu_comp_type,
+	                     static_cast<GLsizei>(image.get_size_bytes()),
+	                     image.data());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	image.flip_vertically();
+
+	return image;
+}
 
-	glBindTexture(GL_TEXTURE_2D, _TextureHandle);
-	glGetTexImage(GL_TEXTURE_2D, 0, _Info._CPUFormat, _Info._CPUCompType, data.data());
+void Texture::_export_to_file(const std::string &file_path, const std::string &codec_name) const {
+	auto &registry = ImageCodecRegistry::instance();
+	auto codec = (codec_name.empty() ? registry.find_encoder_by_extension(file_path) : registry.find_codec(codec_name));
+	if (codec == nullptr || !codec->can_encode()) {
+		g_logger->warn("Texture ({}): no image codec can write {}", _Name, file_path);
+		return;
+	}
 
-	stbi_flip_vertically_on_write(1);
-	stbi_write_png(file_path.c_str(),
-	               static_cast<int>(_Info._Width),
-	               static_cast<int>(_Info._Height),
-	               4,
-	               data.data(),
-	               static_cast<int>(_Info._Width * 4));
+	auto image = read_to_image(codec->get_encode_element_type());
+	if (!codec->encode(file_path, image)) {
+		g_logger->warn("Texture ({}): failed to save texture to {}", _Name, file_path);
+		return;
+	}
 
-	g_logger->info("Texture ({}): saved texture to {}", _Name, file_path);
+	g_logger->info("Texture ({}): saved texture to {} (codec: {})", _Name, file_path, codec->get_name());
 }
 
 }  // namespace gfxutils
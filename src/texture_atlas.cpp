@@ -0,0 +1,127 @@
+#include <gfx-utils-core/texture_atlas.h>
+
+#include <gfx-utils-core/image_codec_registry.h>
+#include <gfx-utils-core/logger.h>
+
+#include <cstddef>
+#include <format>
+
+namespace gfxutils {
+
+TextureAtlas::TextureAtlasBuilder::TextureAtlasBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::set_page_size(size_t width, size_t height) {
+	_PageWidth = width;
+	_PageHeight = height;
+	return *this;
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::set_padding(size_t padding) {
+	_Padding = padding;
+	return *this;
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::set_format(GLenum internal_format) {
+	_InternalFormat = internal_format;
+	return *this;
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::set_filter(GLint filter) {
+	_Filter = filter;
+	return *this;
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::add_image(const std::string &image_name, Image &&image) {
+	if (image.empty()) {
+		g_logger->warn("TextureAtlas::TextureAtlasBuilder ({}): image '{}' is empty, skipped", _Name, image_name);
+		return *this;
+	}
+
+	// GL expects the first row at the bottom
+	image.flip_vertically();
+	_Images.emplace_back(image_name, std::move(image));
+	return *this;
+}
+
+TextureAtlas::TextureAtlasBuilder &TextureAtlas::TextureAtlasBuilder::add_image_from_file(const std::string &image_name, const std::string &file_path) {
+	return add_image(image_name, ImageCodecRegistry::instance().decode(file_path));
+}
+
+TextureAtlas TextureAtlas::TextureAtlasBuilder::_build() const {
+	TextureAtlas res;
+
+	res._set_name(_Name);
+
+	std::vector<std::pair<size_t, size_t>> sizes;
+	sizes.reserve(_Images.size());
+	for (const auto &[image_name, image] : _Images) {
+		sizes.emplace_back(image.get_width(), image.get_height());
+	}
+
+	AtlasPacker packer(_PageWidth, _PageHeight, _Padding);
+	auto regions = packer.pack_all(sizes);
+
+	if (packer.get_page_count() == 0) {
+		g_logger->warn("TextureAtlas::TextureAtlasBuilder ({}): no image is packed, atlas won't be built", _Name);
+		return res;
+	}
+
+	res._Texture = Texture::TextureBuilder(std::format("{}/pages", _Name))
+	                   .set_size(_PageWidth, _PageHeight)
+	                   .set_layers(packer.get_page_count())
+	                   .set_format(_InternalFormat)
+	                   .set_filter(_Filter)
+	                   .build();
+
+	// the padding between the images would otherwise hold whatever the driver left in the fresh storage
+	const auto &info = res._Texture.get_info();
+	glClearTexImage(res._Texture._get_handle(), 0, info._CPUFormat, info._CPUCompType, nullptr);
+
+	for (size_t i = 0; i < _Images.size(); i++) {
+		const auto &[image_name, image] = _Images[i];
+		if (!regions[i].has_value()) {
+			g_logger->warn("TextureAtlas::TextureAtlasBuilder ({}): image '{}' ({}x{}) is larger than a page, skipped",
+			               _Name,
+			               image_name,
+			               image.get_width(),
+			               image.get_height());
+			continue;
+		}
+
+		// extrude the edge texels into the padding, so that filtering across the border repeats the edge instead of
+		// blending in the neighbouring image
+		auto padding = static_cast<ptrdiff_t>(_Padding);
+		Image extruded(image.get_width() + (2 * _Padding), image.get_height() + (2 * _Padding), image.get_channels(), image.get_element_type());
+		image.copy_region_clamped(-padding, -padding, extruded.get_width(), extruded.get_height(), extruded.data());
+		res._Texture.update_layer(regions[i]->_Page, regions[i]->_X - _Padding, regions[i]->_Y - _Padding, extruded);
+		res._MapNameToEntry[image_name] = res._Entries.size();
+		res._Entries.push_back({ image_name, *regions[i] });
+	}
+
+	g_logger->info("TextureAtlas::TextureAtlasBuilder ({}): successfully packed {} image(s) into {} page(s)", _Name, res._Entries.size(), packer.get_page_count());
+
+	res._set_complete();
+
+	return res;
+}
+
+void TextureAtlas::use(size_t texture_unit) const {
+	_Texture.use(texture_unit);
+}
+
+const Texture &TextureAtlas::get_texture() const {
+	return _Texture;
+}
+
+const std::vector<TextureAtlasEntry> &TextureAtlas::get_entries() const {
+	return _Entries;
+}
+
+const TextureAtlasEntry *TextureAtlas::find_entry(const std::string &image_name) const {
+	auto it = _MapNameToEntry.find(image_name);
+	return (it == _MapNameToEntry.end() ? nullptr : &_Entries[it->second]);
+}
+
+}  // namespace gfxutils
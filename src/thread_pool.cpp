@@ -0,0 +1,51 @@
+#include <gfx-utils-core/thread_pool.h>
+
+#include <algorithm>
+
+namespace gfxutils {
+
+ThreadPool::ThreadPool(size_t n_threads) {
+	if (n_threads == 0) {
+		n_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	_Workers.reserve(n_threads);
+	for (size_t i = 0; i < n_threads; i++) {
+		_Workers.emplace_back(&ThreadPool::_worker_loop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(_Mutex);
+		_IsStopping = true;
+	}
+	_HasTask.notify_all();
+
+	for (auto &worker : _Workers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::get_thread_count() const {
+	return _Workers.size();
+}
+
+void ThreadPool::_worker_loop() {
+	while (true) {
+		std::function<void()> task;
+		{
+			std::unique_lock lock(_Mutex);
+			_HasTask.wait(lock, [&]() { return !_Tasks.empty() || _IsStopping; });
+			if (_Tasks.empty()) {
+				return;  // stopping, and nothing left to run
+			}
+
+			task = std::move(_Tasks.front());
+			_Tasks.pop();
+		}
+		task();
+	}
+}
+
+}  // namespace gfxutils
@@ -0,0 +1,371 @@
+#include <gfx-utils-core/tiled_image_processor.h>
+
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/image_codec_registry.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/resource_manager.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <future>
+
+namespace gfxutils {
+
+namespace {
+
+GLenum get_gl_comp_type(ImageElementType element_type) {
+	return (element_type == ImageElementType::F32 ? GL_FLOAT : GL_UNSIGNED_BYTE);
+}
+
+// a tile whose readback has been issued but not copied to the output band yet
+struct PendingReadback {
+	bool _IsValid = false;
+	GLuint _PBO = 0;
+	GLsync _Fence = nullptr;
+	Image *_Dst = nullptr;
+	size_t _X = 0;
+	size_t _Width = 0;
+	size_t _Height = 0;
+};
+
+void resolve_readback(PendingReadback &pending) {
+	if (!pending._IsValid) {
+		return;
+	}
+
+	GLenum wait_result = GL_TIMEOUT_EXPIRED;
+	while (wait_result == GL_TIMEOUT_EXPIRED) {
+		wait_result = glClientWaitSync(pending._Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+	}
+	glDeleteSync(pending._Fence);
+
+	size_t pixel_size = pending._Dst->get_pixel_size();
+	size_t row_size = pending._Width * pixel_size;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pending._PBO);
+	const auto *src = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(row_size * pending._Height), GL_MAP_READ_BIT));
+	if (src != nullptr) {
+		// read back bottom row first
+		for (size_t y = 0; y < pending._Height; y++) {
+			std::memcpy(pending._Dst->row(pending._Height - 1 - y) + (pending._X * pixel_size), src + (y * row_size), row_size);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	pending._IsValid = false;
+}
+
+}  // namespace
+
+TiledImageProcessor::TiledImageProcessorBuilder::TiledImageProcessorBuilder(const std::string &name)
+    : IBuilder(name) {
+}
+
+TiledImageProcessor::TiledImageProcessorBuilder &TiledImageProcessor::TiledImageProcessorBuilder::set_tile_size(size_t tile_size) {
+	_TileSize = tile_size;
+	return *this;
+}
+
+TiledImageProcessor::TiledImageProcessorBuilder &TiledImageProcessor::TiledImageProcessorBuilder::set_apron(size_t apron) {
+	_Apron = apron;
+	return *this;
+}
+
+TiledImageProcessor::TiledImageProcessorBuilder &TiledImageProcessor::TiledImageProcessorBuilder::set_format(GLenum internal_format) {
+	_InternalFormat = internal_format;
+	return *this;
+}
+
+TiledImageProcessor TiledImageProcessor::TiledImageProcessorBuilder::_build() const {
+	TiledImageProcessor res;
+
+	res._set_name(_Name);
+
+	GLint max_texture_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+
+	res._Apron = _Apron;
+	res._TileSize = _TileSize;
+	if (2 * _Apron >= static_cast<size_t>(max_texture_size)) {
+		g_logger->warn("TiledImageProcessor::TiledImageProcessorBuilder ({}): apron {} doesn't fit into GL_MAX_TEXTURE_SIZE ({}), processor won't be built",
+		               _Name,
+		               _Apron,
+		               max_texture_size);
+		return res;
+	}
+	if (res._TileSize + 2 * _Apron > static_cast<size_t>(max_texture_size)) {
+		res._TileSize = static_cast<size_t>(max_texture_size) - 2 * _Apron;
+		g_logger->info("TiledImageProcessor::TiledImageProcessorBuilder ({}): tile size shrunk to {} to fit GL_MAX_TEXTURE_SIZE ({})",
+		               _Name,
+		               res._TileSize,
+		               max_texture_size);
+	}
+	if (res._TileSize == 0 || _Apron >= res._TileSize) {
+		g_logger->warn("TiledImageProcessor::TiledImageProcessorBuilder ({}): apron ({}) must be smaller than the tile size ({}), processor won't be built",
+		               _Name,
+		               _Apron,
+		               res._TileSize);
+		return res;
+	}
+
+	size_t tile_texture_size = res.get_tile_texture_size();
+	res._InputTile = Texture::TextureBuilder(std::format("{}/input_tile", _Name))
+	                     .set_size(tile_texture_size, tile_texture_size)
+	                     .set_format(_InternalFormat)
+	                     .set_filter(GL_NEAREST)
+	                     .build();
+
+	for (auto &pbo : res._UploadPBOs) {
+		pbo = ResourceManager::instance().alloc(ResourceType::PBO);
+	}
+	for (auto &pbo : res._ReadbackPBOs) {
+		pbo = ResourceManager::instance().alloc(ResourceType::PBO);
+	}
+
+	g_logger->info("TiledImageProcessor::TiledImageProcessorBuilder ({}): successfully built with {}x{} tiles and an apron of {} texel(s)",
+	               _Name,
+	               res._TileSize,
+	               res._TileSize,
+	               _Apron);
+
+	res._set_complete();
+
+	return res;
+}
+
+size_t TiledImageProcessor::get_tile_size() const {
+	return _TileSize;
+}
+
+size_t TiledImageProcessor::get_apron() const {
+	return _Apron;
+}
+
+size_t TiledImageProcessor::get_tile_texture_size() const {
+	return _TileSize + 2 * _Apron;
+}
+
+bool TiledImageProcessor::process(const std::string &input_path,
+                                  const std::string &output_path,
+                                  const TileFunc &tile_func,
+                                  TiledProcessingStats *stats,
+                                  const std::string &input_codec_name,
+                                  const std::string &output_codec_name) const {
+	if (!is_complete()) {
+		g_logger->warn("TiledImageProcessor ({}): processor is incomplete", _Name);
+		return false;
+	}
+
+	auto start_time = std::chrono::steady_clock::now();
+	auto &registry = ImageCodecRegistry::instance();
+
+	auto reader = registry.open_reader(input_path, input_codec_name);
+	if (reader == nullptr) {
+		return false;
+	}
+
+	size_t width = reader->get_width();
+	size_t height = reader->get_height();
+	auto writer = registry.open_writer(output_path, width, height, 4, output_codec_name);
+	if (writer == nullptr) {
+		return false;
+	}
+
+	size_t tile_texture_size = get_tile_texture_size();
+	ImageElementType input_type = reader->get_element_type();
+	ImageElementType output_type = writer->get_element_type();
+	size_t input_pixel_size = 4 * get_image_element_size(input_type);
+	size_t output_pixel_size = 4 * get_image_element_size(output_type);
+	size_t upload_size = tile_texture_size * tile_texture_size * input_pixel_size;
+	size_t readback_size = _TileSize * _TileSize * output_pixel_size;
+
+	for (auto pbo : _UploadPBOs) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(upload_size), nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	for (auto pbo : _ReadbackPBOs) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(readback_size), nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	size_t n_tiles_x = (width + _TileSize - 1) / _TileSize;
+	size_t n_bands = (height + _TileSize - 1) / _TileSize;
+
+	// `band` holds the input rows [band_first_row, band_first_row + height) the current band of tiles reads, apron included
+	Image band = reader->read_rows(std::min(height, _TileSize + _Apron));
+	size_t band_first_row = 0;
+	if (band.empty()) {
+		return false;
+	}
+
+	std::array<GLint, 4> prev_viewport{};
+	glGetIntegerv(GL_VIEWPORT, prev_viewport.data());
+	GLStateCache::instance().set_viewport(0, 0, static_cast<GLsizei>(tile_texture_size), static_cast<GLsizei>(tile_texture_size));
+
+	// the band being written to disk and the one being filled alternate
+	std::array<Image, 2> output_bands;
+	PendingReadback pending;
+	size_t n_tiles = 0;
+	bool ok = true;
+
+	// declared after everything they reference, so they are joined first on an early return
+	std::future<Image> next_rows;
+	std::future<bool> pending_write;
+
+	for (size_t by = 0; by < n_bands && ok; by++) {
+		size_t y0 = by * _TileSize;
+		size_t band_height = std::min(_TileSize, height - y0);
+		size_t rows_end = band_first_row + band.get_height();
+
+		// prefetch the rows the next band adds while this one is on the GPU
+		size_t next_rows_end = std::min(height, y0 + 2 * _TileSize + _Apron);
+		if (by + 1 < n_bands && next_rows_end > rows_end) {
+			next_rows = std::async(std::launch::async, [&reader, n_rows = next_rows_end - rows_end]() {
+				return reader->read_rows(n_rows);
+			});
+		}
+
+		// its previous content was written two bands ago, the write has been waited for before the last one started
+		auto &output_band = output_bands[by % 2];
+		if (output_band.get_height() != band_height) {
+			output_band = Image(width, band_height, 4, output_type);
+		}
+
+		for (size_t tx = 0; tx < n_tiles_x; tx++, n_tiles++) {
+			size_t x0 = tx * _TileSize;
+			size_t tile_width = std::min(_TileSize, width - x0);
+			GLuint upload_pbo = _UploadPBOs[n_tiles % 2];
+			GLuint readback_pbo = _ReadbackPBOs[n_tiles % 2];
+
+			// upload
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_pbo);
+			auto *staging = static_cast<uint8_t *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+			                                                        0,
+			                                                        static_cast<GLsizeiptr>(upload_size),
+			                                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+			if (staging == nullptr) {
+				g_logger->warn("TiledImageProcessor ({}): failed to map the upload buffer", _Name);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				ok = false;
+				break;
+			}
+			// the band holds every row the tile reads, rows beyond it are beyond the image as well
+			band.copy_region_clamped(static_cast<ptrdiff_t>(x0) - static_cast<ptrdiff_t>(_Apron),
+			                         static_cast<ptrdiff_t>(y0) - static_cast<ptrdiff_t>(_Apron) - static_cast<ptrdiff_t>(band_first_row),
+			                         tile_texture_size,
+			                         tile_texture_size,
+			                         staging,
+			                         true);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+			glTextureSubImage2D(_InputTile._get_handle(),
+			                    0,
+			                    0,
+			                    0,
+			                    static_cast<GLsizei>(tile_texture_size),
+			                    static_cast<GLsizei>(tile_texture_size),
+			                    GL_RGBA,
+			                    get_gl_comp_type(input_type),
+			                    nullptr);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+			// process, the viewport set above covers the whole tile
+			const auto &output_tile = tile_func(_InputTile);
+			const auto &output_info = output_tile.get_info();
+			if (output_info._Width != tile_texture_size || output_info._Height != tile_texture_size) {
+				g_logger->warn("TiledImageProcessor ({}): processed tile is {}x{}, expected {}x{}",
+				               _Name,
+				               output_info._Width,
+				               output_info._Height,
+				               tile_texture_size,
+				               tile_texture_size);
+				ok = false;
+				break;
+			}
+
+			// read back the center of the tile, the fence is waited for only after the next tile is submitted
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbo);
+			glGetTextureSubImage(output_tile._get_handle(),
+			                     0,
+			                     static_cast<GLint>(_Apron),
+			                     static_cast<GLint>(tile_texture_size - _Apron - band_height),
+			                     0,
+			                     static_cast<GLsizei>(tile_width),
+			                     static_cast<GLsizei>(band_height),
+			                     1,
+			                     GL_RGBA,
+			                     get_gl_comp_type(output_type),
+			                     static_cast<GLsizei>(readback_size),
+			                     nullptr);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			resolve_readback(pending);
+			pending = { true, readback_pbo, fence, &output_band, x0, tile_width, band_height };
+		}
+
+		resolve_readback(pending);
+		if (!ok) {
+			break;
+		}
+
+		if (pending_write.valid() && !pending_write.get()) {
+			ok = false;
+			break;
+		}
+		pending_write = std::async(std::launch::async, [&writer, &output_band]() {
+			return writer->write_rows(output_band);
+		});
+
+		// slide the band down: keep the rows the next apron overlaps, append the prefetched ones
+		if (by + 1 < n_bands) {
+			Image new_rows = (next_rows.valid() ? next_rows.get() : Image{});
+			size_t next_first_row = y0 + _TileSize - _Apron;
+			size_t n_kept = rows_end - next_first_row;
+
+			Image next_band(width, n_kept + new_rows.get_height(), 4, input_type);
+			size_t row_size = width * input_pixel_size;
+			for (size_t y = 0; y < n_kept; y++) {
+				std::memcpy(next_band.row(y), band.row(next_first_row - band_first_row + y), row_size);
+			}
+			for (size_t y = 0; y < new_rows.get_height(); y++) {
+				std::memcpy(next_band.row(n_kept + y), new_rows.row(y), row_size);
+			}
+
+			if (next_first_row + next_band.get_height() < next_rows_end) {
+				g_logger->warn("TiledImageProcessor ({}): failed to read {}", _Name, input_path);
+				ok = false;
+				break;
+			}
+
+			band = std::move(next_band);
+			band_first_row = next_first_row;
+		}
+	}
+
+	GLStateCache::instance().set_viewport(prev_viewport[0], prev_viewport[1], prev_viewport[2], prev_viewport[3]);
+
+	if (pending_write.valid()) {
+		ok = pending_write.get() && ok;
+	}
+	ok = ok && writer->finish();
+
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	if (stats != nullptr) {
+		*stats = { width, height, n_tiles, seconds };
+	}
+
+	if (ok) {
+		g_logger->info("TiledImageProcessor ({}): processed {} ({}x{}) in {} tile(s), {:.3f}s", _Name, input_path, width, height, n_tiles, seconds);
+	} else {
+		g_logger->warn("TiledImageProcessor ({}): failed to process {}", _Name, input_path);
+	}
+
+	return ok;
+}
+
+}  // namespace gfxutils
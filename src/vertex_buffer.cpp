@@ -1,19 +1,256 @@
 #include <gfx-utils-core/vertex_buffer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <numeric>
+#include <utility>
 
+#include <gfx-utils-core/gl_state_cache.h>
+#include <gfx-utils-core/image_kernels.h>
 #include <gfx-utils-core/logger.h>
 #include <gfx-utils-core/resource_manager.h>
 
 namespace gfxutils {
 
-VertexBuffer::VertexBufferBuilder::VertexBufferBuilder(const std::string &name, const std::vector<float> &data)
+namespace {
+
+struct GLAttributeFormat {
+	GLenum _Type;
+	GLboolean _IsNormalized;
+};
+
+GLAttributeFormat get_gl_attribute_format(VertexAttributeFormat format) {
+	switch (format) {
+	case VertexAttributeFormat::HALF:
+		return { GL_HALF_FLOAT, GL_FALSE };
+	case VertexAttributeFormat::SNORM16:
+		return { GL_SHORT, GL_TRUE };
+	case VertexAttributeFormat::UNORM8:
+		return { GL_UNSIGNED_BYTE, GL_TRUE };
+	case VertexAttributeFormat::INT_2_10_10_10_REV:
+		return { GL_INT_2_10_10_10_REV, GL_TRUE };
+	default:
+		return { GL_FLOAT, GL_FALSE };
+	}
+}
+
+size_t align_to_4(size_t n_bytes) {
+	return (n_bytes + 3) & ~static_cast<size_t>(3);
+}
+
+template<typename T>
+T quantize(float value, float lo, float scale) {
+	return static_cast<T>(std::lround(std::clamp(value, lo, 1.0f) * scale));
+}
+
+// signed 10-bit x, y, z and 2-bit w, from the lowest bits up
+uint32_t pack_int_2_10_10_10_rev(const float *src, size_t n_components) {
+	uint32_t res = 0;
+	for (size_t i = 0; i < 3 && i < n_components; i++) {
+		res |= (static_cast<uint32_t>(quantize<int32_t>(src[i], -1.0f, 511.0f)) & 0x3ffu) << (10 * i);
+	}
+	if (n_components > 3) {
+		res |= (static_cast<uint32_t>(quantize<int32_t>(src[3], -1.0f, 1.0f)) & 0x3u) << 30;
+	}
+	return res;
+}
+
+void pack_attribute(const float *src, uint8_t *dst, size_t n_components, VertexAttributeFormat format) {
+	switch (format) {
+	case VertexAttributeFormat::FLOAT:
+		std::memcpy(dst, src, n_components * sizeof(float));
+		break;
+	case VertexAttributeFormat::HALF: {
+		uint16_t halves[4];
+		convert_f32_to_f16(src, halves, n_components);
+		std::memcpy(dst, halves, n_components * sizeof(uint16_t));
+		break;
+	}
+	case VertexAttributeFormat::SNORM16:
+		for (size_t i = 0; i < n_components; i++) {
+			auto value = quantize<int16_t>(src[i], -1.0f, 32767.0f);
+			std::memcpy(dst + i * sizeof(int16_t), &value, sizeof(int16_t));
+		}
+		break;
+	case VertexAttributeFormat::UNORM8:
+		for (size_t i = 0; i < n_components; i++) {
+			dst[i] = quantize<uint8_t>(src[i], 0.0f, 255.0f);
+		}
+		break;
+	case VertexAttributeFormat::INT_2_10_10_10_REV: {
+		auto value = pack_int_2_10_10_10_rev(src, n_components);
+		std::memcpy(dst, &value, sizeof(uint32_t));
+		break;
+	}
+	}
+}
+
+struct PackedLayout {
+	std::vector<size_t> _Offsets;  // in bytes
+	size_t _StrideBytes = 0;
+	size_t _NumInputComponents = 0;  // floats per element in the input
+};
+
+PackedLayout get_packed_layout(const std::vector<VertexAttributeInfo> &attributes) {
+	PackedLayout res;
+	for (const auto &attribute : attributes) {
+		res._Offsets.push_back(res._StrideBytes);
+		res._StrideBytes += align_to_4(get_vertex_attribute_size(attribute._Format, attribute._NumComponents));
+		res._NumInputComponents += attribute._NumComponents;
+	}
+	return res;
+}
+
+bool is_float_only(const std::vector<VertexAttributeInfo> &attributes) {
+	return std::all_of(attributes.begin(), attributes.end(), [](const VertexAttributeInfo &attribute) { return attribute._Format == VertexAttributeFormat::FLOAT; });
+}
+
+// uploads `data` to the buffer bound to `target`, converted to the GPU layout unless it is float only
+void upload_packed(GLenum target, std::span<const float> data, const std::vector<VertexAttributeInfo> &attributes, GLenum usage) {
+	if (is_float_only(attributes)) {
+		// the input layout is already the GPU layout
+		glBufferData(target, static_cast<GLsizeiptr>(data.size_bytes()), data.data(), usage);
+		return;
+	}
+
+	auto packed_data = pack_vertices(data, attributes);
+	glBufferData(target, static_cast<GLsizeiptr>(packed_data.size()), packed_data.data(), usage);
+}
+
+// points the attributes at the buffer bound to GL_ARRAY_BUFFER, from `first_location` on
+void setup_attributes(const std::vector<VertexAttributeInfo> &attributes, const PackedLayout &layout, size_t first_location) {
+	for (size_t i = 0; i < attributes.size(); i++) {
+		auto location = static_cast<GLuint>(first_location + i);
+		auto [type, is_normalized] = get_gl_attribute_format(attributes[i]._Format);
+		// packed 2_10_10_10 attributes always have 4 components, w reads as 0 when only xyz were given
+		auto n_components = (attributes[i]._Format == VertexAttributeFormat::INT_2_10_10_10_REV ? 4 : attributes[i]._NumComponents);
+		glVertexAttribPointer(location,
+		                      static_cast<GLint>(n_components),
+		                      type,
+		                      is_normalized,
+		                      static_cast<GLsizei>(layout._StrideBytes),
+		                      reinterpret_cast<const void *>(layout._Offsets[i]));
+		glVertexAttribDivisor(location, static_cast<GLuint>(attributes[i]._Divisor));
+		glEnableVertexAttribArray(location);
+	}
+}
+
+bool are_attributes_valid(const std::vector<VertexAttributeInfo> &attributes) {
+	return std::all_of(attributes.begin(), attributes.end(), [](const VertexAttributeInfo &attribute) {
+		return attribute._NumComponents > 0 && attribute._NumComponents <= 4 &&
+		       (attribute._Format != VertexAttributeFormat::INT_2_10_10_10_REV || attribute._NumComponents >= 3);
+	});
+}
+
+}  // namespace
+
+size_t get_vertex_attribute_size(VertexAttributeFormat format, size_t n_components) {
+	switch (format) {
+	case VertexAttributeFormat::HALF:
+	case VertexAttributeFormat::SNORM16:
+		return n_components * 2;
+	case VertexAttributeFormat::UNORM8:
+		return n_components;
+	case VertexAttributeFormat::INT_2_10_10_10_REV:
+		return 4;
+	default:
+		return n_components * sizeof(float);
+	}
+}
+
+size_t get_vertex_stride(const std::vector<VertexAttributeInfo> &attributes) {
+	return get_packed_layout(attributes)._StrideBytes;
+}
+
+std::vector<uint8_t> pack_vertices(std::span<const float> data, const std::vector<VertexAttributeInfo> &attributes) {
+	auto layout = get_packed_layout(attributes);
+	if (layout._NumInputComponents == 0) {
+		return {};
+	}
+
+	size_t n_elements = data.size() / layout._NumInputComponents;
+	std::vector<uint8_t> res(n_elements * layout._StrideBytes);
+	for (size_t i = 0; i < n_elements; i++) {
+		const float *src = data.data() + i * layout._NumInputComponents;
+		for (size_t j = 0; j < attributes.size(); j++) {
+			pack_attribute(src, res.data() + i * layout._StrideBytes + layout._Offsets[j], attributes[j]._NumComponents, attributes[j]._Format);
+			src += attributes[j]._NumComponents;
+		}
+	}
+	return res;
+}
+
+VertexBuffer::VertexBufferBuilder::VertexBufferBuilder(const std::string &name, std::span<const float> data)
     : IBuilder(name)
     , _Data(data) {
 }
 
-VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::add_attribute(size_t n_bytes) {
-	_AttrSizes.push_back(n_bytes);
+VertexBuffer::VertexBufferBuilder::VertexBufferBuilder(const std::string &name, std::vector<float> &&data)
+    : IBuilder(name)
+    , _OwnedData(std::move(data))
+    , _Data(_OwnedData) {
+}
+
+VertexBuffer::VertexBufferBuilder::VertexBufferBuilder(const std::string &name, IndexedMesh &&mesh)
+    : IBuilder(name)
+    , _OwnedData(std::move(mesh._Vertices))
+    , _Data(_OwnedData)
+    , _OwnedIndices(std::move(mesh._Indices))
+    , _Indices(_OwnedIndices) {
+}
+
+VertexBuffer::VertexBufferBuilder::VertexBufferBuilder(const std::string &name, std::span<const uint8_t> packed_data)
+    : IBuilder(name)
+    , _PackedData(packed_data)
+    , _IsPacked(true) {
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::add_attribute(size_t n_components, VertexAttributeFormat format) {
+	_Attributes.push_back({ n_components, format, 0 });
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_indices(std::span<const uint32_t> indices) {
+	_OwnedIndices = {};
+	_Indices = indices;
+	_ShortIndices = {};
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_indices(std::vector<uint32_t> &&indices) {
+	_OwnedIndices = std::move(indices);
+	_Indices = _OwnedIndices;
+	_ShortIndices = {};
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_indices(std::span<const uint16_t> indices) {
+	_OwnedIndices = {};
+	_Indices = {};
+	_ShortIndices = indices;
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::add_instance_attribute(size_t n_components, VertexAttributeFormat format, size_t divisor) {
+	_InstanceAttributes.push_back({ n_components, format, std::max<size_t>(divisor, 1) });
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_instance_data(std::span<const float> data) {
+	_OwnedInstanceData = {};
+	_InstanceData = data;
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_instance_data(std::vector<float> &&data) {
+	_OwnedInstanceData = std::move(data);
+	_InstanceData = _OwnedInstanceData;
+	return *this;
+}
+
+VertexBuffer::VertexBufferBuilder &VertexBuffer::VertexBufferBuilder::set_usage(GLenum usage) {
+	_Usage = usage;
 	return *this;
 }
 
@@ -22,31 +259,108 @@ VertexBuffer VertexBuffer::VertexBufferBuilder::_build() const {
 
 	res._set_name(_Name);
 
+	if (!are_attributes_valid(_Attributes) || !are_attributes_valid(_InstanceAttributes)) {
+		g_logger->warn("VertexBuffer::VertexBufferBuilder ({}): attributes need 1 to 4 components (3 or 4 for INT_2_10_10_10_REV): vertex buffer won't be built", _Name);
+		return res;
+	}
+
+	auto layout = get_packed_layout(_Attributes);
+	if (_IsPacked) {
+		if (layout._StrideBytes == 0 || _PackedData.size() % layout._StrideBytes != 0) {
+			g_logger->warn("VertexBuffer::VertexBufferBuilder ({}): packed data size ({} bytes) is not a multiple of the vertex stride ({} bytes): vertex buffer won't be built",
+			               _Name,
+			               _PackedData.size(),
+			               layout._StrideBytes);
+			return res;
+		}
+		res._NumVertices = _PackedData.size() / layout._StrideBytes;
+	} else {
+		if (layout._NumInputComponents == 0 || _Data.size() % layout._NumInputComponents != 0) {
+			g_logger->warn("VertexBuffer::VertexBufferBuilder ({}): data size ({} floats) is not a multiple of the vertex size ({} floats): vertex buffer won't be built",
+			               _Name,
+			               _Data.size(),
+			               layout._NumInputComponents);
+			return res;
+		}
+		res._NumVertices = _Data.size() / layout._NumInputComponents;
+	}
+
+	auto instance_layout = get_packed_layout(_InstanceAttributes);
+	if (!_InstanceAttributes.empty() && _InstanceData.size() % instance_layout._NumInputComponents != 0) {
+		g_logger->warn("VertexBuffer::VertexBufferBuilder ({}): instance data size ({} floats) is not a multiple of the instance size ({} floats): vertex buffer won't be built",
+		               _Name,
+		               _InstanceData.size(),
+		               instance_layout._NumInputComponents);
+		return res;
+	}
+
+	uint32_t max_index = 0;
+	if (!_Indices.empty()) {
+		max_index = *std::max_element(_Indices.begin(), _Indices.end());
+	} else if (!_ShortIndices.empty()) {
+		max_index = *std::max_element(_ShortIndices.begin(), _ShortIndices.end());
+	}
+	size_t n_indices = _Indices.size() + _ShortIndices.size();
+	if (n_indices > 0 && max_index >= res._NumVertices) {
+		g_logger->warn("VertexBuffer::VertexBufferBuilder ({}): index {} is out of range ({} vertices): vertex buffer won't be built", _Name, max_index, res._NumVertices);
+		return res;
+	}
+
+	res._Usage = _Usage;
+
 	res._VAO = ResourceManager::instance().alloc(ResourceType::VAO);
-	glBindVertexArray(res._VAO);
+	GLStateCache::instance().bind_vertex_array(res._VAO);
 
 	res._VBO = ResourceManager::instance().alloc(ResourceType::VBO);
 	glBindBuffer(GL_ARRAY_BUFFER, res._VBO);
-	glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_Data.size() * sizeof(float)), _Data.data(), GL_STATIC_DRAW);
+	if (_IsPacked) {
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(_PackedData.size()), _PackedData.data(), _Usage);
+	} else {
+		upload_packed(GL_ARRAY_BUFFER, _Data, _Attributes, _Usage);
+	}
+	setup_attributes(_Attributes, layout, 0);
+
+	for (size_t i = 0; i < _Attributes.size(); i++) {
+		g_logger->info("VertexBuffer::VertexBufferBuilder ({}): enabled vertex attribute {} with {} components", _Name, i, _Attributes[i]._NumComponents);
+	}
+
+	if (!_InstanceAttributes.empty()) {
+		res._InstanceVBO = ResourceManager::instance().alloc(ResourceType::VBO);
+		res._InstanceAttributes = _InstanceAttributes;
+		res._NumInstances = _InstanceData.size() / instance_layout._NumInputComponents;
+		glBindBuffer(GL_ARRAY_BUFFER, res._InstanceVBO);
+		upload_packed(GL_ARRAY_BUFFER, _InstanceData, _InstanceAttributes, _Usage);
+		setup_attributes(_InstanceAttributes, instance_layout, _Attributes.size());
 
-	size_t n_attrs = _AttrSizes.size();
-	size_t stride_bytes = std::accumulate(_AttrSizes.begin(), _AttrSizes.end(), static_cast<size_t>(0)) * sizeof(float);
-	for (size_t i = 0, offset_bytes = 0; i < n_attrs; i++) {
-		glVertexAttribPointer(static_cast<GLuint>(i),
-		                      static_cast<GLint>(_AttrSizes[i]),
-		                      GL_FLOAT,
-		                      GL_FALSE,
-		                      static_cast<GLsizei>(stride_bytes),
-		                      reinterpret_cast<const void *>(offset_bytes));
-		glEnableVertexAttribArray(static_cast<GLuint>(i));
-		offset_bytes += _AttrSizes[i] * sizeof(float);
+		g_logger->info("VertexBuffer::VertexBufferBuilder ({}): enabled {} instance attribute(s) from location {}", _Name, _InstanceAttributes.size(), _Attributes.size());
+	}
 
-		g_logger->info("VertexBuffer::VertexBufferBuilder ({}): enabled vertex attribute {} with {} components", _Name, i, _AttrSizes[i]);
+	if (n_indices > 0) {
+		// the element array binding is part of the vertex array state
+		res._EBO = ResourceManager::instance().alloc(ResourceType::VBO);
+		res._NumIndices = n_indices;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, res._EBO);
+		if (!_ShortIndices.empty()) {
+			res._IndexType = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(_ShortIndices.size_bytes()), _ShortIndices.data(), _Usage);
+		} else if (max_index <= 0xffff) {
+			std::vector<uint16_t> short_indices(_Indices.begin(), _Indices.end());
+			res._IndexType = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(short_indices.size() * sizeof(uint16_t)), short_indices.data(), _Usage);
+		} else {
+			res._IndexType = GL_UNSIGNED_INT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(_Indices.size_bytes()), _Indices.data(), _Usage);
+		}
 	}
 
-	glBindVertexArray(0);
+	GLStateCache::instance().bind_vertex_array(0);
 
-	g_logger->info("VertexBuffer::VertexBufferBuilder ({}): successfully built vertex buffer", _Name);
+	g_logger->info("VertexBuffer::VertexBufferBuilder ({}): successfully built vertex buffer ({} vertices of {} bytes, {} indices, {} instances)",
+	               _Name,
+	               res._NumVertices,
+	               layout._StrideBytes,
+	               res._NumIndices,
+	               res._NumInstances);
 
 	res._set_complete();
 
@@ -54,7 +368,68 @@ VertexBuffer VertexBuffer::VertexBufferBuilder::_build() const {
 }
 
 void VertexBuffer::use() const {
-	glBindVertexArray(_VAO);
+	GLStateCache::instance().bind_vertex_array(_VAO);
+}
+
+void VertexBuffer::draw(GLenum mode) const {
+	GLStateCache::instance().bind_vertex_array(_VAO);
+	if (_EBO != 0) {
+		glDrawElements(mode, static_cast<GLsizei>(_NumIndices), _IndexType, nullptr);
+	} else {
+		glDrawArrays(mode, 0, static_cast<GLsizei>(_NumVertices));
+	}
+}
+
+void VertexBuffer::draw_instanced(size_t n_instances, GLenum mode, size_t first_instance) const {
+	GLStateCache::instance().bind_vertex_array(_VAO);
+	if (_EBO != 0) {
+		glDrawElementsInstancedBaseInstance(mode, static_cast<GLsizei>(_NumIndices), _IndexType, nullptr, static_cast<GLsizei>(n_instances), static_cast<GLuint>(first_instance));
+	} else {
+		glDrawArraysInstancedBaseInstance(mode, 0, static_cast<GLsizei>(_NumVertices), static_cast<GLsizei>(n_instances), static_cast<GLuint>(first_instance));
+	}
+}
+
+void VertexBuffer::update_instance_data(std::span<const float> data) {
+	if (_InstanceVBO == 0) {
+		g_logger->warn("VertexBuffer ({}): no instance attribute was added", _Name);
+		return;
+	}
+
+	auto layout = get_packed_layout(_InstanceAttributes);
+	if (data.size() % layout._NumInputComponents != 0) {
+		g_logger->warn("VertexBuffer ({}): instance data size ({} floats) is not a multiple of the instance size ({} floats)", _Name, data.size(), layout._NumInputComponents);
+		return;
+	}
+
+	// glBufferData orphans the old storage, so draws still reading it don't stall the update
+	_NumInstances = data.size() / layout._NumInputComponents;
+	glBindBuffer(GL_ARRAY_BUFFER, _InstanceVBO);
+	upload_packed(GL_ARRAY_BUFFER, data, _InstanceAttributes, _Usage);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t VertexBuffer::get_vertex_count() const {
+	return _NumVertices;
+}
+
+size_t VertexBuffer::get_index_count() const {
+	return _NumIndices;
+}
+
+size_t VertexBuffer::get_instance_count() const {
+	return _NumInstances;
+}
+
+bool VertexBuffer::is_indexed() const {
+	return _EBO != 0;
+}
+
+GLenum VertexBuffer::get_index_type() const {
+	return _IndexType;
+}
+
+GLuint VertexBuffer::_get_handle() const {
+	return _VAO;
 }
 
 }  // namespace gfxutils
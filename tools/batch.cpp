@@ -0,0 +1,311 @@
+#include <gfx-utils-core/app.h>
+#include <gfx-utils-core/batch_image_processor.h>
+#include <gfx-utils-core/effect_chain.h>
+#include <gfx-utils-core/image_codec_registry.h>
+#include <gfx-utils-core/logger.h>
+#include <gfx-utils-core/render_target_pool.h>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// runs effect chains described by a post_processing config.json over many image files, without a window
+//
+// usage: gfx-utils-batch --config <config.json> [options] <inputs...>
+//   inputs: image files, directories (their images, non-recursive) or @list.txt (one path per line)
+//   --shader-root <dir>      where the vs_path / fs_path of the config are resolved (default: the folder of the config + /shader)
+//   --effect <fx_name>       applied in the given order, may be repeated; without any, the available effects are listed
+//   --uniform <name>=<value> parameter set on every selected effect that declares it (all its components), may be repeated
+//   --no-fusion              runs consecutive pointwise passes one by one rather than in one generated shader
+//   --full-precision         renders every pass into GL_RGBA32F rather than the format its declared precision needs
+//   --validate-precision     also runs each tile at full precision and prints the largest difference (slower)
+//   --output-dir <dir>       default: output
+//   --format <.ext>          output format, default: .png
+//   --tile-size <n>          default: 1024
+//   --apron <n>              default: 16, at least the widest kernel radius of the chain
+//   --decode-threads <n>     default: half of the hardware threads
+//   --encode-threads <n>     default: half of the hardware threads
+//   --queue-capacity <n>     images buffered between the stages, default: 4
+
+using namespace gfxutils;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BatchOptions {
+	std::string _ConfigPath;
+	std::string _ShaderRoot;
+	std::vector<std::string> _EffectNames;
+	std::vector<std::pair<std::string, float>> _Uniforms;
+	bool _IsFusionEnabled = true;
+	bool _IsAutoPrecisionEnabled = true;
+	bool _IsPrecisionValidated = false;
+	std::string _OutputDir = "output";
+	std::string _OutputFormat = ".png";
+	size_t _TileSize = 1024;
+	size_t _Apron = 16;
+	size_t _NumDecodeThreads = 0;
+	size_t _NumEncodeThreads = 0;
+	size_t _QueueCapacity = 4;
+	std::vector<std::string> _Inputs;
+};
+
+constexpr const char *USAGE = "usage: gfx-utils-batch --config <config.json> [--effect <fx_name>]... [options] <inputs...>";
+
+// the whole of `text` must be the number, e.g. "12px" or "-1" for a size are rejected
+template<typename T>
+bool parse_number(const std::string &text, T &value) {
+	const char *end = text.data() + text.size();
+	auto [ptr, error] = std::from_chars(text.data(), end, value);
+	return error == std::errc() && ptr == end;
+}
+
+bool parse_options(int argc, char **argv, BatchOptions &options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool is_value_missing = false;
+		auto next_value = [&]() -> std::string {
+			if (i + 1 >= argc) {
+				is_value_missing = true;
+				return {};
+			}
+			return argv[++i];
+		};
+		auto next_size = [&](size_t &value) {
+			auto text = next_value();
+			if (!is_value_missing && !parse_number(text, value)) {
+				g_logger->error("{} expects a non-negative integer, got '{}'\n{}", arg, text, USAGE);
+				return false;
+			}
+			return true;
+		};
+
+		if (arg == "--config") {
+			options._ConfigPath = next_value();
+		} else if (arg == "--shader-root") {
+			options._ShaderRoot = next_value();
+		} else if (arg == "--effect") {
+			options._EffectNames.push_back(next_value());
+		} else if (arg == "--uniform") {
+			auto value = next_value();
+			auto eq = value.find('=');
+			if (eq == std::string::npos) {
+				g_logger->error("--uniform expects <name>=<value>, got '{}'", value);
+				return false;
+			}
+			float uniform_value = 0.0f;
+			if (!parse_number(value.substr(eq + 1), uniform_value)) {
+				g_logger->error("--uniform expects a number after '=', got '{}'\n{}", value, USAGE);
+				return false;
+			}
+			options._Uniforms.emplace_back(value.substr(0, eq), uniform_value);
+		} else if (arg == "--no-fusion") {
+			options._IsFusionEnabled = false;
+		} else if (arg == "--full-precision") {
+			options._IsAutoPrecisionEnabled = false;
+		} else if (arg == "--validate-precision") {
+			options._IsPrecisionValidated = true;
+		} else if (arg == "--output-dir") {
+			options._OutputDir = next_value();
+		} else if (arg == "--format") {
+			options._OutputFormat = next_value();
+		} else if (arg == "--tile-size") {
+			if (!next_size(options._TileSize)) {
+				return false;
+			}
+		} else if (arg == "--apron") {
+			if (!next_size(options._Apron)) {
+				return false;
+			}
+		} else if (arg == "--decode-threads") {
+			if (!next_size(options._NumDecodeThreads)) {
+				return false;
+			}
+		} else if (arg == "--encode-threads") {
+			if (!next_size(options._NumEncodeThreads)) {
+				return false;
+			}
+		} else if (arg == "--queue-capacity") {
+			if (!next_size(options._QueueCapacity)) {
+				return false;
+			}
+		} else if (arg.starts_with("--")) {
+			g_logger->error("unknown option {}\n{}", arg, USAGE);
+			return false;
+		} else {
+			options._Inputs.push_back(arg);
+		}
+
+		if (is_value_missing) {
+			g_logger->error("missing value for {}\n{}", arg, USAGE);
+			return false;
+		}
+	}
+
+	if (options._ConfigPath.empty()) {
+		g_logger->error("{}", USAGE);
+		return false;
+	}
+	if (options._ShaderRoot.empty()) {
+		options._ShaderRoot = (fs::path(options._ConfigPath).parent_path() / "shader").string();
+	}
+	if (!options._OutputFormat.starts_with('.')) {
+		options._OutputFormat = "." + options._OutputFormat;
+	}
+	return true;
+}
+
+std::vector<BatchJob> collect_jobs(const BatchOptions &options) {
+	auto &registry = ImageCodecRegistry::instance();
+
+	std::vector<std::string> input_paths;
+	for (const auto &input : options._Inputs) {
+		if (input.starts_with('@')) {
+			std::ifstream list_in(input.substr(1));
+			for (std::string line; std::getline(list_in, line);) {
+				if (!line.empty()) {
+					input_paths.push_back(line);
+				}
+			}
+		} else if (fs::is_directory(input)) {
+			for (const auto &entry : fs::directory_iterator(input)) {
+				if (entry.is_regular_file() && registry.find_decoder_by_extension(entry.path().string()) != nullptr) {
+					input_paths.push_back(entry.path().string());
+				}
+			}
+		} else {
+			input_paths.push_back(input);
+		}
+	}
+
+	std::vector<BatchJob> res;
+	res.reserve(input_paths.size());
+	for (const auto &input_path : input_paths) {
+		auto output_path = fs::path(options._OutputDir) / fs::path(input_path).stem();
+		output_path += options._OutputFormat;
+		res.push_back({ input_path, output_path.string() });
+	}
+	return res;
+}
+
+// the selected effects, in order, with the parameters of the command line
+// runs of consecutive pointwise passes (e.g. exposure, color grading, tonemapping) render as one pass unless disabled
+bool setup_chain(const BatchOptions &options, const EffectChain &chain) {
+	if (options._EffectNames.empty()) {
+		std::printf("available effects:\n");
+		for (const auto &category : chain.get_categories()) {
+			for (const auto &effect_name : chain.get_effect_names(category)) {
+				std::printf("  [%s] %s\n", category.c_str(), effect_name.c_str());
+			}
+		}
+		return false;
+	}
+
+	if (!chain.set_effects(options._EffectNames)) {
+		g_logger->error("an effect is not in {} or failed to build", options._ConfigPath);
+		return false;
+	}
+	chain.set_fusion_enabled(options._IsFusionEnabled);
+	chain.set_auto_precision_enabled(options._IsAutoPrecisionEnabled);
+
+	for (const auto &[name, value] : options._Uniforms) {
+		for (const auto &effect_name : options._EffectNames) {
+			chain.set_parameter(effect_name, name, glm::vec4(value));
+		}
+	}
+	return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	BatchOptions options;
+	if (!parse_options(argc, argv, options)) {
+		return -1;
+	}
+
+	auto jobs = collect_jobs(options);
+	if (jobs.empty() && !options._EffectNames.empty()) {
+		g_logger->error("no input image");
+		return -1;
+	}
+
+	auto &app = App::instance();
+	if (!app.init_headless()) {
+		return -1;
+	}
+
+	int exit_code = 0;
+	{
+		auto processor = BatchImageProcessor::BatchImageProcessorBuilder("batch")
+		                     .set_tile_size(options._TileSize)
+		                     .set_apron(options._Apron)
+		                     .set_thread_count(options._NumDecodeThreads, options._NumEncodeThreads)
+		                     .set_queue_capacity(options._QueueCapacity)
+		                     .build();
+
+		auto chain = EffectChain::EffectChainBuilder("effect_chain")
+		                 .set_config_file(options._ConfigPath)
+		                 .set_shader_root(options._ShaderRoot)
+		                 .build();
+		if (!processor.is_complete() || !chain.is_complete() || !setup_chain(options, chain)) {
+			app.shutdown();
+			return options._EffectNames.empty() ? 0 : -1;
+		}
+
+		// the chain ping-pongs between two tile-sized targets, the output one is kept until the processor read it back
+		auto render_target_pool = RenderTargetPool::RenderTargetPoolBuilder("render_target_pool").build();
+		size_t tile_texture_size = processor.get_tile_texture_size();
+		RenderTargetDesc tile_target_desc{ ._Width = tile_texture_size, ._Height = tile_texture_size, ._InternalFormat = GL_RGBA32F };
+
+		fs::create_directories(options._OutputDir);
+
+		std::optional<PooledRenderTarget> output_tile;
+		float max_precision_error = 0.0f;
+		auto run_chain = [&](const Texture &input_tile) -> const Texture & {
+			if (output_tile.has_value()) {
+				render_target_pool.release(*output_tile);
+				output_tile.reset();
+			}
+			if (options._IsPrecisionValidated) {
+				max_precision_error = std::max(max_precision_error, chain.validate_precision(input_tile, render_target_pool, tile_target_desc).value_or(0.0f));
+			}
+
+			glm::vec2 uv_scale(1.0f);  // tiles are always rendered at full resolution
+			output_tile = chain.execute(input_tile, uv_scale, render_target_pool, tile_target_desc);
+			return output_tile.has_value() ? output_tile->_Texture : input_tile;
+		};
+
+		BatchProcessingStats stats;
+		if (!processor.process(jobs, run_chain, &stats)) {
+			exit_code = -1;
+		}
+
+		std::printf("%zu image(s), %zu failed, %.3fs: %.2f images/s, %.2f MP/s\n",
+		            stats._NumImages,
+		            stats._NumFailed,
+		            stats._Seconds,
+		            stats.get_images_per_second(),
+		            stats.get_megapixels_per_second());
+		for (const auto &pass_stats : chain.get_pass_stats()) {  // of the last tile
+			std::printf("  %s: %.3fms\n", pass_stats._Name.c_str(), pass_stats._GPUMs.value_or(0.0f));
+		}
+		if (options._IsPrecisionValidated) {
+			std::printf("largest difference to full precision: %g\n", max_precision_error);
+		}
+	}
+
+	app.shutdown();
+
+	return exit_code;
+}
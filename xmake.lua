@@ -4,6 +4,7 @@ add_rules("mode.debug", "mode.release")
 add_requires("spdlog", "glm", "glad", "glfw", "stb")
 add_requires("imgui", {configs = { glfw = true, opengl3 = true }})
 add_requires("jsoncpp")
+add_requires("zlib")
 
 target("gfx-utils-core")
     set_languages("cxx20")
@@ -15,6 +16,7 @@ target("gfx-utils-core")
     add_headerfiles("include/(gfx-utils-core/interfaces/*.h)")
     add_files("src/**.cpp")
     add_packages("spdlog", "glm", "glad", "glfw", "imgui", "stb", {public = true})
+    add_packages("zlib", "jsoncpp")
 
     if is_plat("windows") then
         add_cxflags("/utf-8", {force = true})
@@ -25,6 +27,27 @@ target("gfx-utils-core")
     end
 target_end()
 
+target("gfx-utils-batch")
+    set_languages("cxx20")
+    set_kind("binary")
+    set_warnings("all", "error", "extra", "pedantic")
+
+    add_files("tools/batch.cpp")
+    add_deps("gfx-utils-core")
+
+    if is_plat("windows") then
+        add_cxflags("/utf-8", {force = true})
+        add_cxxflags("/utf-8", {force = true})
+        add_cxxflags("/wd4068", {force = true}) -- for #pragma clang
+    elseif is_plat("linux") then
+        add_cxxflags("-Wno-unknown-pragmas", {force = true}) -- for #pragma clang
+    end
+
+    after_build(function (target)
+        os.cp(target:targetfile(), "bin/")
+    end)
+target_end()
+
 function add_example(example_name, extra_pkgs)
     target("example-" .. example_name)
         set_languages("cxx20")
@@ -58,4 +81,5 @@ add_example("create_window")
 add_example("mrt")
 add_example("compute")
 add_example("texture_io")
-add_example("post_processing", {"jsoncpp"})
+add_example("post_processing")
+add_example("atlas")